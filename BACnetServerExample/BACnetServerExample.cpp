@@ -17,8 +17,17 @@
 // !!!!!! This file is part of the CAS BACnet Stack. Please contact Chipkin for more information.
 // !!!!!! https://github.com/chipkin/BACnetServerExampleCPP/issues/8
 
+#include "CASBACnetStackExampleCallbackLatency.h"
 #include "CASBACnetStackExampleConstants.h"
 #include "CASBACnetStackExampleDatabase.h"
+#include "CASBACnetStackExampleDeviceRegistry.h"
+#include "CASBACnetStackExampleLoopProfiler.h"
+#include "CASBACnetStackExampleMetrics.h"
+#include "CASBACnetStackExampleMetricsServer.h"
+#include "CASBACnetStackExampleObjectDescriptors.h"
+#include "CASBACnetStackExampleSelfTest.h"
+#include "CASBACnetStackExampleStartupTrace.h"
+#include "CASBACnetStackExampleVirtualRouter.h"
 #include "CIBuildSettings.h"
 
 // Helpers 
@@ -28,6 +37,8 @@
 #include "ChipkinUtilities.h"
 
 #include <iostream>
+#include <chrono>
+#include <signal.h>
 #ifndef __GNUC__ // Windows
 	#include <conio.h> // _kbhit
 #else // Linux 
@@ -47,6 +58,7 @@
 	#include <termios.h>
 	#include <unistd.h>
 	#include <fcntl.h>
+	#include <sys/resource.h> // getrusage()
 	void Sleep(int milliseconds) {
 		usleep(milliseconds * 1000);
 	}
@@ -56,14 +68,24 @@
 // Globals
 // =======================================
 CSimpleUDP g_udp; // UDP resource
+ExampleVirtualTimeSource g_virtualTime(1.0); // Time source of the database clock with --virtual-time. Declared before the database, which uses it until it is destroyed.
 ExampleDatabase g_exampleDatabase; // The example database that stores current values.
+ExampleDeviceRegistry g_deviceRegistry; // The devices hosted next to the example device, each with its own points.
+uint32_t g_hostedPointCount; // Number of points of a hosted device added at runtime.
+ExampleVirtualRouter g_virtualRouter; // Routes to the hosted devices on a virtual network with --virtual-network.
+ExampleServerMetrics g_metrics; // Packets, requests, callbacks, errors and tick duration.
+ExampleMetricsRegistry g_metricsRegistry; // The metrics served by g_metricsServer.
+ExampleMetricsServer g_metricsServer; // Scrape endpoint of the metrics with --metrics.
+ExampleCallbackLatency g_callbackLatency; // Latency of the callbacks by callback and object type, printed with 'l' or SIGUSR1.
+volatile sig_atomic_t g_printCallbackLatency; // Set by SIGUSR1, the main loop prints the callback latency.
+ExampleLoopProfiler g_loopProfiler; // Time spent in each phase of the main loop.
 bool g_bbmdEnabled; // Flag for whether bbmd was enabled or not.  Users can enable bbmd by pressing 'b' after the application has started.
 bool g_warmStart; // Flag for when warm start reinitialization is requested.
 time_t g_warmStartTimer; // Timer used for delaying the warm start.
 
 // Constants
 // =======================================
-const std::string APPLICATION_VERSION = "1.0.0";  // See CHANGELOG.md for a full list of changes.
+const std::string APPLICATION_VERSION = "1.1.0";  // See CHANGELOG.md for a full list of changes.
 const uint32_t MAX_RENDER_BUFFER_LENGTH = 1024 * 20;
 
 
@@ -113,6 +135,11 @@ bool HookTextMessage(const uint32_t sourceDeviceIdentifier, const bool useMessag
 // Helper functions 
 void RegisterCallbacks();
 bool SetupDevice();
+bool SetupObjectTemplates();
+bool SetupHostedDevice(ExampleHostedDevice& device);
+bool AddHostedDevice(const uint32_t instance, const uint32_t pointCount);
+bool RemoveHostedDevice(const uint32_t instance);
+void PrintSoakReport(const double simulatedHours, const double realSeconds, const uint64_t ticks);
 bool SendIAm(uint8_t* connectionString, uint8_t connectionStringLength);
 void WarmStart();
 bool DoUserInput();
@@ -121,87 +148,473 @@ bool GetObjectName(const uint32_t deviceInstance, const uint16_t objectType, con
 // Debug Message Function
 void CallbackLogDebugMessage(const char* message, const uint16_t messageLength, const uint8_t messageType);
 
+#ifdef __GNUC__
+// SIGUSR1 handler, only sets the flag
+void ExampleRequestCallbackLatency(int signalNumber) {
+	g_printCallbackLatency = 1;
+}
+#endif // __GNUC__
+
+// Passed to ExampleDirtyPointSet::Drain to notify the stack of the points that changed
+struct ExampleNotifyValueUpdated {
+	void operator()(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier) {
+		// Lets the stack check for logic that may need to run on the data. Example: check if COV (change of value) occurred.
+		if (fpValueUpdated != NULL) {
+			fpValueUpdated(g_exampleDatabase.device.instance, objectType, objectInstance, propertyIdentifier);
+		}
+	}
+};
+
+// Passed to ExampleVirtualRouter::Loop to broadcast the messages of the router on the BACnet/IP network
+struct ExampleSendRouterBroadcast {
+	bool operator()(const uint8_t* message, const uint16_t length) {
+		uint8_t connectionString[6];
+		memcpy(connectionString, g_exampleDatabase.networkPort.BroadcastIPAddress, 4);
+		connectionString[4] = g_exampleDatabase.networkPort.BACnetIPUDPPort / 256;
+		connectionString[5] = g_exampleDatabase.networkPort.BACnetIPUDPPort % 256;
+		return CallbackSendMessage(message, length, connectionString, 6, CASBACnetStackExampleConstants::NETWORK_TYPE_IP, true) == length;
+	}
+};
+
+// Registered in place of the set property callbacks. Calls the callback and, if the write was accepted,
+// logs the object's values to the write-ahead log so the new value is saved. All the set property callbacks start with
+// deviceInstance, objectType, objectInstance, propertyIdentifier.
+template <typename Signature, Signature Callback>
+struct ExampleTrackWrite;
+
+template <typename... Args, bool (*Callback)(uint32_t, uint16_t, uint32_t, uint32_t, Args...)>
+struct ExampleTrackWrite<bool (*)(uint32_t, uint16_t, uint32_t, uint32_t, Args...), Callback> {
+	static bool Call(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, Args... args) {
+		// The hosted devices are not saved. Checked before the write, a write of the Device Object_Identifier changes the instance.
+		const bool saved = deviceInstance == g_exampleDatabase.device.instance;
+		if (!Callback(deviceInstance, objectType, objectInstance, propertyIdentifier, args...)) {
+			return false;
+		}
+		if (saved) {
+			// The device is saved under its new instance
+			g_exampleDatabase.LogPersistentWrite(objectType, objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE ? g_exampleDatabase.device.instance : objectInstance);
+		}
+		return true;
+	}
+};
+#define EXAMPLE_TRACK_WRITE(callback) ExampleTrackWrite<decltype(&callback), &callback>::Call
+
+// Counts the error code of a callback that failed. The callbacks that return an error code have it as their last parameter.
+inline void ExampleCountErrorCode() {
+}
+inline void ExampleCountErrorCode(uint32_t* errorCode) {
+	if (errorCode != NULL) {
+		g_metrics.CountError(*errorCode);
+	}
+}
+template <typename First, typename... Rest>
+inline void ExampleCountErrorCode(First, Rest... rest) {
+	ExampleCountErrorCode(rest...);
+}
+
+// The object type of the property and object callbacks, their second parameter
+template <typename... Rest>
+inline uint16_t ExampleCallbackObjectType(const uint32_t deviceInstance, const uint16_t objectType, Rest...) {
+	return objectType;
+}
+inline uint16_t ExampleCallbackObjectType(...) {
+	return ExampleCallbackLatency::OBJECT_TYPE_NONE;
+}
+#define EXAMPLE_CALLBACK_HAS_OBJECT_TYPE(type) ((type) >= ExampleServerMetrics::CALLBACK_GET_PROPERTY_BIT_STRING && (type) <= ExampleServerMetrics::CALLBACK_DELETE_OBJECT)
+
+// Registered in place of all the callbacks. Counts the calls of the callback and the errors it returns through errorCode,
+// and times the callback by object type (CASBACnetStackExampleCallbackLatency.h).
+template <typename Signature, Signature Callback, ExampleServerMetrics::Callback Type>
+struct ExampleCountCallback;
+
+template <typename Result, typename... Args, Result (*Callback)(Args...), ExampleServerMetrics::Callback Type>
+struct ExampleCountCallback<Result (*)(Args...), Callback, Type> {
+	static Result Call(Args... args) {
+		g_metrics.callbacks[Type].Increment();
+		Result result;
+		{
+			ExampleScopedCallbackTimer timer(g_callbackLatency, Type, EXAMPLE_CALLBACK_HAS_OBJECT_TYPE(Type) ? ExampleCallbackObjectType(args...) : ExampleCallbackLatency::OBJECT_TYPE_NONE);
+			result = Callback(args...);
+		}
+		if (!result) {
+			ExampleCountErrorCode(args...);
+		}
+		return result;
+	}
+};
+
+template <typename... Args, void (*Callback)(Args...), ExampleServerMetrics::Callback Type>
+struct ExampleCountCallback<void (*)(Args...), Callback, Type> {
+	static void Call(Args... args) {
+		g_metrics.callbacks[Type].Increment();
+		ExampleScopedCallbackTimer timer(g_callbackLatency, Type, ExampleCallbackLatency::OBJECT_TYPE_NONE);
+		Callback(args...);
+	}
+};
+#define EXAMPLE_COUNT_CALLBACK(type, callback) ExampleCountCallback<decltype(&callback), &callback, ExampleServerMetrics::type>::Call
+
 int main(int argc, char** argv)
 {
 	// Print the application version information 
 	std::cout << "CAS BACnet Stack Server Example v" << APPLICATION_VERSION << "." << CIBUILDNUMBER << std::endl; 
 	std::cout << "https://github.com/chipkin/BACnetServerExampleCPP" << std::endl << std::endl;
+	g_exampleDatabase.SetApplicationSoftwareVersion(APPLICATION_VERSION);
+
+	// Test producer for the shared memory point ingestion: --shm-producer [deviceInstance] [seconds]
+	if (argc >= 2 && strcmp(argv[1], "--shm-producer") == 0) {
+		const uint32_t deviceInstance = argc >= 3 ? (uint32_t)atoi(argv[2]) : g_exampleDatabase.device.instance;
+		const uint32_t seconds = argc >= 4 ? (uint32_t)atoi(argv[3]) : 10;
+		return ExampleSharedPointsTestProducer(ExampleSharedPoints::GetDefaultName(deviceInstance), seconds);
+	}
+	// Stress test of the shared memory point ingestion, without a server: --shm-stress [seconds] [producers]
+	if (argc >= 2 && strcmp(argv[1], "--shm-stress") == 0) {
+		const uint32_t seconds = argc >= 3 ? (uint32_t)atoi(argv[2]) : 10;
+		const uint32_t producerCount = argc >= 4 ? (uint32_t)atoi(argv[3]) : 4;
+		return ExampleSharedPointsStressTest(seconds, producerCount);
+	}
+	// Stress test of the seqlock that guards the multi-word point values: --stress-seqlock [seconds] [writers] [readers]
+	if (argc >= 2 && strcmp(argv[1], "--stress-seqlock") == 0) {
+		const uint32_t seconds = argc >= 3 ? (uint32_t)atoi(argv[2]) : 10;
+		const uint32_t writerCount = argc >= 4 ? (uint32_t)atoi(argv[3]) : 3;
+		const uint32_t readerCount = argc >= 5 ? (uint32_t)atoi(argv[4]) : 1;
+		return ExampleSeqLockStressTest(seconds, writerCount, readerCount);
+	}
+	// Benchmark of the dirty point set that batches fpValueUpdated: --benchmark-dirty-points [points]
+	if (argc >= 2 && strcmp(argv[1], "--benchmark-dirty-points") == 0) {
+		return ExampleDirtyPointSetBenchmark(argc >= 3 ? (uint32_t)atoi(argv[2]) : 50000);
+	}
+	// Benchmark of the COV increment pre-filter, scalar and AVX2: --benchmark-cov-filter [points] [ticks]
+	if (argc >= 2 && strcmp(argv[1], "--benchmark-cov-filter") == 0) {
+		const uint32_t pointCount = argc >= 3 ? (uint32_t)atoi(argv[2]) : 100000;
+		const uint32_t tickCount = argc >= 4 ? (uint32_t)atoi(argv[3]) : 200;
+		return ExampleCovFilterBenchmark(pointCount, tickCount);
+	}
+	// Benchmark of the persistent image save and startup: --benchmark-image [objects]
+	if (argc >= 2 && strcmp(argv[1], "--benchmark-image") == 0) {
+		return ExamplePersistentImageBenchmark(argc >= 3 ? (uint32_t)atoi(argv[2]) : 100000);
+	}
+	// Benchmark of the durable writes through the write-ahead log: --benchmark-wal [writes] [writes per tick]
+	if (argc >= 2 && strcmp(argv[1], "--benchmark-wal") == 0) {
+		return ExampleWriteAheadLogBenchmark(argc >= 3 ? (uint32_t)atoi(argv[2]) : 2000, argc >= 4 ? (uint32_t)atoi(argv[3]) : 100);
+	}
+	// Benchmark of the JSON and compiled device profile at startup: --benchmark-startup [objects]
+	if (argc >= 2 && strcmp(argv[1], "--benchmark-startup") == 0) {
+		return ExampleStartupBenchmark(argc >= 3 ? (uint32_t)atoi(argv[2]) : 10000);
+	}
+	// Benchmark of the hosted device registry: --benchmark-hosted-devices [devices] [points]
+	if (argc >= 2 && strcmp(argv[1], "--benchmark-hosted-devices") == 0) {
+		return ExampleHostedDevicesBenchmark(argc >= 3 ? (uint32_t)atoi(argv[2]) : 1000, argc >= 4 ? (uint32_t)atoi(argv[3]) : 100);
+	}
+	// Test of the virtual router with a routed ReadProperty and its answer: --test-virtual-router
+	if (argc >= 2 && strcmp(argv[1], "--test-virtual-router") == 0) {
+		return ExampleVirtualRouterTest();
+	}
+	// Benchmark of the object lookup on the property callbacks of PROPERTY_IDENTIFIER_ALL reads: --benchmark-property-all [rounds]
+	if (argc >= 2 && strcmp(argv[1], "--benchmark-property-all") == 0) {
+		const ExampleGetPropertyCallbacks callbacks = { CallbackGetPropertyBool, CallbackGetPropertyCharString, CallbackGetPropertyReal };
+		return ExamplePropertyAllBenchmark(g_exampleDatabase, callbacks, argc >= 3 ? (uint32_t)atoi(argv[2]) : 1000000);
+	}
+
+	// Offline step: compiles a JSON device profile into a binary image for --profile. --compile-profile profile image
+	if (argc >= 2 && strcmp(argv[1], "--compile-profile") == 0) {
+		if (argc < 4) {
+			std::cerr << "Usage: --compile-profile <profile.json> <output>" << std::endl;
+			return 1;
+		}
+		uint32_t profileObjectCount = 0;
+		const std::chrono::steady_clock::time_point compileStart = std::chrono::steady_clock::now();
+		if (!g_exampleDatabase.LoadProfile(argv[2], &profileObjectCount) || !g_exampleDatabase.CompileProfile(argv[3])) {
+			std::cerr << "Failed to compile the device profile" << std::endl;
+			return 1;
+		}
+		const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileStart).count();
+		std::cout << "FYI: Compiled the device profile. path=[" << argv[3] << "], objects=[" << profileObjectCount << "], time=[" << milliseconds << " ms]" << std::endl;
+		return 0;
+	}
+
+	// Command line: [--profile path] [--startup-trace path] [--shm-replace] [--virtual-time rate] [--soak hours] [--hosted-devices count] [--hosted-points count] [--virtual-network number] [--iam-rate count] [--metrics port|path] [--latency-sample period] [--loop-summary seconds] [deviceInstance]
+	const char* profilePath = NULL;
+	const char* startupTracePath = NULL;
+	const char* deviceInstanceArgument = NULL;
+	const char* metricsAddress = NULL;
+	bool replaceSharedPoints = false;
+	double virtualTimeRate = 0;
+	double soakHours = 0;
+	uint32_t hostedDeviceCount = 0;
+	uint32_t virtualNetworkNumber = 0;
+	uint32_t iAmRate = 100;
+	g_hostedPointCount = 10;
+	for (int offset = 1; offset < argc; offset++) {
+		if (strcmp(argv[offset], "--profile") == 0 && offset + 1 < argc) {
+			profilePath = argv[++offset];
+		}
+		else if (strcmp(argv[offset], "--startup-trace") == 0 && offset + 1 < argc) {
+			startupTracePath = argv[++offset];
+		}
+		else if (strcmp(argv[offset], "--shm-replace") == 0) {
+			replaceSharedPoints = true;
+		}
+		else if (strcmp(argv[offset], "--virtual-time") == 0 && offset + 1 < argc) {
+			virtualTimeRate = atof(argv[++offset]);
+		}
+		else if (strcmp(argv[offset], "--soak") == 0 && offset + 1 < argc) {
+			soakHours = atof(argv[++offset]);
+		}
+		else if (strcmp(argv[offset], "--hosted-devices") == 0 && offset + 1 < argc) {
+			hostedDeviceCount = (uint32_t)atoi(argv[++offset]);
+		}
+		else if (strcmp(argv[offset], "--hosted-points") == 0 && offset + 1 < argc) {
+			g_hostedPointCount = (uint32_t)atoi(argv[++offset]);
+		}
+		else if (strcmp(argv[offset], "--virtual-network") == 0 && offset + 1 < argc) {
+			virtualNetworkNumber = (uint32_t)atoi(argv[++offset]);
+		}
+		else if (strcmp(argv[offset], "--iam-rate") == 0 && offset + 1 < argc) {
+			iAmRate = (uint32_t)atoi(argv[++offset]);
+		}
+		else if (strcmp(argv[offset], "--metrics") == 0 && offset + 1 < argc) {
+			metricsAddress = argv[++offset];
+		}
+		else if (strcmp(argv[offset], "--latency-sample") == 0 && offset + 1 < argc) {
+			g_callbackLatency.SetSamplePeriod((uint32_t)atoi(argv[++offset]));
+		}
+		else if (strcmp(argv[offset], "--loop-summary") == 0 && offset + 1 < argc) {
+			g_loopProfiler.SetSummaryInterval((uint32_t)atoi(argv[++offset]));
+		}
+		else {
+			deviceInstanceArgument = argv[offset];
+		}
+	}
+
+	// Apply the device profile over the default values, either a JSON profile or one compiled with
+	// --compile-profile. The device instance from the command line still takes precedence over the one in the profile.
+	ExampleStartupTrace& trace = ExampleStartupTrace::Get();
+	if (profilePath != NULL) {
+		trace.Begin("Load profile");
+		const bool compiled = ExampleCompiledProfile::IsCompiledProfile(profilePath);
+		std::cout << "FYI: Loading " << (compiled ? "compiled " : "") << "device profile. path=[" << profilePath << "]... ";
+		const std::chrono::steady_clock::time_point profileStart = std::chrono::steady_clock::now();
+		uint32_t profileObjectCount = 0;
+		if (compiled ? !g_exampleDatabase.LoadCompiledProfile(profilePath, &profileObjectCount) : !g_exampleDatabase.LoadProfile(profilePath, &profileObjectCount)) {
+			std::cerr << "Failed to load the device profile" << std::endl;
+			return 0;
+		}
+		const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - profileStart).count();
+		std::cout << "OK, objects=[" << profileObjectCount << "], created=[" << g_exampleDatabase.CreatedAnalogValueData.size() << "], properties=[" << g_exampleDatabase.profileProperties.size() << "], time=[" << milliseconds << " ms]" << std::endl;
+		trace.SetCount(profileObjectCount);
+		trace.End();
+	}
 
 	// Check to see if they defined the device.instance via the command arguments.
-	if (argc >= 2) {		
-		g_exampleDatabase.device.instance = atoi(argv[1]); 
+	if (deviceInstanceArgument != NULL) {
+		g_exampleDatabase.device.instance = atoi(deviceInstanceArgument);
 		std::cout << "FYI: Device instance= " << g_exampleDatabase.device.instance << std::endl;
 	}
 	else {
 		std::cout << "FYI: Default to use device instance= " << g_exampleDatabase.device.instance << std::endl;
 	}
 
+	// Restore the values saved by the last run. The image is named after the device instance the
+	// application was started with, the device instance itself may have been changed since.
+	const std::string persistentImagePath = ExampleDatabase::GetDefaultPersistentImagePath(g_exampleDatabase.device.instance);
+	std::cout << "FYI: Loading persistent image. path=[" << persistentImagePath << "]... ";
+	trace.Begin("Open persistent image");
+	const std::chrono::steady_clock::time_point persistentImageStart = std::chrono::steady_clock::now();
+	if (g_exampleDatabase.OpenPersistentImage(persistentImagePath)) {
+		const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - persistentImageStart).count();
+		std::cout << "OK, generation=[" << g_exampleDatabase.persistentImage.GetGeneration() << "], records=[" << g_exampleDatabase.persistentImage.GetRecordCount() << "], replayed=[" << g_exampleDatabase.GetReplayedWriteCount() << "], time=[" << milliseconds << " ms]" << std::endl;
+	}
+	else {
+		std::cout << "Not available, using the default values" << std::endl;
+	}
+	trace.End();
+
+	// Run the stack and application timers on simulated time, virtualTimeRate simulated seconds per second
+	if (virtualTimeRate > 0) {
+		g_virtualTime.SetRate(virtualTimeRate);
+		g_exampleDatabase.clock.SetTimeSource(&g_virtualTime);
+		std::cout << "FYI: Using virtual time. rate=[" << virtualTimeRate << "], soak=[" << soakHours << " h]" << std::endl;
+	}
+
 	// Initialize global flags
 	g_bbmdEnabled = false;
+	g_printCallbackLatency = 0;
+#ifdef __GNUC__
+	// kill -USR1 <pid> prints the callback latency, the same as the 'l' key
+	signal(SIGUSR1, ExampleRequestCallbackLatency);
+#endif // __GNUC__
 	g_warmStart = false;
-	g_warmStartTimer = time(0);
+	g_warmStartTimer = g_exampleDatabase.clock.GetSystemTime();
 
 	// 1. Load the CAS BACnet stack functions
 	// ---------------------------------------------------------------------------
 	std::cout << "FYI: Loading CAS BACnet Stack functions... "; 
+	trace.Begin("LoadBACnetFunctions");
 	if (!LoadBACnetFunctions()) {
 		std::cerr << "Failed to load the functions from the DLL" << std::endl;
 		return 0;
 	}
+	trace.End();
 	std::cout << "OK" << std::endl;
 	std::cout << "FYI: CAS BACnet Stack version: " << fpGetAPIMajorVersion() << "." << fpGetAPIMinorVersion() << "." << fpGetAPIPatchVersion() << "." << fpGetAPIBuildVersion() << std::endl;
 
 	// 2. Connect the UDP resource to the BACnet Port
 	// ---------------------------------------------------------------------------
 	std::cout << "FYI: Connecting UDP Resource to port=["<< g_exampleDatabase.networkPort.BACnetIPUDPPort << "]... ";
+	trace.Begin("Connect UDP");
 	if (!g_udp.Connect(g_exampleDatabase.networkPort.BACnetIPUDPPort)) {
 		std::cerr << "Failed to connect to UDP Resource" << std::endl ;
 		std::cerr << "Press any key to exit the application..." << std::endl;
 		(void) getchar();
 		return -1;
 	}
+	trace.End();
 	std::cout << "OK, Connected to port" << std::endl;
 
 
 	// 3. Setup the callbacks
 	// ---------------------------------------------------------------------------
+	trace.Begin("RegisterCallbacks");
 	RegisterCallbacks();
+	trace.End();
 
 	// 4. Setup the BACnet device
 	// ---------------------------------------------------------------------------
+	trace.Begin("SetupDevice");
 	if (!SetupDevice()) {
 		return false;
 	}
+	trace.End();
+
+	// Put the hosted devices on a virtual network behind this server, acting as a router
+	if (virtualNetworkNumber != 0) {
+		if (virtualNetworkNumber > 65534 || !g_virtualRouter.Enable((uint16_t)virtualNetworkNumber, &g_deviceRegistry, iAmRate)) {
+			std::cerr << "Error - Invalid virtual network. number=[" << virtualNetworkNumber << "], iAmRate=[" << iAmRate << "]" << std::endl;
+			return false;
+		}
+		std::cout << "FYI: Virtual network enabled. number=[" << virtualNetworkNumber << "], iAmRate=[" << iAmRate << " per second]" << std::endl;
+	}
+
+	// Gateway devices hosted next to the example device, numbered after it
+	if (hostedDeviceCount > 0) {
+		std::cout << "FYI: Adding hosted devices. devices=[" << hostedDeviceCount << "], points=[" << g_hostedPointCount << "]... ";
+		trace.Begin("Hosted devices");
+		const std::chrono::steady_clock::time_point hostedStart = std::chrono::steady_clock::now();
+		for (uint32_t offset = 1; offset <= hostedDeviceCount; offset++) {
+			if (!AddHostedDevice(g_exampleDatabase.device.instance + offset, g_hostedPointCount)) {
+				return false;
+			}
+		}
+		trace.SetCount((uint32_t)g_deviceRegistry.GetPointCount());
+		trace.End();
+		const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - hostedStart).count();
+		std::cout << "OK, time=[" << milliseconds << " ms]" << std::endl;
+	}
 
 	// 5. Send I-Am of this device
 	// ---------------------------------------------------------------------------
 	// To be a good citizen on a BACnet network. We should announce ourself when we start up. 
 	uint8_t connectionString[6];
+	trace.Begin("Send I-Am");
 	if (!SendIAm(connectionString, 6)) {
 		return false;
 	}
+	trace.End();
+	// The router and the hosted devices on the virtual network are announced by the router, paced
+	if (g_virtualRouter.IsEnabled()) {
+		g_virtualRouter.AnnounceNetwork();
+	}
 
 	// Broadcast BACnet stack version to the network via UnconfirmedTextMessage
 	char stackVersionInfo[50];
 	sprintf(stackVersionInfo, "CAS BACnet Stack v%u.%u.%u.%u", fpGetAPIMajorVersion(), fpGetAPIMinorVersion(), fpGetAPIPatchVersion(), fpGetAPIBuildVersion());
+	trace.Begin("Send text message");
 	if (!fpSendUnconfirmedTextMessage(g_exampleDatabase.device.instance, false, 0, NULL, 0, 0, stackVersionInfo, strlen(stackVersionInfo), connectionString, 6, CASBACnetStackExampleConstants::NETWORK_TYPE_IP, true, 65535, NULL, 0)) {
 		std::cerr << "Unable to send UnconfirmedTextMessage broadcast" << std::endl;
 		return false;
 	}
+	trace.End();
 
 	
+	// Let external acquisition processes write the input points. Optional, the example runs without it.
+	std::cout << "FYI: Creating shared memory segment for the input points... ";
+	trace.Begin("CreateSharedPoints");
+	if (g_exampleDatabase.CreateSharedPoints(ExampleSharedPoints::GetDefaultName(g_exampleDatabase.device.instance), replaceSharedPoints)) {
+		std::cout << "OK, name=[" << ExampleSharedPoints::GetDefaultName(g_exampleDatabase.device.instance) << "]" << std::endl;
+	}
+	else {
+		std::cout << "Not available" << std::endl;
+	}
+	trace.End();
+
+	// Scrape endpoint of the metrics, on localhost or a Unix domain socket. Optional, the example runs without it.
+	g_metrics.Register(g_metricsRegistry);
+	g_loopProfiler.Register(g_metricsRegistry);
+	if (metricsAddress != NULL) {
+		std::cout << "FYI: Opening the metrics endpoint. address=[" << metricsAddress << "]... ";
+		trace.Begin("Open metrics endpoint");
+		if (g_metricsServer.Open(metricsAddress)) {
+			std::cout << "OK, metrics=[" << g_metricsRegistry.GetCount() << "]" << std::endl;
+		}
+		else {
+			std::cout << "Not available" << std::endl;
+		}
+		trace.End();
+	}
+
+	// Where the startup time went
+	trace.Finish();
+	trace.PrintSummary(std::cout);
+	if (startupTracePath != NULL && trace.WriteChromeTrace(startupTracePath)) {
+		std::cout << "FYI: Startup trace written. path=[" << startupTracePath << "]" << std::endl;
+	}
+
 	// 6. Start the main loop
 	// ---------------------------------------------------------------------------
 	std::cout << "FYI: Entering main loop..." << std::endl ;
+	// With virtual time the resource usage is reported once per simulated hour
+	const time_t soakStartTime = g_exampleDatabase.clock.GetSystemTime();
+	time_t soakReportTime = virtualTimeRate > 0 ? soakStartTime + 3600 : 0;
+	const std::chrono::steady_clock::time_point soakRealStart = std::chrono::steady_clock::now();
+	uint64_t ticks = 0;
+	// Each phase of the loop ends with a lap of the profiler
+	g_loopProfiler.Start(g_callbackLatency);
 	for (;;) {
+		ticks++;
 
 		// Starts warm start reinitialization when requested (after 3 seconds).
-		if (g_warmStart && g_warmStartTimer + 3 < time(0)) {
+		if (g_warmStart && g_warmStartTimer + 3 < g_exampleDatabase.clock.GetSystemTime()) {
 			WarmStart();
 		}
+		g_loopProfiler.Lap(ExampleLoopProfiler::PHASE_WARM_START);
 
 		// Call the DLLs loop function which checks for messages and processes them.
+		// All the callbacks of this tick read the input points from the same snapshot, and the time from
+		// the clock refreshed here.
+		g_exampleDatabase.clock.Refresh();
+		g_exampleDatabase.snapshot.BeginRead();
+		g_loopProfiler.Lap(ExampleLoopProfiler::PHASE_CLOCK);
+		const std::chrono::steady_clock::time_point tickStart = std::chrono::steady_clock::now();
 		fpTick();
+		g_metrics.tickDuration.Record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tickStart).count());
+		g_exampleDatabase.snapshot.EndRead();
+		g_loopProfiler.Lap(ExampleLoopProfiler::PHASE_TICK);
+
+		// The paced I-Am responses of the devices on the virtual network
+		ExampleSendRouterBroadcast sendRouterBroadcast;
+		g_virtualRouter.Loop(sendRouterBroadcast);
+		g_metrics.pendingIAm.Set((int64_t)g_virtualRouter.GetPendingCount());
+		g_loopProfiler.Lap(ExampleLoopProfiler::PHASE_ROUTER);
+
+		// Answers the metrics scrapes
+		g_metricsServer.Poll(g_metricsRegistry);
+
+		// Requested with SIGUSR1
+		if (g_printCallbackLatency != 0) {
+			g_printCallbackLatency = 0;
+			g_callbackLatency.Print(std::cout);
+		}
+		g_loopProfiler.Lap(ExampleLoopProfiler::PHASE_METRICS);
 
 		// Handle any user input.
 		// Note: User input in this example is used for the following:
@@ -210,14 +623,37 @@ int main(int argc, char** argv)
 		//		q - Quit
 		if (!DoUserInput()) {
 			// User press 'q' to quit the example application.
+			g_exampleDatabase.SavePersistentImage();
 			break;
 		}
+		g_loopProfiler.Lap(ExampleLoopProfiler::PHASE_USER_INPUT);
 
 		// Update values in the example database
 		g_exampleDatabase.Loop();
+		g_loopProfiler.Lap(ExampleLoopProfiler::PHASE_DATABASE);
+
+		// Notify the stack of the points that changed since the last tick
+		ExampleNotifyValueUpdated notifyValueUpdated;
+		g_exampleDatabase.dirtyPoints.Drain(notifyValueUpdated);
+		g_loopProfiler.Lap(ExampleLoopProfiler::PHASE_NOTIFY);
+
+		// Soak test on virtual time, stops after soakHours simulated hours
+		if (soakReportTime != 0 && g_exampleDatabase.clock.GetSystemTime() >= soakReportTime) {
+			soakReportTime += 3600;
+			const double simulatedHours = (double)(g_exampleDatabase.clock.GetSystemTime() - soakStartTime) / 3600.0;
+			PrintSoakReport(simulatedHours, std::chrono::duration<double>(std::chrono::steady_clock::now() - soakRealStart).count(), ticks);
+			if (soakHours > 0 && simulatedHours >= soakHours) {
+				g_exampleDatabase.SavePersistentImage();
+				break;
+			}
+		}
 
 		// Call Sleep to give some time back to the system
 		Sleep(0); // Windows 
+		g_loopProfiler.Lap(ExampleLoopProfiler::PHASE_SLEEP);
+
+		// The metrics of the profiler once per second, and the one line summary
+		g_loopProfiler.EndIteration(g_callbackLatency, std::cout);
 	}
 
 	// All done. 
@@ -230,61 +666,86 @@ int main(int argc, char** argv)
 void RegisterCallbacks() {
 	std::cout << "FYI: Registering the Callback Functions with the CAS BACnet Stack" << std::endl;
 
+	// All the callbacks are wrapped to count their calls and errors in the metrics
 	// Message Callback Functions
-	fpRegisterCallbackReceiveMessage(CallbackReceiveMessage);
-	fpRegisterCallbackSendMessage(CallbackSendMessage);
+	fpRegisterCallbackReceiveMessage(EXAMPLE_COUNT_CALLBACK(CALLBACK_RECEIVE_MESSAGE, CallbackReceiveMessage));
+	fpRegisterCallbackSendMessage(EXAMPLE_COUNT_CALLBACK(CALLBACK_SEND_MESSAGE, CallbackSendMessage));
 
 	// System Time Callback Functions
-	fpRegisterCallbackGetSystemTime(CallbackGetSystemTime);
-	fpRegisterCallbackSetSystemTime(CallbackSetSystemTime);
+	fpRegisterCallbackGetSystemTime(EXAMPLE_COUNT_CALLBACK(CALLBACK_GET_SYSTEM_TIME, CallbackGetSystemTime));
+	fpRegisterCallbackSetSystemTime(EXAMPLE_COUNT_CALLBACK(CALLBACK_SET_SYSTEM_TIME, CallbackSetSystemTime));
 
 	// Get Property Callback Functions
-	fpRegisterCallbackGetPropertyBitString(CallbackGetPropertyBitString);
-	fpRegisterCallbackGetPropertyBool(CallbackGetPropertyBool);
-	fpRegisterCallbackGetPropertyCharacterString(CallbackGetPropertyCharString);
-	fpRegisterCallbackGetPropertyDate(CallbackGetPropertyDate);
-	fpRegisterCallbackGetPropertyDouble(CallbackGetPropertyDouble);
-	fpRegisterCallbackGetPropertyEnumerated(CallbackGetPropertyEnum);
-	fpRegisterCallbackGetPropertyOctetString(CallbackGetPropertyOctetString);
-	fpRegisterCallbackGetPropertySignedInteger(CallbackGetPropertyInt);
-	fpRegisterCallbackGetPropertyReal(CallbackGetPropertyReal);
-	fpRegisterCallbackGetPropertyTime(CallbackGetPropertyTime);
-	fpRegisterCallbackGetPropertyUnsignedInteger(CallbackGetPropertyUInt);
+	fpRegisterCallbackGetPropertyBitString(EXAMPLE_COUNT_CALLBACK(CALLBACK_GET_PROPERTY_BIT_STRING, CallbackGetPropertyBitString));
+	fpRegisterCallbackGetPropertyBool(EXAMPLE_COUNT_CALLBACK(CALLBACK_GET_PROPERTY_BOOL, CallbackGetPropertyBool));
+	fpRegisterCallbackGetPropertyCharacterString(EXAMPLE_COUNT_CALLBACK(CALLBACK_GET_PROPERTY_CHARACTER_STRING, CallbackGetPropertyCharString));
+	fpRegisterCallbackGetPropertyDate(EXAMPLE_COUNT_CALLBACK(CALLBACK_GET_PROPERTY_DATE, CallbackGetPropertyDate));
+	fpRegisterCallbackGetPropertyDouble(EXAMPLE_COUNT_CALLBACK(CALLBACK_GET_PROPERTY_DOUBLE, CallbackGetPropertyDouble));
+	fpRegisterCallbackGetPropertyEnumerated(EXAMPLE_COUNT_CALLBACK(CALLBACK_GET_PROPERTY_ENUMERATED, CallbackGetPropertyEnum));
+	fpRegisterCallbackGetPropertyOctetString(EXAMPLE_COUNT_CALLBACK(CALLBACK_GET_PROPERTY_OCTET_STRING, CallbackGetPropertyOctetString));
+	fpRegisterCallbackGetPropertySignedInteger(EXAMPLE_COUNT_CALLBACK(CALLBACK_GET_PROPERTY_SIGNED_INTEGER, CallbackGetPropertyInt));
+	fpRegisterCallbackGetPropertyReal(EXAMPLE_COUNT_CALLBACK(CALLBACK_GET_PROPERTY_REAL, CallbackGetPropertyReal));
+	fpRegisterCallbackGetPropertyTime(EXAMPLE_COUNT_CALLBACK(CALLBACK_GET_PROPERTY_TIME, CallbackGetPropertyTime));
+	fpRegisterCallbackGetPropertyUnsignedInteger(EXAMPLE_COUNT_CALLBACK(CALLBACK_GET_PROPERTY_UNSIGNED_INTEGER, CallbackGetPropertyUInt));
 
 	// Set Property Callback Functions
-	fpRegisterCallbackSetPropertyBitString(CallbackSetPropertyBitString);
-	fpRegisterCallbackSetPropertyBool(CallbackSetPropertyBool);
-	fpRegisterCallbackSetPropertyCharacterString(CallbackSetPropertyCharString);
-	fpRegisterCallbackSetPropertyDate(CallbackSetPropertyDate);
-	fpRegisterCallbackSetPropertyDouble(CallbackSetPropertyDouble);
-	fpRegisterCallbackSetPropertyEnumerated(CallbackSetPropertyEnum);
-	fpRegisterCallbackSetPropertyNull(CallbackSetPropertyNull);
-	fpRegisterCallbackSetPropertyObjectIdentifier(CallbackSetPropertyObjectIdentifier);
-	fpRegisterCallbackSetPropertyOctetString(CallbackSetPropertyOctetString);
-	fpRegisterCallbackSetPropertySignedInteger(CallbackSetPropertyInt);
-	fpRegisterCallbackSetPropertyReal(CallbackSetPropertyReal);
-	fpRegisterCallbackSetPropertyTime(CallbackSetPropertyTime);
-	fpRegisterCallbackSetPropertyUnsignedInteger(CallbackSetPropertyUInt);
+	// Wrapped so the accepted writes are saved in the persistent image
+	fpRegisterCallbackSetPropertyBitString(EXAMPLE_COUNT_CALLBACK(CALLBACK_SET_PROPERTY_BIT_STRING, EXAMPLE_TRACK_WRITE(CallbackSetPropertyBitString)));
+	fpRegisterCallbackSetPropertyBool(EXAMPLE_COUNT_CALLBACK(CALLBACK_SET_PROPERTY_BOOL, EXAMPLE_TRACK_WRITE(CallbackSetPropertyBool)));
+	fpRegisterCallbackSetPropertyCharacterString(EXAMPLE_COUNT_CALLBACK(CALLBACK_SET_PROPERTY_CHARACTER_STRING, EXAMPLE_TRACK_WRITE(CallbackSetPropertyCharString)));
+	fpRegisterCallbackSetPropertyDate(EXAMPLE_COUNT_CALLBACK(CALLBACK_SET_PROPERTY_DATE, EXAMPLE_TRACK_WRITE(CallbackSetPropertyDate)));
+	fpRegisterCallbackSetPropertyDouble(EXAMPLE_COUNT_CALLBACK(CALLBACK_SET_PROPERTY_DOUBLE, EXAMPLE_TRACK_WRITE(CallbackSetPropertyDouble)));
+	fpRegisterCallbackSetPropertyEnumerated(EXAMPLE_COUNT_CALLBACK(CALLBACK_SET_PROPERTY_ENUMERATED, EXAMPLE_TRACK_WRITE(CallbackSetPropertyEnum)));
+	fpRegisterCallbackSetPropertyNull(EXAMPLE_COUNT_CALLBACK(CALLBACK_SET_PROPERTY_NULL, EXAMPLE_TRACK_WRITE(CallbackSetPropertyNull)));
+	fpRegisterCallbackSetPropertyObjectIdentifier(EXAMPLE_COUNT_CALLBACK(CALLBACK_SET_PROPERTY_OBJECT_IDENTIFIER, EXAMPLE_TRACK_WRITE(CallbackSetPropertyObjectIdentifier)));
+	fpRegisterCallbackSetPropertyOctetString(EXAMPLE_COUNT_CALLBACK(CALLBACK_SET_PROPERTY_OCTET_STRING, EXAMPLE_TRACK_WRITE(CallbackSetPropertyOctetString)));
+	fpRegisterCallbackSetPropertySignedInteger(EXAMPLE_COUNT_CALLBACK(CALLBACK_SET_PROPERTY_SIGNED_INTEGER, EXAMPLE_TRACK_WRITE(CallbackSetPropertyInt)));
+	fpRegisterCallbackSetPropertyReal(EXAMPLE_COUNT_CALLBACK(CALLBACK_SET_PROPERTY_REAL, EXAMPLE_TRACK_WRITE(CallbackSetPropertyReal)));
+	fpRegisterCallbackSetPropertyTime(EXAMPLE_COUNT_CALLBACK(CALLBACK_SET_PROPERTY_TIME, EXAMPLE_TRACK_WRITE(CallbackSetPropertyTime)));
+	fpRegisterCallbackSetPropertyUnsignedInteger(EXAMPLE_COUNT_CALLBACK(CALLBACK_SET_PROPERTY_UNSIGNED_INTEGER, EXAMPLE_TRACK_WRITE(CallbackSetPropertyUInt)));
 
 	// Object creation
-	fpRegisterCallbackCreateObject(CallbackCreateObject);
-	fpRegisterCallbackDeleteObject(CallbackDeleteObject);
+	fpRegisterCallbackCreateObject(EXAMPLE_COUNT_CALLBACK(CALLBACK_CREATE_OBJECT, CallbackCreateObject));
+	fpRegisterCallbackDeleteObject(EXAMPLE_COUNT_CALLBACK(CALLBACK_DELETE_OBJECT, CallbackDeleteObject));
 
 	// Remote Device Management
-	fpRegisterCallbackReinitializeDevice(CallbackReinitializeDevice);
-	fpRegisterCallbackDeviceCommunicationControl(CallbackDeviceCommunicationControl);
-	fpRegisterHookTextMessage(HookTextMessage);
+	fpRegisterCallbackReinitializeDevice(EXAMPLE_COUNT_CALLBACK(CALLBACK_REINITIALIZE_DEVICE, CallbackReinitializeDevice));
+	fpRegisterCallbackDeviceCommunicationControl(EXAMPLE_COUNT_CALLBACK(CALLBACK_DEVICE_COMMUNICATION_CONTROL, CallbackDeviceCommunicationControl));
+	fpRegisterHookTextMessage(EXAMPLE_COUNT_CALLBACK(CALLBACK_TEXT_MESSAGE, HookTextMessage));
 
 	// Get Debug Message Function
-	fpRegisterCallbackLogDebugMessage(CallbackLogDebugMessage);
+	fpRegisterCallbackLogDebugMessage(EXAMPLE_COUNT_CALLBACK(CALLBACK_LOG_DEBUG_MESSAGE, CallbackLogDebugMessage));
 }
 
+// Applies the writable and subscribable flags declared in the object descriptors (CASBACnetStackExampleObjectDescriptors.h)
+struct ExampleSetupPropertyFlags {
+	bool ok;
+
+	ExampleSetupPropertyFlags() {
+		this->ok = true;
+	}
+
+	void operator()(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const bool writable, const bool subscribable) {
+		if (writable && !fpSetPropertyWritable(g_exampleDatabase.device.instance, objectType, objectInstance, propertyIdentifier, true)) {
+			std::cerr << "Failed to make property writable. objectType=[" << objectType << "], objectInstance=[" << objectInstance << "], propertyIdentifier=[" << propertyIdentifier << "]" << std::endl;
+			this->ok = false;
+		}
+		if (subscribable && !fpSetPropertySubscribable(g_exampleDatabase.device.instance, objectType, objectInstance, propertyIdentifier, true)) {
+			std::cerr << "Failed to make property subscribable. objectType=[" << objectType << "], objectInstance=[" << objectInstance << "], propertyIdentifier=[" << propertyIdentifier << "]" << std::endl;
+			this->ok = false;
+		}
+	}
+};
+
 // Sets up the device on the BACnet Stack. 
 // Add all the functionality for enabling required services and adding objects and properties in this function.
 bool SetupDevice() {
 	std::cout << "Setting up server device. device.instance=[" << g_exampleDatabase.device.instance << "]" << std::endl;
+	// One startup trace step per block, the caller ends the steps
+	ExampleStartupTrace& trace = ExampleStartupTrace::Get();
 
 	// Create the Device
+	trace.Next("Device");
 	if (!fpAddDevice(g_exampleDatabase.device.instance)) {
 		std::cerr << "Failed to add Device." << std::endl;
 		return false;
@@ -293,6 +754,7 @@ bool SetupDevice() {
 
 
 	// Enable the services that this device supports
+	trace.Next("Services");
 	// Some services are mandatory for BACnet devices and are already enabled.
 	// These are: Read Property, Who Is, Who Has
 	//
@@ -405,17 +867,14 @@ bool SetupDevice() {
 
 
 	// Enable Optional Device Properties
+	trace.Next("Device properties");
 	if (!fpSetPropertyEnabled(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE, g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_DESCRIPTION, true)) {
 		std::cerr << "Failed to enable the description property for Device" << std::endl;
 		return false;
 	}
 
 	// Update Writable Device Properties
-	// UTC Offset
-	if (!fpSetPropertyWritable(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE, g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_UTC_OFFSET, true)) {
-		std::cerr << "Failed to make the UTC Offset property writable for Device" << std::endl;
-		return false;
-	}
+	// UTC Offset is declared in the object descriptors
 	// Description
 	if (!fpSetPropertyWritable(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE, g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_DESCRIPTION, true)) {
 		std::cerr << "Failed to make the description property writable for Device" << std::endl;
@@ -446,6 +905,7 @@ bool SetupDevice() {
 	// Add Objects
 	// ---------------------------------------
 	// AnalogInput (AI) 
+	trace.Next("AnalogInput");
 	std::cout << "Adding AnalogInput. analogInput.instance=[" << g_exampleDatabase.analogInput.instance << "]... ";
 	if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, g_exampleDatabase.analogInput.instance)) {
 		std::cerr << "Failed to add AnalogInput" << std::endl;
@@ -460,20 +920,14 @@ bool SetupDevice() {
 	fpSetProprietaryProperty(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, g_exampleDatabase.analogInput.instance, 512 + 5, false, true, CASBACnetStackExampleConstants::DATA_TYPE_REAL, false, false, false);
 	fpSetProprietaryProperty(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, g_exampleDatabase.analogInput.instance, 512 + 6, false, false, CASBACnetStackExampleConstants::DATA_TYPE_REAL, true, false, false);
 
-	// Set the Present value to subscribable 
-	fpSetPropertySubscribable(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, g_exampleDatabase.analogInput.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, true);
-	fpSetPropertyWritable(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, g_exampleDatabase.analogInput.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_COV_INCURMENT, true);
-
 	// Enable the description, units and Reliability property 
 	fpSetPropertyByObjectTypeEnabled(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_DESCRIPTION, true);
 	fpSetPropertyByObjectTypeEnabled(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELIABILITY, true);
 	fpSetPropertyByObjectTypeEnabled(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_UNITS, true);
-
-	// Enable a specific property to be subscribable for COVProperty 
-	fpSetPropertySubscribable(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, g_exampleDatabase.analogInput.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELIABILITY, true);
 	std::cout << "OK" << std::endl;
 
 	// AnalogOutput (AO) 
+	trace.Next("AnalogOutput");
 	std::cout << "Added AnalogOutput. analogOutput.instance=[" << g_exampleDatabase.analogOutput.instance << "]... ";
 	if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_OUTPUT, g_exampleDatabase.analogOutput.instance)) {
 		std::cerr << "Failed to add AnalogOutput" << std::endl;
@@ -481,19 +935,47 @@ bool SetupDevice() {
 	}
 	fpSetPropertyByObjectTypeEnabled(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_OUTPUT, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_MIN_PRES_VALUE, true);
 	fpSetPropertyByObjectTypeEnabled(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_OUTPUT, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_MAX_PRES_VALUE, true);
+	fpSetPropertyWritable(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_OUTPUT, g_exampleDatabase.analogOutput.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELINQUISH_DEFAULT, true);
 	std::cout << "OK" << std::endl;
 
 	// AnalogValue (AV) 
+	trace.Next("AnalogValue");
 	std::cout << "Added AnalogValue. analogValue.instance=[" << g_exampleDatabase.analogValue.instance << "]... ";
 	if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE, g_exampleDatabase.analogValue.instance)) {
 		std::cerr << "Failed to add AnalogValue" << std::endl;
 		return -1;
 	}
-	fpSetPropertyWritable(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE, g_exampleDatabase.analogValue.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, true);
-	fpSetPropertySubscribable(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE, g_exampleDatabase.analogValue.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, true);
 	std::cout << "OK" << std::endl;
 
+	// Analog Values created with the CreateObject service before the restart, restored from the persistent image
+	if (!g_exampleDatabase.CreatedAnalogValueData.empty()) {
+		std::cout << "Adding created AnalogValues. count=[" << g_exampleDatabase.CreatedAnalogValueData.size() << "]... ";
+		// Traced in batches, so that a registration cost that grows with the object count shows up
+		trace.Next("Created AnalogValues");
+		trace.SetCount((uint32_t)g_exampleDatabase.CreatedAnalogValueData.size());
+		const uint32_t STARTUP_TRACE_BATCH_SIZE = 10000;
+		uint32_t count = 0;
+		for (std::map<uint32_t, CreatedAnalogValue>::const_iterator itr = g_exampleDatabase.CreatedAnalogValueData.begin(); itr != g_exampleDatabase.CreatedAnalogValueData.end(); itr++) {
+			if (count % STARTUP_TRACE_BATCH_SIZE == 0) {
+				if (count > 0) {
+					trace.SetCount(STARTUP_TRACE_BATCH_SIZE);
+					trace.End();
+				}
+				trace.Begin("Batch");
+			}
+			if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE, itr->first)) {
+				std::cerr << "Failed to add created AnalogValue. instance=[" << itr->first << "]" << std::endl;
+				return -1;
+			}
+			count++;
+		}
+		trace.SetCount((count - 1) % STARTUP_TRACE_BATCH_SIZE + 1);
+		trace.End();
+		std::cout << "OK" << std::endl;
+	}
+
 	// BinaryInput (BI)
+	trace.Next("BinaryInput");
 	std::cout << "Adding BinaryInput. binaryInput.instance=[" << g_exampleDatabase.binaryInput.instance << "]... ";
 	if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_INPUT, g_exampleDatabase.binaryInput.instance)) {
 		std::cerr << "Failed to add BinaryInput" << std::endl;
@@ -502,23 +984,26 @@ bool SetupDevice() {
 	std::cout << "OK" << std::endl;
 
 	// BinaryOutput (BO)
+	trace.Next("BinaryOutput");
 	std::cout << "Added BinaryOutput. binaryOutput.instance=[" << g_exampleDatabase.binaryOutput.instance << "]... ";
 	if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_OUTPUT, g_exampleDatabase.binaryOutput.instance)) {
 		std::cerr << "Failed to add BinaryOutput" << std::endl;
 		return -1;
 	}
+	fpSetPropertyWritable(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_OUTPUT, g_exampleDatabase.binaryOutput.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELINQUISH_DEFAULT, true);
 	std::cout << "OK" << std::endl;
 
 	// BinaryValue (BV)
+	trace.Next("BinaryValue");
 	std::cout << "Added BinaryValue. binaryValue.instance=[" << g_exampleDatabase.binaryValue.instance << "]... ";
 	if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_VALUE, g_exampleDatabase.binaryValue.instance)) {
 		std::cerr << "Failed to add BinaryValue" << std::endl;
 		return -1;
 	}
-	fpSetPropertyWritable(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_VALUE, g_exampleDatabase.binaryValue.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, true);
 	std::cout << "OK" << std::endl;
 
 	// MultiStateInput (MSI) 
+	trace.Next("MultiStateInput");
 	std::cout << "Added MultiStateInput. multiStateInput.instance=[" << g_exampleDatabase.multiStateInput.instance << "]... ";
 	if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_INPUT, g_exampleDatabase.multiStateInput.instance)) {
 		std::cerr << "Failed to add MultiStateInput" << std::endl;
@@ -528,25 +1013,28 @@ bool SetupDevice() {
 	std::cout << "OK" << std::endl;
 
 	// MultiStateOutput (MSO)
+	trace.Next("MultiStateOutput");
 	std::cout << "Added MultiStateOutput. multiStateOutput.instance=[" << g_exampleDatabase.multiStateOutput.instance << "]... ";
 	if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_OUTPUT, g_exampleDatabase.multiStateOutput.instance)) {
 		std::cerr << "Failed to add MultiStateOutput" << std::endl;
 		return -1;
 	}
 	fpSetPropertyByObjectTypeEnabled(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_OUTPUT, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_STATE_TEXT, true);
+	fpSetPropertyWritable(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_OUTPUT, g_exampleDatabase.multiStateOutput.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELINQUISH_DEFAULT, true);
 	std::cout << "OK" << std::endl;
 
 	// MultiStateValue (MSV)
+	trace.Next("MultiStateValue");
 	std::cout << "Added MultiStateValue. multiStateValue.instance=[" << g_exampleDatabase.multiStateValue.instance << "]... ";
 	if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_VALUE, g_exampleDatabase.multiStateValue.instance)) {
 		std::cerr << "Failed to add MultiStateValue" << std::endl;
 		return -1;
 	}
-	fpSetPropertyWritable(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_VALUE, g_exampleDatabase.multiStateValue.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, true);
 	fpSetPropertyByObjectTypeEnabled(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_VALUE, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_STATE_TEXT, true);
 	std::cout << "OK" << std::endl;
 
 	// BitstringValue (BSV)
+	trace.Next("BitstringValue");
 	std::cout << "Added BitstringValue. bitstringValue.instance=[" << g_exampleDatabase.bitstringValue.instance << "]...";
 	if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_BITSTRING_VALUE, g_exampleDatabase.bitstringValue.instance)) {
 		std::cerr << "Failed to add BitstringValue" << std::endl;
@@ -557,6 +1045,7 @@ bool SetupDevice() {
 	std::cout << "OK" << std::endl;
 
 	// characterStringValue (CSV)
+	trace.Next("CharacterStringValue");
 	std::cout << "Added characterStringValue. characterStringValue.instance=[" << g_exampleDatabase.characterStringValue.instance << "]...";
 	if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_CHARACTERSTRING_VALUE, g_exampleDatabase.characterStringValue.instance)) {
 		std::cerr << "Failed to add characterStringValue" << std::endl;
@@ -566,6 +1055,7 @@ bool SetupDevice() {
 	std::cout << "OK" << std::endl;
 
 	// DateValue (DV)
+	trace.Next("DateValue");
 	std::cout << "Added DateValue. dateValue.instance=[" << g_exampleDatabase.dateValue.instance << "]... ";
 	if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_DATE_VALUE, g_exampleDatabase.dateValue.instance)) {
 		std::cerr << "Failed to add DateValue" << std::endl;
@@ -575,24 +1065,25 @@ bool SetupDevice() {
 	std::cout << "OK" << std::endl;
 
 	// IntegerValue (IV)
+	trace.Next("IntegerValue");
 	std::cout << "Added IntegerValue. integerValue.instance=[" << g_exampleDatabase.integerValue.instance << "]... ";
 	if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_INTEGER_VALUE, g_exampleDatabase.integerValue.instance)) {
 		std::cerr << "Failed to add IntegerValue" << std::endl;
 		return -1;
 	}
-	fpSetPropertyWritable(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_INTEGER_VALUE, g_exampleDatabase.integerValue.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, true);
 	std::cout << "OK" << std::endl;
 
 	// LargeAnalogValue (LAV)
+	trace.Next("LargeAnalogValue");
 	std::cout << "Added LargeAnalogValue. largeAnalogValue.instance=[" << g_exampleDatabase.largeAnalogValue.instance << "]... ";
 	if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_LARGE_ANALOG_VALUE, g_exampleDatabase.largeAnalogValue.instance)) {
 		std::cerr << "Failed to add LargeAnalogValue" << std::endl;
 		return -1;
 	}
-	fpSetPropertyWritable(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_LARGE_ANALOG_VALUE, g_exampleDatabase.largeAnalogValue.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, true);
 	std::cout << "OK" << std::endl;
 
 	// octetStringValue (OSV)
+	trace.Next("OctetStringValue");
 	std::cout << "Added octetStringValue. octetStringValue.instance=[" << g_exampleDatabase.octetStringValue.instance << "]... ";
 	if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_OCTETSTRING_VALUE, g_exampleDatabase.octetStringValue.instance)) {
 		std::cerr << "Failed to add octetStringValue" << std::endl;
@@ -602,15 +1093,16 @@ bool SetupDevice() {
 	std::cout << "OK" << std::endl;
 
 	// PositiveIntegerValue (PIV)
+	trace.Next("PositiveIntegerValue");
 	std::cout << "Added PositiveIntegerValue. positiveIntegerValue.instance=[" << g_exampleDatabase.positiveIntegerValue.instance << "]... ";
 	if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_POSITIVE_INTEGER_VALUE, g_exampleDatabase.positiveIntegerValue.instance)) {
 		std::cerr << "Failed to add PositiveIntegerValue" << std::endl;
 		return -1;
 	}
-	fpSetPropertyWritable(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_POSITIVE_INTEGER_VALUE, g_exampleDatabase.positiveIntegerValue.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, true);
 	std::cout << "OK" << std::endl;
 
 	// TimeValue (TV)
+	trace.Next("TimeValue");
 	std::cout << "Added TimeValue. timeValue.instance=[" << g_exampleDatabase.timeValue.instance << "]... ";
 	if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_TIME_VALUE, g_exampleDatabase.timeValue.instance)) {
 		std::cerr << "Failed to add TimeValue" << std::endl;
@@ -620,6 +1112,7 @@ bool SetupDevice() {
 	std::cout << "OK" << std::endl;
 
 	// Add Trend Log Object
+	trace.Next("TrendLog");
 	std::cout << "Added TrendLog. trendLog.instance=[" << g_exampleDatabase.trendLog.instance << "]... ";
 	if (!fpAddTrendLogObject(g_exampleDatabase.device.instance, g_exampleDatabase.trendLog.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, g_exampleDatabase.analogInput.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, CASBACnetStackExampleConstants::MAX_TREND_LOG_MAX_BUFFER_SIZE, false, 0)) {
 		std::cerr << "Failed to add TrendLog" << std::endl;
@@ -634,6 +1127,7 @@ bool SetupDevice() {
 	std::cout << "OK" << std::endl;
 
 	// Add Trend Log Multiple Object
+	trace.Next("TrendLogMultiple");
 	std::cout << "Added TrendLogMultiple. trendLogMultiple.instance=[" << g_exampleDatabase.trendLogMultiple.instance << "]... ";
 	if (!fpAddTrendLogMultipleObject(g_exampleDatabase.device.instance, g_exampleDatabase.trendLogMultiple.instance, CASBACnetStackExampleConstants::MAX_TREND_LOG_MAX_BUFFER_SIZE)) {
 		std::cerr << "Failed to add TrendLogMultiple" << std::endl;
@@ -656,18 +1150,17 @@ bool SetupDevice() {
 	std::cout << "OK" << std::endl;
 
 	// AnalogInput - OutOfService Example (AI) 
+	trace.Next("AnalogInput OutOfService");
 	std::cout << "Added AnalogInput OutOfService Example. analogInputOutOfService.instance=[" << g_exampleDatabase.analogInputOutOfService.instance << "]... ";
 	if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, g_exampleDatabase.analogInputOutOfService.instance)) {
 		std::cerr << "Failed to add AnalogInput OutOfService Example" << std::endl;
 		return -1;
 	}
 
-	// Make out of service writable
-	fpSetPropertyWritable(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, g_exampleDatabase.analogInputOutOfService.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OUT_OF_SERVICE, true);
-
 	std::cout << "OK" << std::endl;
 
 	// Add the Network Port Object
+	trace.Next("NetworkPort");
 	std::cout << "Added NetworkPort. networkPort.instance=[" << g_exampleDatabase.networkPort.instance << "]... ";
 	if (!fpAddNetworkPortObject(g_exampleDatabase.device.instance, g_exampleDatabase.networkPort.instance, CASBACnetStackExampleConstants::NETWORK_TYPE_IPV4, CASBACnetStackExampleConstants::PROTOCOL_LEVEL_BACNET_APPLICATION, CASBACnetStackExampleConstants::NETWORK_PORT_LOWEST_PROTOCOL_LAYER)) {
 		std::cerr << "Failed to add NetworkPort" << std::endl;
@@ -682,6 +1175,7 @@ bool SetupDevice() {
 	std::cout << "OK" << std::endl;
 
 	// Add the DateTimeValue Object
+	trace.Next("DateTimeValue");
 	std::cout << "Added DateTimeValue. dateTimeValue.instance=[" << g_exampleDatabase.dateTimeValue.instance << "]... ";
 	if (!fpAddObject(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_DATETIME_VALUE, g_exampleDatabase.dateTimeValue.instance)) {
 		std::cerr << "Failed to add DateTimeValue" << std::endl;
@@ -690,6 +1184,47 @@ bool SetupDevice() {
 
 	std::cout << "OK" << std::endl;
 
+	// Writable and subscribable properties declared in the object descriptors
+	trace.Next("Descriptor property flags");
+	// (Analog Input present value, COV increment and reliability, Analog Value present value, Device UTC offset, etc)
+	std::cout << "Setting writable and subscribable properties from the object descriptors... ";
+	ExampleSetupPropertyFlags setupPropertyFlags;
+	ExampleObjectDescriptors::ForEachProperty(g_exampleDatabase, setupPropertyFlags);
+	if (!setupPropertyFlags.ok) {
+		return false;
+	}
+	std::cout << "OK" << std::endl;
+
+	// Enabled, writable and subscribable properties from the device profile
+	trace.Next("Profile property flags");
+	trace.SetCount((uint32_t)g_exampleDatabase.profileProperties.size());
+	if (!g_exampleDatabase.profileProperties.empty()) {
+		std::cout << "Setting the properties from the device profile. count=[" << g_exampleDatabase.profileProperties.size() << "]... ";
+		for (size_t offset = 0; offset < g_exampleDatabase.profileProperties.size(); offset++) {
+			const ExampleProfileProperty& property = g_exampleDatabase.profileProperties[offset];
+			const uint32_t objectInstance = property.objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE ? g_exampleDatabase.device.instance : property.objectInstance;
+			if ((property.flags & ExampleProfileProperty::ENABLED) != 0 && !fpSetPropertyEnabled(g_exampleDatabase.device.instance, property.objectType, objectInstance, property.propertyIdentifier, true)) {
+				std::cerr << "Failed to enable property. objectType=[" << property.objectType << "], objectInstance=[" << objectInstance << "], propertyIdentifier=[" << property.propertyIdentifier << "]" << std::endl;
+				return false;
+			}
+			if ((property.flags & ExampleProfileProperty::WRITABLE) != 0 && !fpSetPropertyWritable(g_exampleDatabase.device.instance, property.objectType, objectInstance, property.propertyIdentifier, true)) {
+				std::cerr << "Failed to make property writable. objectType=[" << property.objectType << "], objectInstance=[" << objectInstance << "], propertyIdentifier=[" << property.propertyIdentifier << "]" << std::endl;
+				return false;
+			}
+			if ((property.flags & ExampleProfileProperty::SUBSCRIBABLE) != 0 && !fpSetPropertySubscribable(g_exampleDatabase.device.instance, property.objectType, objectInstance, property.propertyIdentifier, true)) {
+				std::cerr << "Failed to make property subscribable. objectType=[" << property.objectType << "], objectInstance=[" << objectInstance << "], propertyIdentifier=[" << property.propertyIdentifier << "]" << std::endl;
+				return false;
+			}
+		}
+		std::cout << "OK" << std::endl;
+	}
+
+	trace.Next("Object templates");
+	trace.SetCount((uint32_t)g_exampleDatabase.objectTemplateInstances.size());
+	if (!SetupObjectTemplates()) {
+		return false;
+	}
+
 	// Debug. Print the current IP address of this device incase there are muliple network cards on the PC that is using the 
 	// Example. This is not required, its just for debug 
 	std::cout << "FYI: NetworkPort.IPAddress: " << (int)g_exampleDatabase.networkPort.IPAddress[0] << "." << (int)g_exampleDatabase.networkPort.IPAddress[1] << "." << (int)g_exampleDatabase.networkPort.IPAddress[2] << "." << (int)g_exampleDatabase.networkPort.IPAddress[3] << std::endl;
@@ -698,6 +1233,217 @@ bool SetupDevice() {
 	return true;
 }
 
+// Applies the object templates of the device profile. The template instances are sorted by object type,
+// when every object of a type uses the same template its enabled properties are set with one by type call
+// per property instead of one call per object. The stack has no by type call for the other flags, these
+// are set per object.
+bool SetupObjectTemplates() {
+	const std::vector<ExampleObjectTemplateProperty>& properties = g_exampleDatabase.objectTemplateProperties;
+	const std::vector<ExampleObjectTemplateInstance>& instances = g_exampleDatabase.objectTemplateInstances;
+	if (instances.empty()) {
+		return true;
+	}
+
+	// Range of each template in the properties, they are stored grouped by template
+	std::vector<size_t> templateBegin;
+	std::vector<size_t> templateEnd;
+	for (size_t offset = 0; offset < properties.size(); offset++) {
+		const uint16_t templateIndex = properties[offset].templateIndex;
+		if (templateIndex >= templateBegin.size()) {
+			templateBegin.resize(templateIndex + 1, offset);
+			templateEnd.resize(templateIndex + 1, offset);
+		}
+		templateEnd[templateIndex] = offset + 1;
+	}
+
+	std::cout << "Setting the properties from the object templates. objects=[" << instances.size() << "]... ";
+	const uint32_t deviceInstance = g_exampleDatabase.device.instance;
+	uint32_t calls = 0;
+	uint32_t byTypeCalls = 0;
+	size_t runBegin = 0;
+	while (runBegin < instances.size()) {
+		// The objects of one type
+		const uint16_t objectType = instances[runBegin].objectType;
+		size_t runEnd = runBegin;
+		bool singleTemplate = true;
+		while (runEnd < instances.size() && instances[runEnd].objectType == objectType) {
+			singleTemplate = singleTemplate && instances[runEnd].templateIndex == instances[runBegin].templateIndex;
+			runEnd++;
+		}
+		const bool byType = singleTemplate && runEnd - runBegin == g_exampleDatabase.GetObjectCount(objectType);
+		if (byType && instances[runBegin].templateIndex < templateBegin.size()) {
+			const uint16_t templateIndex = instances[runBegin].templateIndex;
+			for (size_t property = templateBegin[templateIndex]; property < templateEnd[templateIndex]; property++) {
+				if (properties[property].templateIndex != templateIndex || (properties[property].flags & ExampleObjectTemplateProperty::ENABLED) == 0) {
+					continue;
+				}
+				if (!fpSetPropertyByObjectTypeEnabled(deviceInstance, objectType, properties[property].propertyIdentifier, true)) {
+					std::cerr << "Failed to enable property by object type. objectType=[" << objectType << "], propertyIdentifier=[" << properties[property].propertyIdentifier << "]" << std::endl;
+					return false;
+				}
+				byTypeCalls++;
+			}
+		}
+
+		for (size_t offset = runBegin; offset < runEnd; offset++) {
+			const ExampleObjectTemplateInstance& instance = instances[offset];
+			if (instance.templateIndex >= templateBegin.size()) {
+				continue; // A template without properties
+			}
+			for (size_t property = templateBegin[instance.templateIndex]; property < templateEnd[instance.templateIndex]; property++) {
+				const ExampleObjectTemplateProperty& templateProperty = properties[property];
+				if (templateProperty.templateIndex != instance.templateIndex) {
+					continue;
+				}
+				bool ok = true;
+				if ((templateProperty.flags & ExampleObjectTemplateProperty::PROPRIETARY) != 0) {
+					ok = fpSetProprietaryProperty(deviceInstance, instance.objectType, instance.objectInstance, templateProperty.propertyIdentifier, (templateProperty.flags & ExampleObjectTemplateProperty::WRITABLE) != 0, (templateProperty.flags & ExampleObjectTemplateProperty::SUBSCRIBABLE) != 0, templateProperty.dataType, (templateProperty.flags & ExampleObjectTemplateProperty::ARRAY) != 0, false, false) != 0;
+					calls++;
+				}
+				else {
+					if (ok && !byType && (templateProperty.flags & ExampleObjectTemplateProperty::ENABLED) != 0) {
+						ok = fpSetPropertyEnabled(deviceInstance, instance.objectType, instance.objectInstance, templateProperty.propertyIdentifier, true) != 0;
+						calls++;
+					}
+					if (ok && (templateProperty.flags & ExampleObjectTemplateProperty::WRITABLE) != 0) {
+						ok = fpSetPropertyWritable(deviceInstance, instance.objectType, instance.objectInstance, templateProperty.propertyIdentifier, true) != 0;
+						calls++;
+					}
+					if (ok && (templateProperty.flags & ExampleObjectTemplateProperty::SUBSCRIBABLE) != 0) {
+						ok = fpSetPropertySubscribable(deviceInstance, instance.objectType, instance.objectInstance, templateProperty.propertyIdentifier, true) != 0;
+						calls++;
+					}
+				}
+				if (!ok) {
+					std::cerr << "Failed to set a template property. objectType=[" << instance.objectType << "], objectInstance=[" << instance.objectInstance << "], propertyIdentifier=[" << templateProperty.propertyIdentifier << "]" << std::endl;
+					return false;
+				}
+			}
+		}
+		runBegin = runEnd;
+	}
+	std::cout << "OK" << std::endl;
+	std::cout << "FYI: Object templates applied. calls=[" << calls << "], byTypeCalls=[" << byTypeCalls << "]" << std::endl;
+	return true;
+}
+
+// Registers a hosted device and its points with the stack. The points are analog values with a writable
+// and subscribable present value.
+bool SetupHostedDevice(ExampleHostedDevice& device) {
+	const uint32_t deviceInstance = device.GetInstance();
+	if (!fpAddDevice(deviceInstance)) {
+		std::cerr << "Failed to add hosted device. deviceInstance=[" << deviceInstance << "]" << std::endl;
+		return false;
+	}
+
+	const uint8_t services[] = {
+		CASBACnetStackExampleConstants::SERVICE_I_AM,
+		CASBACnetStackExampleConstants::SERVICE_READ_PROPERTY_MULTIPLE,
+		CASBACnetStackExampleConstants::SERVICE_WRITE_PROPERTY,
+		CASBACnetStackExampleConstants::SERVICE_WRITE_PROPERTY_MULTIPLE,
+		CASBACnetStackExampleConstants::SERVICE_SUBSCRIBE_COV,
+		CASBACnetStackExampleConstants::SERVICE_SUBSCRIBE_COV_PROPERTY
+	};
+	for (size_t offset = 0; offset < sizeof(services) / sizeof(services[0]); offset++) {
+		if (services[offset] == CASBACnetStackExampleConstants::SERVICE_I_AM && g_virtualRouter.IsEnabled()) {
+			continue; // The router sends the I-Am of the devices on the virtual network
+		}
+		if (!fpSetServiceEnabled(deviceInstance, services[offset], true)) {
+			std::cerr << "Failed to enable service on hosted device. deviceInstance=[" << deviceInstance << "], service=[" << (uint32_t)services[offset] << "]" << std::endl;
+			return false;
+		}
+	}
+
+	const std::vector<ExampleHostedPoint>& points = device.GetPoints();
+	for (size_t offset = 0; offset < points.size(); offset++) {
+		const ExampleHostedPoint& point = points[offset];
+		if (!fpAddObject(deviceInstance, point.objectType, point.objectInstance)) {
+			std::cerr << "Failed to add object to hosted device. deviceInstance=[" << deviceInstance << "], objectType=[" << point.objectType << "], objectInstance=[" << point.objectInstance << "]" << std::endl;
+			return false;
+		}
+		if (point.objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE && !fpSetPropertyWritable(deviceInstance, point.objectType, point.objectInstance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, true)) {
+			std::cerr << "Failed to make property writable. deviceInstance=[" << deviceInstance << "], objectInstance=[" << point.objectInstance << "]" << std::endl;
+			return false;
+		}
+		if (!fpSetPropertySubscribable(deviceInstance, point.objectType, point.objectInstance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, true)) {
+			std::cerr << "Failed to make property subscribable. deviceInstance=[" << deviceInstance << "], objectInstance=[" << point.objectInstance << "]" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+// Passed to ExampleDeviceRegistry::ForEach to register the hosted devices with the stack again after a reset
+struct ExampleSetupHostedDevices {
+	void operator()(ExampleHostedDevice& device) {
+		SetupHostedDevice(device);
+	}
+};
+
+// Adds a hosted device with pointCount analog values (instances 0 to pointCount - 1) to the registry and the stack
+bool AddHostedDevice(const uint32_t instance, const uint32_t pointCount) {
+	if (instance == g_exampleDatabase.device.instance) {
+		std::cerr << "Error - The hosted device can not use the instance of the example device. instance=[" << instance << "]" << std::endl;
+		return false;
+	}
+	ExampleHostedDevice* device = g_deviceRegistry.Add(instance);
+	if (device == NULL) {
+		std::cerr << "Error - A device with this instance is already hosted. instance=[" << instance << "]" << std::endl;
+		return false;
+	}
+	device->objectName = "Hosted Device " + std::to_string(instance);
+	device->ReservePoints(pointCount);
+	for (uint32_t objectInstance = 0; objectInstance < pointCount; objectInstance++) {
+		// Short names stay in the small string buffer, no allocation per point
+		device->AddPoint(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE, objectInstance, "AV-" + std::to_string(objectInstance), 95); // 95 = no-units
+	}
+
+	if (!SetupHostedDevice(*device)) {
+		// The stack keeps the devices it was given, a device that was removed can not be added again
+		g_deviceRegistry.Remove(instance);
+		return false;
+	}
+	if (g_virtualRouter.IsEnabled()) {
+		g_virtualRouter.AnnounceDevice(instance);
+	}
+	g_metrics.hostedDevices.Set((int64_t)g_deviceRegistry.GetCount());
+	return true;
+}
+
+// Removes a hosted device from the registry. The stack can not remove a device, it stops sending I-Am for it
+// and the property callbacks fail for its objects from now on.
+bool RemoveHostedDevice(const uint32_t instance) {
+	if (!g_deviceRegistry.Remove(instance)) {
+		std::cerr << "Error - No hosted device with this instance. instance=[" << instance << "]" << std::endl;
+		return false;
+	}
+	fpSetServiceEnabled(instance, CASBACnetStackExampleConstants::SERVICE_I_AM, false);
+	g_metrics.hostedDevices.Set((int64_t)g_deviceRegistry.GetCount());
+	return true;
+}
+
+// One line of resource usage for a soak test on virtual time
+void PrintSoakReport(const double simulatedHours, const double realSeconds, const uint64_t ticks) {
+#ifdef __GNUC__
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	const double cpuMilliseconds = usage.ru_utime.tv_sec * 1000.0 + usage.ru_utime.tv_usec / 1000.0 + usage.ru_stime.tv_sec * 1000.0 + usage.ru_stime.tv_usec / 1000.0;
+	// Current resident set from /proc on Linux, ru_maxrss is only the peak
+	long sizePages = 0;
+	long residentPages = 0;
+	FILE* statm = fopen("/proc/self/statm", "r");
+	if (statm != NULL) {
+		if (fscanf(statm, "%ld %ld", &sizePages, &residentPages) != 2) {
+			residentPages = 0;
+		}
+		fclose(statm);
+	}
+	std::cout << "FYI: Soak simulated=[" << simulatedHours << " h], real=[" << realSeconds << " s], ticks=[" << ticks << "], cpu=[" << cpuMilliseconds << " ms], rss=[" << residentPages * (sysconf(_SC_PAGESIZE) / 1024) << " KB], maxRss=[" << usage.ru_maxrss << " KB], createdObjects=[" << g_exampleDatabase.CreatedAnalogValueData.size() << "]" << std::endl;
+#else
+	std::cout << "FYI: Soak simulated=[" << simulatedHours << " h], real=[" << realSeconds << " s], ticks=[" << ticks << "]" << std::endl;
+#endif // __GNUC__
+}
+
 // Sends an I-Am broadcast.
 bool SendIAm(uint8_t* connectionString, uint8_t connectionStringLength) {
 	if (connectionStringLength < 6) {
@@ -722,10 +1468,12 @@ bool SendIAm(uint8_t* connectionString, uint8_t connectionStringLength) {
 void WarmStart() {
 	std::cout << "FYI: Warm Start Initiating..." << std::endl;
 	g_warmStart = false;
-	g_warmStartTimer = time(0);
+	g_warmStartTimer = g_exampleDatabase.clock.GetSystemTime();
 	fpReset();
 	RegisterCallbacks();
 	SetupDevice();
+	ExampleSetupHostedDevices setupHostedDevices;
+	g_deviceRegistry.ForEach(setupHostedDevices);
 	uint8_t connectionString[6];
 	SendIAm(connectionString, 6);
 }
@@ -735,6 +1483,9 @@ void WarmStart() {
 //		i - increment the analog-input value. Used to test COV
 //		r - Toggle Analog Input Reliability
 //		f - Send Register Foreign Device message
+//		a - Add a hosted device
+//		x - Remove the last hosted device
+//		l - Print the callback latency
 //		h - Display options
 //		q - Quit
 bool DoUserInput()
@@ -809,27 +1560,26 @@ bool DoUserInput()
 
 		// Notify the stack that this data point was updated so the stack can check for logic
 		// that may need to run on the data.  Example: check if COV (change of value) occurred.
-		if (fpValueUpdated != NULL) {
-			fpValueUpdated(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE, g_exampleDatabase.analogValue.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE);
-		}
+		// The notification is sent from the main loop with the other changed points.
+		g_exampleDatabase.dirtyPoints.MarkDirty(g_exampleDatabase.analogValue.presentValuePoint);
 		break;
 	}
 	case 'r': {
 		// Toggle the Analog Input reliability status
 		// no-fault-detected (0), unreliable-other (7)
-		if (g_exampleDatabase.analogInput.reliability == 0) {
+		// The new value is published to the stack at the end of the next ExampleDatabase::Loop
+		if (g_exampleDatabase.analogInput.reliability.GetLatest() == 0) {
 			g_exampleDatabase.analogInput.reliability = 7; // unreliable-other (7)
 		}
 		else {
 			g_exampleDatabase.analogInput.reliability = 0; //no-fault-detected (0)
 		}
-		std::cout << "Toggle the Analog Input reliability status to " << g_exampleDatabase.analogInput.reliability << std::endl;
+		std::cout << "Toggle the Analog Input reliability status to " << g_exampleDatabase.analogInput.reliability.GetLatest() << std::endl;
 
 		// Notify the stack that this data point was updated so the stack can check for logic
 		// that may need to run on the data. Example: Check if COVProperty (change of value) occurred.
-		if (fpValueUpdated != NULL) {
-			fpValueUpdated(g_exampleDatabase.device.instance, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, g_exampleDatabase.analogInput.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELIABILITY);
-		}
+		// The notification is sent from the main loop with the other changed points.
+		g_exampleDatabase.dirtyPoints.MarkDirty(g_exampleDatabase.analogInput.reliabilityPoint);
 		break;
 	}
 	case 'f': {
@@ -865,6 +1615,41 @@ bool DoUserInput()
 		}
 		break;
 	}
+	case 'c': {
+		// Checkpoint the persistent image in the background and print the statistics of the previous ones
+		const ExamplePersistentCheckpointStats& stats = g_exampleDatabase.persistentCheckpointStats;
+		std::cout << "Checkpoints: count=[" << stats.count << "], failures=[" << stats.failures << "], duration=[" << stats.lastDuration << " ms, max " << stats.maxDuration << " ms], pause=[" << stats.lastPause << " ms, max " << stats.maxPause << " ms]" << std::endl;
+		if (!g_exampleDatabase.StartPersistentCheckpoint()) {
+			std::cout << "Error - Could not start a checkpoint, the persistent image is not open or a checkpoint is running" << std::endl;
+		}
+		break;
+	}
+	case 'a': {
+		// Add a hosted device after the last one. The instances of the removed devices are not used again,
+		// the stack still knows them.
+		const uint32_t instance = (g_deviceRegistry.GetHighestInstance() > g_exampleDatabase.device.instance ? g_deviceRegistry.GetHighestInstance() : g_exampleDatabase.device.instance) + 1;
+		if (AddHostedDevice(instance, g_hostedPointCount)) {
+			std::cout << "Added hosted device " << instance << " with " << g_hostedPointCount << " points, devices=[" << g_deviceRegistry.GetCount() << "]" << std::endl;
+		}
+		break;
+	}
+	case 'x': {
+		// Remove the last hosted device
+		ExampleHostedDevice* last = g_deviceRegistry.GetLast();
+		if (last == NULL) {
+			std::cout << "No hosted devices" << std::endl;
+			break;
+		}
+		const uint32_t instance = last->GetInstance();
+		if (RemoveHostedDevice(instance)) {
+			std::cout << "Removed hosted device " << instance << ", devices=[" << g_deviceRegistry.GetCount() << "]" << std::endl;
+		}
+		break;
+	}
+	case 'l': {
+		g_callbackLatency.Print(std::cout);
+		break;
+	}
 	case 'h':
 	default: {
 		// Print the Help
@@ -878,6 +1663,14 @@ bool DoUserInput()
 		std::cout << "i - (i)ncrement Analog Value: " << g_exampleDatabase.analogValue.instance << " by 1.1" << std::endl;
 		std::cout << "r - Toggle the Analog Input: 0 (r)eliability status" << std::endl;
 		std::cout << "f - Send Register (foreign) device message" << std::endl;
+		std::cout << "c - (c)heckpoint the persistent image in the background" << std::endl;
+		std::cout << "a - (a)dd a hosted device, hosted devices: " << g_deviceRegistry.GetCount() << std::endl;
+		std::cout << "x - Remove the last hosted device" << std::endl;
+		std::cout << "l - Print the callback (l)atency by object type" << std::endl;
+		if (g_virtualRouter.IsEnabled()) {
+			const ExampleVirtualRouterStats& routerStats = g_virtualRouter.GetStats();
+			std::cout << "Virtual network " << g_virtualRouter.GetNetworkNumber() << ": Who-Is=[" << routerStats.whoIsReceived << "], I-Am sent=[" << routerStats.iAmSent << "], pending=[" << g_virtualRouter.GetPendingCount() << "], routed=[" << routerStats.routed << "], replied=[" << routerStats.replied << "], dropped=[" << routerStats.dropped << "]" << std::endl;
+		}
 		// std::cout << "d - (d)ebug" << std::endl;
 		std::cout << "h - (h)elp" << std::endl;
 		std::cout << "m - Send text (m)essage" << std::endl;
@@ -919,6 +1712,7 @@ uint16_t CallbackReceiveMessage(uint8_t* message, const uint16_t maxMessageLengt
 		// Convert the IP Address to the connection string
 		if (!ChipkinCommon::ChipkinConvert::IPAddressToBytes(ipAddress, sourceConnectionString, maxConnectionStringLength)) {
 			std::cerr << "Failed to convert the ip address into a connectionString" << std::endl;
+			g_metrics.drops[ExampleServerMetrics::DROP_INVALID_ADDRESS].Increment();
 			return 0;
 		}
 		sourceConnectionString[4] = port / 256;
@@ -927,6 +1721,30 @@ uint16_t CallbackReceiveMessage(uint8_t* message, const uint16_t maxMessageLengt
 		*sourceConnectionStringLength = 6;
 		*networkType = CASBACnetStackExampleConstants::NETWORK_TYPE_IP;
 
+		ExampleNpdu npdu;
+		if (ExampleDecodeNpdu(message, (uint16_t)bytesRead, &npdu)) {
+			// In virtual network mode the router answers Who-Is for the devices on the virtual network, drops the
+			// messages for devices that are not hosted and rewrites the ones for hosted devices into local messages
+			const uint64_t routerDropped = g_virtualRouter.GetStats().dropped;
+			uint32_t routedDevice;
+			bytesRead = g_virtualRouter.Receive(message, (uint16_t)bytesRead, npdu, sourceConnectionString, &routedDevice);
+			if (bytesRead == 0) {
+				g_metrics.drops[ExampleServerMetrics::DROP_VIRTUAL_NETWORK].Add(g_virtualRouter.GetStats().dropped - routerDropped);
+				return 0;
+			}
+			// The stack is told which of its devices the message is for by its MAC address on the virtual network
+			if (routedDevice != ExampleVirtualRouter::NO_DEVICE && destinationConnectionString != NULL && destinationConnectionStringLength != NULL && maxConnectionStringLength >= ExampleVirtualRouter::MAC_LENGTH) {
+				destinationConnectionString[0] = (uint8_t)(routedDevice >> 16);
+				destinationConnectionString[1] = (uint8_t)(routedDevice >> 8);
+				destinationConnectionString[2] = (uint8_t)routedDevice;
+				*destinationConnectionStringLength = ExampleVirtualRouter::MAC_LENGTH;
+			}
+			if (routedDevice == ExampleVirtualRouter::NO_DEVICE || ExampleDecodeNpdu(message, (uint16_t)bytesRead, &npdu)) {
+				g_metrics.CountRequest(npdu);
+			}
+		}
+		g_metrics.CountReceived((uint16_t)bytesRead);
+
 		/*
 		// Process the message as XML
 		static char xmlRenderBuffer[MAX_RENDER_BUFFER_LENGTH ]; 
@@ -989,18 +1807,31 @@ uint16_t CallbackSendMessage(const uint8_t* message, const uint16_t messageLengt
 	port += connectionString[4] * 256;
 	port += connectionString[5];
 
-	std::cout << std::endl << "FYI: Sending message to [" << ipAddress << ":"<< port <<"] length [" << messageLength << "]" << std::endl;
+	// The answer of a hosted device to a request routed from the virtual network comes from the device's address on that network
+	static uint8_t routedReply[ExampleVirtualRouter::MAX_REPLY_LENGTH];
+	uint16_t sendLength = messageLength;
+	if (!broadcast && connectionStringLength >= 6) {
+		const uint16_t routedLength = g_virtualRouter.Reply(message, messageLength, connectionString, routedReply, sizeof(routedReply));
+		if (routedLength > 0) {
+			message = routedReply;
+			sendLength = routedLength;
+		}
+	}
+
+	std::cout << std::endl << "FYI: Sending message to [" << ipAddress << ":"<< port <<"] length [" << sendLength << "]" << std::endl;
 
 	// Send the message
-	if (!g_udp.SendMessage(ipAddress, port, (unsigned char*)message, messageLength)) {
+	if (!g_udp.SendMessage(ipAddress, port, (unsigned char*)message, sendLength)) {
 		std::cout << "Failed to send message" << std::endl;
+		g_metrics.drops[ExampleServerMetrics::DROP_SEND_FAILED].Increment();
 		return 0;
 	}
+	g_metrics.CountSent(sendLength);
 
 	/*
 	// Get the XML rendered version of the just sent message
 	static char xmlRenderBuffer[MAX_RENDER_BUFFER_LENGTH];
-	if (fpDecodeAsXML((char*)message, messageLength, xmlRenderBuffer, MAX_RENDER_BUFFER_LENGTH) > 0) {
+	if (fpDecodeAsXML((char*)message, sendLength, xmlRenderBuffer, MAX_RENDER_BUFFER_LENGTH) > 0) {
 		std::cout << xmlRenderBuffer << std::endl;
 		memset(xmlRenderBuffer, 0, MAX_RENDER_BUFFER_LENGTH);
 	}
@@ -1008,7 +1839,7 @@ uint16_t CallbackSendMessage(const uint8_t* message, const uint16_t messageLengt
 	
 	// Get the JSON rendered version of the just sent message
 	static char jsonRenderBuffer[MAX_RENDER_BUFFER_LENGTH];
-	if (fpDecodeAsJSON((char*)message, messageLength, jsonRenderBuffer, MAX_RENDER_BUFFER_LENGTH, networkType) > 0) {
+	if (fpDecodeAsJSON((char*)message, sendLength, jsonRenderBuffer, MAX_RENDER_BUFFER_LENGTH, networkType) > 0) {
 		std::cout << "---------------------" << std::endl;
 		std::cout << jsonRenderBuffer << std::endl;
 		std::cout << "---------------------" << std::endl;
@@ -1021,44 +1852,35 @@ uint16_t CallbackSendMessage(const uint8_t* message, const uint16_t messageLengt
 // Callback used by the BACnet Stack to get the current time
 time_t CallbackGetSystemTime()
 {
-	return time(0) - g_exampleDatabase.device.currentTimeOffset;
+	return g_exampleDatabase.clock.GetTime();
 }
 
 // Callback used by the BACnet Stack to set the current time
 bool CallbackSetSystemTime(const uint32_t deviceInstance, const uint8_t year, const uint8_t month, const uint8_t day, const uint8_t weekday, const uint8_t hour, const uint8_t minute, const uint8_t second, const uint8_t hundrethSeconds)
 {
-
-	// Calculate the time_t based on the passed in parameters
-	struct tm timeInfo;
-	timeInfo.tm_year = year;
-	timeInfo.tm_mon = month - 1;
-	timeInfo.tm_mday = day;
-	timeInfo.tm_wday = weekday == 7 ? 0 : weekday;
-	timeInfo.tm_hour = hour;
-	timeInfo.tm_min = minute;
-	timeInfo.tm_sec = second;
-
-	// Calculate and store the current time offset
-	g_exampleDatabase.device.currentTimeOffset = time(0) - mktime(&timeInfo);
+	// Calculate and store the current time offset, from the local time the device clock shows now
+	g_exampleDatabase.clock.SetLocalTime(year, month, day, hour, minute, second);
 	return true;
 }
 
 // Callback used by the BACnet Stack to get Bitstring property values from the user
 bool CallbackGetPropertyBitString(uint32_t deviceInstance, uint16_t objectType, uint32_t objectInstance, uint32_t propertyIdentifier, bool* value, uint32_t* valueElementCount, uint32_t maxElementCount, bool useArrayIndex, uint32_t propertyArrayIndex)
 {
+	if (deviceInstance != g_exampleDatabase.device.instance) {
+		return false; // The hosted devices have no properties of this type
+	}
+
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
 	// Example of Bitstring Value Object Present Value property
 	if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_BITSTRING_VALUE && objectInstance == g_exampleDatabase.bitstringValue.instance) {
-			if (g_exampleDatabase.bitstringValue.presentValue.size() > maxElementCount) {
+		if (object == &g_exampleDatabase.bitstringValue) {
+			if (g_exampleDatabase.bitstringValue.presentValueLength > maxElementCount) {
 				return false;
 			}
 			else {
-				uint32_t valueArrayLength = 0;
-				for (std::vector<bool>::const_iterator itr = g_exampleDatabase.bitstringValue.presentValue.begin(); itr != g_exampleDatabase.bitstringValue.presentValue.end(); itr++) {
-					*(value + valueArrayLength) = (*itr);
-				}
-
-				*valueElementCount = valueArrayLength;
+				*valueElementCount = g_exampleDatabase.bitstringValue.UnpackPresentValue(value, maxElementCount);
 				return true;
 			}
 		}
@@ -1069,30 +1891,44 @@ bool CallbackGetPropertyBitString(uint32_t deviceInstance, uint16_t objectType,
 // Callback used by the BACnet Stack to get Boolean property values from the user
 bool CallbackGetPropertyBool(uint32_t deviceInstance, uint16_t objectType, uint32_t objectInstance, uint32_t propertyIdentifier, bool* value, bool useArrayIndex, uint32_t propertyArrayIndex)
 {
+	// Devices hosted next to the example device (CASBACnetStackExampleDeviceRegistry.h)
+	if (deviceInstance != g_exampleDatabase.device.instance) {
+		ExampleHostedDevice* device = g_deviceRegistry.Find(deviceInstance);
+		return device != NULL && device->GetPropertyBool(objectType, objectInstance, propertyIdentifier, value);
+	}
+
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
+	// Properties declared in the object descriptors (CASBACnetStackExampleObjectDescriptors.h)
+	if (ExampleObjectDescriptors::Get<CASBACnetStackExampleConstants::DATA_TYPE_BOOLEAN>(g_exampleDatabase, object, propertyIdentifier, value)) {
+		return true;
+	}
+
 	// Example of Priority array Null handling
 	if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRIORITY_ARRAY) {
 		if (useArrayIndex) {
-			if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_OUTPUT && objectInstance == g_exampleDatabase.analogOutput.instance) {
+			if (object == &g_exampleDatabase.analogOutput) {
 				if (propertyArrayIndex <= CASBACnetStackExampleConstants::MAX_BACNET_PRIORITY) {
-					*value = g_exampleDatabase.analogOutput.priorityArrayNulls[propertyArrayIndex - 1];
+					*value = g_exampleDatabase.analogOutput.priorityArray.IsNull(propertyArrayIndex);
 					return true;
 				}
 				else {
 					return false; // property array index out of range
 				}
 			}
-			else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_OUTPUT && objectInstance == g_exampleDatabase.binaryOutput.instance) {
+			else if (object == &g_exampleDatabase.binaryOutput) {
 				if (propertyArrayIndex <= CASBACnetStackExampleConstants::MAX_BACNET_PRIORITY) {
-					*value = g_exampleDatabase.binaryOutput.priorityArrayNulls[propertyArrayIndex - 1];
+					*value = g_exampleDatabase.binaryOutput.priorityArray.IsNull(propertyArrayIndex);
 					return true;
 				}
 				else {
 					return false; // property array index out of range
 				}
 			}
-			else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_OUTPUT && objectInstance == g_exampleDatabase.multiStateOutput.instance) {
+			else if (object == &g_exampleDatabase.multiStateOutput) {
 				if (propertyArrayIndex <= CASBACnetStackExampleConstants::MAX_BACNET_PRIORITY) {
-					*value = g_exampleDatabase.multiStateOutput.priorityArrayNulls[propertyArrayIndex - 1];
+					*value = g_exampleDatabase.multiStateOutput.priorityArray.IsNull(propertyArrayIndex);
 					return true;
 				}
 				else {
@@ -1106,24 +1942,8 @@ bool CallbackGetPropertyBool(uint32_t deviceInstance, uint16_t objectType, uint3
 	}
 	// Example of Device Day Light Savings Status property
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_DAY_LIGHT_SAVINGS_STATUS) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE && objectInstance == g_exampleDatabase.device.instance) {
-			time_t currentTime = time(0);
-			struct tm* timeinfo = localtime(&currentTime);
-			*value = (timeinfo->tm_isdst != 0);
-			return true;
-		}
-	}
-	// Network Port Object - Changes Pending property
-	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_CHANGES_PENDING) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT && objectInstance == g_exampleDatabase.networkPort.instance) {
-			*value = g_exampleDatabase.networkPort.ChangesPending;
-			return true;
-		}
-	}
-	// AnalogInput - OutOfService Example
-	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OUT_OF_SERVICE) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInputOutOfService.instance) {
-			*value = g_exampleDatabase.analogInputOutOfService.outOfService;
+		if (object == &g_exampleDatabase.device) {
+			*value = g_exampleDatabase.clock.Get().daylightSavings;
 			return true;
 		}
 	}
@@ -1133,27 +1953,36 @@ bool CallbackGetPropertyBool(uint32_t deviceInstance, uint16_t objectType, uint3
 // Callback used by the BACnet Stack to get Character String property values from the user
 bool CallbackGetPropertyCharString(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, char* value, uint32_t* valueElementCount, const uint32_t maxElementCount, uint8_t* encodingType, const bool useArrayIndex, const uint32_t propertyArrayIndex)
 {
+	// Devices hosted next to the example device (CASBACnetStackExampleDeviceRegistry.h)
+	if (deviceInstance != g_exampleDatabase.device.instance) {
+		ExampleHostedDevice* device = g_deviceRegistry.Find(deviceInstance);
+		return device != NULL && device->GetPropertyCharString(objectType, objectInstance, propertyIdentifier, value, valueElementCount, maxElementCount);
+	}
+
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
 	// Example of Object Name property
 	if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OBJECT_NAME) {
 		return GetObjectName(deviceInstance, objectType, objectInstance, value, valueElementCount, maxElementCount);
 	}
 	// Example of Device Desription
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_DESCRIPTION) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE && objectInstance == g_exampleDatabase.device.instance) {
+		if (object == &g_exampleDatabase.device) {
 			if (g_exampleDatabase.device.description.size() <= maxElementCount) {
 				memcpy(value, g_exampleDatabase.device.description.c_str(), g_exampleDatabase.device.description.size());
 				*valueElementCount = (uint32_t)g_exampleDatabase.device.description.size();
 				return true;
 			}
 		}
-		else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInput.instance) {
+		else if (object == &g_exampleDatabase.analogInput) {
 			if (g_exampleDatabase.analogInput.description.size() <= maxElementCount) {
 				memcpy(value, g_exampleDatabase.analogInput.description.c_str(), g_exampleDatabase.analogInput.description.size());
 				*valueElementCount = (uint32_t)g_exampleDatabase.analogInput.description.size();
 				return true;
 			}
 		}
-		else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInputOutOfService.instance) {
+		else if (object == &g_exampleDatabase.analogInputOutOfService) {
 			if (g_exampleDatabase.analogInputOutOfService.description.size() <= maxElementCount) {
 				memcpy(value, g_exampleDatabase.analogInputOutOfService.description.c_str(), g_exampleDatabase.analogInputOutOfService.description.size());
 				*valueElementCount = (uint32_t)g_exampleDatabase.analogInputOutOfService.description.size();
@@ -1164,7 +1993,7 @@ bool CallbackGetPropertyCharString(const uint32_t deviceInstance, const uint16_t
 	}
 	// Example of Character String Value Object Present Value property
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_CHARACTERSTRING_VALUE && objectInstance == g_exampleDatabase.characterStringValue.instance) {
+		if (object == &g_exampleDatabase.characterStringValue) {
 			if (g_exampleDatabase.characterStringValue.presentValue.size() <= maxElementCount) {
 				memcpy(value, g_exampleDatabase.characterStringValue.presentValue.c_str(), g_exampleDatabase.characterStringValue.presentValue.size());
 				*valueElementCount = (uint32_t)g_exampleDatabase.characterStringValue.presentValue.size();
@@ -1173,15 +2002,13 @@ bool CallbackGetPropertyCharString(const uint32_t deviceInstance, const uint16_t
 		}
 		return false;
 	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_BITSTRING_VALUE && propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_BIT_TEXT && objectInstance == g_exampleDatabase.bitstringValue.instance && useArrayIndex) {
-		if (propertyArrayIndex <= g_exampleDatabase.bitstringValue.presentValue.size()) {
-			memcpy(value, g_exampleDatabase.bitstringValue.bitText[propertyArrayIndex - 1].c_str(), g_exampleDatabase.bitstringValue.bitText[propertyArrayIndex - 1].size());
-			*valueElementCount = (uint32_t)g_exampleDatabase.bitstringValue.bitText[propertyArrayIndex - 1].size();
-			return true;
+	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_BITSTRING_VALUE && propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_BIT_TEXT && object == &g_exampleDatabase.bitstringValue && useArrayIndex) {
+		if (propertyArrayIndex > 0 && propertyArrayIndex <= g_exampleDatabase.bitstringValue.bitText.size()) {
+			return g_exampleDatabase.strings.Copy(g_exampleDatabase.bitstringValue.bitTextStrings + propertyArrayIndex - 1, value, valueElementCount, maxElementCount);
 		}
 		return false;
 	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_DESCRIPTION && objectInstance == g_exampleDatabase.analogInput.instance) {
+	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_DESCRIPTION && object == &g_exampleDatabase.analogInput) {
 		if (g_exampleDatabase.analogInput.description.size() <= maxElementCount) {
 			memcpy(value, g_exampleDatabase.analogInput.description.c_str(), g_exampleDatabase.analogInput.description.size());
 			*valueElementCount = (uint32_t)g_exampleDatabase.analogInput.description.size();
@@ -1191,45 +2018,36 @@ bool CallbackGetPropertyCharString(const uint32_t deviceInstance, const uint16_t
 	}
 	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE && propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_APPLICATION_SOFTWARE_VERSION)
 	{
-		*valueElementCount = snprintf(value, maxElementCount, APPLICATION_VERSION.c_str());
-		return true;
+		return g_exampleDatabase.strings.Copy(g_exampleDatabase.device.applicationSoftwareVersionString, value, valueElementCount, maxElementCount);
 	}
-	
-
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && propertyIdentifier == 512 + 1 && objectInstance == g_exampleDatabase.analogInput.instance)
+	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && propertyIdentifier == 512 + 1 && object == &g_exampleDatabase.analogInput)
 	{
-		*valueElementCount = snprintf( value, maxElementCount, "Example custom property 512 + 1");
-		return true;
+		return g_exampleDatabase.strings.Copy(g_exampleDatabase.analogInput.proprietaryCharacterStrings + 0, value, valueElementCount, maxElementCount);
 	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && propertyIdentifier == 512 + 2 && objectInstance == g_exampleDatabase.analogInput.instance)
+	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && propertyIdentifier == 512 + 2 && object == &g_exampleDatabase.analogInput)
 	{
-		*valueElementCount = snprintf(value, maxElementCount, "Example custom property 512 + 2");
-		return true;
+		return g_exampleDatabase.strings.Copy(g_exampleDatabase.analogInput.proprietaryCharacterStrings + 1, value, valueElementCount, maxElementCount);
 	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && propertyIdentifier == 512 + 3 && objectInstance == g_exampleDatabase.analogInput.instance)
+	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && propertyIdentifier == 512 + 3 && object == &g_exampleDatabase.analogInput)
 	{
-		*valueElementCount = snprintf(value, maxElementCount, "Example custom property 512 + 3");
-		return true;
+		return g_exampleDatabase.strings.Copy(g_exampleDatabase.analogInput.proprietaryCharacterStrings + 2, value, valueElementCount, maxElementCount);
 	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_INPUT && propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_STATE_TEXT && objectInstance == g_exampleDatabase.multiStateInput.instance) {
+	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_INPUT && propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_STATE_TEXT && object == &g_exampleDatabase.multiStateInput) {
 		if (useArrayIndex && propertyArrayIndex > 0 && propertyArrayIndex <= g_exampleDatabase.multiStateInput.stateText.size()) {
-			// 0 is number of dates. 
-			*valueElementCount = snprintf(value, maxElementCount, g_exampleDatabase.multiStateInput.stateText[propertyArrayIndex - 1].c_str());
-			return true;
+			// 0 is number of states. 
+			return g_exampleDatabase.strings.Copy(g_exampleDatabase.multiStateInput.stateTextStrings + propertyArrayIndex - 1, value, valueElementCount, maxElementCount);
 		}
 	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_OUTPUT && propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_STATE_TEXT && objectInstance == g_exampleDatabase.multiStateOutput.instance) {
+	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_OUTPUT && propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_STATE_TEXT && object == &g_exampleDatabase.multiStateOutput) {
 		if (useArrayIndex && propertyArrayIndex > 0 && propertyArrayIndex <= g_exampleDatabase.multiStateOutput.stateText.size()) {
-			// 0 is number of dates. 
-			*valueElementCount = snprintf(value, maxElementCount, g_exampleDatabase.multiStateOutput.stateText[propertyArrayIndex - 1].c_str());
-			return true;
+			// 0 is number of states. 
+			return g_exampleDatabase.strings.Copy(g_exampleDatabase.multiStateOutput.stateTextStrings + propertyArrayIndex - 1, value, valueElementCount, maxElementCount);
 		}
 	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_VALUE && propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_STATE_TEXT && objectInstance == g_exampleDatabase.multiStateValue.instance) {
+	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_VALUE && propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_STATE_TEXT && object == &g_exampleDatabase.multiStateValue) {
 		if (useArrayIndex && propertyArrayIndex > 0 && propertyArrayIndex <= g_exampleDatabase.multiStateValue.stateText.size()) {
-			// 0 is number of dates. 
-			*valueElementCount = snprintf(value, maxElementCount, g_exampleDatabase.multiStateValue.stateText[propertyArrayIndex - 1].c_str());
-			return true;
+			// 0 is number of states. 
+			return g_exampleDatabase.strings.Copy(g_exampleDatabase.multiStateValue.stateTextStrings + propertyArrayIndex - 1, value, valueElementCount, maxElementCount);
 		}
 	}
 	return false;
@@ -1238,9 +2056,16 @@ bool CallbackGetPropertyCharString(const uint32_t deviceInstance, const uint16_t
 // Callback used by the BACnet Stack to get Date property values from the user
 bool CallbackGetPropertyDate(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, uint8_t* year, uint8_t* month, uint8_t* day, uint8_t* weekday, const bool useArrayIndex, const uint32_t propertyArrayIndex)
 {
+	if (deviceInstance != g_exampleDatabase.device.instance) {
+		return false; // The hosted devices have no properties of this type
+	}
+
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
 	// Example of getting Date Value Object Present Value property
 	if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DATE_VALUE && objectInstance == g_exampleDatabase.dateValue.instance) {
+		if (object == &g_exampleDatabase.dateValue) {
 			*year = g_exampleDatabase.dateValue.presentValueYear;
 			*month = g_exampleDatabase.dateValue.presentValueMonth;
 			*day = g_exampleDatabase.dateValue.presentValueDay;
@@ -1250,28 +2075,28 @@ bool CallbackGetPropertyDate(const uint32_t deviceInstance, const uint16_t objec
 	}
 	// Example of getting Device Local Date property
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_LOCAL_DATE) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE && objectInstance == g_exampleDatabase.device.instance) {
-			time_t adjustedTime = time(0) - g_exampleDatabase.device.currentTimeOffset;
-			struct tm* timeInfo = localtime(&adjustedTime);
-			*year = timeInfo->tm_year;
-			*month = timeInfo->tm_mon + 1;
-			*day = timeInfo->tm_mday;
-			*weekday = timeInfo->tm_wday == 0 ? 7 : timeInfo->tm_wday;
+		if (object == &g_exampleDatabase.device) {
+			const ExampleClockTime& clockTime = g_exampleDatabase.clock.Get();
+			*year = clockTime.year;
+			*month = clockTime.month;
+			*day = clockTime.day;
+			*weekday = clockTime.weekday;
 			return true;
 		}
 	}
 	// Example of getting DateTime Value Object Present Value property
 	if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DATETIME_VALUE && objectInstance == 60) {
 		if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-			*year = g_exampleDatabase.dateTimeValue.presentValueYear;
-			*month = g_exampleDatabase.dateTimeValue.presentValueMonth;
-			*day = g_exampleDatabase.dateTimeValue.presentValueDay;
-			*weekday = g_exampleDatabase.dateTimeValue.presentValueWeekDay;
+			const ExampleDateTime dateTime = g_exampleDatabase.dateTimeValue.presentValue.Read();
+			*year = dateTime.year;
+			*month = dateTime.month;
+			*day = dateTime.day;
+			*weekday = dateTime.weekDay;
 			return true;
 			}
 	}
 	// Example of getting Analog Input object Date Time Proprietary property
-	if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInput.instance) {
+	if (object == &g_exampleDatabase.analogInput) {
 		if (propertyIdentifier == 512 + 4) {
 			*year = g_exampleDatabase.analogInput.proprietaryYear;
 			*month = g_exampleDatabase.analogInput.proprietaryMonth;
@@ -1287,38 +2112,60 @@ bool CallbackGetPropertyDate(const uint32_t deviceInstance, const uint16_t objec
 // Callback used by the BACnet Stack to get Dboule property values from the user
 bool CallbackGetPropertyDouble(uint32_t deviceInstance, uint16_t objectType, uint32_t objectInstance, uint32_t propertyIdentifier, double* value, bool useArrayIndex, uint32_t propertyArrayIndex)
 {
+	if (deviceInstance != g_exampleDatabase.device.instance) {
+		return false; // The hosted devices have no properties of this type
+	}
+
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
 	// Example of Large Analg Value Object Present Value property
-	if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_LARGE_ANALOG_VALUE && objectInstance == g_exampleDatabase.largeAnalogValue.instance) {
-			*value = g_exampleDatabase.largeAnalogValue.presentValue;
-			return true;
-		}
+	if (ExampleObjectDescriptors::Get<CASBACnetStackExampleConstants::DATA_TYPE_DOUBLE>(g_exampleDatabase, object, propertyIdentifier, value)) {
+		return true;
 	}
+
 	return false;
 }
 
 // Callback used by the BACnet Stack to get Enumerated property values from the user
 bool CallbackGetPropertyEnum(uint32_t deviceInstance, uint16_t objectType, uint32_t objectInstance, uint32_t propertyIdentifier, uint32_t* value, bool useArrayIndex, uint32_t propertyArrayIndex)
 {
+	// Devices hosted next to the example device (CASBACnetStackExampleDeviceRegistry.h)
+	if (deviceInstance != g_exampleDatabase.device.instance) {
+		ExampleHostedDevice* device = g_deviceRegistry.Find(deviceInstance);
+		return device != NULL && device->GetPropertyEnum(objectType, objectInstance, propertyIdentifier, value);
+	}
+
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
 	std::cout << "CallbackGetPropertyEnum deviceInstance=" << deviceInstance << ", objectType=" << objectType << ", objectInstance=" << objectInstance << ", propertyIdentifier=" << propertyIdentifier << ", useArrayIndex=" << useArrayIndex << ", propertyArrayIndex=" << propertyArrayIndex << std::endl; 
 
-	// Example of Binary Input / Value Object Present Value property
+	// Properties declared in the object descriptors (CASBACnetStackExampleObjectDescriptors.h)
+	if (ExampleObjectDescriptors::Get<CASBACnetStackExampleConstants::DATA_TYPE_ENUMERATED>(g_exampleDatabase, object, propertyIdentifier, value)) {
+		return true;
+	}
+
+	// Binary Input / Value present values and the Analog Input reliability and units are declared in the object descriptors
 	if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_INPUT && objectInstance == g_exampleDatabase.binaryInput.instance) {
-			*value = g_exampleDatabase.binaryInput.presentValue;
+		// Binary Output present value is the cached result of the priority array
+		if (object == &g_exampleDatabase.binaryOutput) {
+			*value = g_exampleDatabase.binaryOutput.priorityArray.GetPresentValue();
 			return true;
 		}
-		else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_VALUE && objectInstance == g_exampleDatabase.binaryValue.instance) {
-			*value = g_exampleDatabase.binaryValue.presentValue;
+	}
+	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELINQUISH_DEFAULT) {
+		if (object == &g_exampleDatabase.binaryOutput) {
+			*value = g_exampleDatabase.binaryOutput.priorityArray.GetRelinquishDefault();
 			return true;
 		}
 	}
 	// Example of Binary Output Priority Array property
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRIORITY_ARRAY) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_OUTPUT && objectInstance == g_exampleDatabase.binaryOutput.instance) {
+		if (object == &g_exampleDatabase.binaryOutput) {
 			if (useArrayIndex) {
 				if (propertyArrayIndex <= CASBACnetStackExampleConstants::MAX_BACNET_PRIORITY) {
-					*value = g_exampleDatabase.binaryOutput.priorityArrayValues[propertyArrayIndex - 1];
+					*value = g_exampleDatabase.binaryOutput.priorityArray.GetValue(propertyArrayIndex);
 					return true;
 				}
 				else {
@@ -1331,12 +2178,8 @@ bool CallbackGetPropertyEnum(uint32_t deviceInstance, uint16_t objectType, uint3
 		}
 	}
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELIABILITY) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInput.instance) {
-			*value = g_exampleDatabase.analogInput.reliability; 
-			return true;
-		}
 		// Analog Input - OutOfService Example
-		else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInputOutOfService.instance) {
+		if (object == &g_exampleDatabase.analogInputOutOfService) {
 			if (g_exampleDatabase.analogInputOutOfService.outOfService) {
 				*value = g_exampleDatabase.analogInputOutOfService.tempReliability;
 			}
@@ -1348,22 +2191,11 @@ bool CallbackGetPropertyEnum(uint32_t deviceInstance, uint16_t objectType, uint3
 	}
 	// Network Port Object - FdBbmdAddress Host Type
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_FD_BBMD_ADDRESS) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT && objectInstance == g_exampleDatabase.networkPort.instance) {
+		if (object == &g_exampleDatabase.networkPort) {
 			*value = g_exampleDatabase.networkPort.FdBbmdAddressHostType;
 			return true;
 		}
 	}
-	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_UNITS) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInput.instance) {
-			*value = g_exampleDatabase.analogInput.units;
-			return true;
-		}
-		// Analog Input - OutOfService Example
-		else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInputOutOfService.instance) {
-			*value = g_exampleDatabase.analogInputOutOfService.units;
-			return true;
-		}
-	}
 	
 	// Debug for customer 
 	if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_SYSTEM_STATUS &&
@@ -1382,9 +2214,16 @@ bool CallbackGetPropertyEnum(uint32_t deviceInstance, uint16_t objectType, uint3
 // Callback used by the BACnet Stack to get OctetString property values from the user
 bool CallbackGetPropertyOctetString(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, uint8_t* value, uint32_t* valueElementCount, const uint32_t maxElementCount, const bool useArrayIndex, const uint32_t propertyArrayIndex)
 {
+	if (deviceInstance != g_exampleDatabase.device.instance) {
+		return false; // The hosted devices have no properties of this type
+	}
+
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
 	// Example of Octet String Value Object Present Value property
 	if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_OCTETSTRING_VALUE && objectInstance == g_exampleDatabase.octetStringValue.instance) {
+		if (object == &g_exampleDatabase.octetStringValue) {
 			if (g_exampleDatabase.octetStringValue.presentValue.size() > maxElementCount) {
 				return false;
 			}
@@ -1405,7 +2244,7 @@ bool CallbackGetPropertyOctetString(const uint32_t deviceInstance, const uint16_
 	}
 	// Example of Network Port Object IP Address property
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_IP_ADDRESS) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT && objectInstance == g_exampleDatabase.networkPort.instance) {
+		if (object == &g_exampleDatabase.networkPort) {
 			memcpy(value, g_exampleDatabase.networkPort.IPAddress, g_exampleDatabase.networkPort.IPAddressLength);
 			*valueElementCount = g_exampleDatabase.networkPort.IPAddressLength;
 			return true;
@@ -1413,7 +2252,7 @@ bool CallbackGetPropertyOctetString(const uint32_t deviceInstance, const uint16_
 	}
 	// Example of Network Port Object IP Default Gateway property
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_IP_DEFAULT_GATEWAY) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT && objectInstance == g_exampleDatabase.networkPort.instance) {
+		if (object == &g_exampleDatabase.networkPort) {
 			memcpy(value, g_exampleDatabase.networkPort.IPDefaultGateway, g_exampleDatabase.networkPort.IPDefaultGatewayLength);
 			*valueElementCount = g_exampleDatabase.networkPort.IPDefaultGatewayLength;
 			return true;
@@ -1421,7 +2260,7 @@ bool CallbackGetPropertyOctetString(const uint32_t deviceInstance, const uint16_
 	}
 	// Example of Network Port Object IP Subnet Mask property
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_IP_SUBNET_MASK) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT && objectInstance == g_exampleDatabase.networkPort.instance) {
+		if (object == &g_exampleDatabase.networkPort) {
 			memcpy(value, g_exampleDatabase.networkPort.IPSubnetMask, g_exampleDatabase.networkPort.IPSubnetMaskLength);
 			*valueElementCount = g_exampleDatabase.networkPort.IPSubnetMaskLength;
 			return true;
@@ -1429,7 +2268,7 @@ bool CallbackGetPropertyOctetString(const uint32_t deviceInstance, const uint16_
 	}
 	// Example of Network Port Object IP DNS Server property
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_IP_DNS_SERVER) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT && objectInstance == g_exampleDatabase.networkPort.instance) {
+		if (object == &g_exampleDatabase.networkPort) {
 			// The IP DNS Server property is an array of DNS Server addresses
 			if (useArrayIndex) {
 				if (propertyArrayIndex != 0 && propertyArrayIndex <= g_exampleDatabase.networkPort.IPDNSServers.size()) {
@@ -1442,7 +2281,7 @@ bool CallbackGetPropertyOctetString(const uint32_t deviceInstance, const uint16_
 	}
 	// Network Port Object FdBbmdAddress Host (as IP Address)
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_FD_BBMD_ADDRESS) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT && objectInstance == g_exampleDatabase.networkPort.instance) {
+		if (object == &g_exampleDatabase.networkPort) {
 			if (useArrayIndex && propertyArrayIndex == CASBACnetStackExampleConstants::HOST_TYPE_IPADDRESS) {
 				memcpy(value, g_exampleDatabase.networkPort.FdBbmdAddressHostIp, 4);
 				*valueElementCount = 4;
@@ -1456,44 +2295,51 @@ bool CallbackGetPropertyOctetString(const uint32_t deviceInstance, const uint16_
 // Callback used by the BACnet Stack to get Integer property values from the user
 bool CallbackGetPropertyInt(uint32_t deviceInstance, uint16_t objectType, uint32_t objectInstance, uint32_t propertyIdentifier, int32_t* value, bool useArrayIndex, uint32_t propertyArrayIndex)
 {
-	// Example of Integer Value Object Present Value property
-	if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_INTEGER_VALUE && objectInstance == g_exampleDatabase.integerValue.instance) {
-			*value = g_exampleDatabase.integerValue.presentValue;
-			return true;
-		}
+	if (deviceInstance != g_exampleDatabase.device.instance) {
+		return false; // The hosted devices have no properties of this type
 	}
-	// Example of Device UTC Offset property
-	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_UTC_OFFSET) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE && objectInstance == g_exampleDatabase.device.instance) {
-			*value = g_exampleDatabase.device.UTCOffset;
-			return true;
-		}
+
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
+	// Example of Integer Value Object Present Value and Device UTC Offset properties
+	if (ExampleObjectDescriptors::Get<CASBACnetStackExampleConstants::DATA_TYPE_SIGNED_INTEGER>(g_exampleDatabase, object, propertyIdentifier, value)) {
+		return true;
 	}
+
 	return false;
 }
 
 // Callback used by the BACnet Stack to get Real property values from the user
 bool CallbackGetPropertyReal(uint32_t deviceInstance, uint16_t objectType, uint32_t objectInstance, uint32_t propertyIdentifier, float* value, bool useArrayIndex, uint32_t propertyArrayIndex)
 {
-	
-	// Example of Analog Input / Value Object Present Value property
+	// Devices hosted next to the example device (CASBACnetStackExampleDeviceRegistry.h)
+	if (deviceInstance != g_exampleDatabase.device.instance) {
+		ExampleHostedDevice* device = g_deviceRegistry.Find(deviceInstance);
+		return device != NULL && device->GetPropertyReal(objectType, objectInstance, propertyIdentifier, value);
+	}
+
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
+	// Example of Analog Input / Value Object Present Value, COV Increment and Min/Max Present Value properties
+	if (ExampleObjectDescriptors::Get<CASBACnetStackExampleConstants::DATA_TYPE_REAL>(g_exampleDatabase, object, propertyIdentifier, value)) {
+		return true;
+	}
+
 	if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInput.instance) {
-			*value = g_exampleDatabase.analogInput.presentValue;
-			return true;
-		}
-		else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE && objectInstance == g_exampleDatabase.analogValue.instance) {
-			*value = g_exampleDatabase.analogValue.presentValue;
+		// Analog Output present value is the cached result of the priority array
+		if (object == &g_exampleDatabase.analogOutput) {
+			*value = g_exampleDatabase.analogOutput.priorityArray.GetPresentValue();
 			return true;
 		}
 		// Check if this is for a created analog value
-		else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE && g_exampleDatabase.CreatedAnalogValueData.count(objectInstance) > 0) {
-			*value = g_exampleDatabase.CreatedAnalogValueData[objectInstance].value;
+		else if (g_exampleDatabase.AsCreatedAnalogValue(objectType, object) != NULL) {
+			*value = static_cast<CreatedAnalogValue*>(object)->value;
 			return true;
 		}
 		// Check if this is for the analog input out of service example
-		else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInputOutOfService.instance) {
+		else if (object == &g_exampleDatabase.analogInputOutOfService) {
 			if (g_exampleDatabase.analogInputOutOfService.outOfService) {
 				*value = g_exampleDatabase.analogInputOutOfService.tempPresentValue;
 			}
@@ -1505,10 +2351,10 @@ bool CallbackGetPropertyReal(uint32_t deviceInstance, uint16_t objectType, uint3
 	}
 	// Example of Analog Output Priority Array property
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRIORITY_ARRAY) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_OUTPUT && objectInstance == g_exampleDatabase.analogOutput.instance) {
+		if (object == &g_exampleDatabase.analogOutput) {
 			if (useArrayIndex) {
 				if (propertyArrayIndex <= CASBACnetStackExampleConstants::MAX_BACNET_PRIORITY) {
-					*value = g_exampleDatabase.analogOutput.priorityArrayValues[propertyArrayIndex - 1];
+					*value = g_exampleDatabase.analogOutput.priorityArray.GetValue(propertyArrayIndex);
 					return true;
 				}
 				else {
@@ -1520,24 +2366,16 @@ bool CallbackGetPropertyReal(uint32_t deviceInstance, uint16_t objectType, uint3
 			}
 		}
 	}
-	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_COV_INCURMENT && objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInput.instance) {
-		*value = g_exampleDatabase.analogInput.covIncrement;
-		return true;
-	}
-	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_MAX_PRES_VALUE && objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE && objectInstance == g_exampleDatabase.analogValue.instance) {
-		*value = g_exampleDatabase.analogValue.maxPresValue;
+	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELINQUISH_DEFAULT && object == &g_exampleDatabase.analogOutput) {
+		*value = g_exampleDatabase.analogOutput.priorityArray.GetRelinquishDefault();
 		return true;
 	}
-	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_MIN_PRES_VALUE && objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE && objectInstance == g_exampleDatabase.analogValue.instance) {
-		*value = g_exampleDatabase.analogValue.minPresValue;
-		return true;
-	}
-	else if (propertyIdentifier == 512 + 5 && objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInput.instance) {
+	else if (propertyIdentifier == 512 + 5 && object == &g_exampleDatabase.analogInput) {
 		*value = g_exampleDatabase.analogInput.proprietaryReal;
 		return true;
 	}
 	// Example of Proprietary Array of Real primitives
-	else if (propertyIdentifier == 512 + 6 && objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInput.instance && useArrayIndex) {
+	else if (propertyIdentifier == 512 + 6 && object == &g_exampleDatabase.analogInput && useArrayIndex) {
 		*value = g_exampleDatabase.analogInput.proprietaryArrayOfReal[propertyArrayIndex - 1];
 		return true;
 	}
@@ -1548,9 +2386,16 @@ bool CallbackGetPropertyReal(uint32_t deviceInstance, uint16_t objectType, uint3
 // Callback used by the BACnet Stack to get Time property values from the user
 bool CallbackGetPropertyTime(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, uint8_t* hour, uint8_t* minute, uint8_t* second, uint8_t* hundrethSeconds, const bool useArrayIndex, const uint32_t propertyArrayIndex)
 {
+	if (deviceInstance != g_exampleDatabase.device.instance) {
+		return false; // The hosted devices have no properties of this type
+	}
+
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
 	// Example of getting Time Value Object Present Value property
 	if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_TIME_VALUE && objectInstance == g_exampleDatabase.timeValue.instance) {
+		if (object == &g_exampleDatabase.timeValue) {
 			*hour = g_exampleDatabase.timeValue.presentValueHour;
 			*minute = g_exampleDatabase.timeValue.presentValueMinute;
 			*second = g_exampleDatabase.timeValue.presentValueSecond;
@@ -1560,28 +2405,28 @@ bool CallbackGetPropertyTime(const uint32_t deviceInstance, const uint16_t objec
 	}
 	// Example of getting Device Local Time property
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_LOCAL_TIME) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE && objectInstance == g_exampleDatabase.device.instance) {
-			time_t adjustedTime = time(0) - g_exampleDatabase.device.currentTimeOffset;
-			struct tm* timeInfo = localtime(&adjustedTime);
-			*hour = timeInfo->tm_hour;
-			*minute = timeInfo->tm_min;
-			*second = timeInfo->tm_sec;
-			*hundrethSeconds = 0;
+		if (object == &g_exampleDatabase.device) {
+			const ExampleClockTime& clockTime = g_exampleDatabase.clock.Get();
+			*hour = clockTime.hour;
+			*minute = clockTime.minute;
+			*second = clockTime.second;
+			*hundrethSeconds = clockTime.hundredthSeconds;
 			return true;
 		}
 	}
 	// Example of getting DateTime Value Object Present Value property
 	if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DATETIME_VALUE && objectInstance == 60) {
 			if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-			*hour = g_exampleDatabase.dateTimeValue.presentValueHour;
-			*minute = g_exampleDatabase.dateTimeValue.presentValueMinute;
-			*second = g_exampleDatabase.dateTimeValue.presentValueSecond;
-			*hundrethSeconds = g_exampleDatabase.dateTimeValue.presentValueHundredthSeconds;
+			const ExampleDateTime dateTime = g_exampleDatabase.dateTimeValue.presentValue.Read();
+			*hour = dateTime.hour;
+			*minute = dateTime.minute;
+			*second = dateTime.second;
+			*hundrethSeconds = dateTime.hundredthSeconds;
 			return true;
 			}
 	}
 	// Example of getting Analog Input object DateTime Proprietary property
-	if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInput.instance) {
+	if (object == &g_exampleDatabase.analogInput) {
 		if (propertyIdentifier == 512 + 4) {
 			*hour = g_exampleDatabase.analogInput.proprietaryHour;
 			*minute = g_exampleDatabase.analogInput.proprietaryMinute;
@@ -1597,24 +2442,28 @@ bool CallbackGetPropertyTime(const uint32_t deviceInstance, const uint16_t objec
 // Callback used by the BACnet Stack to get Unsigned Integer property values from the user
 bool CallbackGetPropertyUInt(uint32_t deviceInstance, uint16_t objectType, uint32_t objectInstance, uint32_t propertyIdentifier, uint32_t* value, bool useArrayIndex, uint32_t propertyArrayIndex)
 {
+	if (deviceInstance != g_exampleDatabase.device.instance) {
+		return false; // The hosted devices have no properties of this type
+	}
+
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
 	// Example of Positive Integer Value Object and Multi-State Input / Value Objects Present Value property
+	if (ExampleObjectDescriptors::Get<CASBACnetStackExampleConstants::DATA_TYPE_UNSIGNED_INTEGER>(g_exampleDatabase, object, propertyIdentifier, value)) {
+		return true;
+	}
+
 	if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_POSITIVE_INTEGER_VALUE && objectInstance == g_exampleDatabase.positiveIntegerValue.instance) {
-			*value = g_exampleDatabase.positiveIntegerValue.presentValue;
-			return true;
-		}
-		else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_INPUT && objectInstance == g_exampleDatabase.multiStateInput.instance) {
-			*value = g_exampleDatabase.multiStateInput.presentValue;
-			return true;
-		}
-		else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_VALUE && objectInstance == g_exampleDatabase.multiStateValue.instance) {
-			*value = g_exampleDatabase.multiStateValue.presentValue;
+		// Multi-State Output present value is the cached result of the priority array
+		if (object == &g_exampleDatabase.multiStateOutput) {
+			*value = g_exampleDatabase.multiStateOutput.priorityArray.GetPresentValue();
 			return true;
 		}
 	}
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELINQUISH_DEFAULT) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_OUTPUT && objectInstance == g_exampleDatabase.multiStateOutput.instance) {
-			*value = g_exampleDatabase.multiStateOutput.relinquishDefault;
+		if (object == &g_exampleDatabase.multiStateOutput) {
+			*value = g_exampleDatabase.multiStateOutput.priorityArray.GetRelinquishDefault();
 			return true;
 		}
 	}
@@ -1622,10 +2471,10 @@ bool CallbackGetPropertyUInt(uint32_t deviceInstance, uint16_t objectType, uint3
 
 	// Example of Multi-State Output Priority Array property
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRIORITY_ARRAY) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_OUTPUT && objectInstance == g_exampleDatabase.multiStateOutput.instance) {
+		if (object == &g_exampleDatabase.multiStateOutput) {
 			if (useArrayIndex) {
 				if (propertyArrayIndex <= CASBACnetStackExampleConstants::MAX_BACNET_PRIORITY) {
-					*value = g_exampleDatabase.multiStateOutput.priorityArrayValues[propertyArrayIndex - 1];
+					*value = g_exampleDatabase.multiStateOutput.priorityArray.GetValue(propertyArrayIndex);
 					return true;
 				}
 				else {
@@ -1637,18 +2486,11 @@ bool CallbackGetPropertyUInt(uint32_t deviceInstance, uint16_t objectType, uint3
 			}
 		}
 	}
-	// Example of Network Port Object BACnet IP UDP Port property
-	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_BACNET_IP_UDP_PORT) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT && objectInstance == g_exampleDatabase.networkPort.instance) {
-			*value = g_exampleDatabase.networkPort.BACnetIPUDPPort;
-			return true;
-		}
-	}
 	// Example of Network Port Object IP DNS Server Array Size property
 	// Any properties that are an array must have an entry here for the array size.
 	// The array size is provided only if the useArrayIndex parameter is set to true and the propertyArrayIndex is zero.
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_IP_DNS_SERVER) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT && objectInstance == g_exampleDatabase.networkPort.instance) {
+		if (object == &g_exampleDatabase.networkPort) {
 			if (useArrayIndex && propertyArrayIndex == 0) {
 				*value = (uint32_t)g_exampleDatabase.networkPort.IPDNSServers.size();
 				return true;
@@ -1656,35 +2498,35 @@ bool CallbackGetPropertyUInt(uint32_t deviceInstance, uint16_t objectType, uint3
 		}
 	}
 	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_BITSTRING_VALUE && propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_BIT_TEXT) {
-		if (objectInstance == g_exampleDatabase.bitstringValue.instance && useArrayIndex && propertyArrayIndex == 0) {
-			*value = (uint32_t)g_exampleDatabase.bitstringValue.presentValue.size();
+		if (object == &g_exampleDatabase.bitstringValue && useArrayIndex && propertyArrayIndex == 0) {
+			*value = (uint32_t)g_exampleDatabase.bitstringValue.presentValueLength;
 			return true;
 		}
 	}
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_NUMBER_OF_STATES) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_INPUT && objectInstance == g_exampleDatabase.multiStateInput.instance) {
+		if (object == &g_exampleDatabase.multiStateInput) {
 			*value = g_exampleDatabase.multiStateInput.stateText.size();
 			return true;
 		}
-		else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_OUTPUT && objectInstance == g_exampleDatabase.multiStateOutput.instance) {
+		else if (object == &g_exampleDatabase.multiStateOutput) {
 			*value = g_exampleDatabase.multiStateOutput.stateText.size();
 			return true;
 		}
-		else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_VALUE && objectInstance == g_exampleDatabase.multiStateValue.instance) {
+		else if (object == &g_exampleDatabase.multiStateValue) {
 			*value = g_exampleDatabase.multiStateValue.stateText.size();
 			return true;
 		}
 	}
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_STATE_TEXT && useArrayIndex && propertyArrayIndex == 0) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_INPUT && objectInstance == g_exampleDatabase.multiStateInput.instance) {
+		if (object == &g_exampleDatabase.multiStateInput) {
 			*value = g_exampleDatabase.multiStateInput.stateText.size();
 			return true;
 		}
-		else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_OUTPUT && objectInstance == g_exampleDatabase.multiStateOutput.instance) {
+		else if (object == &g_exampleDatabase.multiStateOutput) {
 			*value = g_exampleDatabase.multiStateOutput.stateText.size();
 			return true;
 		}
-		else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_VALUE && objectInstance == g_exampleDatabase.multiStateValue.instance) {
+		else if (object == &g_exampleDatabase.multiStateValue) {
 			*value = g_exampleDatabase.multiStateValue.stateText.size();
 			return true;
 		}
@@ -1692,7 +2534,7 @@ bool CallbackGetPropertyUInt(uint32_t deviceInstance, uint16_t objectType, uint3
 	}
 	// Network Port Object FdBbmdAddress Port
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_FD_BBMD_ADDRESS) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT && objectInstance == g_exampleDatabase.networkPort.instance) {
+		if (object == &g_exampleDatabase.networkPort) {
 			if (useArrayIndex && propertyArrayIndex == CASBACnetStackExampleConstants::FD_BBMD_ADDRESS_PORT) {
 				// Check for index 2, which is looking for the fdBbmdAddress port portion
 				*value = g_exampleDatabase.networkPort.FdBbmdAddressPort;
@@ -1702,14 +2544,14 @@ bool CallbackGetPropertyUInt(uint32_t deviceInstance, uint16_t objectType, uint3
 	}
 	// Network Port Object FdSubscriptionLifetime
 	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_FD_SUBSCRIPTION_LIFETIME) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT && objectInstance == g_exampleDatabase.networkPort.instance) {
+		if (object == &g_exampleDatabase.networkPort) {
 			*value = g_exampleDatabase.networkPort.FdSubscriptionLifetime;
 			return true;
 		}
 	}
 	// Example of Customer Property that is an array. This returns the size of the array
 	else if (propertyIdentifier == 512 + 6) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInput.instance) {
+		if (object == &g_exampleDatabase.analogInput) {
 			*value = g_exampleDatabase.analogInput.proprietaryArrayOfReal.size();
 			return true;
 		}
@@ -1720,19 +2562,19 @@ bool CallbackGetPropertyUInt(uint32_t deviceInstance, uint16_t objectType, uint3
 // Callback used by the BACnet Stack to set Bitstring property values to the user
 bool CallbackSetPropertyBitString(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const bool* value, const uint32_t length, const bool useArrayIndex, const uint32_t propertyArrayIndex, const uint8_t priority, uint32_t* errorCode)
 {
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
 	if (deviceInstance == g_exampleDatabase.device.instance) {
 		// Example of writing to Bitstring Value Object Present Value property
 		if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-			if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_BITSTRING_VALUE && objectInstance == g_exampleDatabase.bitstringValue.instance) {
-				if (length > g_exampleDatabase.bitstringValue.presentValue.size()) {
+			if (object == &g_exampleDatabase.bitstringValue) {
+				if (length > g_exampleDatabase.bitstringValue.presentValueLength) {
 					*errorCode = CASBACnetStackExampleConstants::ERROR_NO_SPACE_TO_WRITE_PROPERTY;
 					return false;
 				}
 				else {
-					g_exampleDatabase.bitstringValue.Resize(length);
-					for (uint32_t offset = 0; offset < length; offset++) {
-						g_exampleDatabase.bitstringValue.SetPresentValue(offset, *(value + offset));
-					}
+					g_exampleDatabase.bitstringValue.PackPresentValue(value, length);
 					return true;
 				}
 			}
@@ -1744,13 +2586,21 @@ bool CallbackSetPropertyBitString(const uint32_t deviceInstance, const uint16_t
 // Callback used by the BACnet Stack to set Boolean property values to the user
 bool CallbackSetPropertyBool(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const bool value, const bool useArrayIndex, const uint32_t propertyArrayIndex, const uint8_t priority, uint32_t* errorCode)
 {
+	// Devices hosted next to the example device (CASBACnetStackExampleDeviceRegistry.h)
+	if (deviceInstance != g_exampleDatabase.device.instance) {
+		ExampleHostedDevice* device = g_deviceRegistry.Find(deviceInstance);
+		return device != NULL && device->SetPropertyBool(objectType, objectInstance, propertyIdentifier, value);
+	}
+
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
 	if (deviceInstance == g_exampleDatabase.device.instance) {
 		// AnalogInput - OutOfService Example
-		if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OUT_OF_SERVICE) {
-			if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInputOutOfService.instance) {
-				g_exampleDatabase.analogInputOutOfService.outOfService = value;
-				return true;
-			}
+		bool handled = false;
+		const bool result = ExampleObjectDescriptors::Set<CASBACnetStackExampleConstants::DATA_TYPE_BOOLEAN>(g_exampleDatabase, object, propertyIdentifier, value, errorCode, &handled);
+		if (handled) {
+			return result;
 		}
 	}
 
@@ -1760,10 +2610,13 @@ bool CallbackSetPropertyBool(const uint32_t deviceInstance, const uint16_t objec
 // Callback used by the BACnet Stack to set Charstring property values to the user
 bool CallbackSetPropertyCharString(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const char* value, const uint32_t length, const uint8_t encodingType, const bool useArrayIndex, const uint32_t propertyArrayIndex, const uint8_t priority, uint32_t* errorCode)
 {
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
 	if (deviceInstance == g_exampleDatabase.device.instance) {
 		// Example of setting Charstring Value Object Present Value property
 		if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-			if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_CHARACTERSTRING_VALUE && objectInstance == g_exampleDatabase.characterStringValue.instance) {
+			if (object == &g_exampleDatabase.characterStringValue) {
 				g_exampleDatabase.characterStringValue.presentValue = std::string(value, length);
 				return true;
 			}
@@ -1771,7 +2624,7 @@ bool CallbackSetPropertyCharString(const uint32_t deviceInstance, const uint16_t
 		}
 		// Example of setting description property of the Device
 		else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_DESCRIPTION) {
-			if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE && objectInstance == g_exampleDatabase.device.instance) {
+			if (object == &g_exampleDatabase.device) {
 				g_exampleDatabase.device.description = std::string(value, length);
 				return true;
 			}
@@ -1779,18 +2632,21 @@ bool CallbackSetPropertyCharString(const uint32_t deviceInstance, const uint16_t
 		}
 		// Example of setting object name property of the Device
 		else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OBJECT_NAME) {
-			if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE && objectInstance == g_exampleDatabase.device.instance) {
+			if (object == &g_exampleDatabase.device) {
 				g_exampleDatabase.device.objectName = std::string(value, length);
 				return true;
 			}
+			// Check if trying to set the object name of an analog value that was created.
+			// Used in initializing objects
+			else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE) {
+				CreatedAnalogValue* createdAnalogValue = g_exampleDatabase.AsCreatedAnalogValue(objectType, object);
+				if (createdAnalogValue != NULL) {
+					createdAnalogValue->objectName = std::string(value, length);
+					return true;
+				}
+			}
 			return false;
 		}
-		// Check if trying to set the object name of an analog value that was created.
-		// Used in initializing objects
-		else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OBJECT_NAME && objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE && g_exampleDatabase.CreatedAnalogValueData.count(objectInstance) > 0) {
-			g_exampleDatabase.CreatedAnalogValueData[objectInstance].name = std::string(value, length);
-			return true;
-		}
 	}
 
 	return false;
@@ -1799,10 +2655,13 @@ bool CallbackSetPropertyCharString(const uint32_t deviceInstance, const uint16_t
 // Callback used by the BACnet Stack to set Date property values to the user
 bool CallbackSetPropertyDate(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint8_t year, const uint8_t month, const uint8_t day, const uint8_t weekday, const bool useArrayIndex, const uint32_t propertyArrayIndex, const uint8_t priority, uint32_t* errorCode)
 {
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
 	if (deviceInstance == g_exampleDatabase.device.instance) {
 		// Example of setting Date Value Present Value property
 		if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-			if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DATE_VALUE && objectInstance == g_exampleDatabase.dateValue.instance) {
+			if (object == &g_exampleDatabase.dateValue) {
 				g_exampleDatabase.dateValue.presentValueYear = year;
 				g_exampleDatabase.dateValue.presentValueMonth = month;
 				g_exampleDatabase.dateValue.presentValueDay = day;
@@ -1817,13 +2676,15 @@ bool CallbackSetPropertyDate(const uint32_t deviceInstance, const uint16_t objec
 // Callback used by the BACnet Stack to set Double property values to the user
 bool CallbackSetPropertyDouble(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const double value, const bool useArrayIndex, const uint32_t propertyArrayIndex, const uint8_t priority, uint32_t* errorCode)
 {
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
 	if (deviceInstance == g_exampleDatabase.device.instance) {
 		// Example of setting Large Analog Value Object Present Value property
-		if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-			if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_LARGE_ANALOG_VALUE && objectInstance == g_exampleDatabase.largeAnalogValue.instance) {
-				g_exampleDatabase.largeAnalogValue.presentValue = value;
-				return true;
-			}
+		bool handled = false;
+		const bool result = ExampleObjectDescriptors::Set<CASBACnetStackExampleConstants::DATA_TYPE_DOUBLE>(g_exampleDatabase, object, propertyIdentifier, value, errorCode, &handled);
+		if (handled) {
+			return result;
 		}
 	}
 	return false;
@@ -1832,23 +2693,33 @@ bool CallbackSetPropertyDouble(const uint32_t deviceInstance, const uint16_t obj
 // Callback used by the BACnet Stack to set Enumerated property values to the user
 bool CallbackSetPropertyEnum(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint32_t value, const bool useArrayIndex, const uint32_t propertyArrayIndex, const uint8_t priority, uint32_t* errorCode)
 {
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
 	if (deviceInstance == g_exampleDatabase.device.instance) {
+		// Example of setting Binary Value Present Value property
+		bool handled = false;
+		const bool result = ExampleObjectDescriptors::Set<CASBACnetStackExampleConstants::DATA_TYPE_ENUMERATED>(g_exampleDatabase, object, propertyIdentifier, value, errorCode, &handled);
+		if (handled) {
+			return result;
+		}
+
 		if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-			// Example of setting Binary Value Present Value property
-			if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_VALUE && objectInstance == g_exampleDatabase.binaryValue.instance) {
-				g_exampleDatabase.binaryValue.presentValue = value;
+			// Example of setting Binary Output Present Value / Priority Array property
+			if (object == &g_exampleDatabase.binaryOutput) {
+				g_exampleDatabase.binaryOutput.priorityArray.Set(priority, value != 0);
 				return true;
 			}
-			// Example of setting Binary Output Present Value / Priority Array property
-			else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_OUTPUT && objectInstance == g_exampleDatabase.binaryOutput.instance) {
-				g_exampleDatabase.binaryOutput.priorityArrayValues[priority - 1] = value;
-				g_exampleDatabase.binaryOutput.priorityArrayNulls[priority - 1] = false;
+		}
+		else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELINQUISH_DEFAULT) {
+			if (object == &g_exampleDatabase.binaryOutput) {
+				g_exampleDatabase.binaryOutput.priorityArray.SetRelinquishDefault(value != 0);
 				return true;
 			}
 		}
 		else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELIABILITY) {
 			// Example of setting reliability to an object that is OutOfService
-			if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInputOutOfService.instance) {
+			if (object == &g_exampleDatabase.analogInputOutOfService) {
 				if (g_exampleDatabase.analogInputOutOfService.outOfService) {
 					g_exampleDatabase.analogInputOutOfService.tempReliability = value;
 					return true;
@@ -1866,22 +2737,22 @@ bool CallbackSetPropertyEnum(const uint32_t deviceInstance, const uint16_t objec
 // message, it will call the CallbackSetPropertyNull callback function with the write priorty.
 bool CallbackSetPropertyNull(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const bool useArrayIndex, const uint32_t propertyArrayIndex, const uint8_t priority, uint32_t* errorCode)
 {
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
 	if (deviceInstance == g_exampleDatabase.device.instance) {
 		// Examples of setting Analog, Binary, and Multi-State Outputs Present Value / Priority Array property to Null
 		if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-			if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_OUTPUT && objectInstance == g_exampleDatabase.analogOutput.instance) {
-				g_exampleDatabase.analogOutput.priorityArrayValues[priority - 1] = 0.0f;
-				g_exampleDatabase.analogOutput.priorityArrayNulls[priority - 1] = true;
+			if (object == &g_exampleDatabase.analogOutput) {
+				g_exampleDatabase.analogOutput.priorityArray.Relinquish(priority);
 				return true;
 			}
-			else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_OUTPUT && objectInstance == g_exampleDatabase.binaryOutput.instance) {
-				g_exampleDatabase.binaryOutput.priorityArrayValues[priority - 1] = 0;
-				g_exampleDatabase.binaryOutput.priorityArrayNulls[priority - 1] = true;
+			else if (object == &g_exampleDatabase.binaryOutput) {
+				g_exampleDatabase.binaryOutput.priorityArray.Relinquish(priority);
 				return true;
 			}
-			else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_OUTPUT && objectInstance == g_exampleDatabase.multiStateOutput.instance) {
-				g_exampleDatabase.multiStateOutput.priorityArrayValues[priority - 1] = 0;
-				g_exampleDatabase.multiStateOutput.priorityArrayNulls[priority - 1] = true;
+			else if (object == &g_exampleDatabase.multiStateOutput) {
+				g_exampleDatabase.multiStateOutput.priorityArray.Relinquish(priority);
 				return true;
 			}
 		}
@@ -1892,10 +2763,13 @@ bool CallbackSetPropertyNull(const uint32_t deviceInstance, const uint16_t objec
 // Callback used by the BACnet Stack to set OctetString property values to the user
 bool CallbackSetPropertyOctetString(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint8_t* value, const uint32_t length, const bool useArrayIndex, const uint32_t propertyArrayIndex, const uint8_t priority, uint32_t* errorCode)
 {
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
 	if (deviceInstance == g_exampleDatabase.device.instance) {
 		// Example of setting Octet String Value Object Present Value property
 		if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-			if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_OCTETSTRING_VALUE && objectInstance == g_exampleDatabase.octetStringValue.instance) {
+			if (object == &g_exampleDatabase.octetStringValue) {
 				if (length > g_exampleDatabase.octetStringValue.presentValue.size()) {
 					*errorCode = CASBACnetStackExampleConstants::ERROR_NO_SPACE_TO_WRITE_PROPERTY;
 					return false;
@@ -1912,7 +2786,7 @@ bool CallbackSetPropertyOctetString(const uint32_t deviceInstance, const uint16_
 
 		// Example of setting FdBbmdAddress Host IP
 		if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_FD_BBMD_ADDRESS) {
-			if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT && objectInstance == g_exampleDatabase.networkPort.instance) {
+			if (object == &g_exampleDatabase.networkPort) {
 				if (useArrayIndex && propertyArrayIndex == CASBACnetStackExampleConstants::FD_BBMD_ADDRESS_HOST) {
 					if (length > 4) {
 						*errorCode = CASBACnetStackExampleConstants::ERROR_VALUE_OUT_OF_RANGE;
@@ -1954,26 +2828,15 @@ bool CallbackSetPropertyObjectIdentifier(const uint32_t deviceInstance, const ui
 // Callback used by the BACnet Stack to set Integer property values to the user
 bool CallbackSetPropertyInt(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const int32_t value, const bool useArrayIndex, const uint32_t propertyArrayIndex, const uint8_t priority, uint32_t* errorCode)
 {
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
 	if (deviceInstance == g_exampleDatabase.device.instance) {
-		// Example of setting Integer Value Object Present Value property
-		if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-			if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_INTEGER_VALUE && objectInstance == g_exampleDatabase.integerValue.instance) {
-				g_exampleDatabase.integerValue.presentValue = value;
-				return true;
-			}
-		}
-		// Example of setting Device UTC Offset property
-		else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_UTC_OFFSET) {
-			if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE && objectInstance == g_exampleDatabase.device.instance) {
-				if (value < -1440 || value > 1440) {
-					*errorCode = CASBACnetStackExampleConstants::ERROR_VALUE_OUT_OF_RANGE;
-					return false;
-				}
-				else {
-					g_exampleDatabase.device.UTCOffset = value;
-					return true;
-				}
-			}
+		// Example of setting Integer Value Object Present Value and Device UTC Offset properties
+		bool handled = false;
+		const bool result = ExampleObjectDescriptors::Set<CASBACnetStackExampleConstants::DATA_TYPE_SIGNED_INTEGER>(g_exampleDatabase, object, propertyIdentifier, value, errorCode, &handled);
+		if (handled) {
+			return result;
 		}
 	}
 	return false;
@@ -1982,45 +2845,52 @@ bool CallbackSetPropertyInt(const uint32_t deviceInstance, const uint16_t object
 // Callback used by the BACnet Stack to set Real property values to the user
 bool CallbackSetPropertyReal(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const float value, const bool useArrayIndex, const uint32_t propertyArrayIndex, const uint8_t priority, uint32_t* errorCode)
 {
+	// Devices hosted next to the example device (CASBACnetStackExampleDeviceRegistry.h)
 	if (deviceInstance != g_exampleDatabase.device.instance) {
-		return false; // Not this device.
+		ExampleHostedDevice* device = g_deviceRegistry.Find(deviceInstance);
+		return device != NULL && device->SetPropertyReal(objectType, objectInstance, propertyIdentifier, value);
 	}
-	if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-		// Example of setting Analog Value Present Value Property
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE && objectInstance == g_exampleDatabase.analogValue.instance) {
-			if (value < g_exampleDatabase.analogValue.minPresValue || value > g_exampleDatabase.analogValue.maxPresValue) {
-				*errorCode = CASBACnetStackExampleConstants::ERROR_VALUE_OUT_OF_RANGE;
-				return false;
-			}
-			g_exampleDatabase.analogValue.presentValue = value;
-			return true;
+
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
+	// Example of setting Analog Value Present Value Property and Analog Input COV Increment
+	bool handled = false;
+	const bool result = ExampleObjectDescriptors::Set<CASBACnetStackExampleConstants::DATA_TYPE_REAL>(g_exampleDatabase, object, propertyIdentifier, value, errorCode, &handled);
+	if (handled) {
+		if (result && propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_COV_INCURMENT && object == &g_exampleDatabase.analogInput) {
+			// Keep the application side COV filter in step with the new increment
+			g_exampleDatabase.covFilter.SetIncrement(g_exampleDatabase.analogInput.presentValueCovFilterPoint, value);
 		}
+		return result;
+	}
+
+	if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
 		// Example of setting Analog Output Present Value / Priority Array property
-		else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_OUTPUT && objectInstance == g_exampleDatabase.analogOutput.instance) {
-			g_exampleDatabase.analogOutput.priorityArrayValues[priority - 1] = value;
-			g_exampleDatabase.analogOutput.priorityArrayNulls[priority - 1] = false;
+		if (object == &g_exampleDatabase.analogOutput) {
+			g_exampleDatabase.analogOutput.priorityArray.Set(priority, value);
 			return true;
 		}
 		// Check if setting present value of a create analog value
-		else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE && g_exampleDatabase.CreatedAnalogValueData.count(objectInstance) > 0) {
-			g_exampleDatabase.CreatedAnalogValueData[objectInstance].value = value;
+		else if (g_exampleDatabase.AsCreatedAnalogValue(objectType, object) != NULL) {
+			static_cast<CreatedAnalogValue*>(object)->value = value;
 			return true;
 		}
 		// Example of setting presentValue to an object that is OutOfService
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInputOutOfService.instance) {
+		if (object == &g_exampleDatabase.analogInputOutOfService) {
 			if (g_exampleDatabase.analogInputOutOfService.outOfService) {
 				g_exampleDatabase.analogInputOutOfService.tempPresentValue = value;
 				return true;
 			}
 		}
 	}
-	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_COV_INCURMENT) {
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInput.instance) {
-			g_exampleDatabase.analogInput.covIncrement = value;
+	else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELINQUISH_DEFAULT) {
+		if (object == &g_exampleDatabase.analogOutput) {
+			g_exampleDatabase.analogOutput.priorityArray.SetRelinquishDefault(value);
 			return true;
 		}
 	}
-	else if (propertyIdentifier == 512 + 5 && objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInput.instance) {
+	else if (propertyIdentifier == 512 + 5 && object == &g_exampleDatabase.analogInput) {
 		g_exampleDatabase.analogInput.proprietaryReal = value;
 		return true;
 	}
@@ -2030,10 +2900,13 @@ bool CallbackSetPropertyReal(const uint32_t deviceInstance, const uint16_t objec
 // Callback used by the BACnet Stack to set Time property values to the user
 bool CallbackSetPropertyTime(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint8_t hour, const uint8_t minute, const uint8_t second, const uint8_t hundrethSeconds, const bool useArrayIndex, const uint32_t propertyArrayIndex, const uint8_t priority, uint32_t* errorCode)
 {
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
 	if (deviceInstance == g_exampleDatabase.device.instance) {
 		// Example of setting Time Value Object Present Value property
 		if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-			if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_TIME_VALUE && objectInstance == g_exampleDatabase.timeValue.instance) {
+			if (object == &g_exampleDatabase.timeValue) {
 				g_exampleDatabase.timeValue.presentValueHour = hour;
 				g_exampleDatabase.timeValue.presentValueMinute = minute;
 				g_exampleDatabase.timeValue.presentValueSecond = second;
@@ -2048,28 +2921,37 @@ bool CallbackSetPropertyTime(const uint32_t deviceInstance, const uint16_t objec
 // Callback used by the BACnet Stack to set Date property values to the user
 bool CallbackSetPropertyUInt(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint32_t value, const bool useArrayIndex, const uint32_t propertyArrayIndex, const uint8_t priority, uint32_t* errorCode)
 {
+	// Resolved once through the object index, the checks below compare the object
+	ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+
 	if (deviceInstance == g_exampleDatabase.device.instance) {
+		// Example of setting Positive Integer Value and Multi-State Value Object Present Value property
+		bool handled = false;
+		const bool result = ExampleObjectDescriptors::Set<CASBACnetStackExampleConstants::DATA_TYPE_UNSIGNED_INTEGER>(g_exampleDatabase, object, propertyIdentifier, value, errorCode, &handled);
+		if (handled) {
+			return result;
+		}
+
 		if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
-			// Example of setting Positive Integer Value Object Present Value property
-			if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_POSITIVE_INTEGER_VALUE && objectInstance == g_exampleDatabase.positiveIntegerValue.instance) {
-				g_exampleDatabase.positiveIntegerValue.presentValue = value;
-				return true;
-			}
-			// Example of setting Multi-State Value Object Present Value property
-			else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_VALUE && objectInstance == g_exampleDatabase.multiStateValue.instance) {
-				g_exampleDatabase.multiStateValue.presentValue = value;
+			// Example of setting Multi-State Output Present Value / Priority Array property
+			if (object == &g_exampleDatabase.multiStateOutput) {
+				g_exampleDatabase.multiStateOutput.priorityArray.Set(priority, value);
 				return true;
 			}
-			// Example of setting Multi-State Output Present Value / Priority Array property
-			else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_OUTPUT && objectInstance == g_exampleDatabase.multiStateOutput.instance) {
-				g_exampleDatabase.multiStateOutput.priorityArrayValues[priority - 1] = value;
-				g_exampleDatabase.multiStateOutput.priorityArrayNulls[priority - 1] = false;
+		}
+		else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELINQUISH_DEFAULT) {
+			if (object == &g_exampleDatabase.multiStateOutput) {
+				if (value == 0 || value > g_exampleDatabase.multiStateOutput.stateText.size()) {
+					*errorCode = CASBACnetStackExampleConstants::ERROR_VALUE_OUT_OF_RANGE;
+					return false;
+				}
+				g_exampleDatabase.multiStateOutput.priorityArray.SetRelinquishDefault(value);
 				return true;
 			}
 		}
 		// Network Port Object FdBbmdAddress Port
 		if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_FD_BBMD_ADDRESS) {
-			if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT && objectInstance == g_exampleDatabase.networkPort.instance) {
+			if (object == &g_exampleDatabase.networkPort) {
 				if (useArrayIndex && propertyArrayIndex == CASBACnetStackExampleConstants::FD_BBMD_ADDRESS_PORT) {
 					g_exampleDatabase.networkPort.FdBbmdAddressPort = value;
 					g_exampleDatabase.networkPort.ChangesPending = true;
@@ -2079,7 +2961,7 @@ bool CallbackSetPropertyUInt(const uint32_t deviceInstance, const uint16_t objec
 		}
 		// Network Port Object FdSubscriptionLifetime
 		else if (propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_FD_SUBSCRIPTION_LIFETIME) {
-			if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT && objectInstance == g_exampleDatabase.networkPort.instance) {
+			if (object == &g_exampleDatabase.networkPort) {
 				g_exampleDatabase.networkPort.FdSubscriptionLifetime = value;
 				g_exampleDatabase.networkPort.ChangesPending = true;
 				return true;
@@ -2093,259 +2975,28 @@ bool CallbackSetPropertyUInt(const uint32_t deviceInstance, const uint16_t objec
 // Gets the object name based on the provided parameters
 bool GetObjectName(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, char* value, uint32_t* valueElementCount, const uint32_t maxElementCount)
 {
-	size_t stringSize = 0;
-	if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE && objectInstance == g_exampleDatabase.device.instance) {
-		stringSize = g_exampleDatabase.device.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance <<" ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.device.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t)stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInput.instance) {
-		stringSize = g_exampleDatabase.analogInput.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance << " ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.analogInput.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t) stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_OUTPUT && objectInstance == g_exampleDatabase.analogOutput.instance) {
-		stringSize = g_exampleDatabase.analogOutput.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance << " ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.analogOutput.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t)stringSize;
-		return true;
-	}
-	else if (objectType == 389 ) {
-		std::string name = "This is an example of the name";
-		stringSize = name.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance << " ]" << std::endl;
-			return false;
-		}
-		memcpy(value, name.c_str(), stringSize);
-		*valueElementCount = (uint32_t) stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE && objectInstance == g_exampleDatabase.analogValue.instance) {
-		stringSize = g_exampleDatabase.analogValue.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance << " ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.analogValue.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t) stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_INPUT && objectInstance == g_exampleDatabase.binaryInput.instance) {
-		stringSize = g_exampleDatabase.binaryInput.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance << " ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.binaryInput.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t) stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_OUTPUT && objectInstance == g_exampleDatabase.binaryOutput.instance) {
-		stringSize = g_exampleDatabase.binaryOutput.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance << " ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.binaryOutput.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t) stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_VALUE && objectInstance == g_exampleDatabase.binaryValue.instance) {
-		stringSize = g_exampleDatabase.binaryValue.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance << " ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.binaryValue.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t) stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_INPUT && objectInstance == g_exampleDatabase.multiStateInput.instance) {
-		stringSize = g_exampleDatabase.multiStateInput.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance << " ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.multiStateInput.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t) stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_OUTPUT && objectInstance == g_exampleDatabase.multiStateOutput.instance) {
-		stringSize = g_exampleDatabase.multiStateOutput.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance << " ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.multiStateOutput.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t) stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_VALUE && objectInstance == g_exampleDatabase.multiStateValue.instance) {
-		stringSize = g_exampleDatabase.multiStateValue.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance << " ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.multiStateValue.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t) stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_TREND_LOG && objectInstance == g_exampleDatabase.trendLog.instance) {
-		stringSize = g_exampleDatabase.trendLog.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance << " ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.trendLog.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t) stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_TREND_LOG_MULTIPLE && objectInstance == g_exampleDatabase.trendLogMultiple.instance) {
-	stringSize = g_exampleDatabase.trendLogMultiple.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance << "]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.trendLogMultiple.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t)stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_BITSTRING_VALUE && objectInstance == g_exampleDatabase.bitstringValue.instance) {
-		stringSize = g_exampleDatabase.bitstringValue.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance << " ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.bitstringValue.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t) stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_CHARACTERSTRING_VALUE && objectInstance == g_exampleDatabase.characterStringValue.instance) {
-		stringSize = g_exampleDatabase.characterStringValue.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance << " ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.characterStringValue.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t) stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DATE_VALUE && objectInstance == g_exampleDatabase.dateValue.instance) {
-		stringSize = g_exampleDatabase.dateValue.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance << " ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.dateValue.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t) stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_INTEGER_VALUE && objectInstance == g_exampleDatabase.integerValue.instance) {
-		stringSize = g_exampleDatabase.integerValue.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance <<" ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.integerValue.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t)stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_LARGE_ANALOG_VALUE && objectInstance == g_exampleDatabase.largeAnalogValue.instance) {
-		stringSize = g_exampleDatabase.largeAnalogValue.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance <<" ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.largeAnalogValue.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t) stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_OCTETSTRING_VALUE && objectInstance == g_exampleDatabase.octetStringValue.instance) {
-		stringSize = g_exampleDatabase.octetStringValue.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance <<" ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.octetStringValue.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t) stringSize;
-		return true;
+	std::string name;
+	if (objectType == 389 ) {
+		// Example of an object name that is not stored in the example database
+		name = "This is an example of the name";
 	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_POSITIVE_INTEGER_VALUE && objectInstance == g_exampleDatabase.positiveIntegerValue.instance) {
-		stringSize = g_exampleDatabase.positiveIntegerValue.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance <<" ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.positiveIntegerValue.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t) stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_TIME_VALUE && objectInstance == g_exampleDatabase.timeValue.instance) {
-		stringSize = g_exampleDatabase.timeValue.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance <<" ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.timeValue.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t) stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT && objectInstance == g_exampleDatabase.networkPort.instance) {
-		stringSize = g_exampleDatabase.networkPort.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance <<" ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.networkPort.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t) stringSize;
-		return true;
-	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DATETIME_VALUE && objectInstance == g_exampleDatabase.dateTimeValue.instance) {
-		stringSize = g_exampleDatabase.dateTimeValue.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance <<" ]" << std::endl;
+	else {
+		// Includes the Analog Values that were created with the CreateObject service
+		ExampleDatabaseBaseObject* object = g_exampleDatabase.FindObject(objectType, objectInstance);
+		if (object == NULL) {
 			return false;
 		}
-		memcpy(value, g_exampleDatabase.dateTimeValue.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t) stringSize;
-		return true;
+		name = object->objectName;
 	}
-	else if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && objectInstance == g_exampleDatabase.analogInputOutOfService.instance) {
-		stringSize = g_exampleDatabase.analogInputOutOfService.objectName.size();
-		if (stringSize > maxElementCount) {
-			std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance << " ]" << std::endl;
-			return false;
-		}
-		memcpy(value, g_exampleDatabase.analogInputOutOfService.objectName.c_str(), stringSize);
-		*valueElementCount = (uint32_t)stringSize;
-		return true;
-		}
-	else {
-		// Check if the value is an Analog Value and check if it was a created object
-		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE && g_exampleDatabase.CreatedAnalogValueData.count(objectInstance) > 0) {
-			std::string objectName = g_exampleDatabase.CreatedAnalogValueData[objectInstance].name;
-			memcpy(value, objectName.c_str(), objectName.size());
-			*valueElementCount = (uint32_t)objectName.size();
-			return true;
-		}
 
+	size_t stringSize = name.size();
+	if (stringSize > maxElementCount) {
+		std::cerr << "Error - not enough space to store full name of objectType=[" << objectType << "], objectInstance=[" << objectInstance << " ]" << std::endl;
 		return false;
 	}
+	memcpy(value, name.c_str(), stringSize);
+	*valueElementCount = (uint32_t)stringSize;
+	return true;
 }
 
 bool CallbackCreateObject(
@@ -2353,6 +3004,10 @@ bool CallbackCreateObject(
 	const uint16_t objectType,
 	const uint32_t objectInstance)
 {
+	if (deviceInstance != g_exampleDatabase.device.instance) {
+		return false; // Only the example device supports CreateObject and DeleteObject
+	}
+
 	// This callback is called when this BACnet Server device receives a CreateObject message
 	// In this callback, you can allocate memory to store properties that you would store
 	// For example, present-value and object name
@@ -2360,8 +3015,11 @@ bool CallbackCreateObject(
 	// In this example, we will only allow Analog-Values to be enabled
 	// See the SetupBACnetDeviceFunction on how this is handled
 	if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE) {
-		g_exampleDatabase.CreatedAnalogValueData.insert(std::pair<uint32_t, CreatedAnalogValue>(objectInstance, CreatedAnalogValue()));
-		g_exampleDatabase.CreatedAnalogValueData[objectInstance].name = std::string("AnalogValue_") + ChipkinCommon::ChipkinConvert::ToString(objectInstance);
+		CreatedAnalogValue& createdAnalogValue = g_exampleDatabase.CreatedAnalogValueData[objectInstance];
+		createdAnalogValue.instance = objectInstance;
+		createdAnalogValue.objectName = std::string("AnalogValue_") + ChipkinCommon::ChipkinConvert::ToString(objectInstance);
+		g_exampleDatabase.AddToObjectIndex(objectType, &createdAnalogValue);
+		g_exampleDatabase.LogPersistentWrite(objectType, objectInstance);
 		return true;
 	}
 	return false;
@@ -2372,13 +3030,19 @@ bool CallbackDeleteObject(
 	const uint16_t objectType,
 	const uint32_t objectInstance)
 {
+	if (deviceInstance != g_exampleDatabase.device.instance) {
+		return false; // Only the example device supports CreateObject and DeleteObject
+	}
+
 	// This callback is called when this BACnet Server device receives a DeleteObject message
 	// In this callbcak, you can clean up any memory that was allocated when the object was
 	// initially created.
 
 	if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE) {
-		if (g_exampleDatabase.CreatedAnalogValueData.count(objectInstance) > 0) {
+		if (g_exampleDatabase.FindCreatedAnalogValue(objectInstance) != NULL) {
+			g_exampleDatabase.RemoveFromObjectIndex(objectType, objectInstance);
 			g_exampleDatabase.CreatedAnalogValueData.erase(objectInstance);
+			g_exampleDatabase.LogPersistentWrite(objectType, objectInstance);
 			return true;
 		}
 	}
@@ -2407,10 +3071,14 @@ bool CallbackReinitializeDevice(const uint32_t deviceInstance, const uint32_t re
 		return false;
 	}
 
-	// In this example, only the NetworkPort Object FdBbmdAddress and FdSubscriptionLifetime properties are writable and need to be
-	// stored in non-volatile memory.  For the purpose of this example, we will not storing these values in non-volaitle memory.
+	// In this example, the NetworkPort Object FdBbmdAddress and FdSubscriptionLifetime properties are stored in non-volatile
+	// memory together with the other writable values, in the persistent image (see CASBACnetStackExamplePersistence.cpp).
 
 	// 1. Store values that must be stored in non-volatile memory (i.e. must survive a reboot).
+	if (g_exampleDatabase.persistentImage.IsOpen() && !g_exampleDatabase.SavePersistentImage()) {
+		*errorCode = CASBACnetStackExampleConstants::ERROR_INVALID_CONFIGURATION_DATA;
+		return false;
+	}
 
 	// 2. Apply any Network Port values that have been written to. 
 	// If any validation on the Network Port values failes, set errorCode to INVALID_CONFIGURATION_DATA (46)
@@ -2428,7 +3096,7 @@ bool CallbackReinitializeDevice(const uint32_t deviceInstance, const uint32_t re
 		// Flag for reboot and handle reboot after stack responds with SimpleAck.
 		g_warmStart = true;
 		g_exampleDatabase.networkPort.ChangesPending = false;
-		g_warmStartTimer = time(0);
+		g_warmStartTimer = g_exampleDatabase.clock.GetSystemTime();
 		return true;
 	}
 	else {
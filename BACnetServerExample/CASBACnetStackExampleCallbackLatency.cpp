@@ -0,0 +1,139 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleCallbackLatency.cpp
+ *
+ * See CASBACnetStackExampleCallbackLatency.h
+*/
+
+#include "CASBACnetStackExampleCallbackLatency.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+ExampleLatencyHistogram::ExampleLatencyHistogram(const uint32_t callback, const uint16_t objectType) {
+	this->callback = callback;
+	this->objectType = objectType;
+	this->count = 0;
+	this->sum = 0;
+	this->max = 0;
+	this->buckets.resize(BUCKET_COUNT, 0);
+}
+
+uint64_t ExampleLatencyHistogram::GetBucketHighest(const uint32_t bucket) {
+	if (bucket < SUB_BUCKET_COUNT) {
+		return bucket;
+	}
+	const uint32_t shift = (bucket >> SUB_BUCKET_BITS) - 1;
+	const uint64_t lowest = (uint64_t)(SUB_BUCKET_COUNT + (bucket & (SUB_BUCKET_COUNT - 1))) << shift;
+	return lowest + ((uint64_t)1 << shift) - 1;
+}
+
+uint64_t ExampleLatencyHistogram::GetPercentile(const double percentile) const {
+	if (this->count == 0) {
+		return 0;
+	}
+	uint64_t rank = (uint64_t)(percentile / 100.0 * (double)this->count + 0.5);
+	if (rank < 1) {
+		rank = 1;
+	}
+	uint64_t cumulative = 0;
+	for (uint32_t bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+		cumulative += this->buckets[bucket];
+		if (cumulative >= rank) {
+			const uint64_t highest = ExampleLatencyHistogram::GetBucketHighest(bucket);
+			return highest < this->max ? highest : this->max;
+		}
+	}
+	return this->max;
+}
+
+ExampleCallbackLatency::ExampleCallbackLatency() {
+	// The least of a few back to back reads, the cost of the counter without the interruptions
+	this->timerTicks = UINT64_MAX;
+	for (uint32_t offset = 0; offset < 1000; offset++) {
+		const uint64_t start = ExampleReadTicks();
+		const uint64_t ticks = ExampleReadTicks() - start;
+		if (ticks < this->timerTicks) {
+			this->timerTicks = ticks;
+		}
+	}
+	this->random = 0x9E3779B97F4A7C15ull;
+	this->SetSamplePeriod(DEFAULT_SAMPLE_PERIOD);
+	this->Reset();
+}
+
+void ExampleCallbackLatency::SetSamplePeriod(const uint32_t period) {
+	uint64_t rounded = 1;
+	while (rounded < period) {
+		rounded <<= 1;
+	}
+	this->sampleMask = rounded - 1;
+}
+
+void ExampleCallbackLatency::Reset() {
+	this->histograms.clear();
+	memset(this->index, 0, sizeof(this->index));
+	memset(this->callbackTicks, 0, sizeof(this->callbackTicks));
+	this->startTicks = ExampleReadTicks();
+	this->startTime = std::chrono::steady_clock::now();
+}
+
+double ExampleCallbackLatency::GetTickPeriod() const {
+	const double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - this->startTime).count();
+	const uint64_t ticks = ExampleReadTicks() - this->startTicks;
+	return ticks > 0 ? nanoseconds / (double)ticks : 1.0;
+}
+
+static double ExampleLatencyWithoutTimer(const double nanoseconds, const double timer) {
+	return nanoseconds > timer ? nanoseconds - timer : 0.0;
+}
+
+// Orders the histograms by the total time of the callback, the largest first
+struct ExampleCompareLatencySum {
+	const std::vector<ExampleLatencyHistogram>* histograms;
+
+	bool operator()(const size_t left, const size_t right) const {
+		return (*this->histograms)[left].GetSum() > (*this->histograms)[right].GetSum();
+	}
+};
+
+void ExampleCallbackLatency::Print(std::ostream& output) const {
+#if EXAMPLE_CALLBACK_TIMERS
+	const double period = this->GetTickPeriod();
+	const double timer = (double)this->timerTicks * period;
+	output << "FYI: Callback latency, histograms=[" << this->histograms.size() << "], samplePeriod=[" << this->GetSamplePeriod() << "], tick=[" << period << " ns], timer=[" << timer << " ns]" << std::endl;
+	char line[256];
+	// Total is estimated from the timed calls, the other columns are of the timed calls. The cost of the timer is taken off.
+	snprintf(line, sizeof(line), "  %-32s %6s %10s %10s %9s %9s %9s %9s %10s", "Callback", "Object", "Timed", "Total ms", "Mean ns", "p50 ns", "p99 ns", "p99.9 ns", "Max ns");
+	output << line << std::endl;
+
+	std::vector<size_t> order(this->histograms.size());
+	for (size_t offset = 0; offset < order.size(); offset++) {
+		order[offset] = offset;
+	}
+	ExampleCompareLatencySum compare;
+	compare.histograms = &this->histograms;
+	std::sort(order.begin(), order.end(), compare);
+
+	for (size_t offset = 0; offset < order.size(); offset++) {
+		const ExampleLatencyHistogram& histogram = this->histograms[order[offset]];
+		char objectType[16] = "-";
+		if (histogram.GetObjectType() == OBJECT_TYPE_SLOTS) {
+			snprintf(objectType, sizeof(objectType), ">=%u", OBJECT_TYPE_SLOTS);
+		}
+		else if (histogram.GetObjectType() != OBJECT_TYPE_NONE) {
+			snprintf(objectType, sizeof(objectType), "%u", histogram.GetObjectType());
+		}
+		const double mean = ExampleLatencyWithoutTimer((double)histogram.GetSum() * period / (double)histogram.GetCount(), timer);
+		snprintf(line, sizeof(line), "  %-32s %6s %10llu %10.3f %9.0f %9.0f %9.0f %9.0f %10.0f", ExampleServerMetrics::GetCallbackName(histogram.GetCallback()), objectType,
+			(unsigned long long)histogram.GetCount(), mean * (double)histogram.GetCount() * (double)this->GetSamplePeriod() / 1000000.0, mean,
+			ExampleLatencyWithoutTimer((double)histogram.GetPercentile(50.0) * period, timer), ExampleLatencyWithoutTimer((double)histogram.GetPercentile(99.0) * period, timer),
+			ExampleLatencyWithoutTimer((double)histogram.GetPercentile(99.9) * period, timer), ExampleLatencyWithoutTimer((double)histogram.GetMax() * period, timer));
+		output << line << std::endl;
+	}
+#else
+	output << "FYI: Callback latency timers are compiled out (EXAMPLE_CALLBACK_TIMERS=0)" << std::endl;
+#endif // EXAMPLE_CALLBACK_TIMERS
+}
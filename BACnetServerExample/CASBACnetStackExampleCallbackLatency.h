@@ -0,0 +1,240 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleCallbackLatency.h
+ *
+ * Latency of the callbacks registered with the stack, by callback and by
+ * object type, to find the slow property callbacks.
+ *
+ * ExampleScopedCallbackTimer reads a tick counter when it is created and
+ * when it goes out of scope, and records the difference. The tick counter
+ * is the TSC on x86 (not serialized, good to a few nanoseconds), otherwise
+ * CLOCK_MONOTONIC_RAW on Linux and steady_clock elsewhere. The ticks are
+ * converted to nanoseconds only when the histograms are printed, with the
+ * rate of the counter measured since the latency was created. This assumes
+ * an invariant TSC, as on all the x86 CPUs of the last decade.
+ *
+ * Reading the TSC costs 7 to 25 ns depending on the CPU and the hypervisor,
+ * so only one call in the sample period (DEFAULT_SAMPLE_PERIOD) is timed.
+ * It is picked at random so that a repeating pattern of calls, such as the
+ * properties of a ReadPropertyMultiple, is not always sampled at the same
+ * place. The other calls only cost a random number and a branch. The cost
+ * of the tick counter itself is measured when the latency is created and
+ * taken off the printed values.
+ *
+ * The histograms are HDR style, log-linear: each power of two is split in
+ * SUB_BUCKET_COUNT buckets, so a value is known to within 1/SUB_BUCKET_COUNT
+ * whatever its magnitude, from a few nanoseconds to minutes, in a fixed
+ * amount of memory. A histogram is created the first time a callback is
+ * called for an object type.
+ *
+ * Recorded by the main loop only, not thread safe.
+ *
+ * The timers are compiled out with EXAMPLE_CALLBACK_TIMERS=0, the callbacks
+ * then have no timing code at all.
+*/
+
+#ifndef __CASBACnetStackExampleCallbackLatency_h__
+#define __CASBACnetStackExampleCallbackLatency_h__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <chrono>
+#include <ostream>
+#include <vector>
+
+#include "CASBACnetStackExampleMetrics.h"
+
+#ifndef EXAMPLE_CALLBACK_TIMERS
+#define EXAMPLE_CALLBACK_TIMERS 1
+#endif // EXAMPLE_CALLBACK_TIMERS
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define EXAMPLE_TICKS_TSC
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define EXAMPLE_TICKS_TSC
+#elif defined(__linux__)
+#include <time.h>
+#endif
+
+inline uint64_t ExampleReadTicks() {
+#if defined(EXAMPLE_TICKS_TSC)
+	return __rdtsc();
+#elif defined(__linux__)
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+	return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+#else
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+class ExampleLatencyHistogram
+{
+	public:
+		static const uint32_t SUB_BUCKET_BITS = 4;
+		static const uint32_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS; // Values within 6.25%
+		static const uint32_t MAX_VALUE_BITS = 40; // Larger values are counted in the last bucket
+		static const uint32_t BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+		ExampleLatencyHistogram(const uint32_t callback, const uint16_t objectType);
+
+		void Record(const uint64_t value) {
+			this->buckets[ExampleLatencyHistogram::GetBucket(value)]++;
+			this->count++;
+			this->sum += value;
+			if (value > this->max) {
+				this->max = value;
+			}
+		}
+
+		// The values below SUB_BUCKET_COUNT have a bucket each, then SUB_BUCKET_COUNT buckets per power of two
+		static uint32_t GetBucket(const uint64_t value) {
+			if (value < SUB_BUCKET_COUNT) {
+				return (uint32_t)value;
+			}
+			if (value >= (uint64_t)1 << MAX_VALUE_BITS) {
+				return BUCKET_COUNT - 1;
+			}
+			const uint32_t shift = ExampleLatencyHistogram::GetHighestBit(value) - SUB_BUCKET_BITS;
+			return ((shift + 1) << SUB_BUCKET_BITS) + (uint32_t)((value >> shift) & (SUB_BUCKET_COUNT - 1));
+		}
+		// Highest value counted in the bucket
+		static uint64_t GetBucketHighest(const uint32_t bucket);
+
+		// Highest value of the bucket the percentile falls in, capped to the largest value recorded. percentile 0 to 100.
+		uint64_t GetPercentile(const double percentile) const;
+
+		uint32_t GetCallback() const {
+			return this->callback;
+		}
+		uint16_t GetObjectType() const {
+			return this->objectType;
+		}
+		uint64_t GetCount() const {
+			return this->count;
+		}
+		uint64_t GetSum() const {
+			return this->sum;
+		}
+		uint64_t GetMax() const {
+			return this->max;
+		}
+
+	private:
+		static uint32_t GetHighestBit(const uint64_t value) {
+#ifdef _MSC_VER
+			unsigned long bit;
+			_BitScanReverse64(&bit, value);
+			return (uint32_t)bit;
+#else
+			return 63 - (uint32_t)__builtin_clzll(value);
+#endif // _MSC_VER
+		}
+
+		uint32_t callback;
+		uint16_t objectType;
+		uint64_t count;
+		uint64_t sum;
+		uint64_t max;
+		std::vector<uint32_t> buckets;
+};
+
+class ExampleCallbackLatency
+{
+	public:
+		static const uint16_t OBJECT_TYPE_NONE = 0xFFFF; // The callbacks that are not about an object
+		static const uint16_t OBJECT_TYPE_SLOTS = 64; // Object types with their own histogram, the higher ones share one
+
+		static const uint32_t DEFAULT_SAMPLE_PERIOD = 8;
+
+		ExampleCallbackLatency();
+
+		// 1 times every call. Rounded up to a power of two.
+		void SetSamplePeriod(const uint32_t period);
+		uint32_t GetSamplePeriod() const {
+			return this->sampleMask + 1;
+		}
+		// True if the call is to be timed
+		bool Sample() {
+			// xorshift64
+			this->random ^= this->random << 13;
+			this->random ^= this->random >> 7;
+			this->random ^= this->random << 17;
+			return (this->random & this->sampleMask) == 0;
+		}
+
+		void Record(const uint32_t callback, const uint16_t objectType, const uint64_t ticks) {
+			const uint32_t slot = objectType == OBJECT_TYPE_NONE ? OBJECT_TYPE_SLOTS + 1 : objectType < OBJECT_TYPE_SLOTS ? objectType : OBJECT_TYPE_SLOTS;
+			uint16_t& index = this->index[callback][slot];
+			if (index == 0) {
+				this->histograms.push_back(ExampleLatencyHistogram(callback, slot == OBJECT_TYPE_SLOTS ? OBJECT_TYPE_SLOTS : objectType));
+				index = (uint16_t)this->histograms.size();
+			}
+			this->histograms[index - 1].Record(ticks);
+			this->callbackTicks[callback] += ticks > this->timerTicks ? ticks - this->timerTicks : 0;
+		}
+
+		// Nanoseconds per tick, measured since the latency was created or reset
+		double GetTickPeriod() const;
+		// Ticks measured by a timer around nothing
+		uint64_t GetTimerTicks() const {
+			return this->timerTicks;
+		}
+		// Ticks in the timed calls of the callback, all object types, without the cost of the timer
+		uint64_t GetCallbackTicks(const uint32_t callback) const {
+			return this->callbackTicks[callback];
+		}
+
+		// One line per callback and object type, the callbacks that took the most time in total first
+		void Print(std::ostream& output) const;
+		void Reset();
+
+	private:
+		std::vector<ExampleLatencyHistogram> histograms;
+		uint16_t index[ExampleServerMetrics::CALLBACK_COUNT][OBJECT_TYPE_SLOTS + 2]; // 1 + offset in histograms, 0 = none yet
+		uint64_t callbackTicks[ExampleServerMetrics::CALLBACK_COUNT];
+		uint64_t startTicks;
+		std::chrono::steady_clock::time_point startTime;
+		uint64_t timerTicks;
+		uint64_t random;
+		uint64_t sampleMask; // Sample period - 1
+};
+
+#if EXAMPLE_CALLBACK_TIMERS
+
+class ExampleScopedCallbackTimer
+{
+	public:
+		ExampleScopedCallbackTimer(ExampleCallbackLatency& latency, const uint32_t callback, const uint16_t objectType) : latency(latency) {
+			this->callback = callback;
+			this->objectType = objectType;
+			this->start = latency.Sample() ? ExampleReadTicks() : 0;
+		}
+		~ExampleScopedCallbackTimer() {
+			if (this->start != 0) {
+				this->latency.Record(this->callback, this->objectType, ExampleReadTicks() - this->start);
+			}
+		}
+
+	private:
+		ExampleCallbackLatency& latency;
+		uint32_t callback;
+		uint16_t objectType;
+		uint64_t start; // 0 = not sampled
+};
+
+#else // EXAMPLE_CALLBACK_TIMERS
+
+class ExampleScopedCallbackTimer
+{
+	public:
+		ExampleScopedCallbackTimer(ExampleCallbackLatency&, const uint32_t, const uint16_t) {
+		}
+};
+
+#endif // EXAMPLE_CALLBACK_TIMERS
+
+#endif // __CASBACnetStackExampleCallbackLatency_h__
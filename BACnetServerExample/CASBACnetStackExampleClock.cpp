@@ -0,0 +1,135 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleClock.cpp
+ *
+ * See CASBACnetStackExampleClock.h
+*/
+
+#include "CASBACnetStackExampleClock.h"
+
+#include <string.h>
+
+ExampleVirtualTimeSource::ExampleVirtualTimeSource(const double rate) {
+	this->realBase = std::chrono::steady_clock::now();
+	this->elapsedBase = 0;
+	this->wallBase = (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	this->rate = rate;
+}
+
+int64_t ExampleVirtualTimeSource::GetElapsed() {
+	const double real = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - this->realBase).count();
+	return this->elapsedBase + (int64_t)(real * this->rate);
+}
+
+void ExampleVirtualTimeSource::SetRate(const double rate) {
+	// The time reached so far is kept, the new rate applies from now on
+	this->elapsedBase = this->GetElapsed();
+	this->realBase = std::chrono::steady_clock::now();
+	this->rate = rate;
+}
+
+void ExampleVirtualTimeSource::Advance(const int64_t nanoseconds) {
+	this->elapsedBase += nanoseconds;
+}
+
+int64_t ExampleVirtualTimeSource::GetMonotonicTime() {
+	return this->GetElapsed();
+}
+
+int64_t ExampleVirtualTimeSource::GetWallTime() {
+	return this->wallBase + this->GetElapsed();
+}
+
+ExampleClock::ExampleClock() {
+	this->source = &this->systemSource;
+	this->offset = 0;
+	this->nanoseconds = 0;
+	this->systemTime = 0;
+	memset(&this->current, 0, sizeof(this->current));
+	this->Synchronize();
+}
+
+void ExampleClock::SetTimeSource(ExampleTimeSource* source) {
+	this->source = source != NULL ? source : &this->systemSource;
+	this->Synchronize();
+}
+
+void ExampleClock::Synchronize() {
+	this->monotonicBase = this->source->GetMonotonicTime();
+	this->wallBase = this->source->GetWallTime();
+	this->nanoseconds = this->wallBase;
+	this->Update(true);
+}
+
+void ExampleClock::Refresh() {
+	const int64_t elapsed = this->source->GetMonotonicTime() - this->monotonicBase;
+	if (elapsed >= ExampleClock::SYNCHRONIZE_INTERVAL * 1000000000LL) {
+		this->Synchronize();
+		return;
+	}
+	this->nanoseconds = this->wallBase + elapsed;
+	this->Update(false);
+}
+
+void ExampleClock::SetOffset(const int64_t offset) {
+	this->offset = offset;
+	this->Update(true);
+}
+
+// Days since 1970-01-01 of a date in the proleptic Gregorian calendar
+int64_t ExampleClock::GetDays(const int64_t year, const uint32_t month, const uint32_t day) {
+	const int64_t shiftedYear = month <= 2 ? year - 1 : year;
+	const int64_t era = (shiftedYear >= 0 ? shiftedYear : shiftedYear - 399) / 400;
+	const int64_t yearOfEra = shiftedYear - era * 400;
+	const int64_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+	const int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+	return era * 146097 + dayOfEra - 719468;
+}
+
+void ExampleClock::SetLocalTime(const uint8_t year, const uint8_t month, const uint8_t day, const uint8_t hour, const uint8_t minute, const uint8_t second) {
+	// Both sides are local times, their difference is the change of the offset. When the daylight savings
+	// state of the requested time is not the current one, the first step lands off by the DST shift and a
+	// second step corrects it.
+	const int64_t requested = ExampleClock::GetDays(1900 + (int64_t)year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+	for (uint32_t step = 0; step < 3; step++) {
+		const int64_t shown = ExampleClock::GetDays(1900 + (int64_t)this->current.year, this->current.month, this->current.day) * 86400 + this->current.hour * 3600 + this->current.minute * 60 + this->current.second;
+		if (shown == requested) {
+			break;
+		}
+		this->SetOffset(this->offset + shown - requested);
+	}
+}
+
+void ExampleClock::Update(const bool force) {
+	this->systemTime = (time_t)(this->nanoseconds >= 0 ? this->nanoseconds / 1000000000LL : (this->nanoseconds - 999999999LL) / 1000000000LL);
+	const int64_t adjusted = this->nanoseconds - this->offset * 1000000000LL;
+	const time_t seconds = (time_t)(adjusted >= 0 ? adjusted / 1000000000LL : (adjusted - 999999999LL) / 1000000000LL);
+	this->current.hundredthSeconds = (uint8_t)((adjusted - (int64_t)seconds * 1000000000LL) / 10000000LL);
+	if (!force && seconds == this->current.time) {
+		return;
+	}
+	this->current.time = seconds;
+
+	// Once per second
+	struct tm local;
+	struct tm utc;
+#ifdef _WIN32
+	localtime_s(&local, &seconds);
+	gmtime_s(&utc, &seconds);
+#else
+	localtime_r(&seconds, &local);
+	gmtime_r(&seconds, &utc);
+#endif // _WIN32
+	this->current.year = (uint8_t)local.tm_year;
+	this->current.month = (uint8_t)(local.tm_mon + 1);
+	this->current.day = (uint8_t)local.tm_mday;
+	this->current.weekday = (uint8_t)(local.tm_wday == 0 ? 7 : local.tm_wday);
+	this->current.hour = (uint8_t)local.tm_hour;
+	this->current.minute = (uint8_t)local.tm_min;
+	this->current.second = (uint8_t)local.tm_sec;
+	this->current.daylightSavings = local.tm_isdst > 0;
+	const int64_t localSeconds = ExampleClock::GetDays(1900 + (int64_t)local.tm_year, local.tm_mon + 1, local.tm_mday) * 86400 + local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec;
+	const int64_t utcSeconds = ExampleClock::GetDays(1900 + (int64_t)utc.tm_year, utc.tm_mon + 1, utc.tm_mday) * 86400 + utc.tm_hour * 3600 + utc.tm_min * 60 + utc.tm_sec;
+	this->current.utcOffset = (int)((utcSeconds - localSeconds) / 60);
+}
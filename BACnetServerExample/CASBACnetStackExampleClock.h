@@ -0,0 +1,146 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleClock.h
+ *
+ * Cached device clock for the time related callbacks (system time, Local
+ * Date, Local Time, Daylight Savings Status).
+ *
+ * Refresh is called once per tick. It advances the wall time from a
+ * monotonic base taken when the clock was last synchronized with the system
+ * clock, and applies the device time offset set by a client. The local time
+ * breakdown, the daylight savings flag and the UTC offset are only computed
+ * again when the second changes. The callbacks read the cached values, they
+ * never call time(), localtime() or mktime().
+ *
+ * The monotonic base is synchronized again with the system clock once a
+ * minute, so steps of the system clock (NTP, manual changes) are followed
+ * within a minute.
+ *
+ * Time sources
+ * The monotonic and wall time come from an ExampleTimeSource, the system
+ * clocks by default. ExampleVirtualTimeSource runs at any rate and can be
+ * advanced by hand, so that the COV lifetimes, trend log polling, foreign
+ * device registrations and the application timers (warm start, write-ahead
+ * log compaction) run faster than real time in a soak test. The time source
+ * is not thread safe, it is read by the main loop only.
+*/
+
+#ifndef __CASBACnetStackExampleClock_h__
+#define __CASBACnetStackExampleClock_h__
+
+#include <stdint.h>
+#include <time.h>
+#include <chrono>
+
+class ExampleTimeSource
+{
+	public:
+		virtual ~ExampleTimeSource() {
+		}
+		// Nanoseconds, only the difference between two calls is used
+		virtual int64_t GetMonotonicTime() = 0;
+		// Nanoseconds since the epoch
+		virtual int64_t GetWallTime() = 0;
+};
+
+class ExampleSystemTimeSource : public ExampleTimeSource
+{
+	public:
+		int64_t GetMonotonicTime() {
+			return (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+		int64_t GetWallTime() {
+			return (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		}
+};
+
+// Starts at the current system time and runs rate virtual seconds per real second
+class ExampleVirtualTimeSource : public ExampleTimeSource
+{
+	public:
+		explicit ExampleVirtualTimeSource(const double rate);
+
+		// 0 stops the time, it then only moves with Advance
+		void SetRate(const double rate);
+		double GetRate() const {
+			return this->rate;
+		}
+		void Advance(const int64_t nanoseconds);
+		// Virtual nanoseconds since the time source was created
+		int64_t GetElapsed();
+
+		int64_t GetMonotonicTime();
+		int64_t GetWallTime();
+
+	private:
+		std::chrono::steady_clock::time_point realBase;
+		int64_t elapsedBase; // Virtual nanoseconds at realBase
+		int64_t wallBase; // System time when the time source was created
+		double rate;
+};
+
+struct ExampleClockTime {
+	time_t time; // Seconds since the epoch, with the device time offset applied
+	uint8_t year; // Years since 1900
+	uint8_t month; // 1 = January
+	uint8_t day;
+	uint8_t weekday; // 1 = Monday, 7 = Sunday
+	uint8_t hour;
+	uint8_t minute;
+	uint8_t second;
+	uint8_t hundredthSeconds;
+	bool daylightSavings;
+	int utcOffset; // Minutes, in the sign convention of the BACnet UTC_Offset property (UTC = local time + utcOffset)
+};
+
+class ExampleClock
+{
+	public:
+		ExampleClock();
+
+		// The clock does not own the source. NULL = the system clocks.
+		void SetTimeSource(ExampleTimeSource* source);
+
+		// Once per tick
+		void Refresh();
+		// Reads the system clock again and takes a new monotonic base
+		void Synchronize();
+
+		const ExampleClockTime& Get() const {
+			return this->current;
+		}
+		time_t GetTime() const {
+			return this->current.time;
+		}
+		// Time of the time source without the device time offset, for the application timers
+		time_t GetSystemTime() const {
+			return this->systemTime;
+		}
+
+		// Seconds the device clock is behind the system clock. The cached time is updated straight away.
+		void SetOffset(const int64_t offset);
+		int64_t GetOffset() const {
+			return this->offset;
+		}
+		// Sets the offset so that the device clock shows the given local date and time (BACnet year, month
+		// and day). Replaces the mktime of the current time in the set system time callback.
+		void SetLocalTime(const uint8_t year, const uint8_t month, const uint8_t day, const uint8_t hour, const uint8_t minute, const uint8_t second);
+
+	private:
+		static const int64_t SYNCHRONIZE_INTERVAL = 60; // Seconds
+
+		void Update(const bool force);
+		static int64_t GetDays(const int64_t year, const uint32_t month, const uint32_t day);
+
+		ExampleSystemTimeSource systemSource;
+		ExampleTimeSource* source;
+		int64_t monotonicBase;
+		int64_t wallBase; // Nanoseconds since the epoch at monotonicBase
+		int64_t offset;
+		int64_t nanoseconds; // Of the last Refresh, without the offset
+		time_t systemTime;
+		ExampleClockTime current;
+};
+
+#endif // __CASBACnetStackExampleClock_h__
@@ -0,0 +1,250 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleCompiledProfile.cpp
+ *
+ * See CASBACnetStackExampleCompiledProfile.h
+*/
+
+#include "CASBACnetStackExampleCompiledProfile.h"
+
+#include <iostream>
+#include <stdio.h> // fopen(), rename()
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+ExampleCompiledProfile::ExampleCompiledProfile() {
+	this->memory = NULL;
+	this->size = 0;
+	this->records = NULL;
+	this->analogValues = NULL;
+	this->properties = NULL;
+	this->templateProperties = NULL;
+	this->templateInstances = NULL;
+	this->strings = NULL;
+}
+
+ExampleCompiledProfile::~ExampleCompiledProfile() {
+	this->Close();
+}
+
+bool ExampleCompiledProfile::IsCompiledProfile(const std::string& path) {
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == NULL) {
+		return false;
+	}
+	uint32_t magic = 0;
+	const bool result = fread(&magic, sizeof(magic), 1, file) == 1 && magic == ExampleCompiledProfileHeader::MAGIC;
+	fclose(file);
+	return result;
+}
+
+void ExampleCompiledProfile::Begin() {
+	this->pendingRecords.clear();
+	this->pendingAnalogValues.clear();
+	this->pendingProperties.clear();
+	this->pendingTemplateProperties.clear();
+	this->pendingTemplateInstances.clear();
+	this->pendingStrings.clear();
+}
+
+uint32_t ExampleCompiledProfile::AddString(const void* data, const uint32_t length) {
+	const uint32_t offset = (uint32_t)this->pendingStrings.size();
+	this->pendingStrings.insert(this->pendingStrings.end(), (const char*)data, (const char*)data + length);
+	return offset;
+}
+
+void ExampleCompiledProfile::AddValue(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint32_t arrayIndex, const uint16_t dataType, const uint64_t value) {
+	ExamplePersistentRecord record;
+	memset(&record, 0, sizeof(record));
+	record.objectType = objectType;
+	record.dataType = dataType;
+	record.objectInstance = objectInstance;
+	record.propertyIdentifier = propertyIdentifier;
+	record.arrayIndex = arrayIndex;
+	record.value = value;
+	this->pendingRecords.push_back(record);
+}
+
+void ExampleCompiledProfile::AddData(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint32_t arrayIndex, const uint16_t dataType, const void* data, const uint32_t length) {
+	this->AddValue(objectType, objectInstance, propertyIdentifier, arrayIndex, dataType, this->AddString(data, length));
+	this->pendingRecords.back().length = length;
+}
+
+void ExampleCompiledProfile::AddAnalogValue(const uint32_t instance, const std::string& name, const float value) {
+	ExampleCompiledAnalogValue analogValue;
+	analogValue.instance = instance;
+	analogValue.value = value;
+	analogValue.nameOffset = this->AddString(name.c_str(), (uint32_t)name.size());
+	analogValue.nameLength = (uint32_t)name.size();
+	this->pendingAnalogValues.push_back(analogValue);
+}
+
+void ExampleCompiledProfile::AddProperty(const ExampleProfileProperty& property) {
+	this->pendingProperties.push_back(property);
+}
+
+void ExampleCompiledProfile::AddTemplateProperty(const ExampleObjectTemplateProperty& property) {
+	this->pendingTemplateProperties.push_back(property);
+}
+
+void ExampleCompiledProfile::AddTemplateInstance(const ExampleObjectTemplateInstance& instance) {
+	this->pendingTemplateInstances.push_back(instance);
+}
+
+bool ExampleCompiledProfile::Commit(const std::string& path) {
+	// The sections are written one after the other, the checksum is accumulated over a copy of the body
+	const size_t recordsSize = this->pendingRecords.size() * sizeof(ExamplePersistentRecord);
+	const size_t analogValuesSize = this->pendingAnalogValues.size() * sizeof(ExampleCompiledAnalogValue);
+	const size_t propertiesSize = this->pendingProperties.size() * sizeof(ExampleProfileProperty);
+	const size_t templatePropertiesSize = this->pendingTemplateProperties.size() * sizeof(ExampleObjectTemplateProperty);
+	const size_t templateInstancesSize = this->pendingTemplateInstances.size() * sizeof(ExampleObjectTemplateInstance);
+	std::vector<uint8_t> body(recordsSize + analogValuesSize + propertiesSize + templatePropertiesSize + templateInstancesSize + this->pendingStrings.size());
+	size_t offset = 0;
+	if (recordsSize > 0) {
+		memcpy(&body[offset], &this->pendingRecords[0], recordsSize);
+		offset += recordsSize;
+	}
+	if (analogValuesSize > 0) {
+		memcpy(&body[offset], &this->pendingAnalogValues[0], analogValuesSize);
+		offset += analogValuesSize;
+	}
+	if (propertiesSize > 0) {
+		memcpy(&body[offset], &this->pendingProperties[0], propertiesSize);
+		offset += propertiesSize;
+	}
+	if (templatePropertiesSize > 0) {
+		memcpy(&body[offset], &this->pendingTemplateProperties[0], templatePropertiesSize);
+		offset += templatePropertiesSize;
+	}
+	if (templateInstancesSize > 0) {
+		memcpy(&body[offset], &this->pendingTemplateInstances[0], templateInstancesSize);
+		offset += templateInstancesSize;
+	}
+	if (!this->pendingStrings.empty()) {
+		memcpy(&body[offset], &this->pendingStrings[0], this->pendingStrings.size());
+	}
+
+	ExampleCompiledProfileHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = ExampleCompiledProfileHeader::MAGIC;
+	header.layoutVersion = ExampleCompiledProfileHeader::LAYOUT_VERSION;
+	header.recordCount = (uint32_t)this->pendingRecords.size();
+	header.analogValueCount = (uint32_t)this->pendingAnalogValues.size();
+	header.propertyCount = (uint32_t)this->pendingProperties.size();
+	header.templatePropertyCount = (uint32_t)this->pendingTemplateProperties.size();
+	header.templateInstanceCount = (uint32_t)this->pendingTemplateInstances.size();
+	header.stringSize = (uint32_t)this->pendingStrings.size();
+	header.checksum = ExamplePersistentImage::Checksum(body.empty() ? NULL : &body[0], body.size());
+
+	const std::string tempPath = path + ".tmp";
+	FILE* file = fopen(tempPath.c_str(), "wb");
+	if (file == NULL) {
+		std::cerr << "Error - Could not create the compiled profile. path=[" << tempPath << "]" << std::endl;
+		return false;
+	}
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	ok = ok && (body.empty() || fwrite(&body[0], body.size(), 1, file) == 1);
+	ok = fclose(file) == 0 && ok;
+	if (!ok || rename(tempPath.c_str(), path.c_str()) != 0) {
+		std::cerr << "Error - Could not write the compiled profile. path=[" << path << "]" << std::endl;
+		remove(tempPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+#ifndef _WIN32
+
+bool ExampleCompiledProfile::Open(const std::string& path) {
+	this->Close();
+
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		std::cerr << "Error - Could not open the compiled profile. path=[" << path << "]" << std::endl;
+		return false;
+	}
+	struct stat status;
+	if (fstat(fd, &status) != 0 || (size_t)status.st_size < sizeof(ExampleCompiledProfileHeader)) {
+		std::cerr << "Error - The compiled profile is too small. path=[" << path << "]" << std::endl;
+		close(fd);
+		return false;
+	}
+	// The mapping stays valid after the descriptor is closed
+	this->memory = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (this->memory == MAP_FAILED) {
+		this->memory = NULL;
+		std::cerr << "Error - Could not map the compiled profile. path=[" << path << "]" << std::endl;
+		return false;
+	}
+	this->size = (size_t)status.st_size;
+
+	const ExampleCompiledProfileHeader* header = this->GetHeader();
+	if (header->magic != ExampleCompiledProfileHeader::MAGIC || header->layoutVersion != ExampleCompiledProfileHeader::LAYOUT_VERSION) {
+		std::cerr << "Error - Not a compiled profile, or an unsupported layout. path=[" << path << "]" << std::endl;
+		this->Close();
+		return false;
+	}
+	const uint64_t bodySize = (uint64_t)header->recordCount * sizeof(ExamplePersistentRecord) + (uint64_t)header->analogValueCount * sizeof(ExampleCompiledAnalogValue) + (uint64_t)header->propertyCount * sizeof(ExampleProfileProperty) + (uint64_t)header->templatePropertyCount * sizeof(ExampleObjectTemplateProperty) + (uint64_t)header->templateInstanceCount * sizeof(ExampleObjectTemplateInstance) + header->stringSize;
+	if (sizeof(ExampleCompiledProfileHeader) + bodySize != this->size || header->checksum != ExamplePersistentImage::Checksum(header + 1, (size_t)bodySize)) {
+		std::cerr << "Error - The compiled profile is damaged. path=[" << path << "]" << std::endl;
+		this->Close();
+		return false;
+	}
+	this->records = (const ExamplePersistentRecord*)(header + 1);
+	this->analogValues = (const ExampleCompiledAnalogValue*)(this->records + header->recordCount);
+	this->properties = (const ExampleProfileProperty*)(this->analogValues + header->analogValueCount);
+	this->templateProperties = (const ExampleObjectTemplateProperty*)(this->properties + header->propertyCount);
+	this->templateInstances = (const ExampleObjectTemplateInstance*)(this->templateProperties + header->templatePropertyCount);
+	this->strings = (const char*)(this->templateInstances + header->templateInstanceCount);
+
+	// Bounds of the string data, checked once here so that the tables can be applied without checks
+	for (uint32_t offset = 0; offset < header->recordCount; offset++) {
+		if (this->records[offset].length > 0 && this->records[offset].value + this->records[offset].length > header->stringSize) {
+			std::cerr << "Error - The compiled profile has a record out of bounds. path=[" << path << "]" << std::endl;
+			this->Close();
+			return false;
+		}
+	}
+	for (uint32_t offset = 0; offset < header->analogValueCount; offset++) {
+		if ((uint64_t)this->analogValues[offset].nameOffset + this->analogValues[offset].nameLength > header->stringSize) {
+			std::cerr << "Error - The compiled profile has a name out of bounds. path=[" << path << "]" << std::endl;
+			this->Close();
+			return false;
+		}
+	}
+	return true;
+}
+
+void ExampleCompiledProfile::Close() {
+	if (this->memory != NULL) {
+		munmap(this->memory, this->size);
+	}
+	this->memory = NULL;
+	this->size = 0;
+	this->records = NULL;
+	this->analogValues = NULL;
+	this->properties = NULL;
+	this->templateProperties = NULL;
+	this->templateInstances = NULL;
+	this->strings = NULL;
+}
+
+#else // _WIN32
+
+bool ExampleCompiledProfile::Open(const std::string& path) {
+	std::cerr << "Error - Compiled profiles are only supported on POSIX systems" << std::endl;
+	return false;
+}
+
+void ExampleCompiledProfile::Close() {
+}
+
+#endif // _WIN32
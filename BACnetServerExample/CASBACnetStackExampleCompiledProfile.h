@@ -0,0 +1,179 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleCompiledProfile.h
+ *
+ * Compiled device profile. A JSON device profile (see
+ * CASBACnetStackExampleProfile.cpp) is compiled offline with
+ * --compile-profile into a binary image that is mapped at startup. The
+ * values, names, added objects and property flags are laid out as flat
+ * tables that are applied without any parsing or validation of text.
+ *
+ * File layout (layout version 2), all sections follow each other
+ *   ExampleCompiledProfileHeader
+ *   ExamplePersistentRecord[recordCount]                         Values, names and descriptions of the built in objects
+ *   ExampleCompiledAnalogValue[analogValueCount]                 Added Analog Values, in instance order
+ *   ExampleProfileProperty[propertyCount]                        Property flags for SetupDevice
+ *   ExampleObjectTemplateProperty[templatePropertyCount]         Properties of the object templates
+ *   ExampleObjectTemplateInstance[templateInstanceCount]         Objects instantiated from a template
+ *   stringSize bytes                                             String data of the records and the names
+ *
+ * The image is written with the byte order and layout of the machine that
+ * compiled it. It is only mapped on POSIX systems, on Windows use the JSON
+ * profile.
+*/
+
+#ifndef __CASBACnetStackExampleCompiledProfile_h__
+#define __CASBACnetStackExampleCompiledProfile_h__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "CASBACnetStackExamplePersistentImage.h"
+
+// Property flags from a device profile, applied by SetupDevice. Also the layout of the property table.
+struct ExampleProfileProperty {
+	static const uint16_t ENABLED = 1;
+	static const uint16_t WRITABLE = 2;
+	static const uint16_t SUBSCRIBABLE = 4;
+
+	uint16_t objectType;
+	uint16_t flags;
+	uint32_t objectInstance; // Not used for the device, SetupDevice uses the current device instance
+	uint32_t propertyIdentifier;
+};
+
+// Object templates
+// A template lists the properties that many objects share. The objects instantiated from it get them in
+// one pass in SetupDevice, see SetupObjectTemplates. Templates are stored as their flattened properties.
+struct ExampleObjectTemplateProperty {
+	static const uint16_t ENABLED = 1;
+	static const uint16_t WRITABLE = 2;
+	static const uint16_t SUBSCRIBABLE = 4;
+	static const uint16_t PROPRIETARY = 8; // Added with fpSetProprietaryProperty, dataType is used
+	static const uint16_t ARRAY = 16; // Proprietary array property
+
+	uint16_t templateIndex;
+	uint16_t flags;
+	uint32_t propertyIdentifier;
+	uint32_t dataType;
+};
+
+struct ExampleObjectTemplateInstance {
+	uint16_t objectType;
+	uint16_t templateIndex;
+	uint32_t objectInstance;
+};
+
+struct ExampleCompiledAnalogValue {
+	uint32_t instance;
+	float value;
+	uint32_t nameOffset; // In the string data
+	uint32_t nameLength;
+};
+
+struct ExampleCompiledProfileHeader {
+	static const uint32_t MAGIC = 0x50534143; // "CASP"
+	static const uint32_t LAYOUT_VERSION = 2;
+
+	uint32_t magic;
+	uint32_t layoutVersion;
+	uint32_t recordCount;
+	uint32_t analogValueCount;
+	uint32_t propertyCount;
+	uint32_t templatePropertyCount;
+	uint32_t templateInstanceCount;
+	uint32_t stringSize;
+	uint64_t checksum; // Of everything after the header
+};
+
+class ExampleCompiledProfile : public ExamplePersistentRecordWriter
+{
+	public:
+		ExampleCompiledProfile();
+		~ExampleCompiledProfile();
+
+		// Maps a compiled profile read only. Fails if the file is not one, or if any table or string is out of bounds.
+		bool Open(const std::string& path);
+		void Close();
+		// Checks the magic only, to tell a compiled profile from a JSON one
+		static bool IsCompiledProfile(const std::string& path);
+
+		uint32_t GetRecordCount() const {
+			return this->GetHeader()->recordCount;
+		}
+		const ExamplePersistentRecord& GetRecord(const uint32_t offset) const {
+			return this->records[offset];
+		}
+		// String data of a record, GetRecord(offset).length bytes
+		const uint8_t* GetData(const ExamplePersistentRecord& record) const {
+			return (const uint8_t*)this->strings + record.value;
+		}
+		uint32_t GetAnalogValueCount() const {
+			return this->GetHeader()->analogValueCount;
+		}
+		const ExampleCompiledAnalogValue& GetAnalogValue(const uint32_t offset) const {
+			return this->analogValues[offset];
+		}
+		const char* GetName(const ExampleCompiledAnalogValue& analogValue) const {
+			return this->strings + analogValue.nameOffset;
+		}
+		uint32_t GetPropertyCount() const {
+			return this->GetHeader()->propertyCount;
+		}
+		const ExampleProfileProperty* GetProperties() const {
+			return this->properties;
+		}
+		uint32_t GetTemplatePropertyCount() const {
+			return this->GetHeader()->templatePropertyCount;
+		}
+		const ExampleObjectTemplateProperty* GetTemplateProperties() const {
+			return this->templateProperties;
+		}
+		uint32_t GetTemplateInstanceCount() const {
+			return this->GetHeader()->templateInstanceCount;
+		}
+		const ExampleObjectTemplateInstance* GetTemplateInstances() const {
+			return this->templateInstances;
+		}
+
+		// Compiling. Begin clears the pending tables, Add* appends to them and Commit writes the image to a
+		// temporary file and renames it over path.
+		void Begin();
+		void AddValue(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint32_t arrayIndex, const uint16_t dataType, const uint64_t value);
+		void AddData(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint32_t arrayIndex, const uint16_t dataType, const void* data, const uint32_t length);
+		void AddAnalogValue(const uint32_t instance, const std::string& name, const float value);
+		void AddProperty(const ExampleProfileProperty& property);
+		void AddTemplateProperty(const ExampleObjectTemplateProperty& property);
+		void AddTemplateInstance(const ExampleObjectTemplateInstance& instance);
+		bool Commit(const std::string& path);
+
+	private:
+		ExampleCompiledProfile(const ExampleCompiledProfile&);
+		ExampleCompiledProfile& operator=(const ExampleCompiledProfile&);
+
+		const ExampleCompiledProfileHeader* GetHeader() const {
+			return (const ExampleCompiledProfileHeader*)this->memory;
+		}
+		uint32_t AddString(const void* data, const uint32_t length);
+
+		void* memory;
+		size_t size;
+		const ExamplePersistentRecord* records;
+		const ExampleCompiledAnalogValue* analogValues;
+		const ExampleProfileProperty* properties;
+		const ExampleObjectTemplateProperty* templateProperties;
+		const ExampleObjectTemplateInstance* templateInstances;
+		const char* strings;
+
+		std::vector<ExamplePersistentRecord> pendingRecords;
+		std::vector<ExampleCompiledAnalogValue> pendingAnalogValues;
+		std::vector<ExampleProfileProperty> pendingProperties;
+		std::vector<ExampleObjectTemplateProperty> pendingTemplateProperties;
+		std::vector<ExampleObjectTemplateInstance> pendingTemplateInstances;
+		std::vector<char> pendingStrings;
+};
+
+#endif // __CASBACnetStackExampleCompiledProfile_h__
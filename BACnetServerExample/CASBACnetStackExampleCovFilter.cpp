@@ -0,0 +1,132 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleCovFilter.cpp
+ *
+ * See CASBACnetStackExampleCovFilter.h
+*/
+
+#include "CASBACnetStackExampleCovFilter.h"
+
+#include <math.h>
+
+// AVX2 is compiled in with a function level target on GCC/Clang so the rest of the application
+// does not need -mavx2, and is only used if the CPU supports it.
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))) || (defined(_MSC_VER) && defined(_M_X64))
+#define EXAMPLE_COV_FILTER_AVX2
+#include <immintrin.h>
+#endif
+
+#ifdef EXAMPLE_COV_FILTER_AVX2
+#ifdef _MSC_VER
+#include <intrin.h>
+#define EXAMPLE_TARGET_AVX2
+#else
+#define EXAMPLE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif // _MSC_VER
+
+static bool ExampleCpuSupportsAVX2() {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+	__cpuid(info, 1);
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	const bool avx = (info[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx || (_xgetbv(0) & 0x06) != 0x06) {
+		return false; // The OS does not save the AVX registers
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#endif // _MSC_VER
+}
+#endif // EXAMPLE_COV_FILTER_AVX2
+
+ExampleCovFilter::ExampleCovFilter() {
+#ifdef EXAMPLE_COV_FILTER_AVX2
+	this->useAVX2 = ExampleCpuSupportsAVX2();
+#else
+	this->useAVX2 = false;
+#endif // EXAMPLE_COV_FILTER_AVX2
+}
+
+uint32_t ExampleCovFilter::AddPoint(const uint32_t dirtyPoint, const float initialValue, const float covIncrement) {
+	this->values.push_back(initialValue);
+	this->reported.push_back(initialValue);
+	this->increments.push_back(covIncrement);
+	this->dirtyPoints.push_back(dirtyPoint);
+	return (uint32_t)(this->values.size() - 1);
+}
+
+void ExampleCovFilter::Clear() {
+	this->values.clear();
+	this->reported.clear();
+	this->increments.clear();
+	this->dirtyPoints.clear();
+}
+
+void ExampleCovFilter::SetVectorized(const bool enable) {
+#ifdef EXAMPLE_COV_FILTER_AVX2
+	this->useAVX2 = enable && ExampleCpuSupportsAVX2();
+#else
+	this->useAVX2 = false;
+#endif // EXAMPLE_COV_FILTER_AVX2
+}
+
+uint32_t ExampleCovFilter::Scan(ExampleDirtyPointSet& dirtyPoints) {
+#ifdef EXAMPLE_COV_FILTER_AVX2
+	if (this->useAVX2) {
+		return this->ScanAVX2(dirtyPoints);
+	}
+#endif // EXAMPLE_COV_FILTER_AVX2
+	return this->ScanScalar(dirtyPoints, 0, (uint32_t)this->values.size());
+}
+
+uint32_t ExampleCovFilter::Report(ExampleDirtyPointSet& dirtyPoints, const uint32_t point) {
+	this->reported[point] = this->values[point];
+	dirtyPoints.MarkDirty(this->dirtyPoints[point]);
+	return 1;
+}
+
+// A point is reported if it changed and the change is at least the COV increment. A COV increment
+// of zero reports every change. NaN values never compare as a change.
+uint32_t ExampleCovFilter::ScanScalar(ExampleDirtyPointSet& dirtyPoints, const uint32_t begin, const uint32_t end) {
+	uint32_t count = 0;
+	for (uint32_t point = begin; point < end; point++) {
+		const float change = fabsf(this->values[point] - this->reported[point]);
+		if (change > 0.0f && change >= this->increments[point]) {
+			count += this->Report(dirtyPoints, point);
+		}
+	}
+	return count;
+}
+
+#ifdef EXAMPLE_COV_FILTER_AVX2
+EXAMPLE_TARGET_AVX2
+uint32_t ExampleCovFilter::ScanAVX2(ExampleDirtyPointSet& dirtyPoints) {
+	const uint32_t pointCount = (uint32_t)this->values.size();
+	const uint32_t vectorEnd = pointCount - (pointCount % 8);
+	const float* values = this->values.data();
+	const float* reported = this->reported.data();
+	const float* increments = this->increments.data();
+	const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+	const __m256 zero = _mm256_setzero_ps();
+
+	uint32_t count = 0;
+	for (uint32_t point = 0; point < vectorEnd; point += 8) {
+		const __m256 change = _mm256_and_ps(_mm256_sub_ps(_mm256_loadu_ps(values + point), _mm256_loadu_ps(reported + point)), absMask);
+		const __m256 crossed = _mm256_and_ps(_mm256_cmp_ps(change, zero, _CMP_GT_OQ), _mm256_cmp_ps(change, _mm256_loadu_ps(increments + point), _CMP_GE_OQ));
+		uint32_t mask = (uint32_t)_mm256_movemask_ps(crossed);
+		while (mask != 0) {
+			count += this->Report(dirtyPoints, point + ExampleCountTrailingZeros64(mask));
+			mask &= mask - 1;
+		}
+	}
+	return count + this->ScanScalar(dirtyPoints, vectorEnd, pointCount);
+}
+#endif // EXAMPLE_COV_FILTER_AVX2
@@ -0,0 +1,72 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleCovFilter.h
+ *
+ * Application side COV (change of value) increment filter for analog points.
+ *
+ * The stack can only decide if a COV notification is needed after it has been
+ * told that a value changed with fpValueUpdated. With many analog points
+ * changing by small amounts most of those calls end with no notification.
+ * This filter keeps the last value reported to the stack for each point and
+ * only marks a point dirty when the current value has moved by at least the
+ * COV increment since then.
+ *
+ * The values are kept in flat arrays (current, last reported, increment) so
+ * Scan can compare eight points at a time with AVX2 when the CPU supports it.
+ * Otherwise a scalar loop is used. Both give the same result.
+*/
+
+#ifndef __CASBACnetStackExampleCovFilter_h__
+#define __CASBACnetStackExampleCovFilter_h__
+
+#include <stdint.h>
+#include <vector>
+
+#include "CASBACnetStackExampleDirtyPointSet.h"
+
+class ExampleCovFilter
+{
+	public:
+		ExampleCovFilter();
+
+		// Adds a point and returns its index in the filter. dirtyPoint is the handle of the point in
+		// the ExampleDirtyPointSet that Scan marks. The initial value counts as reported.
+		uint32_t AddPoint(const uint32_t dirtyPoint, const float initialValue, const float covIncrement);
+		void Clear();
+
+		// SetValue and Scan must be called from the same thread.
+		void SetValue(const uint32_t point, const float value) {
+			this->values[point] = value;
+		}
+		void SetIncrement(const uint32_t point, const float covIncrement) {
+			this->increments[point] = covIncrement;
+		}
+		uint32_t GetPointCount() const {
+			return (uint32_t)this->values.size();
+		}
+
+		// Marks the points whose value moved by at least their COV increment since they were last
+		// reported, and takes the current value as the new reported value. Returns the number of
+		// points marked.
+		uint32_t Scan(ExampleDirtyPointSet& dirtyPoints);
+
+		// Can be used to force the scalar loop, for testing and benchmarks.
+		bool IsVectorized() const {
+			return this->useAVX2;
+		}
+		void SetVectorized(const bool enable);
+
+	private:
+		std::vector<float> values;
+		std::vector<float> reported;
+		std::vector<float> increments;
+		std::vector<uint32_t> dirtyPoints;
+		bool useAVX2;
+
+		uint32_t ScanScalar(ExampleDirtyPointSet& dirtyPoints, const uint32_t begin, const uint32_t end);
+		uint32_t ScanAVX2(ExampleDirtyPointSet& dirtyPoints);
+		uint32_t Report(ExampleDirtyPointSet& dirtyPoints, const uint32_t point);
+};
+
+#endif // __CASBACnetStackExampleCovFilter_h__
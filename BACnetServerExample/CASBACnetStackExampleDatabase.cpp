@@ -9,8 +9,12 @@
 */
 
 #include "CASBACnetStackExampleDatabase.h"
+#include "CASBACnetStackExampleConstants.h"
+#include "CASBACnetStackExampleStartupTrace.h"
 
 #include <time.h> // time()
+#include <algorithm> // std::fill
+#include <iostream>
 #ifdef _WIN32 
 #include <winsock2.h>
 #include <iphlpapi.h>
@@ -20,20 +24,89 @@
 #define FREE(x) HeapFree(GetProcessHeap(), 0, (x))
 #endif // _WIN32 
 
+// Lookup table that expands one byte of a packed bitstring into eight bools (one per byte, 0 or 1).
+// Bit 0 of the index ends up in the lowest addressed byte.
+static const uint64_t* GetBitstringUnpackTable() {
+	static uint64_t table[256];
+	static bool loaded = false;
+	if (!loaded) {
+		for (uint32_t index = 0; index < 256; index++) {
+			uint8_t bytes[8];
+			for (uint32_t bit = 0; bit < 8; bit++) {
+				bytes[bit] = (index >> bit) & 0x01;
+			}
+			memcpy(&table[index], bytes, sizeof(uint64_t));
+		}
+		loaded = true;
+	}
+	return table;
+}
+
 bool ExampleDatabaseBitstringValue::Resize( size_t count)  {
-	this->presentValue.resize(count);
+	this->presentValueWords.resize((count + 63) / 64, 0);
+	this->presentValueLength = (uint32_t)count;
+	if (count % 64 != 0) {
+		// Clear any bits past the new length so they don't come back if the bitstring grows again.
+		this->presentValueWords.back() &= (((uint64_t)1) << (count % 64)) - 1;
+	}
 	this->bitText.resize(count);
-	return false; 
+	return false;
 }
 bool ExampleDatabaseBitstringValue::SetPresentValue(size_t offset, bool value) {
-	if( this->presentValue.size() < offset ) {
-		return false; 
+	if( this->presentValueLength <= offset ) {
+		return false;
+	}
+	const uint64_t mask = ((uint64_t)1) << (offset % 64);
+	if (value) {
+		this->presentValueWords[offset / 64] |= mask;
+	}
+	else {
+		this->presentValueWords[offset / 64] &= ~mask;
+	}
+	return true ;
+}
+bool ExampleDatabaseBitstringValue::GetPresentValue(size_t offset) const {
+	if (this->presentValueLength <= offset) {
+		return false;
+	}
+	return ((this->presentValueWords[offset / 64] >> (offset % 64)) & 0x01) != 0;
+}
+uint32_t ExampleDatabaseBitstringValue::UnpackPresentValue(bool* value, uint32_t maxElementCount) const {
+	if (this->presentValueLength > maxElementCount) {
+		return 0;
+	}
+
+	// Expand eight bits at a time with the lookup table. The trailing partial byte is handled one bit at a time.
+	const uint64_t* table = GetBitstringUnpackTable();
+	const uint32_t wholeBytes = this->presentValueLength / 8;
+	for (uint32_t byteOffset = 0; byteOffset < wholeBytes; byteOffset++) {
+		const uint8_t packed = (uint8_t)(this->presentValueWords[byteOffset / 8] >> ((byteOffset % 8) * 8));
+		memcpy(value + byteOffset * 8, &table[packed], sizeof(uint64_t));
+	}
+	for (uint32_t offset = wholeBytes * 8; offset < this->presentValueLength; offset++) {
+		value[offset] = this->GetPresentValue(offset);
+	}
+	return this->presentValueLength;
+}
+void ExampleDatabaseBitstringValue::PackPresentValue(const bool* value, uint32_t length) {
+	this->Resize(length);
+	std::fill(this->presentValueWords.begin(), this->presentValueWords.end(), 0);
+
+	// Gather eight bools at a time. Each bool is a byte with the value 0 or 1, the multiply moves
+	// the low bit of each byte into the top byte of the result.
+	const uint32_t wholeBytes = length / 8;
+	for (uint32_t byteOffset = 0; byteOffset < wholeBytes; byteOffset++) {
+		uint64_t bytes;
+		memcpy(&bytes, value + byteOffset * 8, sizeof(uint64_t));
+		const uint64_t packed = ((bytes & 0x0101010101010101ULL) * 0x0102040810204080ULL) >> 56;
+		this->presentValueWords[byteOffset / 8] |= packed << ((byteOffset % 8) * 8);
+	}
+	for (uint32_t offset = wholeBytes * 8; offset < length; offset++) {
+		this->SetPresentValue(offset, value[offset]);
 	}
-	this->presentValue[offset] = value ;
-	return true ;  
 }
 bool ExampleDatabaseBitstringValue::SetBitText(size_t offset, std::string bitText) {
-	if( this->bitText.size() < offset ) {
+	if( this->bitText.size() <= offset ) {
 		return false; 
 	}
 	this->bitText[offset] = bitText ; 
@@ -54,6 +127,20 @@ void ExampleDatabaseTimeValue::Set( uint8_t hour, uint8_t minute, uint8_t second
 }
 
 ExampleDatabase::ExampleDatabase() {
+	this->objectLookup = ExampleDatabase::OBJECT_LOOKUP_CURSOR;
+	// The input points are stored in the snapshot, attach them before Setup gives them a value
+	this->analogInput.presentValue.Attach(&this->snapshot, 0.0f);
+	this->analogInput.reliability.Attach(&this->snapshot, 0);
+	this->binaryInput.presentValue.Attach(&this->snapshot, false);
+	this->multiStateInput.presentValue.Attach(&this->snapshot, 1);
+	this->persistentImageChanged = false;
+	this->persistentImageSaveTime = 0;
+	this->writeAheadLogCommitWindow = 0;
+	this->writeAheadLogReplayCount = 0;
+	this->persistentCheckpointInBackground = true;
+	memset(&this->persistentCheckpointStats, 0, sizeof(this->persistentCheckpointStats));
+	this->persistentCheckpointProcess = 0;
+	this->persistentCheckpointLogSize = 0;
 	this->Setup();
 }
 
@@ -73,11 +160,13 @@ const std::string ExampleDatabase::GetColorName() {
 }
 
 void ExampleDatabase::Setup() {
+	ExampleStartupTrace& trace = ExampleStartupTrace::Get();
+	trace.Begin("ExampleDatabase::Setup");
 
 	this->device.instance = 389999;
 	this->device.objectName = "Device Rainbow";
 	this->device.UTCOffset = 0;
-	this->device.currentTimeOffset = 0;
+	this->clock.SetOffset(0);
 	this->device.description = "Chipkin test BACnet IP Server device";
 	// BACnetDeviceStatus ::= ENUMERATED { operational (0), operational-read-only (1), download-required (2), 
 	// download-in-progress (3), non-operational (4), backup-in-progress (5) } 
@@ -182,14 +271,16 @@ void ExampleDatabase::Setup() {
 	this->networkPort.FdSubscriptionLifetime = 3600;
 	this->dateTimeValue.instance = 60;
 	this->dateTimeValue.objectName = "DateTimeValue " + ExampleDatabase::GetColorName();
-	this->dateTimeValue.presentValueYear = 122;
-	this->dateTimeValue.presentValueMonth = 1;
-	this->dateTimeValue.presentValueDay = 28;
-	this->dateTimeValue.presentValueWeekDay = 5;
-	this->dateTimeValue.presentValueHour = 16;
-	this->dateTimeValue.presentValueMinute = 53;
-	this->dateTimeValue.presentValueSecond = 47;
-	this->dateTimeValue.presentValueHundredthSeconds = 55;	
+	ExampleDateTime dateTime;
+	dateTime.year = 122;
+	dateTime.month = 1;
+	dateTime.day = 28;
+	dateTime.weekDay = 5;
+	dateTime.hour = 16;
+	dateTime.minute = 53;
+	dateTime.second = 47;
+	dateTime.hundredthSeconds = 55;
+	this->dateTimeValue.presentValue.Write(dateTime);
 	this->analogInputOutOfService.instance = 100;
 	this->analogInputOutOfService.objectName = "AnalogInput OutOfService " + ExampleDatabase::GetColorName();
 	this->analogInputOutOfService.description = "Example of using out of service functionality";
@@ -199,7 +290,165 @@ void ExampleDatabase::Setup() {
 	this->analogInputOutOfService.reliability = 0;
 	this->analogInputOutOfService.tempReliability = 0;
 	this->analogInputOutOfService.outOfService = false;
+	trace.Begin("LoadNetworkPortProperties");
 	this->LoadNetworkPortProperties() ; 
+	trace.End();
+	this->snapshot.Publish();
+	this->RebuildObjectIndex();
+	this->LoadStringTable();
+	this->RegisterDirtyPoints();
+	trace.End();
+}
+
+void ExampleDatabase::RegisterDirtyPoints() {
+	this->dirtyPoints.Clear();
+	this->covFilter.Clear();
+	this->analogInput.presentValuePoint = this->dirtyPoints.AddPoint(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, this->analogInput.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE);
+	this->analogInput.reliabilityPoint = this->dirtyPoints.AddPoint(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, this->analogInput.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELIABILITY);
+	this->analogInput.presentValueCovFilterPoint = this->covFilter.AddPoint(this->analogInput.presentValuePoint, this->analogInput.presentValue, this->analogInput.covIncrement);
+	this->analogValue.presentValuePoint = this->dirtyPoints.AddPoint(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE, this->analogValue.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE);
+	this->binaryInput.presentValuePoint = this->dirtyPoints.AddPoint(CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_INPUT, this->binaryInput.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE);
+	this->multiStateInput.presentValuePoint = this->dirtyPoints.AddPoint(CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_INPUT, this->multiStateInput.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE);
+}
+
+void ExampleDatabase::LoadStringTable() {
+	this->strings.Clear();
+
+	this->device.applicationSoftwareVersionString = this->strings.Add(this->device.applicationSoftwareVersion);
+
+	std::vector<std::string> proprietaryCharacterStrings;
+	proprietaryCharacterStrings.push_back("Example custom property 512 + 1");
+	proprietaryCharacterStrings.push_back("Example custom property 512 + 2");
+	proprietaryCharacterStrings.push_back("Example custom property 512 + 3");
+	this->analogInput.proprietaryCharacterStrings = this->strings.AddArray(proprietaryCharacterStrings);
+
+	this->multiStateInput.stateTextStrings = this->strings.AddArray(this->multiStateInput.stateText);
+	this->multiStateOutput.stateTextStrings = this->strings.AddArray(this->multiStateOutput.stateText);
+	this->multiStateValue.stateTextStrings = this->strings.AddArray(this->multiStateValue.stateText);
+	this->bitstringValue.bitTextStrings = this->strings.AddArray(this->bitstringValue.bitText);
+}
+
+bool ExampleDatabase::SetBitText(size_t offset, const std::string& bitText) {
+	if (!this->bitstringValue.SetBitText(offset, bitText)) {
+		return false;
+	}
+	this->strings.Set(this->bitstringValue.bitTextStrings + (uint32_t)offset, bitText);
+	return true;
+}
+
+void ExampleDatabase::SetApplicationSoftwareVersion(const std::string& version) {
+	this->device.applicationSoftwareVersion = version;
+	this->strings.Set(this->device.applicationSoftwareVersionString, version);
+}
+
+void ExampleDatabase::RebuildObjectIndex() {
+	this->objectIndex.clear();
+	this->objectIndex.reserve(this->CreatedAnalogValueData.size() + 32);
+
+	// The device is not in the index, its instance can be changed at runtime. See FindObject.
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, &this->analogInput);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, &this->analogInputOutOfService);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_OUTPUT, &this->analogOutput);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE, &this->analogValue);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_INPUT, &this->binaryInput);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_OUTPUT, &this->binaryOutput);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_VALUE, &this->binaryValue);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_INPUT, &this->multiStateInput);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_OUTPUT, &this->multiStateOutput);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_VALUE, &this->multiStateValue);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_TREND_LOG, &this->trendLog);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_TREND_LOG_MULTIPLE, &this->trendLogMultiple);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_BITSTRING_VALUE, &this->bitstringValue);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_CHARACTERSTRING_VALUE, &this->characterStringValue);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_DATE_VALUE, &this->dateValue);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_INTEGER_VALUE, &this->integerValue);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_LARGE_ANALOG_VALUE, &this->largeAnalogValue);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_OCTETSTRING_VALUE, &this->octetStringValue);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_POSITIVE_INTEGER_VALUE, &this->positiveIntegerValue);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_TIME_VALUE, &this->timeValue);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT, &this->networkPort);
+	this->AddToObjectIndex(CASBACnetStackExampleConstants::OBJECT_TYPE_DATETIME_VALUE, &this->dateTimeValue);
+	// There can be a large number of created objects (restored from the persistent image), they are added
+	// directly and the cache is invalidated once.
+	for (std::map<uint32_t, CreatedAnalogValue>::iterator itr = this->CreatedAnalogValueData.begin(); itr != this->CreatedAnalogValueData.end(); itr++) {
+		this->objectIndex[ExampleDatabase::GetObjectIdentifier(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE, itr->first)] = &itr->second;
+	}
+	this->InvalidateObjectCache();
+}
+
+uint32_t ExampleDatabase::GetObjectCount(const uint16_t objectType) const {
+	uint32_t count = 0;
+	for (std::unordered_map<uint32_t, ExampleDatabaseBaseObject*>::const_iterator itr = this->objectIndex.begin(); itr != this->objectIndex.end(); itr++) {
+		if ((itr->first >> 22) == objectType) {
+			count++;
+		}
+	}
+	return count;
+}
+
+void ExampleDatabase::AddToObjectIndex(const uint16_t objectType, ExampleDatabaseBaseObject* object) {
+	this->objectIndex[ExampleDatabase::GetObjectIdentifier(objectType, object->instance)] = object;
+	this->InvalidateObjectCache();
+}
+
+void ExampleDatabase::RemoveFromObjectIndex(const uint16_t objectType, const uint32_t objectInstance) {
+	this->objectIndex.erase(ExampleDatabase::GetObjectIdentifier(objectType, objectInstance));
+	this->InvalidateObjectCache();
+}
+
+void ExampleDatabase::InvalidateObjectCache() {
+	this->objectCursor.objectIdentifier = ExampleDatabase::INVALID_OBJECT_IDENTIFIER;
+	this->objectCursor.object = NULL;
+	for (uint32_t offset = 0; offset < ExampleDatabase::OBJECT_CACHE_SIZE; offset++) {
+		this->objectCache[offset].objectIdentifier = ExampleDatabase::INVALID_OBJECT_IDENTIFIER;
+		this->objectCache[offset].object = NULL;
+	}
+}
+
+ExampleDatabaseBaseObject* ExampleDatabase::FindObject(const uint16_t objectType, const uint32_t objectInstance) {
+	if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE) {
+		return objectInstance == this->device.instance ? &this->device : NULL;
+	}
+
+	// 1. Same object as the last call. The cursor is never set with the other lookups.
+	const uint32_t objectIdentifier = ExampleDatabase::GetObjectIdentifier(objectType, objectInstance);
+	if (this->objectCursor.objectIdentifier == objectIdentifier) {
+		return this->objectCursor.object;
+	}
+	if (this->objectLookup == ExampleDatabase::OBJECT_LOOKUP_INDEX) {
+		std::unordered_map<uint32_t, ExampleDatabaseBaseObject*>::const_iterator itr = this->objectIndex.find(objectIdentifier);
+		return itr == this->objectIndex.end() ? NULL : itr->second;
+	}
+
+	// 2. Recently used objects. Objects that don't exist are cached as NULL as well.
+	ObjectCacheEntry& entry = this->objectCache[(objectIdentifier * 2654435761u) >> (32 - ExampleDatabase::OBJECT_CACHE_BITS)];
+	if (entry.objectIdentifier != objectIdentifier) {
+		// 3. Object index
+		std::unordered_map<uint32_t, ExampleDatabaseBaseObject*>::const_iterator itr = this->objectIndex.find(objectIdentifier);
+		entry.objectIdentifier = objectIdentifier;
+		entry.object = itr == this->objectIndex.end() ? NULL : itr->second;
+	}
+	if (this->objectLookup == ExampleDatabase::OBJECT_LOOKUP_CURSOR) {
+		this->objectCursor = entry;
+	}
+	return entry.object;
+}
+
+void ExampleDatabase::SetObjectLookup(const ObjectLookup lookup) {
+	this->objectLookup = lookup;
+	this->InvalidateObjectCache();
+}
+
+CreatedAnalogValue* ExampleDatabase::FindCreatedAnalogValue(const uint32_t objectInstance) {
+	return this->AsCreatedAnalogValue(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE, this->FindObject(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE, objectInstance));
+}
+
+CreatedAnalogValue* ExampleDatabase::AsCreatedAnalogValue(const uint16_t objectType, ExampleDatabaseBaseObject* object) {
+	// The analog values other than the one in the database are the ones created with CreateObject
+	if (objectType != CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE || object == NULL || object == &this->analogValue) {
+		return NULL;
+	}
+	return static_cast<CreatedAnalogValue*>(object);
 }
 
 void ExampleDatabase::LoadNetworkPortProperties() {
@@ -319,22 +568,163 @@ void ExampleDatabase::LoadNetworkPortProperties() {
 		FREE(pAddresses);
 	}
 
+#else
+	// The cached interface of the monitor, the interfaces are only queried the first time
+	if (this->networkMonitor.Open()) {
+		this->ApplyNetworkInterface(this->networkMonitor.GetInterface());
+	}
 #endif // _WIN32 
 }
 
+void ExampleDatabase::ApplyNetworkInterface(const ExampleNetworkInterface& networkInterface) {
+	memcpy(this->networkPort.IPAddress, networkInterface.IPAddress, 4);
+	this->networkPort.IPAddressLength = 4;
+	memcpy(this->networkPort.IPSubnetMask, networkInterface.IPSubnetMask, 4);
+	this->networkPort.IPSubnetMaskLength = 4;
+	memcpy(this->networkPort.IPDefaultGateway, networkInterface.IPDefaultGateway, 4);
+	this->networkPort.IPDefaultGatewayLength = 4;
+	memcpy(this->networkPort.BroadcastIPAddress, networkInterface.BroadcastIPAddress, 4);
+
+	for (size_t offset = 0; offset < this->networkPort.IPDNSServers.size(); offset++) {
+		delete[] this->networkPort.IPDNSServers[offset];
+	}
+	this->networkPort.IPDNSServers.clear();
+	for (uint8_t offset = 0; offset < networkInterface.IPDNSServerCount; offset++) {
+		uint8_t* dns = new uint8_t[4];
+		memcpy(dns, networkInterface.IPDNSServers[offset], 4);
+		this->networkPort.IPDNSServers.push_back(dns);
+	}
+	this->networkPort.IPDNSServerLength = 4;
+}
+
 
 void ExampleDatabase::Loop() {
 
-	time_t currentTime = time(0); 
+	time_t currentTime = this->clock.GetSystemTime();
+
+	// The simulated input values. The points in the shared memory segment are written by the acquisition
+	// processes instead, see CreateSharedPoints.
+	const bool simulateInputs = !this->sharedPoints.IsOpen();
 
 	static time_t updateOnceASecondTimer = 0; 
 	if (updateOnceASecondTimer + 1 <= currentTime) {
 		updateOnceASecondTimer = currentTime;
 
-		this->analogInput.presentValue += 1.001f;
+		if (simulateInputs) {
+			const float analogInputValue = (this->analogInput.presentValue += 1.001f);
+			this->covFilter.SetValue(this->analogInput.presentValueCovFilterPoint, analogInputValue);
+		}
+
+		// Address changes queued by the kernel since the last second
+		if (this->networkMonitor.Poll()) {
+			const ExampleNetworkInterface& networkInterface = this->networkMonitor.GetInterface();
+			this->ApplyNetworkInterface(networkInterface);
+			std::cout << "FYI: Network port address changed. interface=[" << networkInterface.name << "], IPAddress=[" << (int)networkInterface.IPAddress[0] << "." << (int)networkInterface.IPAddress[1] << "." << (int)networkInterface.IPAddress[2] << "." << (int)networkInterface.IPAddress[3] << "/" << (int)networkInterface.IPSubnetMask[0] << "." << (int)networkInterface.IPSubnetMask[1] << "." << (int)networkInterface.IPSubnetMask[2] << "." << (int)networkInterface.IPSubnetMask[3] << "]" << std::endl;
+		}
+	}
+
+	const bool binaryInputValue = (currentTime % 2 == 1);
+	if (simulateInputs && this->binaryInput.presentValue.GetLatest() != binaryInputValue) {
+		this->binaryInput.presentValue = binaryInputValue;
+		this->dirtyPoints.MarkDirty(this->binaryInput.presentValuePoint);
 	}
 
-	this->binaryInput.presentValue = (currentTime % 2 == 1);
+	// Values written by external acquisition processes
+	this->LoadSharedPoints();
+
+	// Commit the values written since the last tick
+	this->CommitPersistentWrites();
+
+	// End of the acquisition cycle, make the new input values visible to the stack as one snapshot
+	this->snapshot.Publish();
+
+	// Mark the analog points that moved by at least their COV increment
+	this->covFilter.Scan(this->dirtyPoints);
+}
+
+bool ExampleDatabase::CreateSharedPoints(const std::string& name, const bool replace) {
+	this->sharedPointBindings.clear();
+	if (!this->sharedPoints.Create(name, 64, replace)) {
+		return false;
+	}
+
+	SharedPointBinding binding = { NULL, NULL, NULL, ExampleDirtyPointSet::INVALID_POINT, ExampleDirtyPointSet::INVALID_POINT, 0 };
+	SharedPointBinding analogInputPresentValue = binding;
+	analogInputPresentValue.real = &this->analogInput.presentValue;
+	analogInputPresentValue.covFilterPoint = this->analogInput.presentValueCovFilterPoint;
+	SharedPointBinding analogInputReliability = binding;
+	analogInputReliability.unsignedInteger = &this->analogInput.reliability;
+	analogInputReliability.dirtyPoint = this->analogInput.reliabilityPoint;
+	SharedPointBinding binaryInputPresentValue = binding;
+	binaryInputPresentValue.boolean = &this->binaryInput.presentValue;
+	binaryInputPresentValue.dirtyPoint = this->binaryInput.presentValuePoint;
+	SharedPointBinding multiStateInputPresentValue = binding;
+	multiStateInputPresentValue.unsignedInteger = &this->multiStateInput.presentValue;
+	multiStateInputPresentValue.dirtyPoint = this->multiStateInput.presentValuePoint;
+	multiStateInputPresentValue.maximum = (uint32_t)this->multiStateInput.stateText.size();
+
+	if (!this->AddSharedPoint(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, this->analogInput.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, analogInputPresentValue) ||
+		!this->AddSharedPoint(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, this->analogInput.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELIABILITY, analogInputReliability) ||
+		!this->AddSharedPoint(CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_INPUT, this->binaryInput.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, binaryInputPresentValue) ||
+		!this->AddSharedPoint(CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_INPUT, this->multiStateInput.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, multiStateInputPresentValue)) {
+		this->sharedPoints.Close();
+		this->sharedPointBindings.clear();
+		return false;
+	}
+	this->sharedPoints.SetReady();
+	return true;
+}
+
+bool ExampleDatabase::AddSharedPoint(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const SharedPointBinding& binding) {
+	uint32_t index = ExampleSharedPoints::INVALID_POINT;
+	if (binding.real != NULL) {
+		const float value = binding.real->GetLatest();
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		index = this->sharedPoints.AddPoint(objectType, objectInstance, propertyIdentifier, ExampleSharedPoint::DATA_TYPE_REAL, bits);
+	}
+	else if (binding.unsignedInteger != NULL) {
+		index = this->sharedPoints.AddPoint(objectType, objectInstance, propertyIdentifier, ExampleSharedPoint::DATA_TYPE_UNSIGNED, binding.unsignedInteger->GetLatest());
+	}
+	else if (binding.boolean != NULL) {
+		index = this->sharedPoints.AddPoint(objectType, objectInstance, propertyIdentifier, ExampleSharedPoint::DATA_TYPE_BOOLEAN, binding.boolean->GetLatest() ? 1 : 0);
+	}
+	if (index == ExampleSharedPoints::INVALID_POINT) {
+		return false;
+	}
+	this->sharedPointBindings.resize(index + 1);
+	this->sharedPointBindings[index] = binding;
+	return true;
 }
 
+uint32_t ExampleDatabase::LoadSharedPoints() {
+	SharedPointsApply apply;
+	apply.database = this;
+	return this->sharedPoints.CollectChanges(apply);
+}
 
+void ExampleDatabase::SharedPointsApply::operator()(const uint32_t index, const ExampleSharedPoint& point) {
+	if (index >= this->database->sharedPointBindings.size()) {
+		return;
+	}
+	const SharedPointBinding& binding = this->database->sharedPointBindings[index];
+	const uint64_t value = point.value.load(std::memory_order_acquire);
+	if (binding.real != NULL) {
+		*binding.real = ExampleSharedPoints::ToReal(value);
+		if (binding.covFilterPoint != ExampleDirtyPointSet::INVALID_POINT) {
+			// Reported to the stack by the COV filter when it moves by the COV increment
+			this->database->covFilter.SetValue(binding.covFilterPoint, binding.real->GetLatest());
+			return;
+		}
+	}
+	else if (binding.unsignedInteger != NULL) {
+		if (binding.maximum != 0 && (value < 1 || value > binding.maximum)) {
+			return; // Not a valid state, keep the last good value
+		}
+		*binding.unsignedInteger = (uint32_t)value;
+	}
+	else if (binding.boolean != NULL) {
+		*binding.boolean = value != 0;
+	}
+	this->database->dirtyPoints.MarkDirty(binding.dirtyPoint);
+}
@@ -23,7 +23,23 @@
 #include <vector>
 #include <stdint.h>
 #include <string.h>
+#include <time.h>
+#include <chrono>
 #include <map>
+#include <unordered_map>
+
+#include "CASBACnetStackExamplePriorityArray.h"
+#include "CASBACnetStackExampleStringTable.h"
+#include "CASBACnetStackExamplePointValue.h"
+#include "CASBACnetStackExampleSnapshot.h"
+#include "CASBACnetStackExampleDirtyPointSet.h"
+#include "CASBACnetStackExampleCovFilter.h"
+#include "CASBACnetStackExampleSharedPoints.h"
+#include "CASBACnetStackExamplePersistentImage.h"
+#include "CASBACnetStackExampleWriteAheadLog.h"
+#include "CASBACnetStackExampleCompiledProfile.h"
+#include "CASBACnetStackExampleNetworkMonitor.h"
+#include "CASBACnetStackExampleClock.h"
 
 // Base class for all object types. 
 class ExampleDatabaseBaseObject
@@ -40,9 +56,13 @@ class ExampleDatabaseBaseObject
 class ExampleDatabaseAnalogInput : public ExampleDatabaseBaseObject 
 {
 	public:
-		float presentValue ;
+		// Present value and reliability are input points in ExampleDatabase::snapshot
+		ExampleSnapshotPoint<float> presentValue ;
 		float covIncrement;
-		uint32_t reliability;
+		ExampleSnapshotPoint<uint32_t> reliability;
+		uint32_t presentValuePoint; // Handles in ExampleDatabase::dirtyPoints
+		uint32_t reliabilityPoint;
+		uint32_t presentValueCovFilterPoint; // Index in ExampleDatabase::covFilter
 		uint32_t units;
 		std::string description; // This is an optional property that has been enabled.  
 
@@ -61,6 +81,9 @@ class ExampleDatabaseAnalogInput : public ExampleDatabaseBaseObject
 
 		// Proprietary Array of Reals
 		std::vector<float> proprietaryArrayOfReal;
+
+		// Proprietary character strings (512 + 1, 512 + 2, 512 + 3), handle of the first one in the string table
+		uint32_t proprietaryCharacterStrings;
 };
 
 class ExampleDatabaseAnalogInputOutOfService : public ExampleDatabaseBaseObject
@@ -78,12 +101,9 @@ class ExampleDatabaseAnalogInputOutOfService : public ExampleDatabaseBaseObject
 class ExampleDatabaseAnalogOutput : public ExampleDatabaseBaseObject 
 {
 	public:
-		bool priorityArrayNulls[ExampleDatabaseBaseObject::PRIORITY_ARRAY_LENGTH] ;
-		float priorityArrayValues[ExampleDatabaseBaseObject::PRIORITY_ARRAY_LENGTH] ;
+		ExampleDatabasePriorityArray<float> priorityArray;
 
-		ExampleDatabaseAnalogOutput() {
-			memset(this->priorityArrayValues, 0, sizeof(float) * ExampleDatabaseBaseObject::PRIORITY_ARRAY_LENGTH);
-			memset(this->priorityArrayNulls, true, sizeof(bool) * ExampleDatabaseBaseObject::PRIORITY_ARRAY_LENGTH);
+		ExampleDatabaseAnalogOutput() : priorityArray(0.0f) {
 		}
 };
 
@@ -93,24 +113,23 @@ class ExampleDatabaseAnalogValue : public ExampleDatabaseBaseObject
 		float presentValue;		
 		float maxPresValue; // This is an optional property 
 		float minPresValue; // This is an optional property 
+		uint32_t presentValuePoint; // Handle in ExampleDatabase::dirtyPoints
 };
 
 class ExampleDatabaseBinaryInput : public ExampleDatabaseBaseObject 
 {
 	public:
-		bool presentValue ;
+		ExampleSnapshotPoint<bool> presentValue ; // Input point in ExampleDatabase::snapshot
+		uint32_t presentValuePoint; // Handle in ExampleDatabase::dirtyPoints
 		std::string description ; // This is an optional property that has been enabled.   
 };
 
 class ExampleDatabaseBinaryOutput : public ExampleDatabaseBaseObject 
 {
 	public:
-		bool priorityArrayNulls[ExampleDatabaseBaseObject::PRIORITY_ARRAY_LENGTH];
-		bool priorityArrayValues[ExampleDatabaseBaseObject::PRIORITY_ARRAY_LENGTH];
+		ExampleDatabasePriorityArray<bool> priorityArray;
 
-		ExampleDatabaseBinaryOutput() {
-			memset(this->priorityArrayValues, 0, sizeof(bool) * ExampleDatabaseBaseObject::PRIORITY_ARRAY_LENGTH);
-			memset(this->priorityArrayNulls, true, sizeof(bool) * ExampleDatabaseBaseObject::PRIORITY_ARRAY_LENGTH);
+		ExampleDatabaseBinaryOutput() : priorityArray(false) {
 		}
 };
 
@@ -124,19 +143,22 @@ class ExampleDatabaseDevice : public ExampleDatabaseBaseObject
 {
 	public:
 		int UTCOffset;
-		int64_t currentTimeOffset;
 		std::string description;
 		uint32_t systemStatus;
+		std::string applicationSoftwareVersion;
+		uint32_t applicationSoftwareVersionString; // Handle in the string table
 };
 
 class ExampleDatabaseMultiStateInput : public ExampleDatabaseBaseObject 
 {
 	public:
-		uint32_t presentValue ;
+		ExampleSnapshotPoint<uint32_t> presentValue ; // Input point in ExampleDatabase::snapshot
+		uint32_t presentValuePoint; // Handle in ExampleDatabase::dirtyPoints
 		std::vector<std::string> stateText; 
+		uint32_t stateTextStrings; // Handle of the first state text in the string table
 
 		ExampleDatabaseMultiStateInput() {
-			this->presentValue = 1 ; // A value of zero is invalid.
+			// The present value is attached with 1 by ExampleDatabase, a value of zero is invalid.
 			this->stateText.push_back("One");
 			this->stateText.push_back("Two");
 			this->stateText.push_back("Three");
@@ -146,16 +168,11 @@ class ExampleDatabaseMultiStateInput : public ExampleDatabaseBaseObject
 class ExampleDatabaseMultiStateOutput : public ExampleDatabaseBaseObject 
 {
 	public:
-		bool priorityArrayNulls[ExampleDatabaseBaseObject::PRIORITY_ARRAY_LENGTH] ;
-		uint32_t priorityArrayValues[ExampleDatabaseBaseObject::PRIORITY_ARRAY_LENGTH] ;
+		ExampleDatabasePriorityArray<uint32_t> priorityArray;
 		std::vector<std::string> stateText; 
+		uint32_t stateTextStrings; // Handle of the first state text in the string table
 
-		uint32_t relinquishDefault = 1; // Zero is not a valid value
-
-		ExampleDatabaseMultiStateOutput() {
-			memset(this->priorityArrayValues, 1, sizeof(uint32_t) * ExampleDatabaseBaseObject::PRIORITY_ARRAY_LENGTH);
-			memset(this->priorityArrayNulls, true, sizeof(bool) * ExampleDatabaseBaseObject::PRIORITY_ARRAY_LENGTH);
-
+		ExampleDatabaseMultiStateOutput() : priorityArray(1) { // Zero is not a valid relinquish default
 			this->stateText.push_back("Light on");
 			this->stateText.push_back("Light off");
 			this->stateText.push_back("Light blinking");
@@ -168,6 +185,7 @@ class ExampleDatabaseMultiStateValue : public ExampleDatabaseBaseObject
 	public:
 		uint32_t presentValue ;
 		std::vector<std::string> stateText; 
+		uint32_t stateTextStrings; // Handle of the first state text in the string table
 		
 		ExampleDatabaseMultiStateValue() {
 			this->presentValue = 1 ;  // A value of zero is invalid.
@@ -190,15 +208,29 @@ class ExampleDatabaseTrendLogMultiple : public ExampleDatabaseBaseObject
 public:
 };
 
-class ExampleDatabaseBitstringValue : public ExampleDatabaseBaseObject 
+class ExampleDatabaseBitstringValue : public ExampleDatabaseBaseObject
 {
 	public:
-		std::vector<bool> presentValue;
+		// The present value is stored packed, 64 bits per word. Bit N is stored in
+		// presentValueWords[N / 64] at bit position (N % 64). Bits past presentValueLength are always zero.
+		std::vector<uint64_t> presentValueWords;
+		uint32_t presentValueLength;
 		std::vector<std::string> bitText;
+		uint32_t bitTextStrings; // Handle of the first bit text in the string table
+
+		ExampleDatabaseBitstringValue() {
+			this->presentValueLength = 0;
+		}
 
-		bool Resize( size_t count) ; 
+		bool Resize( size_t count) ;
 		bool SetPresentValue(size_t offset, bool value);
+		bool GetPresentValue(size_t offset) const;
 		bool SetBitText(size_t offset, std::string bitText);
+
+		// Bulk copy of the present value to and from the bool arrays used by the CAS BACnet Stack.
+		// UnpackPresentValue returns the number of bits written, or zero if maxElementCount is too small.
+		uint32_t UnpackPresentValue(bool* value, uint32_t maxElementCount) const;
+		void PackPresentValue(const bool* value, uint32_t length);
 };
 
 class ExampleDatabaseCharacterStringValue : public ExampleDatabaseBaseObject 
@@ -276,27 +308,42 @@ class ExampleDatabaseNetworkPort : public ExampleDatabaseBaseObject
 		uint16_t FdSubscriptionLifetime;
 };
 
-struct CreatedAnalogValue {
-	std::string name;
+struct CreatedAnalogValue : public ExampleDatabaseBaseObject {
 	float value;
 
 	CreatedAnalogValue() {
-		this->name = "";
+		this->instance = 0;
 		this->value = 0.0f;
 	}
 };
 
+struct ExampleDateTime {
+	uint8_t year;
+	uint8_t month;
+	uint8_t day;
+	uint8_t weekDay;
+	uint8_t hour;
+	uint8_t minute;
+	uint8_t second;
+	uint8_t hundredthSeconds;
+};
+
 class ExampleDatabaseDateTimeValue : public ExampleDatabaseBaseObject
 {
 	public:
-		uint8_t presentValueYear;
-		uint8_t presentValueMonth;
-		uint8_t presentValueDay;
-		uint8_t presentValueWeekDay;
-		uint8_t presentValueHour;
-		uint8_t presentValueMinute;
-		uint8_t presentValueSecond;
-		uint8_t presentValueHundredthSeconds;
+		// The date and time are read by two different callbacks, the seqlock keeps each
+		// read consistent if a field I/O thread updates the value in between.
+		ExampleSeqLock<ExampleDateTime> presentValue;
+};
+
+// Background checkpoints of the persistent image, see ExampleDatabase::StartPersistentCheckpoint
+struct ExamplePersistentCheckpointStats {
+	uint32_t count;
+	uint32_t failures;
+	double lastDuration; // Milliseconds from the fork until the end of the checkpoint process was seen
+	double maxDuration;
+	double lastPause; // Milliseconds the tick loop was stopped for, forking and mapping the new generation
+	double maxPause;
 };
 
 class ExampleDatabase {
@@ -329,6 +376,50 @@ class ExampleDatabase {
 	// Storage for create objects
 	std::map<uint32_t, CreatedAnalogValue> CreatedAnalogValueData;
 
+	// Device clock, refreshed once per tick in the main loop. The time related callbacks read it, the
+	// time offset set by clients is kept in it.
+	ExampleClock clock;
+
+	// Input point values. Written by the acquisition side (Loop) and published once per cycle,
+	// the main loop pins a snapshot for each fpTick so multi property reads are consistent.
+	ExampleSnapshot snapshot;
+
+	// Preformatted constant and rarely changing character strings, see LoadStringTable
+	ExampleStringTable strings;
+
+	// Points changed by the application since the last tick. Drained once per tick in the
+	// main loop, which calls fpValueUpdated for each of them. See RegisterDirtyPoints.
+	ExampleDirtyPointSet dirtyPoints;
+
+	// Analog points that change continuously are marked in dirtyPoints by the COV filter, only
+	// when they move by their COV increment.
+	ExampleCovFilter covFilter;
+
+	// Input points written by external acquisition processes, see CreateSharedPoints
+	ExampleSharedPoints sharedPoints;
+
+	// Cached IPv4 interface of the network port, kept up to date from the netlink change events (Linux).
+	// See LoadNetworkPortProperties and Loop.
+	ExampleNetworkMonitor networkMonitor;
+
+	// Values that must survive a restart, see CASBACnetStackExamplePersistence.cpp
+	ExamplePersistentImage persistentImage;
+	ExampleWriteAheadLog writeAheadLog;
+
+	// Milliseconds between two group commits of the write-ahead log, 0 = once per tick
+	uint32_t writeAheadLogCommitWindow;
+
+	// Save the image from a forked copy-on-write process instead of inside the tick loop (POSIX only)
+	bool persistentCheckpointInBackground;
+	ExamplePersistentCheckpointStats persistentCheckpointStats;
+
+	// Property flags from the device profile, applied by SetupDevice once the objects are added to the stack
+	std::vector<ExampleProfileProperty> profileProperties;
+	// Object templates from the device profile, also applied by SetupDevice. The properties are grouped by
+	// template, the instances are sorted by object type and instance.
+	std::vector<ExampleObjectTemplateProperty> objectTemplateProperties;
+	std::vector<ExampleObjectTemplateInstance> objectTemplateInstances;
+
 	// Constructor / Deconstructor
 	ExampleDatabase();
 	~ExampleDatabase();
@@ -341,10 +432,146 @@ class ExampleDatabase {
 
 	// Helper Functions	
 	void LoadNetworkPortProperties();
+	// Copies the interface selected by networkMonitor into the network port
+	void ApplyNetworkInterface(const ExampleNetworkInterface& networkInterface);
+
+	// String table
+	// The string table copies of the state text, bit text, etc are rebuilt by LoadStringTable. Changes made
+	// after setup go through the setters below so that only the entry that changed is updated.
+	void LoadStringTable();
+	bool SetBitText(size_t offset, const std::string& bitText);
+	void SetApplicationSoftwareVersion(const std::string& version);
+
+	// Registers the points that the application changes (not written by the stack) in dirtyPoints and covFilter
+	void RegisterDirtyPoints();
+
+	// Shared memory point ingestion
+	// Creates the shared memory segment with the input points so that external acquisition processes can
+	// write them. The values written are picked up by Loop, which then stops simulating these points.
+	// replace removes a segment with the same name first. See CASBACnetStackExampleSharedPoints.h
+	bool CreateSharedPoints(const std::string& name, const bool replace);
+	uint32_t LoadSharedPoints();
+
+	// Persistent image
+	// OpenPersistentImage maps the image, applies the saved values over the defaults from Setup and then
+	// replays the write-ahead log (path + ".wal") on top of them. LogPersistentWrite is called after every
+	// successful write and adds the object's values to the pending batch of the log. CommitPersistentWrites,
+	// called by Loop, commits the batch (group commit) and compacts the log into a new generation of the
+	// image when it gets large or old. SavePersistentImage saves a new generation straight away.
+	// Without the log, CommitPersistentWrites saves the image at most once a second while there are changes.
+	bool OpenPersistentImage(const std::string& path);
+	bool SavePersistentImage();
+	void LogPersistentWrite(const uint16_t objectType, const uint32_t objectInstance);
+	void CommitPersistentWrites();
+	// Background checkpoint
+	// StartPersistentCheckpoint forks, the child process saves its copy-on-write view of the database to
+	// the image and exits while the parent keeps ticking. WaitPersistentCheckpoint picks up the result, it
+	// returns true once no checkpoint is running. Only one checkpoint runs at a time and SavePersistentImage
+	// waits for it first.
+	bool StartPersistentCheckpoint();
+	bool WaitPersistentCheckpoint(const bool block);
+	uint32_t GetReplayedWriteCount() const {
+		return this->writeAheadLogReplayCount;
+	}
+	static std::string GetDefaultPersistentImagePath(const uint32_t deviceInstance);
+
+	// Device profile
+	// Reads a JSON device profile and applies it over the defaults from Setup: the device, the names,
+	// descriptions and writable values of the objects, added Analog Values and the property flags. The
+	// file is streamed, one object at a time. See CASBACnetStackExampleProfile.cpp for the format.
+	bool LoadProfile(const std::string& path, uint32_t* objectCount);
+	// CompileProfile writes the values loaded from a profile to a compiled profile (--compile-profile), which
+	// LoadCompiledProfile maps and applies at startup without parsing. See CASBACnetStackExampleCompiledProfile.h
+	bool CompileProfile(const std::string& path);
+	bool LoadCompiledProfile(const std::string& path, uint32_t* objectCount);
+
+	// Object lookup
+	// Resolves an object type and instance to the object in this database, or NULL if there is no such object.
+	// The stack calls the property callbacks many times in a row for the same object (ReadPropertyMultiple,
+	// PROPERTY_IDENTIFIER_ALL) so the last resolved object and a small direct mapped cache are checked
+	// before the object index.
+	ExampleDatabaseBaseObject* FindObject(const uint16_t objectType, const uint32_t objectInstance);
+	// The steps FindObject takes, for the benchmarks. OBJECT_LOOKUP_CURSOR (all of them) by default.
+	enum ObjectLookup {
+		OBJECT_LOOKUP_CURSOR,
+		OBJECT_LOOKUP_CACHE, // Without the last resolved object
+		OBJECT_LOOKUP_INDEX // The object index only
+	};
+	void SetObjectLookup(const ObjectLookup lookup);
+	CreatedAnalogValue* FindCreatedAnalogValue(const uint32_t objectInstance);
+	// The created analog value for an object already resolved with FindObject, or NULL
+	CreatedAnalogValue* AsCreatedAnalogValue(const uint16_t objectType, ExampleDatabaseBaseObject* object);
+	void AddToObjectIndex(const uint16_t objectType, ExampleDatabaseBaseObject* object);
+	void RemoveFromObjectIndex(const uint16_t objectType, const uint32_t objectInstance);
+	void RebuildObjectIndex();
+	// Number of objects of a type, the device excluded
+	uint32_t GetObjectCount(const uint16_t objectType) const;
 
 	private:
 		const std::string GetColorName();
 
+		// BACnet object identifier, objectType in the top 10 bits and the instance in the low 22 bits.
+		static uint32_t GetObjectIdentifier(const uint16_t objectType, const uint32_t objectInstance) {
+			return ((uint32_t)objectType << 22) | (objectInstance & 0x003FFFFF);
+		}
+		void InvalidateObjectCache();
+
+		static const uint32_t OBJECT_CACHE_BITS = 6;
+		static const uint32_t OBJECT_CACHE_SIZE = 1 << OBJECT_CACHE_BITS;
+		static const uint32_t INVALID_OBJECT_IDENTIFIER = 0xFFFFFFFF;
+		struct ObjectCacheEntry {
+			uint32_t objectIdentifier;
+			ExampleDatabaseBaseObject* object;
+		};
+		std::unordered_map<uint32_t, ExampleDatabaseBaseObject*> objectIndex;
+
+		// Database point for each point in sharedPoints, by index. One of real, unsignedInteger or boolean is set.
+		struct SharedPointBinding {
+			ExampleSnapshotPoint<float>* real;
+			ExampleSnapshotPoint<uint32_t>* unsignedInteger;
+			ExampleSnapshotPoint<bool>* boolean;
+			uint32_t dirtyPoint;
+			uint32_t covFilterPoint; // ExampleDirtyPointSet::INVALID_POINT if the point is not COV filtered
+			uint32_t maximum; // Unsigned points only, values outside of 1..maximum are ignored. 0 = no limit.
+		};
+		std::vector<SharedPointBinding> sharedPointBindings;
+
+		// Compaction of the write-ahead log into the image
+		static const uint64_t WRITE_AHEAD_LOG_COMPACT_SIZE = 1024 * 1024; // Bytes
+		static const time_t WRITE_AHEAD_LOG_COMPACT_INTERVAL = 60; // Seconds since the last save
+
+		bool persistentImageChanged;
+		time_t persistentImageSaveTime;
+		std::chrono::steady_clock::time_point writeAheadLogCommitTime;
+		int persistentCheckpointProcess; // Process id of the running checkpoint, 0 = none
+		std::chrono::steady_clock::time_point persistentCheckpointStartTime;
+		uint64_t persistentCheckpointLogSize; // Size of the write-ahead log when the checkpoint was started
+		uint32_t writeAheadLogReplayCount;
+		uint32_t LoadPersistentImage();
+		bool LoadPersistentRecord(const ExamplePersistentRecord& record, const uint8_t* data);
+		void StorePersistentValues(ExamplePersistentRecordWriter& writer);
+		void StorePersistentBuiltInValues(ExamplePersistentRecordWriter& writer);
+		void StorePersistentObject(ExamplePersistentRecordWriter& writer, const uint16_t objectType, const uint32_t objectInstance);
+		void StorePersistentRecords(ExamplePersistentRecordWriter& writer, const uint16_t objectType, const uint32_t objectInstance);
+
+		// Passed to ExampleWriteAheadLog::Replay
+		struct WriteAheadLogApply {
+			ExampleDatabase* database;
+			void operator()(const ExamplePersistentRecord& record, const uint8_t* data) {
+				this->database->LoadPersistentRecord(record, data);
+			}
+		};
+		bool AddSharedPoint(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const SharedPointBinding& binding);
+
+		// Passed to ExampleSharedPoints::CollectChanges
+		struct SharedPointsApply {
+			ExampleDatabase* database;
+			void operator()(const uint32_t index, const ExampleSharedPoint& point);
+		};
+		ObjectLookup objectLookup;
+		ObjectCacheEntry objectCursor; // Last resolved object
+		ObjectCacheEntry objectCache[OBJECT_CACHE_SIZE];
+
 };
 
 
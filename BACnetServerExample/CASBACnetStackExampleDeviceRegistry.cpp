@@ -0,0 +1,165 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleDeviceRegistry.cpp
+ *
+ * See CASBACnetStackExampleDeviceRegistry.h
+*/
+
+#include "CASBACnetStackExampleDeviceRegistry.h"
+#include "CASBACnetStackExampleConstants.h"
+
+#include <string.h>
+
+ExampleHostedDevice::ExampleHostedDevice(const uint32_t instance) {
+	this->instance = instance;
+}
+
+ExampleHostedPoint* ExampleHostedDevice::AddPoint(const uint16_t objectType, const uint32_t objectInstance, const std::string& objectName, const uint32_t units) {
+	if (!this->pointIndex.insert(std::make_pair(ExampleHostedDevice::GetObjectIdentifier(objectType, objectInstance), (uint32_t)this->points.size())).second) {
+		return NULL;
+	}
+	ExampleHostedPoint point;
+	point.objectType = objectType;
+	point.objectInstance = objectInstance;
+	point.objectName = objectName;
+	point.presentValue = 0.0f;
+	point.units = units;
+	point.outOfService = false;
+	this->points.push_back(point);
+	return &this->points.back();
+}
+
+ExampleHostedPoint* ExampleHostedDevice::FindPoint(const uint16_t objectType, const uint32_t objectInstance) {
+	std::unordered_map<uint32_t, uint32_t>::const_iterator itr = this->pointIndex.find(ExampleHostedDevice::GetObjectIdentifier(objectType, objectInstance));
+	if (itr == this->pointIndex.end()) {
+		return NULL;
+	}
+	return &this->points[itr->second];
+}
+
+bool ExampleHostedDevice::GetPropertyBool(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, bool* value) {
+	if (propertyIdentifier != CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OUT_OF_SERVICE) {
+		return false;
+	}
+	ExampleHostedPoint* point = this->FindPoint(objectType, objectInstance);
+	if (point == NULL) {
+		return false;
+	}
+	*value = point->outOfService;
+	return true;
+}
+
+bool ExampleHostedDevice::GetPropertyCharString(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, char* value, uint32_t* valueElementCount, const uint32_t maxElementCount) {
+	if (propertyIdentifier != CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OBJECT_NAME) {
+		return false;
+	}
+	const std::string* name;
+	if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE && objectInstance == this->instance) {
+		name = &this->objectName;
+	}
+	else {
+		ExampleHostedPoint* point = this->FindPoint(objectType, objectInstance);
+		if (point == NULL) {
+			return false;
+		}
+		name = &point->objectName;
+	}
+	if (name->size() > maxElementCount) {
+		return false;
+	}
+	memcpy(value, name->c_str(), name->size());
+	*valueElementCount = (uint32_t)name->size();
+	return true;
+}
+
+bool ExampleHostedDevice::GetPropertyEnum(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, uint32_t* value) {
+	if (propertyIdentifier != CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_UNITS) {
+		return false;
+	}
+	ExampleHostedPoint* point = this->FindPoint(objectType, objectInstance);
+	if (point == NULL) {
+		return false;
+	}
+	*value = point->units;
+	return true;
+}
+
+bool ExampleHostedDevice::GetPropertyReal(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, float* value) {
+	if (propertyIdentifier != CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
+		return false;
+	}
+	ExampleHostedPoint* point = this->FindPoint(objectType, objectInstance);
+	if (point == NULL) {
+		return false;
+	}
+	*value = point->presentValue;
+	return true;
+}
+
+bool ExampleHostedDevice::SetPropertyBool(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const bool value) {
+	if (propertyIdentifier != CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OUT_OF_SERVICE) {
+		return false;
+	}
+	ExampleHostedPoint* point = this->FindPoint(objectType, objectInstance);
+	if (point == NULL) {
+		return false;
+	}
+	point->outOfService = value;
+	return true;
+}
+
+bool ExampleHostedDevice::SetPropertyReal(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const float value) {
+	if (propertyIdentifier != CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
+		return false;
+	}
+	ExampleHostedPoint* point = this->FindPoint(objectType, objectInstance);
+	if (point == NULL) {
+		return false;
+	}
+	// The present value of an analog input can only be written while it is out of service
+	if (point->objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT && !point->outOfService) {
+		return false;
+	}
+	point->presentValue = value;
+	return true;
+}
+
+ExampleDeviceRegistry::ExampleDeviceRegistry() {
+	this->lastDevice = NULL;
+	this->highestInstance = 0;
+}
+
+ExampleHostedDevice* ExampleDeviceRegistry::Add(const uint32_t instance) {
+	std::pair<std::unordered_map<uint32_t, ExampleHostedDevice>::iterator, bool> result = this->devices.insert(std::make_pair(instance, ExampleHostedDevice(instance)));
+	if (!result.second) {
+		return NULL;
+	}
+	if (instance > this->highestInstance) {
+		this->highestInstance = instance;
+	}
+	return &result.first->second;
+}
+
+bool ExampleDeviceRegistry::Remove(const uint32_t instance) {
+	this->lastDevice = NULL;
+	return this->devices.erase(instance) > 0;
+}
+
+size_t ExampleDeviceRegistry::GetPointCount() const {
+	size_t count = 0;
+	for (std::unordered_map<uint32_t, ExampleHostedDevice>::const_iterator itr = this->devices.begin(); itr != this->devices.end(); itr++) {
+		count += itr->second.GetPoints().size();
+	}
+	return count;
+}
+
+ExampleHostedDevice* ExampleDeviceRegistry::GetLast() {
+	ExampleHostedDevice* last = NULL;
+	for (std::unordered_map<uint32_t, ExampleHostedDevice>::iterator itr = this->devices.begin(); itr != this->devices.end(); itr++) {
+		if (last == NULL || itr->second.GetInstance() > last->GetInstance()) {
+			last = &itr->second;
+		}
+	}
+	return last;
+}
@@ -0,0 +1,130 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleDeviceRegistry.h
+ *
+ * Devices hosted next to the example device, for gateways that expose many
+ * virtual devices from one process.
+ *
+ * Each hosted device has its own point database: a flat array of analog
+ * points and an index from the BACnet object identifier to the offset of
+ * the point in the array. The registry maps the device instance to the
+ * device. The property callbacks look up the device first and then the
+ * point, two hash lookups whatever the number of devices and points. The
+ * last device found is remembered, the stack usually asks for several
+ * properties of the same device in a row.
+ *
+ * Devices are added and removed at runtime. A device is never moved once it
+ * is added, pointers to it stay valid until it is removed.
+ *
+ * The example device itself is not in the registry, it is served from the
+ * example database (CASBACnetStackExampleDatabase.h).
+*/
+
+#ifndef __CASBACnetStackExampleDeviceRegistry_h__
+#define __CASBACnetStackExampleDeviceRegistry_h__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+struct ExampleHostedPoint {
+	uint16_t objectType; // Analog input or analog value
+	uint32_t objectInstance;
+	std::string objectName;
+	float presentValue;
+	uint32_t units;
+	bool outOfService;
+};
+
+class ExampleHostedDevice
+{
+	public:
+		explicit ExampleHostedDevice(const uint32_t instance);
+
+		uint32_t GetInstance() const {
+			return this->instance;
+		}
+
+		void ReservePoints(const size_t count) {
+			this->points.reserve(count);
+			this->pointIndex.reserve(count);
+		}
+		// Returns NULL if the object identifier is already used in this device. The points can move when
+		// a point is added, the pointer is valid until the next AddPoint.
+		ExampleHostedPoint* AddPoint(const uint16_t objectType, const uint32_t objectInstance, const std::string& objectName, const uint32_t units);
+		ExampleHostedPoint* FindPoint(const uint16_t objectType, const uint32_t objectInstance);
+		const std::vector<ExampleHostedPoint>& GetPoints() const {
+			return this->points;
+		}
+
+		// The properties served from the point database. They return false for the other properties,
+		// the stack then uses its own value or reports unknown-property.
+		bool GetPropertyBool(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, bool* value);
+		bool GetPropertyCharString(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, char* value, uint32_t* valueElementCount, const uint32_t maxElementCount);
+		bool GetPropertyEnum(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, uint32_t* value);
+		bool GetPropertyReal(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, float* value);
+		bool SetPropertyBool(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const bool value);
+		bool SetPropertyReal(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const float value);
+
+		std::string objectName;
+
+	private:
+		// BACnet object identifier, objectType in the top 10 bits and the instance in the low 22 bits.
+		static uint32_t GetObjectIdentifier(const uint16_t objectType, const uint32_t objectInstance) {
+			return ((uint32_t)objectType << 22) | (objectInstance & 0x003FFFFF);
+		}
+
+		uint32_t instance;
+		std::vector<ExampleHostedPoint> points;
+		std::unordered_map<uint32_t, uint32_t> pointIndex; // Object identifier to offset in points
+};
+
+class ExampleDeviceRegistry
+{
+	public:
+		ExampleDeviceRegistry();
+
+		// Returns NULL if a device with this instance is already hosted
+		ExampleHostedDevice* Add(const uint32_t instance);
+		bool Remove(const uint32_t instance);
+		ExampleHostedDevice* Find(const uint32_t instance) {
+			if (this->lastDevice != NULL && this->lastDevice->GetInstance() == instance) {
+				return this->lastDevice;
+			}
+			std::unordered_map<uint32_t, ExampleHostedDevice>::iterator itr = this->devices.find(instance);
+			if (itr == this->devices.end()) {
+				return NULL;
+			}
+			this->lastDevice = &itr->second;
+			return this->lastDevice;
+		}
+		size_t GetCount() const {
+			return this->devices.size();
+		}
+		// Total number of points of the hosted devices
+		size_t GetPointCount() const;
+		// The hosted device with the highest instance, NULL if there is none
+		ExampleHostedDevice* GetLast();
+		// Highest instance ever added, removed devices included. 0 if no device was added.
+		uint32_t GetHighestInstance() const {
+			return this->highestInstance;
+		}
+		// Calls visitor(device) for each hosted device, in no particular order. The visitor must not add or remove devices.
+		template <typename Visitor>
+		void ForEach(Visitor& visitor) {
+			for (std::unordered_map<uint32_t, ExampleHostedDevice>::iterator itr = this->devices.begin(); itr != this->devices.end(); itr++) {
+				visitor(itr->second);
+			}
+		}
+
+	private:
+		// Node based, the devices do not move when the map grows
+		std::unordered_map<uint32_t, ExampleHostedDevice> devices;
+		ExampleHostedDevice* lastDevice; // Of the last Find, NULL after a Remove
+		uint32_t highestInstance;
+};
+
+#endif // __CASBACnetStackExampleDeviceRegistry_h__
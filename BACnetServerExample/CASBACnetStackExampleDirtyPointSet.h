@@ -0,0 +1,153 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleDirtyPointSet.h
+ *
+ * Tracks which points (object type, instance, property) changed since the
+ * last tick, so that fpValueUpdated is called once per changed point per
+ * tick instead of once per write.
+ *
+ * Points are registered once at setup and grouped in one pool per object
+ * type. Each pool has a bitmap with one bit per point, and a summary bitmap
+ * with one bit per 64 bit word of the first. Marking a point dirty is an
+ * atomic OR on both so it can be done from a field I/O thread. Drain skips
+ * clean pools and only visits the words flagged in the summary, so the cost
+ * follows the number of changed points. Several changes to the same point
+ * before a drain are reported once.
+*/
+
+#ifndef __CASBACnetStackExampleDirtyPointSet_h__
+#define __CASBACnetStackExampleDirtyPointSet_h__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <deque>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif // _MSC_VER
+
+// Returns the index of the lowest set bit. The value must not be zero.
+inline uint32_t ExampleCountTrailingZeros64(uint64_t value) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctzll(value);
+#endif // _MSC_VER
+}
+
+class ExampleDirtyPointSet
+{
+	public:
+		// Handles have the pool in the top 10 bits and the point in the low 22 bits,
+		// the same layout as a BACnet object identifier.
+		static const uint32_t INVALID_POINT = 0xFFFFFFFF;
+
+		// Registers a point and returns its handle. Not thread safe, call during setup only.
+		uint32_t AddPoint(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier) {
+			Pool* pool = NULL;
+			uint32_t poolIndex = 0;
+			for (; poolIndex < this->pools.size(); poolIndex++) {
+				if (this->pools[poolIndex].objectType == objectType) {
+					pool = &this->pools[poolIndex];
+					break;
+				}
+			}
+			if (pool == NULL) {
+				this->pools.emplace_back(objectType);
+				pool = &this->pools.back();
+			}
+
+			Point point;
+			point.objectInstance = objectInstance;
+			point.propertyIdentifier = propertyIdentifier;
+			pool->points.push_back(point);
+			const uint32_t slot = (uint32_t)(pool->points.size() - 1);
+			if (slot / 64 >= pool->words.size()) {
+				pool->words.emplace_back(0);
+			}
+			if (slot / (64 * 64) >= pool->summary.size()) {
+				pool->summary.emplace_back(0);
+			}
+			return (poolIndex << 22) | slot;
+		}
+
+		// Removes all the points. Not thread safe, call during setup only.
+		void Clear() {
+			this->pools.clear();
+		}
+
+		// Marks a point as changed. Safe to call from any thread.
+		void MarkDirty(const uint32_t handle) {
+			if (handle == INVALID_POINT || (handle >> 22) >= this->pools.size()) {
+				return;
+			}
+			Pool& pool = this->pools[handle >> 22];
+			const uint32_t slot = handle & 0x003FFFFF;
+			// The bits are set from the bottom up (point, summary, pool) and Drain clears them from
+			// the top down. A point marked during a drain is either reported by it or by the next one.
+			// If the word already had a bit set, the summary and pool are already flagged (or a drain
+			// has not reached this word yet) so only the first point marked in a word pays for them.
+			const uint32_t word = slot / 64;
+			if (pool.words[word].fetch_or(((uint64_t)1) << (slot % 64), std::memory_order_release) != 0) {
+				return;
+			}
+			pool.summary[word / 64].fetch_or(((uint64_t)1) << (word % 64), std::memory_order_release);
+			pool.dirty.store(true, std::memory_order_release);
+		}
+
+		// Calls notify(objectType, objectInstance, propertyIdentifier) once for every point marked
+		// since the last drain, and clears them. Returns the number of points reported.
+		template <typename Notify>
+		uint32_t Drain(Notify& notify) {
+			uint32_t count = 0;
+			for (size_t poolIndex = 0; poolIndex < this->pools.size(); poolIndex++) {
+				Pool& pool = this->pools[poolIndex];
+				if (!pool.dirty.exchange(false, std::memory_order_acquire)) {
+					continue;
+				}
+				for (size_t summaryIndex = 0; summaryIndex < pool.summary.size(); summaryIndex++) {
+					uint64_t words = pool.summary[summaryIndex].exchange(0, std::memory_order_acquire);
+					while (words != 0) {
+						const uint32_t word = (uint32_t)(summaryIndex * 64) + ExampleCountTrailingZeros64(words);
+						words &= words - 1;
+						uint64_t bits = pool.words[word].exchange(0, std::memory_order_acquire);
+						while (bits != 0) {
+							const uint32_t slot = word * 64 + ExampleCountTrailingZeros64(bits);
+							bits &= bits - 1;
+							const Point& point = pool.points[slot];
+							notify(pool.objectType, point.objectInstance, point.propertyIdentifier);
+							count++;
+						}
+					}
+				}
+			}
+			return count;
+		}
+
+	private:
+		struct Point {
+			uint32_t objectInstance;
+			uint32_t propertyIdentifier;
+		};
+
+		struct Pool {
+			uint16_t objectType;
+			std::vector<Point> points;
+			// deque, the atomics can't be moved
+			std::deque<std::atomic<uint64_t> > words; // Bit set = point changed
+			std::deque<std::atomic<uint64_t> > summary; // Bit set = word in words might have a bit set
+			std::atomic<bool> dirty; // Set if any bit in summary might be set
+
+			explicit Pool(const uint16_t objectType) : objectType(objectType), dirty(false) {
+			}
+		};
+
+		std::deque<Pool> pools;
+};
+
+#endif // __CASBACnetStackExampleDirtyPointSet_h__
@@ -0,0 +1,318 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleJsonReader.cpp
+ *
+ * See CASBACnetStackExampleJsonReader.h
+*/
+
+#include "CASBACnetStackExampleJsonReader.h"
+
+#include <iostream>
+#include <stdlib.h> // strtod()
+
+ExampleJsonReader::ExampleJsonReader() {
+	this->file = NULL;
+	this->position = 0;
+	this->length = 0;
+	this->line = 1;
+	this->expectKey = false;
+	this->afterValue = false;
+	this->number = 0;
+}
+
+ExampleJsonReader::~ExampleJsonReader() {
+	this->Close();
+}
+
+bool ExampleJsonReader::Open(const std::string& path) {
+	this->Close();
+	this->file = fopen(path.c_str(), "rb");
+	if (this->file == NULL) {
+		std::cerr << "Error - Could not open the file. path=[" << path << "]" << std::endl;
+		return false;
+	}
+	this->buffer.resize(BUFFER_SIZE);
+	this->position = 0;
+	this->length = 0;
+	this->line = 1;
+	this->containers.clear();
+	this->expectKey = false;
+	this->afterValue = false;
+	return true;
+}
+
+void ExampleJsonReader::Close() {
+	if (this->file != NULL) {
+		fclose(this->file);
+	}
+	this->file = NULL;
+}
+
+bool ExampleJsonReader::Fill() {
+	if (this->file == NULL) {
+		return false;
+	}
+	this->length = fread(&this->buffer[0], 1, this->buffer.size(), this->file);
+	this->position = 0;
+	return this->length > 0;
+}
+
+int ExampleJsonReader::SkipWhitespace() {
+	for (;;) {
+		const int character = this->Peek();
+		if (character == '\n') {
+			this->line++;
+		}
+		else if (character != ' ' && character != '\t' && character != '\r') {
+			return character;
+		}
+		this->position++;
+	}
+}
+
+ExampleJsonReader::Token ExampleJsonReader::Fail(const char* message) {
+	std::cerr << "Error - Invalid JSON, " << message << ". line=[" << this->line << "]" << std::endl;
+	return TOKEN_ERROR;
+}
+
+ExampleJsonReader::Token ExampleJsonReader::Next() {
+	int character = this->SkipWhitespace();
+
+	// Separator between two values
+	if (this->afterValue) {
+		if (character == ',') {
+			if (this->containers.empty()) {
+				return this->Fail("unexpected comma");
+			}
+			this->position++;
+			this->afterValue = false;
+			this->expectKey = this->containers.back() == '{';
+			character = this->SkipWhitespace();
+			if (character == '}' || character == ']') {
+				return this->Fail("trailing comma");
+			}
+		}
+		else if (character != '}' && character != ']' && !(character < 0 && this->containers.empty())) {
+			return this->Fail("expected a comma");
+		}
+	}
+	if (this->expectKey && character != '"' && character != '}') {
+		return this->Fail("expected a key");
+	}
+
+	switch (character) {
+		case -1:
+			if (!this->containers.empty()) {
+				return this->Fail("unexpected end of file");
+			}
+			return TOKEN_END;
+		case '{':
+			this->position++;
+			this->containers.push_back('{');
+			this->expectKey = true;
+			this->afterValue = false;
+			return TOKEN_BEGIN_OBJECT;
+		case '[':
+			this->position++;
+			this->containers.push_back('[');
+			this->expectKey = false;
+			this->afterValue = false;
+			return TOKEN_BEGIN_ARRAY;
+		case '}':
+		case ']':
+			if (this->containers.empty() || this->containers.back() != (character == '}' ? '{' : '[')) {
+				return this->Fail("unexpected end of a container");
+			}
+			if (character == '}' && !this->expectKey && !this->afterValue) {
+				return this->Fail("missing value");
+			}
+			this->position++;
+			this->containers.pop_back();
+			this->expectKey = false;
+			this->afterValue = true;
+			return character == '}' ? TOKEN_END_OBJECT : TOKEN_END_ARRAY;
+		case '"':
+			this->position++;
+			if (!this->ReadString()) {
+				return TOKEN_ERROR;
+			}
+			if (this->expectKey) {
+				if (this->SkipWhitespace() != ':') {
+					return this->Fail("expected a colon");
+				}
+				this->position++;
+				this->expectKey = false;
+				return TOKEN_KEY;
+			}
+			this->afterValue = true;
+			return TOKEN_STRING;
+		case 't':
+			this->afterValue = true;
+			return this->ReadLiteral("true") ? TOKEN_TRUE : TOKEN_ERROR;
+		case 'f':
+			this->afterValue = true;
+			return this->ReadLiteral("false") ? TOKEN_FALSE : TOKEN_ERROR;
+		case 'n':
+			this->afterValue = true;
+			return this->ReadLiteral("null") ? TOKEN_NULL : TOKEN_ERROR;
+		default:
+			if (character == '-' || (character >= '0' && character <= '9')) {
+				this->afterValue = true;
+				return this->ReadNumber() ? TOKEN_NUMBER : TOKEN_ERROR;
+			}
+			return this->Fail("unexpected character");
+	}
+}
+
+bool ExampleJsonReader::Skip(const Token token) {
+	if (token != TOKEN_BEGIN_OBJECT && token != TOKEN_BEGIN_ARRAY) {
+		return token != TOKEN_ERROR && token != TOKEN_END;
+	}
+	const size_t depth = this->containers.size() - 1;
+	for (;;) {
+		const Token next = this->Next();
+		if (next == TOKEN_ERROR || next == TOKEN_END) {
+			return false;
+		}
+		if ((next == TOKEN_END_OBJECT || next == TOKEN_END_ARRAY) && this->containers.size() == depth) {
+			return true;
+		}
+	}
+}
+
+bool ExampleJsonReader::ReadString() {
+	this->text.clear();
+	for (;;) {
+		// Copy the run of plain characters in the buffer at once
+		const size_t start = this->position;
+		while (this->position < this->length && this->buffer[this->position] != '"' && this->buffer[this->position] != '\\' && (unsigned char)this->buffer[this->position] >= 0x20) {
+			this->position++;
+		}
+		this->text.append(&this->buffer[0] + start, this->position - start);
+
+		const int character = this->Read();
+		if (character < 0) {
+			this->Fail("unterminated string");
+			return false;
+		}
+		if (character == '"') {
+			return true;
+		}
+		if (character != '\\') {
+			if (character >= 0x20) {
+				// End of the buffer was reached, the next Peek refilled it
+				this->text.push_back((char)character);
+				continue;
+			}
+			this->Fail("control character in a string");
+			return false;
+		}
+
+		const int escape = this->Read();
+		switch (escape) {
+			case '"': this->text.push_back('"'); break;
+			case '\\': this->text.push_back('\\'); break;
+			case '/': this->text.push_back('/'); break;
+			case 'b': this->text.push_back('\b'); break;
+			case 'f': this->text.push_back('\f'); break;
+			case 'n': this->text.push_back('\n'); break;
+			case 'r': this->text.push_back('\r'); break;
+			case 't': this->text.push_back('\t'); break;
+			case 'u': {
+				uint32_t codePoint = 0;
+				for (int digit = 0; digit < 4; digit++) {
+					const int hex = this->Read();
+					codePoint <<= 4;
+					if (hex >= '0' && hex <= '9') {
+						codePoint |= (uint32_t)(hex - '0');
+					}
+					else if (hex >= 'a' && hex <= 'f') {
+						codePoint |= (uint32_t)(hex - 'a' + 10);
+					}
+					else if (hex >= 'A' && hex <= 'F') {
+						codePoint |= (uint32_t)(hex - 'A' + 10);
+					}
+					else {
+						this->Fail("invalid unicode escape");
+						return false;
+					}
+				}
+				if (codePoint < 0x80) {
+					this->text.push_back((char)codePoint);
+				}
+				else if (codePoint < 0x800) {
+					this->text.push_back((char)(0xC0 | (codePoint >> 6)));
+					this->text.push_back((char)(0x80 | (codePoint & 0x3F)));
+				}
+				else {
+					this->text.push_back((char)(0xE0 | (codePoint >> 12)));
+					this->text.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+					this->text.push_back((char)(0x80 | (codePoint & 0x3F)));
+				}
+				break;
+			}
+			default:
+				this->Fail("invalid escape");
+				return false;
+		}
+	}
+}
+
+bool ExampleJsonReader::ReadNumber() {
+	// Integers are converted here, anything with a fraction or an exponent goes through strtod
+	char digits[64];
+	size_t count = 0;
+	bool integer = true;
+	for (;;) {
+		const int character = this->Peek();
+		if (character >= '0' && character <= '9') {
+		}
+		else if (character == '-' || character == '+' || character == '.' || character == 'e' || character == 'E') {
+			integer = integer && character == '-' && count == 0;
+		}
+		else {
+			break;
+		}
+		if (count + 1 >= sizeof(digits)) {
+			this->Fail("number too long");
+			return false;
+		}
+		digits[count++] = (char)character;
+		this->position++;
+	}
+	digits[count] = 0;
+
+	if (integer) {
+		const bool negative = digits[0] == '-';
+		size_t offset = negative ? 1 : 0;
+		if (offset == count) {
+			this->Fail("invalid number");
+			return false;
+		}
+		double value = 0;
+		for (; offset < count; offset++) {
+			value = value * 10 + (digits[offset] - '0');
+		}
+		this->number = negative ? -value : value;
+		return true;
+	}
+
+	char* end = NULL;
+	this->number = strtod(digits, &end);
+	if (end != digits + count) {
+		this->Fail("invalid number");
+		return false;
+	}
+	return true;
+}
+
+bool ExampleJsonReader::ReadLiteral(const char* literal) {
+	for (const char* character = literal; *character != 0; character++) {
+		if (this->Read() != *character) {
+			this->Fail("invalid literal");
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,113 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleJsonReader.h
+ *
+ * Streaming (pull) JSON reader. The file is read through a fixed size buffer
+ * and returned one token at a time, no document tree is built, so large
+ * device profiles are read in a single pass with constant memory.
+ *
+ * Usage
+ *   ExampleJsonReader reader;
+ *   reader.Open(path);
+ *   for (;;) {
+ *       token = reader.Next(); // TOKEN_KEY, TOKEN_NUMBER, TOKEN_BEGIN_OBJECT, ...
+ *       reader.GetString() / GetNumber() for the value of the token
+ *       reader.Skip() to skip a value that is not needed
+ *   }
+ *
+ * Strings are returned as UTF-8, \uXXXX escapes of the basic multilingual
+ * plane are converted.
+*/
+
+#ifndef __CASBACnetStackExampleJsonReader_h__
+#define __CASBACnetStackExampleJsonReader_h__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+class ExampleJsonReader
+{
+	public:
+		enum Token {
+			TOKEN_ERROR = 0,
+			TOKEN_END, // End of the document
+			TOKEN_BEGIN_OBJECT,
+			TOKEN_END_OBJECT,
+			TOKEN_BEGIN_ARRAY,
+			TOKEN_END_ARRAY,
+			TOKEN_KEY, // GetString is the key, the next token is its value
+			TOKEN_STRING,
+			TOKEN_NUMBER,
+			TOKEN_TRUE,
+			TOKEN_FALSE,
+			TOKEN_NULL
+		};
+
+		ExampleJsonReader();
+		~ExampleJsonReader();
+
+		bool Open(const std::string& path);
+		void Close();
+
+		Token Next();
+		// Skips the value that starts with token (the last token returned by Next), nested objects and arrays included
+		bool Skip(const Token token);
+
+		const std::string& GetString() const {
+			return this->text;
+		}
+		double GetNumber() const {
+			return this->number;
+		}
+		// Position of the last token, for error messages
+		uint32_t GetLine() const {
+			return this->line;
+		}
+
+	private:
+		ExampleJsonReader(const ExampleJsonReader&);
+		ExampleJsonReader& operator=(const ExampleJsonReader&);
+
+		static const size_t BUFFER_SIZE = 64 * 1024;
+
+		// Next character, or -1 at the end of the file
+		int Peek() {
+			if (this->position == this->length && !this->Fill()) {
+				return -1;
+			}
+			return (unsigned char)this->buffer[this->position];
+		}
+		int Read() {
+			const int character = this->Peek();
+			if (character >= 0) {
+				this->position++;
+			}
+			return character;
+		}
+		bool Fill();
+		int SkipWhitespace();
+		bool ReadString();
+		bool ReadNumber();
+		bool ReadLiteral(const char* literal);
+		Token Fail(const char* message);
+
+		FILE* file;
+		std::vector<char> buffer;
+		size_t position;
+		size_t length;
+		uint32_t line;
+
+		// Open containers, '{' or '['. In an object expectKey is set where the next token must be a key.
+		// afterValue is set after a complete value, where only a comma or the end of the container can follow.
+		std::vector<char> containers;
+		bool expectKey;
+		bool afterValue;
+
+		std::string text;
+		double number;
+};
+
+#endif // __CASBACnetStackExampleJsonReader_h__
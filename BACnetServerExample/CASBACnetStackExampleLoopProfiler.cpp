@@ -0,0 +1,191 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleLoopProfiler.cpp
+ *
+ * See CASBACnetStackExampleLoopProfiler.h
+*/
+
+#include "CASBACnetStackExampleLoopProfiler.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+static const char* EXAMPLE_PHASE_NAMES[ExampleLoopProfiler::PHASE_COUNT] = {
+	"warm_start",
+	"clock",
+	"tick",
+	"router",
+	"metrics",
+	"user_input",
+	"database",
+	"notify",
+	"sleep"
+};
+
+static const char* EXAMPLE_TICK_PART_NAMES[ExampleLoopProfiler::TICK_PART_COUNT] = {
+	"receive",
+	"send",
+	"property",
+	"other_callbacks",
+	"stack"
+};
+
+ExampleLoopProfiler::ExampleLoopProfiler() {
+	this->startTicks = ExampleReadTicks();
+	this->startTime = std::chrono::steady_clock::now();
+	this->summaryInterval = DEFAULT_SUMMARY_INTERVAL;
+	memset(this->ticks, 0, sizeof(this->ticks));
+	memset(this->callbackTicks, 0, sizeof(this->callbackTicks));
+	this->iterations = 0;
+	this->last = this->startTicks;
+	this->publishTicks = this->startTicks;
+	this->publishIntervalTicks = UINT64_MAX; // Set by Start
+	this->publishTime = this->startTime;
+	this->ResetSummary(this->startTime);
+}
+
+void ExampleLoopProfiler::Start(const ExampleCallbackLatency& latency) {
+	memset(this->ticks, 0, sizeof(this->ticks));
+	// The callbacks called before the loop are not counted
+	for (uint32_t callback = 0; callback < ExampleServerMetrics::CALLBACK_COUNT; callback++) {
+		this->callbackTicks[callback] = latency.GetCallbackTicks(callback);
+	}
+	this->iterations = 0;
+	this->last = ExampleReadTicks();
+	this->publishTicks = this->last;
+	this->publishTime = std::chrono::steady_clock::now();
+
+	// The rate of the tick counter since the profiler was created, the startup in practice. Measured again on each Publish.
+	const double nanoseconds = std::chrono::duration<double, std::nano>(this->publishTime - this->startTime).count();
+	const uint64_t elapsed = this->last - this->startTicks;
+	const double period = nanoseconds > 1000000.0 && elapsed > 0 ? nanoseconds / (double)elapsed : 1.0;
+	this->publishIntervalTicks = (uint64_t)(PUBLISH_INTERVAL * 1000000.0 / period);
+
+	this->ResetSummary(this->publishTime);
+}
+
+void ExampleLoopProfiler::ResetSummary(const std::chrono::steady_clock::time_point& now) {
+	this->summaryTime = now;
+	this->summaryIterations = 0;
+	for (uint32_t phase = 0; phase < PHASE_COUNT; phase++) {
+		this->summaryPhases[phase] = 0.0;
+	}
+	for (uint32_t part = 0; part < TICK_PART_COUNT; part++) {
+		this->summaryTickParts[part] = 0.0;
+	}
+}
+
+ExampleLoopProfiler::TickPart ExampleLoopProfiler::GetTickPart(const uint32_t callback) {
+	if (callback == ExampleServerMetrics::CALLBACK_RECEIVE_MESSAGE) {
+		return TICK_RECEIVE;
+	}
+	if (callback == ExampleServerMetrics::CALLBACK_SEND_MESSAGE) {
+		return TICK_SEND;
+	}
+	if (callback >= ExampleServerMetrics::CALLBACK_GET_PROPERTY_BIT_STRING && callback <= ExampleServerMetrics::CALLBACK_SET_PROPERTY_UNSIGNED_INTEGER) {
+		return TICK_PROPERTY;
+	}
+	return TICK_OTHER_CALLBACKS;
+}
+
+void ExampleLoopProfiler::Publish(const ExampleCallbackLatency& latency, std::ostream& output) {
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	const double elapsed = std::chrono::duration<double, std::nano>(now - this->startTime).count();
+	const double period = this->last > this->startTicks ? elapsed / (double)(this->last - this->startTicks) : 1.0;
+
+	double phases[PHASE_COUNT];
+	for (uint32_t phase = 0; phase < PHASE_COUNT; phase++) {
+		phases[phase] = (double)this->ticks[phase] * period;
+		this->ticks[phase] = 0;
+	}
+
+	// The callbacks timed since the last Publish, scaled by the sample period
+	double tickParts[TICK_PART_COUNT] = { 0.0 };
+	for (uint32_t callback = 0; callback < ExampleServerMetrics::CALLBACK_COUNT; callback++) {
+		const uint64_t callbackTicks = latency.GetCallbackTicks(callback);
+		// Less than before when the latency was reset
+		const uint64_t delta = callbackTicks >= this->callbackTicks[callback] ? callbackTicks - this->callbackTicks[callback] : callbackTicks;
+		this->callbackTicks[callback] = callbackTicks;
+		tickParts[ExampleLoopProfiler::GetTickPart(callback)] += (double)delta * (double)latency.GetSamplePeriod() * period;
+	}
+	double callbacks = 0.0;
+	for (uint32_t part = 0; part < TICK_STACK; part++) {
+		callbacks += tickParts[part];
+	}
+	// The estimate can be a little more than fpTick, the callbacks are then scaled down to fit
+	if (callbacks > phases[PHASE_TICK]) {
+		for (uint32_t part = 0; part < TICK_STACK; part++) {
+			tickParts[part] *= phases[PHASE_TICK] / callbacks;
+		}
+		callbacks = phases[PHASE_TICK];
+	}
+	tickParts[TICK_STACK] = phases[PHASE_TICK] - callbacks;
+
+	for (uint32_t phase = 0; phase < PHASE_COUNT; phase++) {
+		this->phaseNanoseconds[phase].Add((uint64_t)phases[phase]);
+		this->summaryPhases[phase] += phases[phase];
+	}
+	for (uint32_t part = 0; part < TICK_PART_COUNT; part++) {
+		this->tickPartNanoseconds[part].Add((uint64_t)tickParts[part]);
+		this->summaryTickParts[part] += tickParts[part];
+	}
+	const double seconds = std::chrono::duration<double>(now - this->publishTime).count();
+	this->iterationsTotal.Add(this->iterations);
+	this->iterationsPerSecond.Set(seconds > 0.0 ? (int64_t)((double)this->iterations / seconds + 0.5) : 0);
+	this->summaryIterations += this->iterations;
+	this->iterations = 0;
+
+	this->publishTicks = this->last;
+	this->publishIntervalTicks = (uint64_t)(PUBLISH_INTERVAL * 1000000.0 / period);
+	this->publishTime = now;
+
+	if (this->summaryInterval == 0 || now - this->summaryTime < std::chrono::seconds(this->summaryInterval)) {
+		return;
+	}
+	this->PrintSummary(output, std::chrono::duration<double>(now - this->summaryTime).count());
+	this->ResetSummary(now);
+}
+
+void ExampleLoopProfiler::PrintSummary(std::ostream& output, const double seconds) const {
+	double total = 0.0;
+	for (uint32_t phase = 0; phase < PHASE_COUNT; phase++) {
+		total += this->summaryPhases[phase];
+	}
+	if (total <= 0.0 || this->summaryIterations == 0) {
+		return;
+	}
+
+	// The share of each phase in the wall time, the parts of fpTick after it
+	char text[128];
+	snprintf(text, sizeof(text), "FYI: Main loop. rate=[%.0f it/s], iteration=[%.2f us]", (double)this->summaryIterations / seconds, total / (double)this->summaryIterations / 1000.0);
+	std::string line = text;
+	for (uint32_t phase = 0; phase < PHASE_COUNT; phase++) {
+		snprintf(text, sizeof(text), ", %s=[%.1f%%", EXAMPLE_PHASE_NAMES[phase], this->summaryPhases[phase] * 100.0 / total);
+		line += text;
+		if (phase == PHASE_TICK) {
+			for (uint32_t part = 0; part < TICK_PART_COUNT; part++) {
+				snprintf(text, sizeof(text), "%s%s %.1f%%", part == 0 ? ": " : ", ", EXAMPLE_TICK_PART_NAMES[part], this->summaryTickParts[part] * 100.0 / total);
+				line += text;
+			}
+		}
+		line += "]";
+	}
+	output << line << std::endl;
+}
+
+void ExampleLoopProfiler::Register(ExampleMetricsRegistry& registry) {
+	registry.AddCounter("bacnet_loop_iterations_total", "Iterations of the main loop.", "", &this->iterationsTotal);
+	registry.AddGauge("bacnet_loop_iterations_per_second", "Iterations of the main loop per second, over the last second.", "", &this->iterationsPerSecond);
+	// The phases add up to the wall time of the main loop, fpTick is split into its parts
+	for (uint32_t phase = 0; phase < PHASE_COUNT; phase++) {
+		if (phase == PHASE_TICK) {
+			for (uint32_t part = 0; part < TICK_PART_COUNT; part++) {
+				registry.AddCounter("bacnet_loop_phase_nanoseconds_total", "Time spent in each phase of the main loop, fpTick split into the callbacks and the stack.", std::string("phase=\"tick_") + EXAMPLE_TICK_PART_NAMES[part] + "\"", &this->tickPartNanoseconds[part]);
+			}
+			continue;
+		}
+		registry.AddCounter("bacnet_loop_phase_nanoseconds_total", "Time spent in each phase of the main loop, fpTick split into the callbacks and the stack.", std::string("phase=\"") + EXAMPLE_PHASE_NAMES[phase] + "\"", &this->phaseNanoseconds[phase]);
+	}
+}
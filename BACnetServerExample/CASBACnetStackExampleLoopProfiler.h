@@ -0,0 +1,131 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleLoopProfiler.h
+ *
+ * Where the main loop spends its time: the iterations per second and the
+ * time of each phase of an iteration (warm start, clock, fpTick, virtual
+ * router, metrics, user input, database, point notifications and sleep).
+ * The time of fpTick is split into the receive, send, property and other
+ * callbacks, and the stack itself.
+ *
+ * The main loop calls Lap at the end of each phase. A Lap is one read of the
+ * tick counter (ExampleReadTicks), the time since the previous Lap goes to
+ * the phase, so the phases add up to the wall time of the loop.
+ *
+ * The callback time comes from the sampled callback timers
+ * (CASBACnetStackExampleCallbackLatency.h) scaled by the sample period, so
+ * it is an estimate. The stack time is the rest of fpTick. The callbacks
+ * called outside of fpTick, such as a text message sent with a key, are
+ * counted in fpTick too. With EXAMPLE_CALLBACK_TIMERS=0 all of fpTick is
+ * counted as stack time.
+ *
+ * About once per PUBLISH_INTERVAL the ticks are converted to nanoseconds,
+ * with the rate of the tick counter measured since the profiler was
+ * created, and added to the metrics. A one line summary is printed every
+ * summary interval.
+ *
+ * Main loop only, not thread safe.
+*/
+
+#ifndef __CASBACnetStackExampleLoopProfiler_h__
+#define __CASBACnetStackExampleLoopProfiler_h__
+
+#include <stdint.h>
+#include <chrono>
+#include <ostream>
+
+#include "CASBACnetStackExampleCallbackLatency.h"
+#include "CASBACnetStackExampleMetrics.h"
+
+class ExampleLoopProfiler
+{
+	public:
+		// In the order of the main loop
+		enum Phase {
+			PHASE_WARM_START,
+			PHASE_CLOCK,
+			PHASE_TICK,
+			PHASE_ROUTER,
+			PHASE_METRICS,
+			PHASE_USER_INPUT,
+			PHASE_DATABASE,
+			PHASE_NOTIFY,
+			PHASE_SLEEP,
+			PHASE_COUNT
+		};
+		// The parts of PHASE_TICK
+		enum TickPart {
+			TICK_RECEIVE,
+			TICK_SEND,
+			TICK_PROPERTY,
+			TICK_OTHER_CALLBACKS,
+			TICK_STACK,
+			TICK_PART_COUNT
+		};
+
+		static const uint32_t PUBLISH_INTERVAL = 1000; // Milliseconds
+		static const uint32_t DEFAULT_SUMMARY_INTERVAL = 60; // Seconds
+
+		ExampleLoopProfiler();
+
+		// Seconds between the one line summaries, 0 for none
+		void SetSummaryInterval(const uint32_t seconds) {
+			this->summaryInterval = seconds;
+		}
+
+		// Before the first iteration
+		void Start(const ExampleCallbackLatency& latency);
+
+		// At the end of each phase
+		void Lap(const Phase phase) {
+			const uint64_t now = ExampleReadTicks();
+			this->ticks[phase] += now - this->last;
+			this->last = now;
+		}
+
+		// At the end of each iteration, after the last Lap. Publishes the metrics and prints the summary when due.
+		void EndIteration(const ExampleCallbackLatency& latency, std::ostream& output) {
+			this->iterations++;
+			if (this->last - this->publishTicks >= this->publishIntervalTicks) {
+				this->Publish(latency, output);
+			}
+		}
+
+		static TickPart GetTickPart(const uint32_t callback);
+
+		void Register(ExampleMetricsRegistry& registry);
+
+	private:
+		void Publish(const ExampleCallbackLatency& latency, std::ostream& output);
+		void PrintSummary(std::ostream& output, const double seconds) const;
+		void ResetSummary(const std::chrono::steady_clock::time_point& now);
+
+		// Since the last Publish, in ticks
+		uint64_t ticks[PHASE_COUNT];
+		uint64_t iterations;
+		uint64_t last; // Ticks at the last Lap
+
+		uint64_t publishTicks;
+		uint64_t publishIntervalTicks;
+		std::chrono::steady_clock::time_point publishTime;
+		uint64_t callbackTicks[ExampleServerMetrics::CALLBACK_COUNT]; // ExampleCallbackLatency::GetCallbackTicks at the last Publish
+
+		// Rate of the tick counter
+		uint64_t startTicks;
+		std::chrono::steady_clock::time_point startTime;
+
+		// Since the last summary, in nanoseconds
+		uint32_t summaryInterval;
+		std::chrono::steady_clock::time_point summaryTime;
+		uint64_t summaryIterations;
+		double summaryPhases[PHASE_COUNT];
+		double summaryTickParts[TICK_PART_COUNT];
+
+		ExampleMetricCounter iterationsTotal;
+		ExampleMetricGauge iterationsPerSecond;
+		ExampleMetricCounter phaseNanoseconds[PHASE_COUNT]; // PHASE_TICK is not registered, its parts are
+		ExampleMetricCounter tickPartNanoseconds[TICK_PART_COUNT];
+};
+
+#endif // __CASBACnetStackExampleLoopProfiler_h__
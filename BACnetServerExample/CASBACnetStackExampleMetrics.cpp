@@ -0,0 +1,258 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleMetrics.cpp
+ *
+ * See CASBACnetStackExampleMetrics.h
+*/
+
+#include "CASBACnetStackExampleMetrics.h"
+
+#include <stdio.h>
+
+static const char* EXAMPLE_CALLBACK_NAMES[ExampleServerMetrics::CALLBACK_COUNT] = {
+	"receive_message",
+	"send_message",
+	"get_system_time",
+	"set_system_time",
+	"get_property_bit_string",
+	"get_property_bool",
+	"get_property_character_string",
+	"get_property_date",
+	"get_property_double",
+	"get_property_enumerated",
+	"get_property_octet_string",
+	"get_property_signed_integer",
+	"get_property_real",
+	"get_property_time",
+	"get_property_unsigned_integer",
+	"set_property_bit_string",
+	"set_property_bool",
+	"set_property_character_string",
+	"set_property_date",
+	"set_property_double",
+	"set_property_enumerated",
+	"set_property_null",
+	"set_property_object_identifier",
+	"set_property_octet_string",
+	"set_property_signed_integer",
+	"set_property_real",
+	"set_property_time",
+	"set_property_unsigned_integer",
+	"create_object",
+	"delete_object",
+	"reinitialize_device",
+	"device_communication_control",
+	"text_message",
+	"log_debug_message"
+};
+
+static const char* EXAMPLE_DROP_NAMES[ExampleServerMetrics::DROP_COUNT] = {
+	"invalid_address",
+	"virtual_network",
+	"send_failed"
+};
+
+// BACnetConfirmedServiceChoice
+static const char* EXAMPLE_CONFIRMED_SERVICE_NAMES[ExampleServerMetrics::CONFIRMED_SERVICE_COUNT] = {
+	"acknowledge_alarm",
+	"confirmed_cov_notification",
+	"confirmed_event_notification",
+	"get_alarm_summary",
+	"get_enrollment_summary",
+	"subscribe_cov",
+	"atomic_read_file",
+	"atomic_write_file",
+	"add_list_element",
+	"remove_list_element",
+	"create_object",
+	"delete_object",
+	"read_property",
+	"read_property_conditional",
+	"read_property_multiple",
+	"write_property",
+	"write_property_multiple",
+	"device_communication_control",
+	"confirmed_private_transfer",
+	"confirmed_text_message",
+	"reinitialize_device",
+	"vt_open",
+	"vt_close",
+	"vt_data",
+	"authenticate",
+	"request_key",
+	"read_range",
+	"life_safety_operation",
+	"subscribe_cov_property",
+	"get_event_information",
+	"subscribe_cov_property_multiple",
+	"confirmed_cov_notification_multiple",
+	"confirmed_audit_notification",
+	"audit_log_query"
+};
+
+// BACnetUnconfirmedServiceChoice
+static const char* EXAMPLE_UNCONFIRMED_SERVICE_NAMES[ExampleServerMetrics::UNCONFIRMED_SERVICE_COUNT] = {
+	"i_am",
+	"i_have",
+	"unconfirmed_cov_notification",
+	"unconfirmed_event_notification",
+	"unconfirmed_private_transfer",
+	"unconfirmed_text_message",
+	"time_synchronization",
+	"who_has",
+	"who_is",
+	"utc_time_synchronization",
+	"write_group",
+	"unconfirmed_cov_notification_multiple",
+	"unconfirmed_audit_notification",
+	"who_am_i",
+	"you_are"
+};
+
+ExampleMetricHistogram::ExampleMetricHistogram() {
+	for (uint32_t bucket = 0; bucket <= BUCKET_COUNT; bucket++) {
+		this->buckets[bucket].store(0, std::memory_order_relaxed);
+	}
+	this->count.store(0, std::memory_order_relaxed);
+	this->sum.store(0, std::memory_order_relaxed);
+}
+
+void ExampleMetricsRegistry::AddCounter(const std::string& name, const std::string& help, const std::string& labels, const ExampleMetricCounter* counter, const bool hideZero) {
+	this->Add(name, help, labels, counter, NULL, NULL, hideZero);
+}
+
+void ExampleMetricsRegistry::AddGauge(const std::string& name, const std::string& help, const std::string& labels, const ExampleMetricGauge* gauge) {
+	this->Add(name, help, labels, NULL, gauge, NULL, false);
+}
+
+void ExampleMetricsRegistry::AddHistogram(const std::string& name, const std::string& help, const std::string& labels, const ExampleMetricHistogram* histogram) {
+	this->Add(name, help, labels, NULL, NULL, histogram, false);
+}
+
+void ExampleMetricsRegistry::Add(const std::string& name, const std::string& help, const std::string& labels, const ExampleMetricCounter* counter, const ExampleMetricGauge* gauge, const ExampleMetricHistogram* histogram, const bool hideZero) {
+	Entry entry;
+	entry.name = name;
+	entry.help = help;
+	entry.labels = labels;
+	entry.counter = counter;
+	entry.gauge = gauge;
+	entry.histogram = histogram;
+	entry.hideZero = hideZero;
+	this->entries.push_back(entry);
+}
+
+void ExampleMetricsRegistry::Write(std::string& output) const {
+	char number[32];
+	const std::string* lastName = NULL;
+	for (std::vector<Entry>::const_iterator itr = this->entries.begin(); itr != this->entries.end(); itr++) {
+		if (itr->hideZero && itr->counter != NULL && itr->counter->Get() == 0) {
+			continue;
+		}
+		// HELP and TYPE once per metric, before its first series
+		if (lastName == NULL || *lastName != itr->name) {
+			lastName = &itr->name;
+			output += "# HELP " + itr->name + " " + itr->help + "\n";
+			output += "# TYPE " + itr->name + (itr->counter != NULL ? " counter\n" : itr->gauge != NULL ? " gauge\n" : " histogram\n");
+		}
+
+		if (itr->histogram == NULL) {
+			output += itr->name;
+			if (!itr->labels.empty()) {
+				output += "{" + itr->labels + "}";
+			}
+			if (itr->counter != NULL) {
+				snprintf(number, sizeof(number), " %llu\n", (unsigned long long)itr->counter->Get());
+			}
+			else {
+				snprintf(number, sizeof(number), " %lld\n", (long long)itr->gauge->Get());
+			}
+			output += number;
+			continue;
+		}
+
+		// Cumulative buckets, the bounds and the sum in seconds
+		const std::string labels = itr->labels.empty() ? std::string() : itr->labels + ",";
+		uint64_t cumulative = 0;
+		for (uint32_t bucket = 0; bucket <= ExampleMetricHistogram::BUCKET_COUNT; bucket++) {
+			cumulative += itr->histogram->GetBucket(bucket);
+			if (bucket < ExampleMetricHistogram::BUCKET_COUNT) {
+				snprintf(number, sizeof(number), "%g", (double)ExampleMetricHistogram::GetBucketBound(bucket) / 1e9);
+			}
+			else {
+				snprintf(number, sizeof(number), "+Inf");
+			}
+			output += itr->name + "_bucket{" + labels + "le=\"" + number + "\"}";
+			snprintf(number, sizeof(number), " %llu\n", (unsigned long long)cumulative);
+			output += number;
+		}
+		const std::string braces = itr->labels.empty() ? std::string() : "{" + itr->labels + "}";
+		snprintf(number, sizeof(number), " %.9f\n", (double)itr->histogram->GetSum() / 1e9);
+		output += itr->name + "_sum" + braces + number;
+		snprintf(number, sizeof(number), " %llu\n", (unsigned long long)itr->histogram->GetCount());
+		output += itr->name + "_count" + braces + number;
+	}
+}
+
+const char* ExampleServerMetrics::GetCallbackName(const uint32_t callback) {
+	return callback < CALLBACK_COUNT ? EXAMPLE_CALLBACK_NAMES[callback] : "unknown";
+}
+
+void ExampleServerMetrics::CountRequest(const ExampleNpdu& npdu) {
+	if ((npdu.control & NPDU_CONTROL_NETWORK_MESSAGE) != 0) {
+		return;
+	}
+	const uint8_t type = npdu.data[0] & APDU_TYPE_MASK;
+	if (type == APDU_CONFIRMED_REQUEST) {
+		// The sequence number and window size of a segmented request come before the service choice
+		const uint16_t offset = (npdu.data[0] & APDU_SEGMENTED_MESSAGE) != 0 ? 5 : 3;
+		if (npdu.dataLength > offset) {
+			const uint8_t service = npdu.data[offset];
+			this->confirmedRequests[service < CONFIRMED_SERVICE_COUNT ? service : CONFIRMED_SERVICE_COUNT].Increment();
+		}
+	}
+	else if (type == APDU_UNCONFIRMED_REQUEST && npdu.dataLength > 1) {
+		const uint8_t service = npdu.data[1];
+		this->unconfirmedRequests[service < UNCONFIRMED_SERVICE_COUNT ? service : UNCONFIRMED_SERVICE_COUNT].Increment();
+	}
+}
+
+void ExampleServerMetrics::Register(ExampleMetricsRegistry& registry) {
+	registry.AddCounter("bacnet_packets_received_total", "BACnet/IP messages received and given to the stack.", "", &this->packetsReceived);
+	registry.AddCounter("bacnet_packets_sent_total", "BACnet/IP messages sent.", "", &this->packetsSent);
+	registry.AddCounter("bacnet_bytes_received_total", "Bytes of the BACnet/IP messages received and given to the stack.", "", &this->bytesReceived);
+	registry.AddCounter("bacnet_bytes_sent_total", "Bytes of the BACnet/IP messages sent.", "", &this->bytesSent);
+	for (uint32_t drop = 0; drop < DROP_COUNT; drop++) {
+		registry.AddCounter("bacnet_packets_dropped_total", "BACnet/IP messages dropped, by reason.", std::string("reason=\"") + EXAMPLE_DROP_NAMES[drop] + "\"", &this->drops[drop]);
+	}
+
+	// Only the services that were requested at least once
+	for (uint32_t service = 0; service <= CONFIRMED_SERVICE_COUNT; service++) {
+		const char* name = service < CONFIRMED_SERVICE_COUNT ? EXAMPLE_CONFIRMED_SERVICE_NAMES[service] : "other";
+		registry.AddCounter("bacnet_requests_total", "Requests received, by service.", std::string("type=\"confirmed\",service=\"") + name + "\"", &this->confirmedRequests[service], true);
+	}
+	for (uint32_t service = 0; service <= UNCONFIRMED_SERVICE_COUNT; service++) {
+		const char* name = service < UNCONFIRMED_SERVICE_COUNT ? EXAMPLE_UNCONFIRMED_SERVICE_NAMES[service] : "other";
+		registry.AddCounter("bacnet_requests_total", "Requests received, by service.", std::string("type=\"unconfirmed\",service=\"") + name + "\"", &this->unconfirmedRequests[service], true);
+	}
+
+	for (uint32_t callback = 0; callback < CALLBACK_COUNT; callback++) {
+		registry.AddCounter("bacnet_callbacks_total", "Calls of the callbacks registered with the stack, by callback.", std::string("callback=\"") + EXAMPLE_CALLBACK_NAMES[callback] + "\"", &this->callbacks[callback]);
+	}
+
+	// Only the error codes that were returned at least once
+	char errorCode[16];
+	for (uint32_t code = 0; code <= ERROR_CODE_COUNT; code++) {
+		if (code < ERROR_CODE_COUNT) {
+			snprintf(errorCode, sizeof(errorCode), "%u", code);
+		}
+		else {
+			snprintf(errorCode, sizeof(errorCode), "other");
+		}
+		registry.AddCounter("bacnet_callback_errors_total", "Errors returned to the stack through errorCode, by BACnet error code.", std::string("error_code=\"") + errorCode + "\"", &this->errors[code], true);
+	}
+
+	registry.AddHistogram("bacnet_tick_duration_seconds", "Duration of fpTick, the callbacks called by the stack included.", "", &this->tickDuration);
+	registry.AddGauge("bacnet_hosted_devices", "Devices hosted next to the example device.", "", &this->hostedDevices);
+	registry.AddGauge("bacnet_virtual_network_pending_iam", "I-Am responses of the virtual router waiting to be sent.", "", &this->pendingIAm);
+}
@@ -0,0 +1,231 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleMetrics.h
+ *
+ * Runtime metrics of the server: counters, gauges and histograms, and a
+ * registry that writes them in the Prometheus text format (version 0.0.4)
+ * for the scrape endpoint (CASBACnetStackExampleMetricsServer.h).
+ *
+ * The metrics are updated on the hot paths (the message and property
+ * callbacks), so they are plain relaxed atomics with a single writer, the
+ * main loop: an update is a load and a store, no lock and no read-modify-
+ * write instruction. They can be read from any thread, a reader sees each
+ * value whole but not the values of several metrics at the same instant.
+ *
+ * The registry does not own the metrics, it keeps their name, help text and
+ * labels. ExampleServerMetrics holds the metrics of the example server and
+ * registers them.
+*/
+
+#ifndef __CASBACnetStackExampleMetrics_h__
+#define __CASBACnetStackExampleMetrics_h__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "CASBACnetStackExampleNpdu.h"
+
+class ExampleMetricCounter
+{
+	public:
+		ExampleMetricCounter() : value(0) {
+		}
+		// Main loop only
+		void Add(const uint64_t count) {
+			this->value.store(this->value.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+		}
+		void Increment() {
+			this->Add(1);
+		}
+		uint64_t Get() const {
+			return this->value.load(std::memory_order_relaxed);
+		}
+
+	private:
+		std::atomic<uint64_t> value;
+};
+
+class ExampleMetricGauge
+{
+	public:
+		ExampleMetricGauge() : value(0) {
+		}
+		void Set(const int64_t value) {
+			this->value.store(value, std::memory_order_relaxed);
+		}
+		int64_t Get() const {
+			return this->value.load(std::memory_order_relaxed);
+		}
+
+	private:
+		std::atomic<int64_t> value;
+};
+
+// Durations in nanoseconds. The upper bounds of the buckets double from 1 us to 2^(BUCKET_COUNT - 1) us,
+// one more bucket takes the longer durations.
+class ExampleMetricHistogram
+{
+	public:
+		static const uint32_t BUCKET_COUNT = 20; // Up to 524 ms
+
+		ExampleMetricHistogram();
+
+		// Main loop only
+		void Record(const uint64_t nanoseconds) {
+			uint32_t bucket = 0;
+			while (bucket < BUCKET_COUNT && nanoseconds > ExampleMetricHistogram::GetBucketBound(bucket)) {
+				bucket++;
+			}
+			this->buckets[bucket].store(this->buckets[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			this->count.store(this->count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			this->sum.store(this->sum.load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+		}
+
+		static uint64_t GetBucketBound(const uint32_t bucket) {
+			return (uint64_t)1000 << bucket;
+		}
+		// Not cumulative, bucket BUCKET_COUNT has the durations longer than the last bound
+		uint64_t GetBucket(const uint32_t bucket) const {
+			return this->buckets[bucket].load(std::memory_order_relaxed);
+		}
+		uint64_t GetCount() const {
+			return this->count.load(std::memory_order_relaxed);
+		}
+		uint64_t GetSum() const {
+			return this->sum.load(std::memory_order_relaxed);
+		}
+
+	private:
+		std::atomic<uint64_t> buckets[BUCKET_COUNT + 1];
+		std::atomic<uint64_t> count;
+		std::atomic<uint64_t> sum; // Nanoseconds
+};
+
+class ExampleMetricsRegistry
+{
+	public:
+		// Several series of a metric share its name, they have to be added one after the other. The help text
+		// of the first one is used. labels is the text between the braces (name="value",...), empty for none.
+		// Series with hideZero are left out of the output while they are 0.
+		void AddCounter(const std::string& name, const std::string& help, const std::string& labels, const ExampleMetricCounter* counter, const bool hideZero = false);
+		void AddGauge(const std::string& name, const std::string& help, const std::string& labels, const ExampleMetricGauge* gauge);
+		void AddHistogram(const std::string& name, const std::string& help, const std::string& labels, const ExampleMetricHistogram* histogram);
+
+		size_t GetCount() const {
+			return this->entries.size();
+		}
+
+		// Appends all the metrics in the Prometheus text format
+		void Write(std::string& output) const;
+
+	private:
+		struct Entry {
+			std::string name;
+			std::string help;
+			std::string labels;
+			const ExampleMetricCounter* counter;
+			const ExampleMetricGauge* gauge;
+			const ExampleMetricHistogram* histogram;
+			bool hideZero;
+		};
+
+		void Add(const std::string& name, const std::string& help, const std::string& labels, const ExampleMetricCounter* counter, const ExampleMetricGauge* gauge, const ExampleMetricHistogram* histogram, const bool hideZero);
+
+		std::vector<Entry> entries;
+};
+
+// The metrics of the example server
+class ExampleServerMetrics
+{
+	public:
+		// The callbacks registered with the stack, in the order of RegisterCallbacks
+		enum Callback {
+			CALLBACK_RECEIVE_MESSAGE,
+			CALLBACK_SEND_MESSAGE,
+			CALLBACK_GET_SYSTEM_TIME,
+			CALLBACK_SET_SYSTEM_TIME,
+			CALLBACK_GET_PROPERTY_BIT_STRING,
+			CALLBACK_GET_PROPERTY_BOOL,
+			CALLBACK_GET_PROPERTY_CHARACTER_STRING,
+			CALLBACK_GET_PROPERTY_DATE,
+			CALLBACK_GET_PROPERTY_DOUBLE,
+			CALLBACK_GET_PROPERTY_ENUMERATED,
+			CALLBACK_GET_PROPERTY_OCTET_STRING,
+			CALLBACK_GET_PROPERTY_SIGNED_INTEGER,
+			CALLBACK_GET_PROPERTY_REAL,
+			CALLBACK_GET_PROPERTY_TIME,
+			CALLBACK_GET_PROPERTY_UNSIGNED_INTEGER,
+			CALLBACK_SET_PROPERTY_BIT_STRING,
+			CALLBACK_SET_PROPERTY_BOOL,
+			CALLBACK_SET_PROPERTY_CHARACTER_STRING,
+			CALLBACK_SET_PROPERTY_DATE,
+			CALLBACK_SET_PROPERTY_DOUBLE,
+			CALLBACK_SET_PROPERTY_ENUMERATED,
+			CALLBACK_SET_PROPERTY_NULL,
+			CALLBACK_SET_PROPERTY_OBJECT_IDENTIFIER,
+			CALLBACK_SET_PROPERTY_OCTET_STRING,
+			CALLBACK_SET_PROPERTY_SIGNED_INTEGER,
+			CALLBACK_SET_PROPERTY_REAL,
+			CALLBACK_SET_PROPERTY_TIME,
+			CALLBACK_SET_PROPERTY_UNSIGNED_INTEGER,
+			CALLBACK_CREATE_OBJECT,
+			CALLBACK_DELETE_OBJECT,
+			CALLBACK_REINITIALIZE_DEVICE,
+			CALLBACK_DEVICE_COMMUNICATION_CONTROL,
+			CALLBACK_TEXT_MESSAGE,
+			CALLBACK_LOG_DEBUG_MESSAGE,
+			CALLBACK_COUNT
+		};
+
+		// Why a message was not received or sent
+		enum Drop {
+			DROP_INVALID_ADDRESS, // The address of the sender could not be converted
+			DROP_VIRTUAL_NETWORK, // For a device on the virtual network that is not hosted
+			DROP_SEND_FAILED,
+			DROP_COUNT
+		};
+
+		// BACnet service choices (clause 21) with a name, the others are counted as "other"
+		static const uint8_t CONFIRMED_SERVICE_COUNT = 34;
+		static const uint8_t UNCONFIRMED_SERVICE_COUNT = 15;
+		// The error codes of the set property and device management callbacks, the higher ones are counted as "other"
+		static const uint16_t ERROR_CODE_COUNT = 256;
+
+		static const char* GetCallbackName(const uint32_t callback);
+
+		// A received message that the stack processes
+		void CountReceived(const uint16_t length) {
+			this->packetsReceived.Increment();
+			this->bytesReceived.Add(length);
+		}
+		void CountSent(const uint16_t length) {
+			this->packetsSent.Increment();
+			this->bytesSent.Add(length);
+		}
+		// Counts the request in the APDU of the message, if it is one
+		void CountRequest(const ExampleNpdu& npdu);
+		void CountError(const uint32_t errorCode) {
+			this->errors[errorCode < ERROR_CODE_COUNT ? errorCode : ERROR_CODE_COUNT].Increment();
+		}
+
+		void Register(ExampleMetricsRegistry& registry);
+
+		ExampleMetricCounter packetsReceived;
+		ExampleMetricCounter packetsSent;
+		ExampleMetricCounter bytesReceived;
+		ExampleMetricCounter bytesSent;
+		ExampleMetricCounter drops[DROP_COUNT];
+		ExampleMetricCounter confirmedRequests[CONFIRMED_SERVICE_COUNT + 1]; // The last one for the others
+		ExampleMetricCounter unconfirmedRequests[UNCONFIRMED_SERVICE_COUNT + 1];
+		ExampleMetricCounter callbacks[CALLBACK_COUNT];
+		ExampleMetricCounter errors[ERROR_CODE_COUNT + 1];
+		ExampleMetricHistogram tickDuration; // Of fpTick
+		ExampleMetricGauge hostedDevices;
+		ExampleMetricGauge pendingIAm; // Of the virtual router
+};
+
+#endif // __CASBACnetStackExampleMetrics_h__
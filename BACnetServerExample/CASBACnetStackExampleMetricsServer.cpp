@@ -0,0 +1,243 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleMetricsServer.cpp
+ *
+ * See CASBACnetStackExampleMetricsServer.h
+*/
+
+#include "CASBACnetStackExampleMetricsServer.h"
+
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __GNUC__
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif // __GNUC__
+
+// Bound to a reference by std::chrono::milliseconds, so defined here as well
+const uint32_t ExampleMetricsServer::POLL_INTERVAL;
+const uint32_t ExampleMetricsServer::REQUEST_TIMEOUT;
+
+ExampleMetricsServer::ExampleMetricsServer() {
+	this->socket = -1;
+}
+
+ExampleMetricsServer::~ExampleMetricsServer() {
+	this->Close();
+}
+
+void ExampleMetricsServer::Respond(Connection& connection, const char* status, const std::string& body) {
+	char header[160];
+	snprintf(header, sizeof(header), "HTTP/1.1 %s\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: %lu\r\nConnection: close\r\n\r\n", status, (unsigned long)body.size());
+	connection.response = header;
+	connection.response += body;
+	connection.sent = 0;
+}
+
+#ifdef __GNUC__
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif // MSG_NOSIGNAL
+
+static bool ExampleSetNonBlocking(const int socket) {
+	const int flags = fcntl(socket, F_GETFL, 0);
+	return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0 && fcntl(socket, F_SETFD, FD_CLOEXEC) == 0;
+}
+
+bool ExampleMetricsServer::Open(const std::string& address) {
+	if (this->IsOpen()) {
+		return true;
+	}
+
+	// A number is a TCP port, anything else a path
+	char* end = NULL;
+	const long port = strtol(address.c_str(), &end, 10);
+	const bool tcp = !address.empty() && *end == '\0';
+	if (tcp) {
+		if (port <= 0 || port > 65535) {
+			std::cerr << "Error - Invalid metrics port. port=[" << address << "]" << std::endl;
+			return false;
+		}
+		this->socket = ::socket(AF_INET, SOCK_STREAM, 0);
+		if (this->socket < 0) {
+			std::cerr << "Error - Could not open the metrics socket. errno=[" << errno << "]" << std::endl;
+			return false;
+		}
+		const int reuse = 1;
+		setsockopt(this->socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+		struct sockaddr_in local;
+		memset(&local, 0, sizeof(local));
+		local.sin_family = AF_INET;
+		local.sin_port = htons((uint16_t)port);
+		local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (bind(this->socket, (struct sockaddr*)&local, sizeof(local)) != 0) {
+			std::cerr << "Error - Could not bind the metrics socket. port=[" << port << "], errno=[" << errno << "]" << std::endl;
+			this->Close();
+			return false;
+		}
+	}
+	else {
+		struct sockaddr_un local;
+		memset(&local, 0, sizeof(local));
+		if (address.empty() || address.size() >= sizeof(local.sun_path)) {
+			std::cerr << "Error - Invalid metrics socket path. path=[" << address << "]" << std::endl;
+			return false;
+		}
+		this->socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if (this->socket < 0) {
+			std::cerr << "Error - Could not open the metrics socket. errno=[" << errno << "]" << std::endl;
+			return false;
+		}
+		local.sun_family = AF_UNIX;
+		memcpy(local.sun_path, address.c_str(), address.size());
+		// A socket left by a previous run is removed, anything else at the path is left alone and bind fails
+		struct stat status;
+		if (lstat(address.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+			unlink(address.c_str());
+		}
+		if (bind(this->socket, (struct sockaddr*)&local, sizeof(local)) != 0) {
+			std::cerr << "Error - Could not bind the metrics socket. path=[" << address << "], errno=[" << errno << "]" << std::endl;
+			this->Close();
+			return false;
+		}
+		this->unixPath = address;
+	}
+
+	if (!ExampleSetNonBlocking(this->socket) || listen(this->socket, (int)MAX_CONNECTIONS) != 0) {
+		std::cerr << "Error - Could not listen on the metrics socket. errno=[" << errno << "]" << std::endl;
+		this->Close();
+		return false;
+	}
+	this->nextAccept = std::chrono::steady_clock::now();
+	return true;
+}
+
+void ExampleMetricsServer::Close() {
+	for (size_t offset = 0; offset < this->connections.size(); offset++) {
+		close(this->connections[offset].socket);
+	}
+	this->connections.clear();
+	if (this->socket >= 0) {
+		close(this->socket);
+		this->socket = -1;
+	}
+	if (!this->unixPath.empty()) {
+		unlink(this->unixPath.c_str());
+		this->unixPath.clear();
+	}
+}
+
+uint32_t ExampleMetricsServer::Poll(const ExampleMetricsRegistry& registry) {
+	if (!this->IsOpen()) {
+		return 0;
+	}
+	if (this->connections.empty()) {
+		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (now < this->nextAccept) {
+			return 0;
+		}
+		this->nextAccept = now + std::chrono::milliseconds(POLL_INTERVAL);
+	}
+	this->Accept();
+
+	uint32_t scrapes = 0;
+	for (size_t offset = 0; offset < this->connections.size();) {
+		if (this->Serve(this->connections[offset], registry, &scrapes)) {
+			offset++;
+			continue;
+		}
+		close(this->connections[offset].socket);
+		this->connections.erase(this->connections.begin() + offset);
+	}
+	return scrapes;
+}
+
+void ExampleMetricsServer::Accept() {
+	while (this->connections.size() < MAX_CONNECTIONS) {
+		const int socket = accept(this->socket, NULL, NULL);
+		if (socket < 0) {
+			return; // EAGAIN, nothing waiting
+		}
+		if (!ExampleSetNonBlocking(socket)) {
+			close(socket);
+			continue;
+		}
+		Connection connection;
+		connection.socket = socket;
+		connection.opened = std::chrono::steady_clock::now();
+		connection.sent = 0;
+		this->connections.push_back(connection);
+	}
+}
+
+bool ExampleMetricsServer::Serve(Connection& connection, const ExampleMetricsRegistry& registry, uint32_t* scrapes) {
+	if (connection.response.empty()) {
+		char buffer[1024];
+		const ssize_t length = recv(connection.socket, buffer, sizeof(buffer), 0);
+		if (length == 0 || (length < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+			return false;
+		}
+		if (length > 0) {
+			connection.request.append(buffer, (size_t)length);
+		}
+		if (connection.request.find("\r\n\r\n") == std::string::npos) {
+			// Not complete yet
+			return connection.request.size() < MAX_REQUEST_LENGTH && std::chrono::steady_clock::now() - connection.opened < std::chrono::milliseconds(REQUEST_TIMEOUT);
+		}
+
+		if (connection.request.compare(0, 13, "GET /metrics ") == 0 || connection.request.compare(0, 14, "GET /metrics?") == 0) {
+			this->body.clear();
+			registry.Write(this->body);
+			ExampleMetricsServer::Respond(connection, "200 OK", this->body);
+			(*scrapes)++;
+		}
+		else if (connection.request.compare(0, 4, "GET ") == 0) {
+			ExampleMetricsServer::Respond(connection, "404 Not Found", "Not found, the metrics are at /metrics\n");
+		}
+		else {
+			ExampleMetricsServer::Respond(connection, "405 Method Not Allowed", "Only GET is supported\n");
+		}
+	}
+
+	// The response is usually sent in one go, the rest waits for the next Poll
+	const ssize_t length = send(connection.socket, connection.response.data() + connection.sent, connection.response.size() - connection.sent, MSG_NOSIGNAL);
+	if (length < 0) {
+		return (errno == EAGAIN || errno == EWOULDBLOCK) && std::chrono::steady_clock::now() - connection.opened < std::chrono::milliseconds(REQUEST_TIMEOUT);
+	}
+	connection.sent += (size_t)length;
+	return connection.sent < connection.response.size();
+}
+
+#else // __GNUC__
+
+bool ExampleMetricsServer::Open(const std::string& address) {
+	std::cerr << "Error - The metrics endpoint is not supported on this platform. address=[" << address << "]" << std::endl;
+	return false;
+}
+
+void ExampleMetricsServer::Close() {
+}
+
+uint32_t ExampleMetricsServer::Poll(const ExampleMetricsRegistry& registry) {
+	return 0;
+}
+
+void ExampleMetricsServer::Accept() {
+}
+
+bool ExampleMetricsServer::Serve(Connection& connection, const ExampleMetricsRegistry& registry, uint32_t* scrapes) {
+	return false;
+}
+
+#endif // __GNUC__
@@ -0,0 +1,77 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleMetricsServer.h
+ *
+ * Scrape endpoint for the metrics (CASBACnetStackExampleMetrics.h). A tiny
+ * HTTP/1.1 server that answers GET /metrics with the Prometheus text format
+ * and closes the connection after each response.
+ *
+ * It listens on 127.0.0.1 only, or on a Unix domain socket, it is not meant
+ * to be reachable from the BACnet network.
+ *
+ * There is no thread: Poll is called from the main loop and never blocks.
+ * The listening socket is checked every POLL_INTERVAL milliseconds at most,
+ * so the main loop does not make a system call per tick for it. A request
+ * that is not complete within REQUEST_TIMEOUT milliseconds is dropped.
+ *
+ * Only supported with the POSIX sockets (__GNUC__). On other platforms Open
+ * fails.
+*/
+
+#ifndef __CASBACnetStackExampleMetricsServer_h__
+#define __CASBACnetStackExampleMetricsServer_h__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "CASBACnetStackExampleMetrics.h"
+
+class ExampleMetricsServer
+{
+	public:
+		static const uint32_t POLL_INTERVAL = 10; // Milliseconds
+		static const uint32_t REQUEST_TIMEOUT = 2000; // Milliseconds
+		static const size_t MAX_CONNECTIONS = 8;
+		static const size_t MAX_REQUEST_LENGTH = 4096;
+
+		ExampleMetricsServer();
+		~ExampleMetricsServer();
+
+		// address is a TCP port on 127.0.0.1, or the path of a Unix domain socket. A stale socket file at
+		// the path is replaced.
+		bool Open(const std::string& address);
+		void Close();
+		bool IsOpen() const {
+			return this->socket >= 0;
+		}
+
+		// Accepts the new connections and answers the complete requests, without blocking. Returns the
+		// number of scrapes answered.
+		uint32_t Poll(const ExampleMetricsRegistry& registry);
+
+	private:
+		struct Connection {
+			int socket;
+			std::chrono::steady_clock::time_point opened;
+			std::string request;
+			std::string response;
+			size_t sent; // Bytes of response sent, the response is ready when it is not empty
+		};
+
+		void Accept();
+		// Returns false when the connection is done, answered or failed
+		bool Serve(Connection& connection, const ExampleMetricsRegistry& registry, uint32_t* scrapes);
+		static void Respond(Connection& connection, const char* status, const std::string& body);
+
+		int socket;
+		std::string unixPath; // Removed on Close, empty for TCP
+		std::vector<Connection> connections;
+		std::chrono::steady_clock::time_point nextAccept;
+		std::string body; // Kept between scrapes, for its capacity
+};
+
+#endif // __CASBACnetStackExampleMetricsServer_h__
@@ -0,0 +1,353 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleNetworkMonitor.cpp
+ *
+ * See CASBACnetStackExampleNetworkMonitor.h
+*/
+
+#include "CASBACnetStackExampleNetworkMonitor.h"
+
+#include <iostream>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <arpa/inet.h> // inet_pton()
+#include <errno.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif // __linux__
+
+ExampleNetworkMonitor::ExampleNetworkMonitor() {
+	this->socket = -1;
+	this->sequence = 0;
+	this->dumpSequence = 0;
+	this->generation = 0;
+	memset(&this->selected, 0, sizeof(this->selected));
+}
+
+ExampleNetworkMonitor::~ExampleNetworkMonitor() {
+	this->Close();
+}
+
+static void ExampleSubnetMask(const uint8_t prefixLength, uint8_t* mask) {
+	const uint32_t bits = prefixLength == 0 ? 0 : 0xFFFFFFFFu << (32 - (prefixLength > 32 ? 32 : prefixLength));
+	mask[0] = (uint8_t)(bits >> 24);
+	mask[1] = (uint8_t)(bits >> 16);
+	mask[2] = (uint8_t)(bits >> 8);
+	mask[3] = (uint8_t)bits;
+}
+
+bool ExampleNetworkMonitor::Select() {
+	// The interface of the default route with the lowest metric, otherwise the first one that is not loopback
+	const Address* address = NULL;
+	const Route* route = NULL;
+	for (size_t offset = 0; offset < this->routes.size(); offset++) {
+		if (route != NULL && route->priority <= this->routes[offset].priority) {
+			continue;
+		}
+		for (size_t candidate = 0; candidate < this->addresses.size(); candidate++) {
+			if (this->addresses[candidate].interfaceIndex == this->routes[offset].interfaceIndex) {
+				route = &this->routes[offset];
+				address = &this->addresses[candidate];
+				break;
+			}
+		}
+	}
+	for (size_t offset = 0; address == NULL && offset < this->addresses.size(); offset++) {
+		if (this->addresses[offset].address[0] != 127) {
+			address = &this->addresses[offset];
+		}
+	}
+
+	ExampleNetworkInterface networkInterface;
+	memset(&networkInterface, 0, sizeof(networkInterface));
+	if (address != NULL) {
+		networkInterface.interfaceIndex = address->interfaceIndex;
+		memcpy(networkInterface.name, address->name, sizeof(networkInterface.name));
+		memcpy(networkInterface.IPAddress, address->address, 4);
+		ExampleSubnetMask(address->prefixLength, networkInterface.IPSubnetMask);
+		for (size_t offset = 0; offset < 4; offset++) {
+			networkInterface.BroadcastIPAddress[offset] = address->address[offset] | (uint8_t)~networkInterface.IPSubnetMask[offset];
+		}
+		if (address->broadcast[0] != 0 || address->broadcast[1] != 0 || address->broadcast[2] != 0 || address->broadcast[3] != 0) {
+			memcpy(networkInterface.BroadcastIPAddress, address->broadcast, 4);
+		}
+		if (route != NULL) {
+			memcpy(networkInterface.IPDefaultGateway, route->gateway, 4);
+		}
+	}
+	// The DNS servers are only read again when the rest changed
+	memcpy(networkInterface.IPDNSServers, this->selected.IPDNSServers, sizeof(networkInterface.IPDNSServers));
+	networkInterface.IPDNSServerCount = this->selected.IPDNSServerCount;
+	if (this->generation > 0 && memcmp(&networkInterface, &this->selected, sizeof(networkInterface)) == 0) {
+		return false;
+	}
+	this->LoadDNSServers(networkInterface);
+	this->selected = networkInterface;
+	this->generation++;
+	return true;
+}
+
+#ifdef __linux__
+
+void ExampleNetworkMonitor::LoadDNSServers(ExampleNetworkInterface& networkInterface) const {
+	networkInterface.IPDNSServerCount = 0;
+	memset(networkInterface.IPDNSServers, 0, sizeof(networkInterface.IPDNSServers));
+	FILE* file = fopen("/etc/resolv.conf", "r");
+	if (file == NULL) {
+		return;
+	}
+	char line[256];
+	char address[64];
+	while (networkInterface.IPDNSServerCount < ExampleNetworkInterface::MAX_DNS_SERVERS && fgets(line, sizeof(line), file) != NULL) {
+		if (sscanf(line, " nameserver %63s", address) == 1 && inet_pton(AF_INET, address, networkInterface.IPDNSServers[networkInterface.IPDNSServerCount]) == 1) {
+			networkInterface.IPDNSServerCount++;
+		}
+	}
+	fclose(file);
+}
+
+bool ExampleNetworkMonitor::Open() {
+	if (this->IsOpen()) {
+		return true;
+	}
+	this->socket = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+	if (this->socket < 0) {
+		std::cerr << "Error - Could not open the netlink socket. errno=[" << errno << "]" << std::endl;
+		return false;
+	}
+	// Subscribed before the dump, so that no change between the dump and the first Poll is lost
+	struct sockaddr_nl local;
+	memset(&local, 0, sizeof(local));
+	local.nl_family = AF_NETLINK;
+	local.nl_groups = RTMGRP_IPV4_IFADDR | RTMGRP_IPV4_ROUTE;
+	if (bind(this->socket, (struct sockaddr*)&local, sizeof(local)) != 0) {
+		std::cerr << "Error - Could not bind the netlink socket. errno=[" << errno << "]" << std::endl;
+		this->Close();
+		return false;
+	}
+	this->buffer.resize(32768);
+	if (!this->Load()) {
+		this->Close();
+		return false;
+	}
+	this->Select();
+	return true;
+}
+
+void ExampleNetworkMonitor::Close() {
+	if (this->socket >= 0) {
+		close(this->socket);
+	}
+	this->socket = -1;
+	this->dumpSequence = 0;
+	this->addresses.clear();
+	this->routes.clear();
+}
+
+bool ExampleNetworkMonitor::Load() {
+	this->addresses.clear();
+	this->routes.clear();
+	return this->Dump(RTM_GETADDR) && this->Dump(RTM_GETROUTE);
+}
+
+bool ExampleNetworkMonitor::Dump(const uint16_t type) {
+	struct {
+		struct nlmsghdr header;
+		struct rtgenmsg message;
+	} request;
+	memset(&request, 0, sizeof(request));
+	request.header.nlmsg_len = NLMSG_LENGTH(sizeof(request.message));
+	request.header.nlmsg_type = type;
+	request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+	request.header.nlmsg_seq = ++this->sequence;
+	request.message.rtgen_family = AF_INET;
+	struct sockaddr_nl kernel;
+	memset(&kernel, 0, sizeof(kernel));
+	kernel.nl_family = AF_NETLINK;
+	if (sendto(this->socket, &request, request.header.nlmsg_len, 0, (struct sockaddr*)&kernel, sizeof(kernel)) < 0) {
+		std::cerr << "Error - Could not request the network interfaces. errno=[" << errno << "]" << std::endl;
+		return false;
+	}
+
+	// Change events can be read in between the parts of the dump, they are applied the same way
+	this->dumpSequence = request.header.nlmsg_seq;
+	bool done = false;
+	while (!done) {
+		struct pollfd descriptor = { this->socket, POLLIN, 0 };
+		if (poll(&descriptor, 1, 1000) <= 0) {
+			std::cerr << "Error - No reply from netlink while loading the network interfaces" << std::endl;
+			this->dumpSequence = 0;
+			return false;
+		}
+		const ssize_t length = recv(this->socket, &this->buffer[0], this->buffer.size(), 0);
+		if (length < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			std::cerr << "Error - Could not read the network interfaces. errno=[" << errno << "]" << std::endl;
+			this->dumpSequence = 0;
+			return false;
+		}
+		if (!this->ApplyMessages((size_t)length, &done)) {
+			this->dumpSequence = 0;
+			return false;
+		}
+	}
+	this->dumpSequence = 0;
+	return true;
+}
+
+bool ExampleNetworkMonitor::Poll() {
+	if (!this->IsOpen()) {
+		return false;
+	}
+	for (;;) {
+		const ssize_t length = recv(this->socket, &this->buffer[0], this->buffer.size(), MSG_DONTWAIT);
+		if (length >= 0) {
+			this->ApplyMessages((size_t)length, NULL);
+			continue;
+		}
+		if (errno == EINTR) {
+			continue;
+		}
+		if (errno == ENOBUFS) {
+			// The socket overflowed and events were dropped, the cache is loaded again
+			std::cout << "FYI: Network change events were dropped, loading the network interfaces again" << std::endl;
+			if (!this->Load()) {
+				this->Close();
+				return false;
+			}
+			continue;
+		}
+		break; // EAGAIN, nothing left
+	}
+	return this->Select();
+}
+
+bool ExampleNetworkMonitor::ApplyMessages(const size_t length, bool* done) {
+	int remaining = (int)length;
+	for (const struct nlmsghdr* header = (const struct nlmsghdr*)&this->buffer[0]; NLMSG_OK(header, remaining); header = NLMSG_NEXT(header, remaining)) {
+		const bool reply = this->dumpSequence != 0 && header->nlmsg_seq == this->dumpSequence;
+		if (header->nlmsg_type == NLMSG_DONE) {
+			if (reply && done != NULL) {
+				*done = true;
+			}
+		}
+		else if (header->nlmsg_type == NLMSG_ERROR) {
+			if (reply) {
+				std::cerr << "Error - Netlink refused the request for the network interfaces" << std::endl;
+				return false;
+			}
+		}
+		else if (header->nlmsg_type == RTM_NEWADDR || header->nlmsg_type == RTM_DELADDR) {
+			this->ApplyAddress(header);
+		}
+		else if (header->nlmsg_type == RTM_NEWROUTE || header->nlmsg_type == RTM_DELROUTE) {
+			this->ApplyRoute(header);
+		}
+	}
+	return true;
+}
+
+void ExampleNetworkMonitor::ApplyAddress(const struct nlmsghdr* header) {
+	const struct ifaddrmsg* message = (const struct ifaddrmsg*)NLMSG_DATA(header);
+	if (header->nlmsg_len < NLMSG_LENGTH(sizeof(*message)) || message->ifa_family != AF_INET) {
+		return;
+	}
+	Address address;
+	memset(&address, 0, sizeof(address));
+	address.interfaceIndex = message->ifa_index;
+	address.prefixLength = message->ifa_prefixlen;
+	bool hasAddress = false;
+	int remaining = (int)IFA_PAYLOAD(header);
+	for (const struct rtattr* attribute = IFA_RTA(message); RTA_OK(attribute, remaining); attribute = RTA_NEXT(attribute, remaining)) {
+		const size_t size = RTA_PAYLOAD(attribute);
+		// IFA_LOCAL is the address of the interface, IFA_ADDRESS is the peer on point to point links
+		if ((attribute->rta_type == IFA_LOCAL || (attribute->rta_type == IFA_ADDRESS && !hasAddress)) && size == 4) {
+			memcpy(address.address, RTA_DATA(attribute), 4);
+			hasAddress = true;
+		}
+		else if (attribute->rta_type == IFA_BROADCAST && size == 4) {
+			memcpy(address.broadcast, RTA_DATA(attribute), 4);
+		}
+		else if (attribute->rta_type == IFA_LABEL) {
+			strncpy(address.name, (const char*)RTA_DATA(attribute), size < sizeof(address.name) ? size : sizeof(address.name) - 1);
+		}
+	}
+	if (!hasAddress) {
+		return;
+	}
+	for (size_t offset = 0; offset < this->addresses.size(); offset++) {
+		if (this->addresses[offset].interfaceIndex == address.interfaceIndex && memcmp(this->addresses[offset].address, address.address, 4) == 0) {
+			this->addresses.erase(this->addresses.begin() + offset);
+			break;
+		}
+	}
+	if (header->nlmsg_type == RTM_NEWADDR) {
+		this->addresses.push_back(address);
+	}
+}
+
+void ExampleNetworkMonitor::ApplyRoute(const struct nlmsghdr* header) {
+	const struct rtmsg* message = (const struct rtmsg*)NLMSG_DATA(header);
+	// Only the default routes of the main table
+	if (header->nlmsg_len < NLMSG_LENGTH(sizeof(*message)) || message->rtm_family != AF_INET || message->rtm_dst_len != 0 || message->rtm_type != RTN_UNICAST) {
+		return;
+	}
+	Route route;
+	memset(&route, 0, sizeof(route));
+	uint32_t table = message->rtm_table;
+	int remaining = (int)RTM_PAYLOAD(header);
+	for (const struct rtattr* attribute = RTM_RTA(message); RTA_OK(attribute, remaining); attribute = RTA_NEXT(attribute, remaining)) {
+		const size_t size = RTA_PAYLOAD(attribute);
+		if (attribute->rta_type == RTA_GATEWAY && size == 4) {
+			memcpy(route.gateway, RTA_DATA(attribute), 4);
+		}
+		else if (attribute->rta_type == RTA_OIF && size == 4) {
+			memcpy(&route.interfaceIndex, RTA_DATA(attribute), 4);
+		}
+		else if (attribute->rta_type == RTA_PRIORITY && size == 4) {
+			memcpy(&route.priority, RTA_DATA(attribute), 4);
+		}
+		else if (attribute->rta_type == RTA_TABLE && size == 4) {
+			memcpy(&table, RTA_DATA(attribute), 4);
+		}
+	}
+	if (table != RT_TABLE_MAIN || route.interfaceIndex == 0) {
+		return;
+	}
+	for (size_t offset = 0; offset < this->routes.size(); offset++) {
+		if (this->routes[offset].interfaceIndex == route.interfaceIndex && this->routes[offset].priority == route.priority && memcmp(this->routes[offset].gateway, route.gateway, 4) == 0) {
+			this->routes.erase(this->routes.begin() + offset);
+			break;
+		}
+	}
+	if (header->nlmsg_type == RTM_NEWROUTE) {
+		this->routes.push_back(route);
+	}
+}
+
+#else // __linux__
+
+void ExampleNetworkMonitor::LoadDNSServers(ExampleNetworkInterface& networkInterface) const {
+	networkInterface.IPDNSServerCount = 0;
+}
+
+bool ExampleNetworkMonitor::Open() {
+	return false;
+}
+
+void ExampleNetworkMonitor::Close() {
+}
+
+bool ExampleNetworkMonitor::Poll() {
+	return false;
+}
+
+#endif // __linux__
@@ -0,0 +1,107 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleNetworkMonitor.h
+ *
+ * IPv4 interface monitor for the Network Port object (Linux).
+ *
+ * Open dumps the IPv4 addresses and default routes once over an rtnetlink
+ * socket that is also subscribed to the address and route change groups,
+ * and keeps them in a cache. The interface used by the server is selected
+ * from the cache: the one with the default route of lowest metric, or the
+ * first interface that is not loopback. Poll reads the change events that
+ * the kernel queued on the socket since the last call, without blocking,
+ * and reports whether the selected interface changed. Nothing queries the
+ * interfaces again after Open.
+ *
+ * Netlink does not carry the DNS servers, they are read from
+ * /etc/resolv.conf at Open and whenever the selected interface changes.
+ *
+ * Only supported on Linux. On other platforms Open fails.
+*/
+
+#ifndef __CASBACnetStackExampleNetworkMonitor_h__
+#define __CASBACnetStackExampleNetworkMonitor_h__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+struct nlmsghdr;
+
+// The selected interface, in the layout of ExampleDatabaseNetworkPort
+struct ExampleNetworkInterface {
+	static const uint8_t MAX_DNS_SERVERS = 3; // MAXNS of resolv.conf
+
+	uint32_t interfaceIndex; // 0 = no interface with an IPv4 address
+	char name[16];
+	uint8_t IPAddress[4];
+	uint8_t IPSubnetMask[4];
+	uint8_t BroadcastIPAddress[4];
+	uint8_t IPDefaultGateway[4]; // 0.0.0.0 = no default route on this interface
+	uint8_t IPDNSServers[MAX_DNS_SERVERS][4];
+	uint8_t IPDNSServerCount;
+};
+
+class ExampleNetworkMonitor
+{
+	public:
+		ExampleNetworkMonitor();
+		~ExampleNetworkMonitor();
+
+		// Subscribes to the change events and loads the cache. Does nothing if the monitor is already open.
+		bool Open();
+		void Close();
+		bool IsOpen() const {
+			return this->socket >= 0;
+		}
+
+		// Applies the change events queued since the last call. Returns true if the selected interface changed.
+		bool Poll();
+
+		const ExampleNetworkInterface& GetInterface() const {
+			return this->selected;
+		}
+		// Incremented every time the selected interface changes
+		uint32_t GetGeneration() const {
+			return this->generation;
+		}
+
+	private:
+		ExampleNetworkMonitor(const ExampleNetworkMonitor&);
+		ExampleNetworkMonitor& operator=(const ExampleNetworkMonitor&);
+
+		struct Address {
+			uint32_t interfaceIndex;
+			uint8_t prefixLength;
+			uint8_t address[4];
+			uint8_t broadcast[4]; // 0.0.0.0 = not given, computed from the prefix
+			char name[16];
+		};
+		struct Route {
+			uint32_t interfaceIndex;
+			uint32_t priority;
+			uint8_t gateway[4];
+		};
+
+		// Loads the cache again, the events received in between are applied too
+		bool Load();
+		bool Dump(const uint16_t type);
+		// Applies the messages in buffer. done is set at the end of the dump in progress.
+		bool ApplyMessages(const size_t length, bool* done);
+		void ApplyAddress(const struct nlmsghdr* header);
+		void ApplyRoute(const struct nlmsghdr* header);
+		bool Select();
+		void LoadDNSServers(ExampleNetworkInterface& networkInterface) const;
+
+		int socket;
+		uint32_t sequence;
+		uint32_t dumpSequence; // Of the dump in progress, 0 = none
+		uint32_t generation;
+		std::vector<Address> addresses;
+		std::vector<Route> routes;
+		ExampleNetworkInterface selected;
+		std::vector<uint8_t> buffer;
+};
+
+#endif // __CASBACnetStackExampleNetworkMonitor_h__
@@ -0,0 +1,113 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleNpdu.h
+ *
+ * Decodes the BVLC (Annex J) and NPDU (clause 6) header of a received
+ * BACnet/IP message, for the application code that looks at the messages
+ * before the stack does: the virtual router and the metrics. The stack
+ * decodes the message again, nothing here replaces it.
+*/
+
+#ifndef __CASBACnetStackExampleNpdu_h__
+#define __CASBACnetStackExampleNpdu_h__
+
+#include <stdint.h>
+#include <stddef.h>
+
+// BVLC (Annex J)
+static const uint8_t BVLC_TYPE_BACNET_IP = 0x81;
+static const uint8_t BVLC_FORWARDED_NPDU = 0x04;
+static const uint8_t BVLC_ORIGINAL_UNICAST_NPDU = 0x0A;
+static const uint8_t BVLC_ORIGINAL_BROADCAST_NPDU = 0x0B;
+
+// NPDU (clause 6)
+static const uint8_t NPDU_VERSION = 0x01;
+static const uint8_t NPDU_CONTROL_NETWORK_MESSAGE = 0x80;
+static const uint8_t NPDU_CONTROL_DESTINATION = 0x20;
+static const uint8_t NPDU_CONTROL_SOURCE = 0x08;
+static const uint16_t NPDU_GLOBAL_BROADCAST = 0xFFFF;
+
+// APDU (clause 20), the type is the high nibble of the first byte
+static const uint8_t APDU_CONFIRMED_REQUEST = 0x00;
+static const uint8_t APDU_UNCONFIRMED_REQUEST = 0x10;
+static const uint8_t APDU_SIMPLE_ACK = 0x20;
+static const uint8_t APDU_COMPLEX_ACK = 0x30;
+static const uint8_t APDU_SEGMENT_ACK = 0x40;
+static const uint8_t APDU_TYPE_MASK = 0xF0;
+static const uint8_t APDU_SEGMENTED_MESSAGE = 0x08;
+static const uint8_t APDU_MORE_FOLLOWS = 0x04;
+
+struct ExampleNpdu {
+	uint8_t control;
+	bool hasDestination;
+	uint16_t destinationNetwork;
+	uint8_t destinationLength; // 0 = broadcast on destinationNetwork
+	const uint8_t* destinationAddress;
+	uint16_t sourceNetwork; // 0 = the local network
+	uint8_t sourceLength;
+	const uint8_t* sourceAddress;
+	// The APDU, or the network layer message if control has NPDU_CONTROL_NETWORK_MESSAGE. At least one byte.
+	const uint8_t* data;
+	uint16_t dataLength;
+};
+
+// Returns false for the BVLC messages without an NPDU (BDT, FDT, ...) and for the messages too short for their header
+inline bool ExampleDecodeNpdu(const uint8_t* message, const uint16_t length, ExampleNpdu* npdu) {
+	if (length < 6 || message[0] != BVLC_TYPE_BACNET_IP) {
+		return false;
+	}
+	size_t offset;
+	if (message[1] == BVLC_ORIGINAL_UNICAST_NPDU || message[1] == BVLC_ORIGINAL_BROADCAST_NPDU) {
+		offset = 4;
+	}
+	else if (message[1] == BVLC_FORWARDED_NPDU) {
+		offset = 10; // The B/IP address of the original sender comes first
+	}
+	else {
+		return false;
+	}
+
+	if (length < offset + 2 || message[offset] != NPDU_VERSION) {
+		return false;
+	}
+	npdu->control = message[offset + 1];
+	offset += 2;
+	npdu->hasDestination = false;
+	npdu->destinationNetwork = 0;
+	npdu->destinationLength = 0;
+	npdu->destinationAddress = NULL;
+	if ((npdu->control & NPDU_CONTROL_DESTINATION) != 0) {
+		if (length < offset + 3) {
+			return false;
+		}
+		npdu->hasDestination = true;
+		npdu->destinationNetwork = (uint16_t)((message[offset] << 8) | message[offset + 1]);
+		npdu->destinationLength = message[offset + 2];
+		npdu->destinationAddress = message + offset + 3;
+		offset += 3 + npdu->destinationLength;
+	}
+	npdu->sourceNetwork = 0;
+	npdu->sourceLength = 0;
+	npdu->sourceAddress = NULL;
+	if ((npdu->control & NPDU_CONTROL_SOURCE) != 0) {
+		if (length < offset + 3) {
+			return false;
+		}
+		npdu->sourceNetwork = (uint16_t)((message[offset] << 8) | message[offset + 1]);
+		npdu->sourceLength = message[offset + 2];
+		npdu->sourceAddress = message + offset + 3;
+		offset += 3 + npdu->sourceLength;
+	}
+	if (npdu->hasDestination) {
+		offset++; // Hop count
+	}
+	if (length < offset + 1) {
+		return false;
+	}
+	npdu->data = message + offset;
+	npdu->dataLength = (uint16_t)(length - offset);
+	return true;
+}
+
+#endif // __CASBACnetStackExampleNpdu_h__
@@ -0,0 +1,329 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleObjectDescriptors.h
+ *
+ * Compile time descriptors for the properties that are stored directly in a
+ * member of an example database object. Each property is declared once with
+ * its property identifier, BACnet data type, storage member and flags. The
+ * get/set callback dispatch and the writable/subscribable setup calls are
+ * generated from these declarations by the templates below.
+ *
+ * Properties with behaviour (priority arrays, out of service, arrays, strings)
+ * are still handled by hand in the callbacks.
+*/
+
+#ifndef __CASBACnetStackExampleObjectDescriptors_h__
+#define __CASBACnetStackExampleObjectDescriptors_h__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "CASBACnetStackExampleConstants.h"
+#include "CASBACnetStackExampleDatabase.h"
+
+// Write validators
+// ---------------------------------------------------------------------------
+// Called before a value is stored. Return false and set the errorCode to reject the write.
+template <typename ObjectT, typename StorageT>
+inline bool ExampleAcceptAnyValue(const ObjectT& object, const StorageT value, uint32_t* errorCode) {
+	return true;
+}
+
+inline bool ExampleValidateAnalogValuePresentValue(const ExampleDatabaseAnalogValue& object, const float value, uint32_t* errorCode) {
+	if (value < object.minPresValue || value > object.maxPresValue) {
+		*errorCode = CASBACnetStackExampleConstants::ERROR_VALUE_OUT_OF_RANGE;
+		return false;
+	}
+	return true;
+}
+
+inline bool ExampleValidateMultiStateValuePresentValue(const ExampleDatabaseMultiStateValue& object, const uint32_t value, uint32_t* errorCode) {
+	if (value == 0 || value > object.stateText.size()) {
+		*errorCode = CASBACnetStackExampleConstants::ERROR_VALUE_OUT_OF_RANGE;
+		return false;
+	}
+	return true;
+}
+
+inline bool ExampleValidateUTCOffset(const ExampleDatabaseDevice& object, const int value, uint32_t* errorCode) {
+	if (value < -1440 || value > 1440) {
+		*errorCode = CASBACnetStackExampleConstants::ERROR_VALUE_OUT_OF_RANGE;
+		return false;
+	}
+	return true;
+}
+
+// Property descriptor
+// ---------------------------------------------------------------------------
+// DataType is one of CASBACnetStackExampleConstants::DATA_TYPE_*. The value passed through the
+// callback is converted to and from the storage type of the member (for example a bool
+// Binary Value present value is served as an enumerated). Members stored as an ExampleSnapshotPoint
+// are validated and converted using the type of the value they hold.
+template <
+	uint32_t PropertyIdentifier,
+	uint32_t DataType,
+	typename ObjectT,
+	typename StorageT,
+	StorageT ObjectT::*Member,
+	bool Writable = false,
+	bool Subscribable = false,
+	bool (*Validate)(const ObjectT&, const typename ExamplePointValueType<StorageT>::Type, uint32_t*) = &ExampleAcceptAnyValue<ObjectT, typename ExamplePointValueType<StorageT>::Type> >
+struct ExamplePropertyDescriptor
+{
+	static const uint32_t propertyIdentifier = PropertyIdentifier;
+	static const uint32_t dataType = DataType;
+	static const bool writable = Writable;
+	static const bool subscribable = Subscribable;
+
+	typedef typename ExamplePointValueType<StorageT>::Type ValueType;
+
+	template <typename ValueT>
+	static void Get(const ObjectT& object, ValueT* value) {
+		*value = static_cast<ValueT>(static_cast<ValueType>(object.*Member));
+	}
+
+	template <typename ValueT>
+	static bool Set(ObjectT& object, const ValueT value, uint32_t* errorCode) {
+		const ValueType storageValue = static_cast<ValueType>(value);
+		if (!Validate(object, storageValue, errorCode)) {
+			return false;
+		}
+		object.*Member = storageValue;
+		return true;
+	}
+};
+
+// Property dispatch
+// ---------------------------------------------------------------------------
+// Unrolled at compile time over the property descriptors of one object. The data type
+// and writable tests are constants so only the properties of the requested data type
+// remain in each instantiation.
+template <uint32_t DataType, typename... Properties>
+struct ExamplePropertyDispatch;
+
+template <uint32_t DataType>
+struct ExamplePropertyDispatch<DataType>
+{
+	template <typename ObjectT, typename ValueT>
+	static bool Get(const ObjectT& object, const uint32_t propertyIdentifier, ValueT* value) {
+		return false;
+	}
+
+	template <typename ObjectT, typename ValueT>
+	static bool Set(ObjectT& object, const uint32_t propertyIdentifier, const ValueT value, uint32_t* errorCode, bool* handled) {
+		return false;
+	}
+
+	template <typename Visitor>
+	static void ForEachProperty(const uint16_t objectType, const uint32_t objectInstance, Visitor& visitor) {
+	}
+};
+
+template <uint32_t DataType, typename Property, typename... Properties>
+struct ExamplePropertyDispatch<DataType, Property, Properties...>
+{
+	template <typename ObjectT, typename ValueT>
+	static bool Get(const ObjectT& object, const uint32_t propertyIdentifier, ValueT* value) {
+		if (Property::dataType == DataType && Property::propertyIdentifier == propertyIdentifier) {
+			Property::Get(object, value);
+			return true;
+		}
+		return ExamplePropertyDispatch<DataType, Properties...>::Get(object, propertyIdentifier, value);
+	}
+
+	template <typename ObjectT, typename ValueT>
+	static bool Set(ObjectT& object, const uint32_t propertyIdentifier, const ValueT value, uint32_t* errorCode, bool* handled) {
+		if (Property::writable && Property::dataType == DataType && Property::propertyIdentifier == propertyIdentifier) {
+			*handled = true;
+			return Property::Set(object, value, errorCode);
+		}
+		return ExamplePropertyDispatch<DataType, Properties...>::Set(object, propertyIdentifier, value, errorCode, handled);
+	}
+
+	// DataType is ignored, every property is visited.
+	template <typename Visitor>
+	static void ForEachProperty(const uint16_t objectType, const uint32_t objectInstance, Visitor& visitor) {
+		visitor(objectType, objectInstance, Property::propertyIdentifier, Property::writable, Property::subscribable);
+		ExamplePropertyDispatch<DataType, Properties...>::ForEachProperty(objectType, objectInstance, visitor);
+	}
+};
+
+// Object descriptor
+// ---------------------------------------------------------------------------
+// Binds an object type to the object stored in the example database and its property descriptors.
+template <uint16_t ObjectType, typename ObjectT, ObjectT ExampleDatabase::*Storage, typename... Properties>
+struct ExampleObjectDescriptor
+{
+	template <uint32_t DataType, typename ValueT>
+	static bool Get(const ExampleDatabase& database, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, ValueT* value, bool* matched) {
+		const ObjectT& object = database.*Storage;
+		if (objectType != ObjectType || objectInstance != object.instance) {
+			return false;
+		}
+		*matched = true;
+		return ExamplePropertyDispatch<DataType, Properties...>::Get(object, propertyIdentifier, value);
+	}
+
+	template <uint32_t DataType, typename ValueT>
+	static bool Set(ExampleDatabase& database, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const ValueT value, uint32_t* errorCode, bool* handled) {
+		ObjectT& object = database.*Storage;
+		if (objectType != ObjectType || objectInstance != object.instance) {
+			return false;
+		}
+		return ExamplePropertyDispatch<DataType, Properties...>::Set(object, propertyIdentifier, value, errorCode, handled);
+	}
+
+	// Matched by the object already resolved through the object index (ExampleDatabase::FindObject)
+	template <uint32_t DataType, typename ValueT>
+	static bool Get(const ExampleDatabase& database, const ExampleDatabaseBaseObject* resolved, const uint32_t propertyIdentifier, ValueT* value, bool* matched) {
+		const ObjectT& object = database.*Storage;
+		if (resolved != &object) {
+			return false;
+		}
+		*matched = true;
+		return ExamplePropertyDispatch<DataType, Properties...>::Get(object, propertyIdentifier, value);
+	}
+
+	template <uint32_t DataType, typename ValueT>
+	static bool Set(ExampleDatabase& database, const ExampleDatabaseBaseObject* resolved, const uint32_t propertyIdentifier, const ValueT value, uint32_t* errorCode, bool* handled) {
+		ObjectT& object = database.*Storage;
+		if (resolved != &object) {
+			return false;
+		}
+		return ExamplePropertyDispatch<DataType, Properties...>::Set(object, propertyIdentifier, value, errorCode, handled);
+	}
+
+	template <typename Visitor>
+	static void ForEachProperty(const ExampleDatabase& database, Visitor& visitor) {
+		ExamplePropertyDispatch<0, Properties...>::ForEachProperty(ObjectType, (database.*Storage).instance, visitor);
+	}
+};
+
+// Object descriptor list
+// ---------------------------------------------------------------------------
+template <typename... Objects>
+struct ExampleObjectDescriptorList;
+
+template <>
+struct ExampleObjectDescriptorList<>
+{
+	template <uint32_t DataType, typename ValueT>
+	static bool Get(const ExampleDatabase& database, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, ValueT* value) {
+		return false;
+	}
+
+	template <uint32_t DataType, typename ValueT>
+	static bool Set(ExampleDatabase& database, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const ValueT value, uint32_t* errorCode, bool* handled) {
+		return false;
+	}
+
+	template <uint32_t DataType, typename ValueT>
+	static bool Get(const ExampleDatabase& database, const ExampleDatabaseBaseObject* resolved, const uint32_t propertyIdentifier, ValueT* value) {
+		return false;
+	}
+
+	template <uint32_t DataType, typename ValueT>
+	static bool Set(ExampleDatabase& database, const ExampleDatabaseBaseObject* resolved, const uint32_t propertyIdentifier, const ValueT value, uint32_t* errorCode, bool* handled) {
+		return false;
+	}
+
+	template <typename Visitor>
+	static void ForEachProperty(const ExampleDatabase& database, Visitor& visitor) {
+	}
+};
+
+template <typename Object, typename... Objects>
+struct ExampleObjectDescriptorList<Object, Objects...>
+{
+	// Returns true if the property is declared for this object and data type, and the value was read.
+	template <uint32_t DataType, typename ValueT>
+	static bool Get(const ExampleDatabase& database, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, ValueT* value) {
+		bool matched = false;
+		const bool found = Object::template Get<DataType>(database, objectType, objectInstance, propertyIdentifier, value, &matched);
+		if (matched) {
+			return found;
+		}
+		return ExampleObjectDescriptorList<Objects...>::template Get<DataType>(database, objectType, objectInstance, propertyIdentifier, value);
+	}
+
+	// handled is set to true if the property is declared writable for this object and data type.
+	// The return value is the result of the write.
+	template <uint32_t DataType, typename ValueT>
+	static bool Set(ExampleDatabase& database, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const ValueT value, uint32_t* errorCode, bool* handled) {
+		const bool result = Object::template Set<DataType>(database, objectType, objectInstance, propertyIdentifier, value, errorCode, handled);
+		if (*handled) {
+			return result;
+		}
+		return ExampleObjectDescriptorList<Objects...>::template Set<DataType>(database, objectType, objectInstance, propertyIdentifier, value, errorCode, handled);
+	}
+
+	// The same for an object resolved with ExampleDatabase::FindObject, as the property callbacks do. The
+	// objects are compared by address. The object type and instance are used where the index may not be
+	// up to date, while a profile or an image is loaded.
+	template <uint32_t DataType, typename ValueT>
+	static bool Get(const ExampleDatabase& database, const ExampleDatabaseBaseObject* resolved, const uint32_t propertyIdentifier, ValueT* value) {
+		bool matched = false;
+		const bool found = Object::template Get<DataType>(database, resolved, propertyIdentifier, value, &matched);
+		if (matched) {
+			return found;
+		}
+		return ExampleObjectDescriptorList<Objects...>::template Get<DataType>(database, resolved, propertyIdentifier, value);
+	}
+
+	template <uint32_t DataType, typename ValueT>
+	static bool Set(ExampleDatabase& database, const ExampleDatabaseBaseObject* resolved, const uint32_t propertyIdentifier, const ValueT value, uint32_t* errorCode, bool* handled) {
+		const bool result = Object::template Set<DataType>(database, resolved, propertyIdentifier, value, errorCode, handled);
+		if (*handled) {
+			return result;
+		}
+		return ExampleObjectDescriptorList<Objects...>::template Set<DataType>(database, resolved, propertyIdentifier, value, errorCode, handled);
+	}
+
+	// Calls visitor(objectType, objectInstance, propertyIdentifier, writable, subscribable) for every declared property.
+	template <typename Visitor>
+	static void ForEachProperty(const ExampleDatabase& database, Visitor& visitor) {
+		Object::ForEachProperty(database, visitor);
+		ExampleObjectDescriptorList<Objects...>::ForEachProperty(database, visitor);
+	}
+};
+
+// Descriptors for the example database
+// ---------------------------------------------------------------------------
+// Note: Objects that share an object type (Analog Input and the Analog Input out of service example)
+// are matched by instance, so each one has its own descriptor.
+typedef ExampleObjectDescriptorList<
+	ExampleObjectDescriptor<CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE, ExampleDatabaseDevice, &ExampleDatabase::device,
+		ExamplePropertyDescriptor<CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_UTC_OFFSET, CASBACnetStackExampleConstants::DATA_TYPE_SIGNED_INTEGER, ExampleDatabaseDevice, int, &ExampleDatabaseDevice::UTCOffset, true, false, &ExampleValidateUTCOffset> >,
+	ExampleObjectDescriptor<CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, ExampleDatabaseAnalogInput, &ExampleDatabase::analogInput,
+		ExamplePropertyDescriptor<CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, CASBACnetStackExampleConstants::DATA_TYPE_REAL, ExampleDatabaseAnalogInput, ExampleSnapshotPoint<float>, &ExampleDatabaseAnalogInput::presentValue, false, true>,
+		ExamplePropertyDescriptor<CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_COV_INCURMENT, CASBACnetStackExampleConstants::DATA_TYPE_REAL, ExampleDatabaseAnalogInput, float, &ExampleDatabaseAnalogInput::covIncrement, true, false>,
+		ExamplePropertyDescriptor<CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELIABILITY, CASBACnetStackExampleConstants::DATA_TYPE_ENUMERATED, ExampleDatabaseAnalogInput, ExampleSnapshotPoint<uint32_t>, &ExampleDatabaseAnalogInput::reliability, false, true>,
+		ExamplePropertyDescriptor<CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_UNITS, CASBACnetStackExampleConstants::DATA_TYPE_ENUMERATED, ExampleDatabaseAnalogInput, uint32_t, &ExampleDatabaseAnalogInput::units> >,
+	ExampleObjectDescriptor<CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, ExampleDatabaseAnalogInputOutOfService, &ExampleDatabase::analogInputOutOfService,
+		ExamplePropertyDescriptor<CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OUT_OF_SERVICE, CASBACnetStackExampleConstants::DATA_TYPE_BOOLEAN, ExampleDatabaseAnalogInputOutOfService, bool, &ExampleDatabaseAnalogInputOutOfService::outOfService, true, false>,
+		ExamplePropertyDescriptor<CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_UNITS, CASBACnetStackExampleConstants::DATA_TYPE_ENUMERATED, ExampleDatabaseAnalogInputOutOfService, uint32_t, &ExampleDatabaseAnalogInputOutOfService::units> >,
+	ExampleObjectDescriptor<CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE, ExampleDatabaseAnalogValue, &ExampleDatabase::analogValue,
+		ExamplePropertyDescriptor<CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, CASBACnetStackExampleConstants::DATA_TYPE_REAL, ExampleDatabaseAnalogValue, float, &ExampleDatabaseAnalogValue::presentValue, true, true, &ExampleValidateAnalogValuePresentValue>,
+		ExamplePropertyDescriptor<CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_MAX_PRES_VALUE, CASBACnetStackExampleConstants::DATA_TYPE_REAL, ExampleDatabaseAnalogValue, float, &ExampleDatabaseAnalogValue::maxPresValue>,
+		ExamplePropertyDescriptor<CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_MIN_PRES_VALUE, CASBACnetStackExampleConstants::DATA_TYPE_REAL, ExampleDatabaseAnalogValue, float, &ExampleDatabaseAnalogValue::minPresValue> >,
+	ExampleObjectDescriptor<CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_INPUT, ExampleDatabaseBinaryInput, &ExampleDatabase::binaryInput,
+		ExamplePropertyDescriptor<CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, CASBACnetStackExampleConstants::DATA_TYPE_ENUMERATED, ExampleDatabaseBinaryInput, ExampleSnapshotPoint<bool>, &ExampleDatabaseBinaryInput::presentValue> >,
+	ExampleObjectDescriptor<CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_VALUE, ExampleDatabaseBinaryValue, &ExampleDatabase::binaryValue,
+		ExamplePropertyDescriptor<CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, CASBACnetStackExampleConstants::DATA_TYPE_ENUMERATED, ExampleDatabaseBinaryValue, bool, &ExampleDatabaseBinaryValue::presentValue, true, false> >,
+	ExampleObjectDescriptor<CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_INPUT, ExampleDatabaseMultiStateInput, &ExampleDatabase::multiStateInput,
+		ExamplePropertyDescriptor<CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, CASBACnetStackExampleConstants::DATA_TYPE_UNSIGNED_INTEGER, ExampleDatabaseMultiStateInput, ExampleSnapshotPoint<uint32_t>, &ExampleDatabaseMultiStateInput::presentValue> >,
+	ExampleObjectDescriptor<CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_VALUE, ExampleDatabaseMultiStateValue, &ExampleDatabase::multiStateValue,
+		ExamplePropertyDescriptor<CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, CASBACnetStackExampleConstants::DATA_TYPE_UNSIGNED_INTEGER, ExampleDatabaseMultiStateValue, uint32_t, &ExampleDatabaseMultiStateValue::presentValue, true, false, &ExampleValidateMultiStateValuePresentValue> >,
+	ExampleObjectDescriptor<CASBACnetStackExampleConstants::OBJECT_TYPE_INTEGER_VALUE, ExampleDatabaseIntegerValue, &ExampleDatabase::integerValue,
+		ExamplePropertyDescriptor<CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, CASBACnetStackExampleConstants::DATA_TYPE_SIGNED_INTEGER, ExampleDatabaseIntegerValue, int32_t, &ExampleDatabaseIntegerValue::presentValue, true, false> >,
+	ExampleObjectDescriptor<CASBACnetStackExampleConstants::OBJECT_TYPE_LARGE_ANALOG_VALUE, ExampleDatabaseLargeAnalogValue, &ExampleDatabase::largeAnalogValue,
+		ExamplePropertyDescriptor<CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, CASBACnetStackExampleConstants::DATA_TYPE_DOUBLE, ExampleDatabaseLargeAnalogValue, double, &ExampleDatabaseLargeAnalogValue::presentValue, true, false> >,
+	ExampleObjectDescriptor<CASBACnetStackExampleConstants::OBJECT_TYPE_POSITIVE_INTEGER_VALUE, ExampleDatabasePositiveIntegerValue, &ExampleDatabase::positiveIntegerValue,
+		ExamplePropertyDescriptor<CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, CASBACnetStackExampleConstants::DATA_TYPE_UNSIGNED_INTEGER, ExampleDatabasePositiveIntegerValue, uint32_t, &ExampleDatabasePositiveIntegerValue::presentValue, true, false> >,
+	ExampleObjectDescriptor<CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT, ExampleDatabaseNetworkPort, &ExampleDatabase::networkPort,
+		ExamplePropertyDescriptor<CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_BACNET_IP_UDP_PORT, CASBACnetStackExampleConstants::DATA_TYPE_UNSIGNED_INTEGER, ExampleDatabaseNetworkPort, uint16_t, &ExampleDatabaseNetworkPort::BACnetIPUDPPort>,
+		ExamplePropertyDescriptor<CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_CHANGES_PENDING, CASBACnetStackExampleConstants::DATA_TYPE_BOOLEAN, ExampleDatabaseNetworkPort, bool, &ExampleDatabaseNetworkPort::ChangesPending> >
+> ExampleObjectDescriptors;
+
+#endif // __CASBACnetStackExampleObjectDescriptors_h__
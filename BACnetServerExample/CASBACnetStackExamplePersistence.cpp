@@ -0,0 +1,622 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExamplePersistence.cpp
+ *
+ * Saves the values of the example database that must survive a restart to the
+ * persistent image, and applies them again at startup. Accepted writes are
+ * logged to the write-ahead log between two saves of the image.
+ * See CASBACnetStackExamplePersistentImage.h and
+ * CASBACnetStackExampleWriteAheadLog.h for the file formats.
+ *
+ * Saved values
+ *   - Writable properties declared in CASBACnetStackExampleObjectDescriptors.h
+ *   - Priority arrays and relinquish defaults of the output objects
+ *   - Character string, octet string, bitstring, date and time value present values
+ *   - Device object identifier, object name and description
+ *   - Network port FdBbmdAddress and FdSubscriptionLifetime
+ *   - Analog Value objects created with the CreateObject service
+*/
+
+#include "CASBACnetStackExampleDatabase.h"
+#include "CASBACnetStackExampleConstants.h"
+#include "CASBACnetStackExampleObjectDescriptors.h"
+
+#include <chrono>
+#include <iostream>
+#include <string.h>
+#include <time.h> // time()
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif // _WIN32
+
+static uint64_t ExampleRealToBits(const float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static float ExampleBitsToReal(const uint64_t value) {
+	const uint32_t bits = (uint32_t)value;
+	float real;
+	memcpy(&real, &bits, sizeof(real));
+	return real;
+}
+
+static uint64_t ExampleDoubleToBits(const double value) {
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static double ExampleBitsToDouble(const uint64_t value) {
+	double real;
+	memcpy(&real, &value, sizeof(real));
+	return real;
+}
+
+static uint64_t ExampleBooleanToBits(const bool value) {
+	return value ? 1 : 0;
+}
+
+static uint64_t ExampleUnsignedToBits(const uint32_t value) {
+	return value;
+}
+
+// Passed to ExampleObjectDescriptors::ForEachProperty. Saves the value of every writable property of one
+// object, or of all the objects, trying the data types a descriptor can be declared with.
+struct ExamplePersistentStoreVisitor {
+	const ExampleDatabase* database;
+	ExamplePersistentRecordWriter* writer;
+	bool allObjects;
+	uint16_t objectType;
+	uint32_t objectInstance; // Not checked for the device, its instance can be written
+
+	void operator()(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const bool writable, const bool subscribable) {
+		if (!writable) {
+			return;
+		}
+		if (!this->allObjects && (objectType != this->objectType || (objectType != CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE && objectInstance != this->objectInstance))) {
+			return;
+		}
+		float real;
+		double largeReal;
+		int32_t signedInteger;
+		uint32_t unsignedInteger;
+		bool boolean;
+		if (ExampleObjectDescriptors::Get<CASBACnetStackExampleConstants::DATA_TYPE_REAL>(*this->database, objectType, objectInstance, propertyIdentifier, &real)) {
+			this->writer->AddValue(objectType, objectInstance, propertyIdentifier, 0, CASBACnetStackExampleConstants::DATA_TYPE_REAL, ExampleRealToBits(real));
+		}
+		else if (ExampleObjectDescriptors::Get<CASBACnetStackExampleConstants::DATA_TYPE_DOUBLE>(*this->database, objectType, objectInstance, propertyIdentifier, &largeReal)) {
+			this->writer->AddValue(objectType, objectInstance, propertyIdentifier, 0, CASBACnetStackExampleConstants::DATA_TYPE_DOUBLE, ExampleDoubleToBits(largeReal));
+		}
+		else if (ExampleObjectDescriptors::Get<CASBACnetStackExampleConstants::DATA_TYPE_SIGNED_INTEGER>(*this->database, objectType, objectInstance, propertyIdentifier, &signedInteger)) {
+			this->writer->AddValue(objectType, objectInstance, propertyIdentifier, 0, CASBACnetStackExampleConstants::DATA_TYPE_SIGNED_INTEGER, (uint32_t)signedInteger);
+		}
+		else if (ExampleObjectDescriptors::Get<CASBACnetStackExampleConstants::DATA_TYPE_UNSIGNED_INTEGER>(*this->database, objectType, objectInstance, propertyIdentifier, &unsignedInteger)) {
+			this->writer->AddValue(objectType, objectInstance, propertyIdentifier, 0, CASBACnetStackExampleConstants::DATA_TYPE_UNSIGNED_INTEGER, unsignedInteger);
+		}
+		else if (ExampleObjectDescriptors::Get<CASBACnetStackExampleConstants::DATA_TYPE_ENUMERATED>(*this->database, objectType, objectInstance, propertyIdentifier, &unsignedInteger)) {
+			this->writer->AddValue(objectType, objectInstance, propertyIdentifier, 0, CASBACnetStackExampleConstants::DATA_TYPE_ENUMERATED, unsignedInteger);
+		}
+		else if (ExampleObjectDescriptors::Get<CASBACnetStackExampleConstants::DATA_TYPE_BOOLEAN>(*this->database, objectType, objectInstance, propertyIdentifier, &boolean)) {
+			this->writer->AddValue(objectType, objectInstance, propertyIdentifier, 0, CASBACnetStackExampleConstants::DATA_TYPE_BOOLEAN, boolean ? 1 : 0);
+		}
+	}
+};
+
+// All 16 priorities are saved, the relinquished ones as DATA_TYPE_NULL records, so that a relinquish in
+// the write-ahead log overrides the value in the image.
+template <typename T, typename ToBits>
+static void ExampleStorePriorityArray(ExamplePersistentRecordWriter& writer, const uint16_t objectType, const uint32_t objectInstance, const ExampleDatabasePriorityArray<T>& priorityArray, const uint16_t dataType, ToBits toBits) {
+	for (uint8_t priority = 1; priority <= ExampleDatabaseBaseObject::PRIORITY_ARRAY_LENGTH; priority++) {
+		if (priorityArray.IsNull(priority)) {
+			writer.AddValue(objectType, objectInstance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, priority, CASBACnetStackExampleConstants::DATA_TYPE_NULL, 0);
+		}
+		else {
+			writer.AddValue(objectType, objectInstance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, priority, dataType, toBits(priorityArray.GetValue(priority)));
+		}
+	}
+	writer.AddValue(objectType, objectInstance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELINQUISH_DEFAULT, 0, dataType, toBits(priorityArray.GetRelinquishDefault()));
+}
+
+static void ExampleStoreCreatedAnalogValue(ExamplePersistentRecordWriter& writer, const uint32_t objectInstance, const CreatedAnalogValue& createdAnalogValue) {
+	writer.AddData(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE, objectInstance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OBJECT_NAME, 0, CASBACnetStackExampleConstants::DATA_TYPE_CHARACTER_STRING, createdAnalogValue.objectName.c_str(), (uint32_t)createdAnalogValue.objectName.size());
+	writer.AddValue(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE, objectInstance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, 0, CASBACnetStackExampleConstants::DATA_TYPE_REAL, ExampleRealToBits(createdAnalogValue.value));
+}
+
+// Applies a saved value to a priority array record. Returns false if the record is not for the priority array.
+template <typename T>
+static bool ExampleLoadPriorityArray(const ExamplePersistentRecord& record, ExampleDatabasePriorityArray<T>& priorityArray, const T value) {
+	if (record.propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
+		if (record.dataType == CASBACnetStackExampleConstants::DATA_TYPE_NULL) {
+			priorityArray.Relinquish(record.arrayIndex);
+		}
+		else {
+			priorityArray.Set(record.arrayIndex, value);
+		}
+		return true;
+	}
+	else if (record.propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELINQUISH_DEFAULT) {
+		priorityArray.SetRelinquishDefault(value);
+		return true;
+	}
+	return false;
+}
+
+std::string ExampleDatabase::GetDefaultPersistentImagePath(const uint32_t deviceInstance) {
+	return "CASBACnetStackExample_" + std::to_string(deviceInstance) + ".image";
+}
+
+bool ExampleDatabase::OpenPersistentImage(const std::string& path) {
+	if (!this->persistentImage.Open(path)) {
+		return false;
+	}
+	this->LoadPersistentImage();
+
+	// Writes committed after the last save of the image
+	this->writeAheadLogReplayCount = 0;
+	if (this->writeAheadLog.Open(path + ".wal")) {
+		WriteAheadLogApply apply;
+		apply.database = this;
+		this->writeAheadLogReplayCount = this->writeAheadLog.Replay(apply);
+	}
+	else {
+		std::cerr << "Error - Writes are saved once a second without the write-ahead log" << std::endl;
+	}
+
+	// Objects were created and values changed outside of the normal setters
+	this->RebuildObjectIndex();
+	this->covFilter.SetIncrement(this->analogInput.presentValueCovFilterPoint, this->analogInput.covIncrement);
+	this->persistentImageChanged = false;
+
+	// Compact the replayed writes into the image straight away
+	if (this->writeAheadLog.GetSize() > 0) {
+		this->SavePersistentImage();
+	}
+	return true;
+}
+
+void ExampleDatabase::LogPersistentWrite(const uint16_t objectType, const uint32_t objectInstance) {
+	this->persistentImageChanged = true;
+	if (this->writeAheadLog.IsOpen()) {
+		this->StorePersistentObject(this->writeAheadLog, objectType, objectInstance);
+	}
+}
+
+void ExampleDatabase::CommitPersistentWrites() {
+	// Group commit, all the writes accepted since the last commit reach the disk with one fdatasync
+	bool logFailed = false;
+	if (this->writeAheadLog.GetPendingCount() > 0) {
+		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (now - this->writeAheadLogCommitTime >= std::chrono::milliseconds(this->writeAheadLogCommitWindow)) {
+			// A batch that could not be committed is retried with the next window, the image is saved meanwhile
+			logFailed = !this->writeAheadLog.Commit();
+			this->writeAheadLogCommitTime = now;
+		}
+	}
+
+	// Nothing else to do while a background checkpoint is running
+	if (!this->WaitPersistentCheckpoint(false)) {
+		return;
+	}
+
+	// Compaction, the image is saved and the log emptied once it is large or old enough. Without the
+	// log the whole image is saved, at most once a second while there are changes.
+	bool saveImage;
+	if (this->writeAheadLog.IsOpen()) {
+		const uint64_t size = this->writeAheadLog.GetSize();
+		saveImage = size >= WRITE_AHEAD_LOG_COMPACT_SIZE || (size > 0 && this->clock.GetSystemTime() - this->persistentImageSaveTime >= WRITE_AHEAD_LOG_COMPACT_INTERVAL) ||
+			(logFailed && this->persistentImageSaveTime != this->clock.GetSystemTime());
+	}
+	else {
+		saveImage = this->persistentImageChanged && this->persistentImageSaveTime != this->clock.GetSystemTime();
+	}
+	if (!saveImage) {
+		return;
+	}
+	if (this->persistentCheckpointInBackground) {
+		this->StartPersistentCheckpoint();
+	}
+	else {
+		this->SavePersistentImage();
+	}
+}
+
+bool ExampleDatabase::SavePersistentImage() {
+	if (!this->persistentImage.IsOpen()) {
+		return false;
+	}
+	// The checkpoint process writes to the same image
+	this->WaitPersistentCheckpoint(true);
+	this->persistentImageChanged = false;
+	this->persistentImageSaveTime = this->clock.GetSystemTime();
+
+	ExamplePersistentImage& image = this->persistentImage;
+	image.Begin();
+	this->StorePersistentValues(image);
+	if (!image.Commit()) {
+		std::cerr << "Error - Could not save the persistent image" << std::endl;
+		return false;
+	}
+
+	// Everything in the log, committed or pending, is in the image now
+	this->writeAheadLog.Reset();
+	return true;
+}
+
+#ifndef _WIN32
+
+bool ExampleDatabase::StartPersistentCheckpoint() {
+	if (!this->persistentImage.IsOpen() || this->persistentCheckpointProcess != 0) {
+		return false;
+	}
+
+	// The checkpoint covers the log up to here, the writes logged from now on are kept for the next one
+	this->writeAheadLog.Commit();
+	this->persistentCheckpointLogSize = this->writeAheadLog.GetSize();
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	const pid_t process = fork();
+	if (process == 0) {
+		// Checkpoint process. Its copy of the database is frozen at the fork, the pages the parent changes
+		// from now on are copied by the kernel. Nothing but the image is touched and _exit skips the
+		// parent's atexit handlers and stream buffers.
+		ExamplePersistentImage& image = this->persistentImage;
+		image.Begin();
+		this->StorePersistentValues(image);
+		_exit(image.Commit() ? 0 : 1);
+	}
+	const double pause = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	if (process < 0) {
+		std::cerr << "Error - Could not start the checkpoint process, saving in the foreground" << std::endl;
+		return this->SavePersistentImage();
+	}
+
+	this->persistentCheckpointProcess = (int)process;
+	this->persistentCheckpointStartTime = start;
+	this->persistentImageChanged = false;
+	this->persistentImageSaveTime = this->clock.GetSystemTime();
+	this->persistentCheckpointStats.lastPause = pause;
+	return true;
+}
+
+bool ExampleDatabase::WaitPersistentCheckpoint(const bool block) {
+	if (this->persistentCheckpointProcess == 0) {
+		return true;
+	}
+	int status = 0;
+	const pid_t process = waitpid((pid_t)this->persistentCheckpointProcess, &status, block ? 0 : WNOHANG);
+	if (process == 0) {
+		// Still running
+		return false;
+	}
+	this->persistentCheckpointProcess = 0;
+
+	ExamplePersistentCheckpointStats& stats = this->persistentCheckpointStats;
+	const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	stats.lastDuration = std::chrono::duration<double, std::milli>(end - this->persistentCheckpointStartTime).count();
+	if (process < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		// The previous generation is still the current one and the log still has all the writes
+		std::cerr << "Error - The checkpoint process failed" << std::endl;
+		stats.failures++;
+		this->persistentImageChanged = true;
+		return true;
+	}
+
+	// Pick up the new generation and drop the part of the log that it covers
+	this->persistentImage.Reload();
+	this->writeAheadLog.Discard(this->persistentCheckpointLogSize);
+	stats.lastPause += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - end).count();
+	stats.count++;
+	if (stats.lastDuration > stats.maxDuration) {
+		stats.maxDuration = stats.lastDuration;
+	}
+	if (stats.lastPause > stats.maxPause) {
+		stats.maxPause = stats.lastPause;
+	}
+	return true;
+}
+
+#else // _WIN32
+
+// No fork, the image is saved in the foreground
+bool ExampleDatabase::StartPersistentCheckpoint() {
+	return this->SavePersistentImage();
+}
+
+bool ExampleDatabase::WaitPersistentCheckpoint(const bool block) {
+	return true;
+}
+
+#endif // _WIN32
+
+void ExampleDatabase::StorePersistentValues(ExamplePersistentRecordWriter& writer) {
+	this->StorePersistentBuiltInValues(writer);
+
+	// Created objects, in instance order
+	for (std::map<uint32_t, CreatedAnalogValue>::const_iterator itr = this->CreatedAnalogValueData.begin(); itr != this->CreatedAnalogValueData.end(); itr++) {
+		ExampleStoreCreatedAnalogValue(writer, itr->first, itr->second);
+	}
+}
+
+void ExampleDatabase::StorePersistentBuiltInValues(ExamplePersistentRecordWriter& writer) {
+	// Device first, so the object identifier is known when the rest is loaded
+	this->StorePersistentRecords(writer, CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE, this->device.instance);
+
+	// Writable properties declared in the object descriptors
+	ExamplePersistentStoreVisitor visitor;
+	visitor.database = this;
+	visitor.writer = &writer;
+	visitor.allObjects = true;
+	visitor.objectType = 0;
+	visitor.objectInstance = 0;
+	ExampleObjectDescriptors::ForEachProperty(*this, visitor);
+
+	// Values that are not in the object descriptors
+	this->StorePersistentRecords(writer, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, this->analogInput.instance);
+	this->StorePersistentRecords(writer, CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_OUTPUT, this->analogOutput.instance);
+	this->StorePersistentRecords(writer, CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_OUTPUT, this->binaryOutput.instance);
+	this->StorePersistentRecords(writer, CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_OUTPUT, this->multiStateOutput.instance);
+	this->StorePersistentRecords(writer, CASBACnetStackExampleConstants::OBJECT_TYPE_CHARACTERSTRING_VALUE, this->characterStringValue.instance);
+	this->StorePersistentRecords(writer, CASBACnetStackExampleConstants::OBJECT_TYPE_OCTETSTRING_VALUE, this->octetStringValue.instance);
+	this->StorePersistentRecords(writer, CASBACnetStackExampleConstants::OBJECT_TYPE_BITSTRING_VALUE, this->bitstringValue.instance);
+	this->StorePersistentRecords(writer, CASBACnetStackExampleConstants::OBJECT_TYPE_DATE_VALUE, this->dateValue.instance);
+	this->StorePersistentRecords(writer, CASBACnetStackExampleConstants::OBJECT_TYPE_TIME_VALUE, this->timeValue.instance);
+	this->StorePersistentRecords(writer, CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT, this->networkPort.instance);
+}
+
+void ExampleDatabase::StorePersistentObject(ExamplePersistentRecordWriter& writer, const uint16_t objectType, const uint32_t objectInstance) {
+	this->StorePersistentRecords(writer, objectType, objectInstance);
+
+	ExamplePersistentStoreVisitor visitor;
+	visitor.database = this;
+	visitor.writer = &writer;
+	visitor.allObjects = false;
+	visitor.objectType = objectType;
+	visitor.objectInstance = objectInstance;
+	ExampleObjectDescriptors::ForEachProperty(*this, visitor);
+}
+
+void ExampleDatabase::StorePersistentRecords(ExamplePersistentRecordWriter& writer, const uint16_t objectType, const uint32_t objectInstance) {
+	switch (objectType) {
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE:
+			writer.AddValue(objectType, this->device.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OBJECT_IDENTIFIER, 0, CASBACnetStackExampleConstants::DATA_TYPE_BACNET_OBJECT_IDENTIFIER, this->device.instance);
+			writer.AddData(objectType, this->device.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OBJECT_NAME, 0, CASBACnetStackExampleConstants::DATA_TYPE_CHARACTER_STRING, this->device.objectName.c_str(), (uint32_t)this->device.objectName.size());
+			writer.AddData(objectType, this->device.instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_DESCRIPTION, 0, CASBACnetStackExampleConstants::DATA_TYPE_CHARACTER_STRING, this->device.description.c_str(), (uint32_t)this->device.description.size());
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT:
+			if (objectInstance == this->analogInput.instance) {
+				writer.AddValue(objectType, objectInstance, 512 + 5, 0, CASBACnetStackExampleConstants::DATA_TYPE_REAL, ExampleRealToBits(this->analogInput.proprietaryReal));
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_OUTPUT:
+			if (objectInstance == this->analogOutput.instance) {
+				ExampleStorePriorityArray(writer, objectType, objectInstance, this->analogOutput.priorityArray, CASBACnetStackExampleConstants::DATA_TYPE_REAL, ExampleRealToBits);
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_OUTPUT:
+			if (objectInstance == this->binaryOutput.instance) {
+				ExampleStorePriorityArray(writer, objectType, objectInstance, this->binaryOutput.priorityArray, CASBACnetStackExampleConstants::DATA_TYPE_ENUMERATED, ExampleBooleanToBits);
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_OUTPUT:
+			if (objectInstance == this->multiStateOutput.instance) {
+				ExampleStorePriorityArray(writer, objectType, objectInstance, this->multiStateOutput.priorityArray, CASBACnetStackExampleConstants::DATA_TYPE_UNSIGNED_INTEGER, ExampleUnsignedToBits);
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE:
+			if (objectInstance != this->analogValue.instance) {
+				// Created with the CreateObject service. A deleted object is logged as a NULL object identifier.
+				const CreatedAnalogValue* createdAnalogValue = this->FindCreatedAnalogValue(objectInstance);
+				if (createdAnalogValue != NULL) {
+					ExampleStoreCreatedAnalogValue(writer, objectInstance, *createdAnalogValue);
+				}
+				else {
+					writer.AddValue(objectType, objectInstance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OBJECT_IDENTIFIER, 0, CASBACnetStackExampleConstants::DATA_TYPE_NULL, 0);
+				}
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_CHARACTERSTRING_VALUE:
+			if (objectInstance == this->characterStringValue.instance) {
+				writer.AddData(objectType, objectInstance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, 0, CASBACnetStackExampleConstants::DATA_TYPE_CHARACTER_STRING, this->characterStringValue.presentValue.c_str(), (uint32_t)this->characterStringValue.presentValue.size());
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_OCTETSTRING_VALUE:
+			if (objectInstance == this->octetStringValue.instance && !this->octetStringValue.presentValue.empty()) {
+				writer.AddData(objectType, objectInstance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, 0, CASBACnetStackExampleConstants::DATA_TYPE_OCTET_STRING, &this->octetStringValue.presentValue[0], (uint32_t)this->octetStringValue.presentValue.size());
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_BITSTRING_VALUE:
+			// The packed words, with the length in bits as the array index
+			if (objectInstance == this->bitstringValue.instance && !this->bitstringValue.presentValueWords.empty()) {
+				writer.AddData(objectType, objectInstance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, this->bitstringValue.presentValueLength, CASBACnetStackExampleConstants::DATA_TYPE_BIT_STRING, &this->bitstringValue.presentValueWords[0], (uint32_t)(this->bitstringValue.presentValueWords.size() * sizeof(uint64_t)));
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_DATE_VALUE:
+			if (objectInstance == this->dateValue.instance) {
+				writer.AddValue(objectType, objectInstance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, 0, CASBACnetStackExampleConstants::DATA_TYPE_DATE,
+					(uint64_t)this->dateValue.presentValueYear | (uint64_t)this->dateValue.presentValueMonth << 8 | (uint64_t)this->dateValue.presentValueDay << 16 | (uint64_t)this->dateValue.presentValueWeekday << 24);
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_TIME_VALUE:
+			if (objectInstance == this->timeValue.instance) {
+				writer.AddValue(objectType, objectInstance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, 0, CASBACnetStackExampleConstants::DATA_TYPE_TIME,
+					(uint64_t)this->timeValue.presentValueHour | (uint64_t)this->timeValue.presentValueMinute << 8 | (uint64_t)this->timeValue.presentValueSecond << 16 | (uint64_t)this->timeValue.presentValueHundrethSecond << 24);
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT:
+			if (objectInstance == this->networkPort.instance) {
+				writer.AddData(objectType, objectInstance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_FD_BBMD_ADDRESS, CASBACnetStackExampleConstants::FD_BBMD_ADDRESS_HOST, CASBACnetStackExampleConstants::DATA_TYPE_OCTET_STRING, this->networkPort.FdBbmdAddressHostIp, sizeof(this->networkPort.FdBbmdAddressHostIp));
+				writer.AddValue(objectType, objectInstance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_FD_BBMD_ADDRESS, CASBACnetStackExampleConstants::FD_BBMD_ADDRESS_PORT, CASBACnetStackExampleConstants::DATA_TYPE_UNSIGNED_INTEGER, this->networkPort.FdBbmdAddressPort);
+				writer.AddValue(objectType, objectInstance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_FD_SUBSCRIPTION_LIFETIME, 0, CASBACnetStackExampleConstants::DATA_TYPE_UNSIGNED_INTEGER, this->networkPort.FdSubscriptionLifetime);
+			}
+			break;
+	}
+}
+
+uint32_t ExampleDatabase::LoadPersistentImage() {
+	const ExamplePersistentImage& image = this->persistentImage;
+	const uint32_t recordCount = image.GetRecordCount();
+	uint32_t loaded = 0;
+	for (uint32_t offset = 0; offset < recordCount; offset++) {
+		const ExamplePersistentRecord& record = image.GetRecord(offset);
+		if (this->LoadPersistentRecord(record, record.length > 0 ? image.GetData(record) : NULL)) {
+			loaded++;
+		}
+	}
+	return loaded;
+}
+
+bool ExampleDatabase::LoadPersistentRecord(const ExamplePersistentRecord& record, const uint8_t* data) {
+	if (record.length > 0 && data == NULL) {
+		return false;
+	}
+	const char* text = (const char*)data;
+
+	switch (record.objectType) {
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE:
+			if (record.propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OBJECT_IDENTIFIER) {
+				this->device.instance = (uint32_t)record.value;
+				return true;
+			}
+			else if (record.propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OBJECT_NAME) {
+				this->device.objectName.assign(text, record.length);
+				return true;
+			}
+			else if (record.propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_DESCRIPTION) {
+				this->device.description.assign(text, record.length);
+				return true;
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT:
+			if (record.objectInstance == this->analogInput.instance && record.propertyIdentifier == 512 + 5) {
+				this->analogInput.proprietaryReal = ExampleBitsToReal(record.value);
+				return true;
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_OUTPUT:
+			if (record.objectInstance == this->analogOutput.instance) {
+				return ExampleLoadPriorityArray(record, this->analogOutput.priorityArray, ExampleBitsToReal(record.value));
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_BINARY_OUTPUT:
+			if (record.objectInstance == this->binaryOutput.instance) {
+				return ExampleLoadPriorityArray(record, this->binaryOutput.priorityArray, record.value != 0);
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_MULTI_STATE_OUTPUT:
+			if (record.objectInstance == this->multiStateOutput.instance) {
+				if (record.dataType != CASBACnetStackExampleConstants::DATA_TYPE_NULL && (record.value == 0 || record.value > this->multiStateOutput.stateText.size())) {
+					return false;
+				}
+				return ExampleLoadPriorityArray(record, this->multiStateOutput.priorityArray, (uint32_t)record.value);
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE:
+			if (record.objectInstance != this->analogValue.instance) {
+				// Created with the CreateObject service
+				std::map<uint32_t, CreatedAnalogValue>& created = this->CreatedAnalogValueData;
+				if (record.propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OBJECT_IDENTIFIER && record.dataType == CASBACnetStackExampleConstants::DATA_TYPE_NULL) {
+					created.erase(record.objectInstance);
+					return true;
+				}
+				// Saved in instance order, one record after the other for each object. The last object is reused
+				// and new ones are appended with an end hint, so there is no search.
+				CreatedAnalogValue& createdAnalogValue = !created.empty() && created.rbegin()->first == record.objectInstance ? created.rbegin()->second : created.insert(created.end(), std::make_pair(record.objectInstance, CreatedAnalogValue()))->second;
+				createdAnalogValue.instance = record.objectInstance;
+				if (record.propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OBJECT_NAME) {
+					createdAnalogValue.objectName.assign(text, record.length);
+				}
+				else if (record.propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE) {
+					createdAnalogValue.value = ExampleBitsToReal(record.value);
+				}
+				return true;
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_CHARACTERSTRING_VALUE:
+			if (record.objectInstance == this->characterStringValue.instance) {
+				this->characterStringValue.presentValue.assign(text, record.length);
+				return true;
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_OCTETSTRING_VALUE:
+			// Writes can not make the octet string longer than it was at setup
+			if (record.objectInstance == this->octetStringValue.instance && record.length <= this->octetStringValue.presentValue.size()) {
+				this->octetStringValue.presentValue.assign(data, data + record.length);
+				return true;
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_BITSTRING_VALUE:
+			// Writes can not make the bitstring longer than it was at setup
+			if (record.objectInstance == this->bitstringValue.instance && record.arrayIndex > 0 && record.arrayIndex <= this->bitstringValue.presentValueLength &&
+				record.length == (record.arrayIndex + 63) / 64 * sizeof(uint64_t)) {
+				this->bitstringValue.Resize(record.arrayIndex);
+				memcpy(&this->bitstringValue.presentValueWords[0], data, record.length);
+				this->bitstringValue.Resize(record.arrayIndex); // Clears the bits past the length
+				return true;
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_DATE_VALUE:
+			if (record.objectInstance == this->dateValue.instance) {
+				this->dateValue.Set((uint8_t)record.value, (uint8_t)(record.value >> 8), (uint8_t)(record.value >> 16), (uint8_t)(record.value >> 24));
+				return true;
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_TIME_VALUE:
+			if (record.objectInstance == this->timeValue.instance) {
+				this->timeValue.Set((uint8_t)record.value, (uint8_t)(record.value >> 8), (uint8_t)(record.value >> 16), (uint8_t)(record.value >> 24));
+				return true;
+			}
+			break;
+		case CASBACnetStackExampleConstants::OBJECT_TYPE_NETWORK_PORT:
+			if (record.objectInstance != this->networkPort.instance) {
+				break;
+			}
+			if (record.propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_FD_BBMD_ADDRESS && record.arrayIndex == CASBACnetStackExampleConstants::FD_BBMD_ADDRESS_HOST) {
+				if (record.length != sizeof(this->networkPort.FdBbmdAddressHostIp)) {
+					return false;
+				}
+				memcpy(this->networkPort.FdBbmdAddressHostIp, data, record.length);
+				return true;
+			}
+			else if (record.propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_FD_BBMD_ADDRESS && record.arrayIndex == CASBACnetStackExampleConstants::FD_BBMD_ADDRESS_PORT) {
+				this->networkPort.FdBbmdAddressPort = (uint16_t)record.value;
+				return true;
+			}
+			else if (record.propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_FD_SUBSCRIPTION_LIFETIME) {
+				this->networkPort.FdSubscriptionLifetime = (uint16_t)record.value;
+				return true;
+			}
+			break;
+	}
+
+	// Writable properties declared in the object descriptors, validated the same way as a WriteProperty
+	uint32_t errorCode = 0;
+	bool handled = false;
+	bool result = false;
+	switch (record.dataType) {
+		case CASBACnetStackExampleConstants::DATA_TYPE_REAL:
+			result = ExampleObjectDescriptors::Set<CASBACnetStackExampleConstants::DATA_TYPE_REAL>(*this, record.objectType, record.objectInstance, record.propertyIdentifier, ExampleBitsToReal(record.value), &errorCode, &handled);
+			break;
+		case CASBACnetStackExampleConstants::DATA_TYPE_DOUBLE:
+			result = ExampleObjectDescriptors::Set<CASBACnetStackExampleConstants::DATA_TYPE_DOUBLE>(*this, record.objectType, record.objectInstance, record.propertyIdentifier, ExampleBitsToDouble(record.value), &errorCode, &handled);
+			break;
+		case CASBACnetStackExampleConstants::DATA_TYPE_SIGNED_INTEGER:
+			result = ExampleObjectDescriptors::Set<CASBACnetStackExampleConstants::DATA_TYPE_SIGNED_INTEGER>(*this, record.objectType, record.objectInstance, record.propertyIdentifier, (int32_t)(uint32_t)record.value, &errorCode, &handled);
+			break;
+		case CASBACnetStackExampleConstants::DATA_TYPE_UNSIGNED_INTEGER:
+			result = ExampleObjectDescriptors::Set<CASBACnetStackExampleConstants::DATA_TYPE_UNSIGNED_INTEGER>(*this, record.objectType, record.objectInstance, record.propertyIdentifier, (uint32_t)record.value, &errorCode, &handled);
+			break;
+		case CASBACnetStackExampleConstants::DATA_TYPE_ENUMERATED:
+			result = ExampleObjectDescriptors::Set<CASBACnetStackExampleConstants::DATA_TYPE_ENUMERATED>(*this, record.objectType, record.objectInstance, record.propertyIdentifier, (uint32_t)record.value, &errorCode, &handled);
+			break;
+		case CASBACnetStackExampleConstants::DATA_TYPE_BOOLEAN:
+			result = ExampleObjectDescriptors::Set<CASBACnetStackExampleConstants::DATA_TYPE_BOOLEAN>(*this, record.objectType, record.objectInstance, record.propertyIdentifier, record.value != 0, &errorCode, &handled);
+			break;
+	}
+	return handled && result;
+}
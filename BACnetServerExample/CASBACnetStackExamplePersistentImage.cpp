@@ -0,0 +1,311 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExamplePersistentImage.cpp
+ *
+ * See CASBACnetStackExamplePersistentImage.h
+*/
+
+#include "CASBACnetStackExamplePersistentImage.h"
+
+#include <iostream>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+ExamplePersistentImage::ExamplePersistentImage() {
+	this->fd = -1;
+	this->memory = NULL;
+	this->size = 0;
+	this->currentSlot = -1;
+}
+
+ExamplePersistentImage::~ExamplePersistentImage() {
+	this->Close();
+}
+
+// 64 bit FNV-1a over 8 byte words, fast enough to check a few MB at startup.
+uint64_t ExamplePersistentImage::Checksum(const void* data, const size_t length) {
+	const uint8_t* bytes = (const uint8_t*)data;
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	size_t offset = 0;
+	for (; offset + sizeof(uint64_t) <= length; offset += sizeof(uint64_t)) {
+		uint64_t word;
+		memcpy(&word, bytes + offset, sizeof(word));
+		hash = (hash ^ word) * 0x100000001B3ULL;
+	}
+	for (; offset < length; offset++) {
+		hash = (hash ^ bytes[offset]) * 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+bool ExamplePersistentImage::IsValidSlot(const ExamplePersistentImageSlot& slot, const bool checkData) const {
+	if (slot.generation == 0 || slot.slotChecksum != ExamplePersistentImage::Checksum(&slot, offsetof(ExamplePersistentImageSlot, slotChecksum))) {
+		return false;
+	}
+	const uint64_t regionSize = (uint64_t)slot.recordCount * sizeof(ExamplePersistentRecord) + slot.blobSize;
+	if (slot.offset < PAGE_SIZE || slot.offset + regionSize > this->size) {
+		return false;
+	}
+	if (!checkData) {
+		return true;
+	}
+	return slot.dataChecksum == ExamplePersistentImage::Checksum((const uint8_t*)this->memory + slot.offset, (size_t)regionSize);
+}
+
+int ExamplePersistentImage::FindCurrentSlot(const bool checkData) const {
+	const ExamplePersistentImageHeader* header = this->GetHeader();
+	int current = -1;
+	for (int offset = 0; offset < 2; offset++) {
+		if (this->IsValidSlot(header->slots[offset], checkData) && (current < 0 || header->slots[offset].generation > header->slots[current].generation)) {
+			current = offset;
+		}
+	}
+	return current;
+}
+
+uint64_t ExamplePersistentImage::GetGeneration() const {
+	if (this->currentSlot < 0) {
+		return 0;
+	}
+	return this->GetHeader()->slots[this->currentSlot].generation;
+}
+
+uint32_t ExamplePersistentImage::GetRecordCount() const {
+	if (this->currentSlot < 0) {
+		return 0;
+	}
+	return this->GetHeader()->slots[this->currentSlot].recordCount;
+}
+
+const ExamplePersistentRecord& ExamplePersistentImage::GetRecord(const uint32_t offset) const {
+	const ExamplePersistentImageSlot& slot = this->GetHeader()->slots[this->currentSlot];
+	return ((const ExamplePersistentRecord*)((const uint8_t*)this->memory + slot.offset))[offset];
+}
+
+const uint8_t* ExamplePersistentImage::GetData(const ExamplePersistentRecord& record) const {
+	const ExamplePersistentImageSlot& slot = this->GetHeader()->slots[this->currentSlot];
+	const uint8_t* blob = (const uint8_t*)this->memory + slot.offset + (size_t)slot.recordCount * sizeof(ExamplePersistentRecord);
+	if (record.value + record.length > slot.blobSize) {
+		return NULL;
+	}
+	return blob + record.value;
+}
+
+void ExamplePersistentImage::Begin() {
+	this->pendingRecords.clear();
+	this->pendingData.clear();
+}
+
+void ExamplePersistentImage::AddValue(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint32_t arrayIndex, const uint16_t dataType, const uint64_t value) {
+	ExamplePersistentRecord record;
+	memset(&record, 0, sizeof(record));
+	record.objectType = objectType;
+	record.dataType = dataType;
+	record.objectInstance = objectInstance;
+	record.propertyIdentifier = propertyIdentifier;
+	record.arrayIndex = arrayIndex;
+	record.value = value;
+	this->pendingRecords.push_back(record);
+}
+
+void ExamplePersistentImage::AddData(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint32_t arrayIndex, const uint16_t dataType, const void* data, const uint32_t length) {
+	this->AddValue(objectType, objectInstance, propertyIdentifier, arrayIndex, dataType, this->pendingData.size());
+	this->pendingRecords.back().length = length;
+	this->pendingData.insert(this->pendingData.end(), (const uint8_t*)data, (const uint8_t*)data + length);
+}
+
+#ifndef _WIN32
+
+bool ExamplePersistentImage::Open(const std::string& path) {
+	this->Close();
+
+	this->fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+	if (this->fd < 0) {
+		std::cerr << "Error - Could not open the persistent image. path=[" << path << "]" << std::endl;
+		return false;
+	}
+	struct stat status;
+	if (fstat(this->fd, &status) != 0) {
+		std::cerr << "Error - Could not read the size of the persistent image. path=[" << path << "]" << std::endl;
+		this->Close();
+		return false;
+	}
+
+	const bool created = status.st_size == 0;
+	if (created) {
+		if (!this->Resize(PAGE_SIZE)) {
+			this->Close();
+			return false;
+		}
+		ExamplePersistentImageHeader* header = this->GetHeader();
+		header->magic = ExamplePersistentImageHeader::MAGIC;
+		header->layoutVersion = ExamplePersistentImageHeader::LAYOUT_VERSION;
+		msync(this->memory, PAGE_SIZE, MS_SYNC);
+	}
+	else {
+		if ((size_t)status.st_size < PAGE_SIZE) {
+			std::cerr << "Error - The persistent image is too small. path=[" << path << "]" << std::endl;
+			this->Close();
+			return false;
+		}
+		this->memory = mmap(NULL, (size_t)status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+		if (this->memory == MAP_FAILED) {
+			this->memory = NULL;
+			std::cerr << "Error - Could not map the persistent image. path=[" << path << "]" << std::endl;
+			this->Close();
+			return false;
+		}
+		this->size = (size_t)status.st_size;
+	}
+
+	const ExamplePersistentImageHeader* header = this->GetHeader();
+	if (header->magic != ExamplePersistentImageHeader::MAGIC || header->layoutVersion != ExamplePersistentImageHeader::LAYOUT_VERSION) {
+		std::cerr << "Error - Not a persistent image, or an unsupported layout. path=[" << path << "]" << std::endl;
+		this->Close();
+		return false;
+	}
+	this->path = path;
+	this->currentSlot = this->FindCurrentSlot(true);
+	return true;
+}
+
+void ExamplePersistentImage::Close() {
+	if (this->memory != NULL) {
+		munmap(this->memory, this->size);
+	}
+	if (this->fd >= 0) {
+		close(this->fd);
+	}
+	this->fd = -1;
+	this->memory = NULL;
+	this->size = 0;
+	this->currentSlot = -1;
+}
+
+bool ExamplePersistentImage::Reload() {
+	if (this->fd < 0) {
+		return false;
+	}
+	struct stat status;
+	if (fstat(this->fd, &status) != 0) {
+		std::cerr << "Error - Could not read the size of the persistent image. path=[" << this->path << "]" << std::endl;
+		return false;
+	}
+	if ((size_t)status.st_size != this->size) {
+		munmap(this->memory, this->size);
+		this->memory = mmap(NULL, (size_t)status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+		if (this->memory == MAP_FAILED) {
+			this->memory = NULL;
+			std::cerr << "Error - Could not map the persistent image. path=[" << this->path << "]" << std::endl;
+			this->Close();
+			return false;
+		}
+		this->size = (size_t)status.st_size;
+	}
+	this->currentSlot = this->FindCurrentSlot(false);
+	return true;
+}
+
+// Grows the file and maps it again. The regions already written keep their offsets.
+bool ExamplePersistentImage::Resize(const size_t size) {
+	if (ftruncate(this->fd, (off_t)size) != 0) {
+		std::cerr << "Error - Could not resize the persistent image. size=[" << size << "]" << std::endl;
+		return false;
+	}
+	if (this->memory != NULL) {
+		munmap(this->memory, this->size);
+	}
+	this->memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+	if (this->memory == MAP_FAILED) {
+		this->memory = NULL;
+		this->size = 0;
+		std::cerr << "Error - Could not map the persistent image. size=[" << size << "]" << std::endl;
+		return false;
+	}
+	this->size = size;
+	return true;
+}
+
+bool ExamplePersistentImage::Commit() {
+	if (this->memory == NULL) {
+		return false;
+	}
+
+	// Place the new generation where it does not overlap the current one: at the start of the file
+	// if it fits before it, otherwise after it.
+	const size_t regionSize = this->pendingRecords.size() * sizeof(ExamplePersistentRecord) + this->pendingData.size();
+	size_t offset = PAGE_SIZE;
+	if (this->currentSlot >= 0) {
+		const ExamplePersistentImageSlot& current = this->GetHeader()->slots[this->currentSlot];
+		const size_t currentEnd = (size_t)current.offset + (size_t)current.recordCount * sizeof(ExamplePersistentRecord) + current.blobSize;
+		if (offset + regionSize > current.offset) {
+			offset = (currentEnd + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+		}
+	}
+	if (offset + regionSize > this->size && !this->Resize(offset + regionSize)) {
+		return false;
+	}
+
+	// 1. Write and flush the new generation
+	uint8_t* region = (uint8_t*)this->memory + offset;
+	if (!this->pendingRecords.empty()) {
+		memcpy(region, &this->pendingRecords[0], this->pendingRecords.size() * sizeof(ExamplePersistentRecord));
+	}
+	if (!this->pendingData.empty()) {
+		memcpy(region + this->pendingRecords.size() * sizeof(ExamplePersistentRecord), &this->pendingData[0], this->pendingData.size());
+	}
+	if (regionSize > 0 && msync((uint8_t*)this->memory + offset / PAGE_SIZE * PAGE_SIZE, regionSize + offset % PAGE_SIZE, MS_SYNC) != 0) {
+		std::cerr << "Error - Could not flush the persistent image. path=[" << this->path << "]" << std::endl;
+		return false;
+	}
+
+	// 2. Point the older slot at it and flush the header. Until this reaches the disk the current
+	// generation is the one that is loaded.
+	const int nextSlot = this->currentSlot < 0 ? 0 : this->currentSlot ^ 1;
+	ExamplePersistentImageSlot slot;
+	memset(&slot, 0, sizeof(slot));
+	slot.generation = this->GetGeneration() + 1;
+	slot.offset = offset;
+	slot.recordCount = (uint32_t)this->pendingRecords.size();
+	slot.blobSize = (uint32_t)this->pendingData.size();
+	slot.dataChecksum = ExamplePersistentImage::Checksum(region, regionSize);
+	slot.slotChecksum = ExamplePersistentImage::Checksum(&slot, offsetof(ExamplePersistentImageSlot, slotChecksum));
+	this->GetHeader()->slots[nextSlot] = slot;
+	if (msync(this->memory, PAGE_SIZE, MS_SYNC) != 0) {
+		std::cerr << "Error - Could not flush the persistent image header. path=[" << this->path << "]" << std::endl;
+		return false;
+	}
+	this->currentSlot = nextSlot;
+	return true;
+}
+
+#else // _WIN32
+
+bool ExamplePersistentImage::Open(const std::string& path) {
+	std::cerr << "Error - The persistent image is only supported on POSIX systems" << std::endl;
+	return false;
+}
+
+void ExamplePersistentImage::Close() {
+}
+
+bool ExamplePersistentImage::Reload() {
+	return false;
+}
+
+bool ExamplePersistentImage::Resize(const size_t size) {
+	return false;
+}
+
+bool ExamplePersistentImage::Commit() {
+	return false;
+}
+
+#endif // _WIN32
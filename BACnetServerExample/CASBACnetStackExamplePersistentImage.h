@@ -0,0 +1,131 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExamplePersistentImage.h
+ *
+ * Memory mapped on-disk image of the values that must survive a restart
+ * (the writable properties, the created objects and the network port
+ * configuration).
+ *
+ * The image is a flat table of fixed size records, one per property value,
+ * followed by the variable length data of the string records. Each save
+ * writes a complete new generation to a free region of the file, flushes
+ * it, and only then flips the header slot that points at it. A crash in the
+ * middle of a save leaves the previous generation in place. On open the
+ * newest slot whose checksums match is used, nothing is parsed or copied:
+ * the records are read straight from the mapping.
+ *
+ * File layout (layout version 1)
+ *   Page 0   ExamplePersistentImageHeader, two slots written alternately
+ *   Region   ExamplePersistentRecord[recordCount], then blobSize bytes of string data
+ *   Region   The other generation, anywhere after page 0
+ *
+ * Only supported on POSIX systems. On Windows Open fails and the example
+ * runs from the default values.
+*/
+
+#ifndef __CASBACnetStackExamplePersistentImage_h__
+#define __CASBACnetStackExamplePersistentImage_h__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+struct ExamplePersistentRecord {
+	uint16_t objectType;
+	uint16_t dataType; // CASBACnetStackExampleConstants::DATA_TYPE_*
+	uint32_t objectInstance;
+	uint32_t propertyIdentifier;
+	uint32_t arrayIndex; // Priority for priority array values, array index, or 0
+	uint32_t length; // Bytes of string data, 0 for scalar values
+	uint32_t reserved;
+	uint64_t value; // Raw bits of a scalar value, or the offset of the string data in the blob
+};
+
+struct ExamplePersistentImageSlot {
+	uint64_t generation; // 0 = never written
+	uint64_t offset; // File offset of the region, page aligned
+	uint32_t recordCount;
+	uint32_t blobSize;
+	uint64_t dataChecksum; // Checksum of the region
+	uint64_t slotChecksum; // Checksum of the fields above
+};
+
+struct ExamplePersistentImageHeader {
+	static const uint32_t MAGIC = 0x49534143; // "CASI"
+	static const uint32_t LAYOUT_VERSION = 1;
+
+	uint32_t magic;
+	uint32_t layoutVersion;
+	ExamplePersistentImageSlot slots[2];
+};
+
+// Destination of the saved values, the persistent image or the write-ahead log
+class ExamplePersistentRecordWriter
+{
+	public:
+		virtual ~ExamplePersistentRecordWriter() {
+		}
+		virtual void AddValue(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint32_t arrayIndex, const uint16_t dataType, const uint64_t value) = 0;
+		virtual void AddData(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint32_t arrayIndex, const uint16_t dataType, const void* data, const uint32_t length) = 0;
+};
+
+class ExamplePersistentImage : public ExamplePersistentRecordWriter
+{
+	public:
+		ExamplePersistentImage();
+		~ExamplePersistentImage();
+
+		// Maps the image file, creating an empty one if it does not exist. Fails if the file is not an image.
+		bool Open(const std::string& path);
+		void Close();
+		bool IsOpen() const {
+			return this->memory != NULL;
+		}
+		// Maps the file again and finds the current generation, after another process (a background
+		// checkpoint) has committed a new generation to it. That process has flushed the region before the
+		// header, so only the slot checksums are checked, not the whole region.
+		bool Reload();
+
+		// Current generation, read straight from the mapping. Empty (generation 0) for a new image.
+		uint64_t GetGeneration() const;
+		uint32_t GetRecordCount() const;
+		const ExamplePersistentRecord& GetRecord(const uint32_t offset) const;
+		// String data of a record, GetRecord(offset).length bytes
+		const uint8_t* GetData(const ExamplePersistentRecord& record) const;
+
+		// Saving a new generation. Begin clears the pending records, Add* appends to them and Commit writes
+		// them out and flips the header. The pending buffers are kept between saves.
+		void Begin();
+		void AddValue(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint32_t arrayIndex, const uint16_t dataType, const uint64_t value);
+		void AddData(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint32_t arrayIndex, const uint16_t dataType, const void* data, const uint32_t length);
+		bool Commit();
+
+		static uint64_t Checksum(const void* data, const size_t length);
+
+	private:
+		ExamplePersistentImage(const ExamplePersistentImage&);
+		ExamplePersistentImage& operator=(const ExamplePersistentImage&);
+
+		static const size_t PAGE_SIZE = 4096;
+
+		// Index of the newest valid slot, or -1 if there is none
+		int FindCurrentSlot(const bool checkData) const;
+		bool IsValidSlot(const ExamplePersistentImageSlot& slot, const bool checkData) const;
+		bool Resize(const size_t size);
+		ExamplePersistentImageHeader* GetHeader() const {
+			return (ExamplePersistentImageHeader*)this->memory;
+		}
+
+		std::string path;
+		int fd;
+		void* memory;
+		size_t size;
+		int currentSlot;
+
+		std::vector<ExamplePersistentRecord> pendingRecords;
+		std::vector<uint8_t> pendingData;
+};
+
+#endif // __CASBACnetStackExamplePersistentImage_h__
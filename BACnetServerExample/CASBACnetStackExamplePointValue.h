@@ -0,0 +1,100 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExamplePointValue.h
+ *
+ * Point values that can be updated by a field I/O (acquisition) thread while
+ * the CAS BACnet Stack reads them from the callbacks on the main thread.
+ *
+ * ExampleSeqLock is used for values made of several fields that must be
+ * read together (for example a date and time). Writers are serialized with
+ * the sequence counter, readers never lock and retry if a write happened
+ * while they were copying the value. It never blocks the thread that calls
+ * fpTick().
+ *
+ * The scalar input points are kept in the double buffered snapshot, see
+ * CASBACnetStackExampleSnapshot.h.
+*/
+
+#ifndef __CASBACnetStackExamplePointValue_h__
+#define __CASBACnetStackExamplePointValue_h__
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+// Gives the value type stored by a point, used by the object descriptors to convert callback values.
+// Specialized by the point wrappers (see ExampleSnapshotPoint).
+template <typename T>
+struct ExamplePointValueType {
+	typedef T Type;
+};
+
+// T must be a plain struct that can be copied with memcpy.
+template <typename T>
+class ExampleSeqLock
+{
+	public:
+		ExampleSeqLock() : sequence(0) {
+			for (uint32_t offset = 0; offset < WORD_COUNT; offset++) {
+				this->words[offset].store(0, std::memory_order_relaxed);
+			}
+		}
+
+		// Returns a consistent copy of the value. Never blocks a writer.
+		T Read() const {
+			uint64_t copy[WORD_COUNT];
+			for (;;) {
+				const uint32_t begin = this->sequence.load(std::memory_order_acquire);
+				if (begin & 1) {
+					continue; // Write in progress
+				}
+				for (uint32_t offset = 0; offset < WORD_COUNT; offset++) {
+					copy[offset] = this->words[offset].load(std::memory_order_relaxed);
+				}
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (this->sequence.load(std::memory_order_relaxed) == begin) {
+					break;
+				}
+			}
+			T result;
+			memcpy(&result, copy, sizeof(T));
+			return result;
+		}
+
+		void Write(const T& value) {
+			uint64_t copy[WORD_COUNT] = { 0 };
+			memcpy(copy, &value, sizeof(T));
+
+			// An odd sequence marks a write in progress. Taking it with a compare exchange
+			// serializes writers from different threads.
+			uint32_t begin = this->sequence.load(std::memory_order_relaxed);
+			for (;;) {
+				if ((begin & 1) == 0 && this->sequence.compare_exchange_weak(begin, begin + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+					break;
+				}
+				begin = this->sequence.load(std::memory_order_relaxed);
+			}
+			std::atomic_thread_fence(std::memory_order_release);
+			for (uint32_t offset = 0; offset < WORD_COUNT; offset++) {
+				this->words[offset].store(copy[offset], std::memory_order_relaxed);
+			}
+			this->sequence.store(begin + 2, std::memory_order_release);
+		}
+
+		// Number of completed writes, can be used to see if the value changed since the last read.
+		uint32_t GetVersion() const {
+			return this->sequence.load(std::memory_order_acquire) / 2;
+		}
+
+	private:
+		static const uint32_t WORD_COUNT = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+		ExampleSeqLock(const ExampleSeqLock&);
+		ExampleSeqLock& operator=(const ExampleSeqLock&);
+
+		std::atomic<uint32_t> sequence;
+		std::atomic<uint64_t> words[WORD_COUNT];
+};
+
+#endif // __CASBACnetStackExamplePointValue_h__
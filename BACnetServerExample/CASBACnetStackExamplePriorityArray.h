@@ -0,0 +1,128 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExamplePriorityArray.h
+ *
+ * Priority array used by the commandable objects in the example database
+ * (Analog Output, Binary Output, Multi-State Output).
+ *
+ * The NULL slots are stored as a 16 bit mask (bit 0 = priority 1). The winning
+ * priority is the lowest slot that is not NULL, found with a count trailing zeros
+ * on the inverted mask. The effective present value is cached and only
+ * recalculated when a slot or the relinquish default changes, so reading the
+ * present value is a single load.
+*/
+
+#ifndef __CASBACnetStackExamplePriorityArray_h__
+#define __CASBACnetStackExamplePriorityArray_h__
+
+#include <stdint.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif // _MSC_VER
+
+// Returns the index of the lowest set bit. The value must not be zero.
+inline uint32_t ExampleCountTrailingZeros(uint32_t value) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctz(value);
+#endif // _MSC_VER
+}
+
+template <typename T>
+class ExampleDatabasePriorityArray
+{
+	public:
+		static const uint8_t PRIORITY_ARRAY_LENGTH = 16;
+		static const uint16_t ALL_NULL = 0xFFFF;
+
+		ExampleDatabasePriorityArray(const T relinquishDefault) {
+			this->nullMask = ALL_NULL;
+			this->relinquishDefault = relinquishDefault;
+			this->presentValue = relinquishDefault;
+			for (uint8_t offset = 0; offset < PRIORITY_ARRAY_LENGTH; offset++) {
+				this->values[offset] = relinquishDefault;
+			}
+		}
+
+		// Priorities are 1 (highest) to 16 (lowest), the same as the BACnet priority array index.
+		bool IsValidPriority(const uint32_t priority) const {
+			return priority >= 1 && priority <= PRIORITY_ARRAY_LENGTH;
+		}
+
+		bool IsNull(const uint32_t priority) const {
+			if (!this->IsValidPriority(priority)) {
+				return true;
+			}
+			return (this->nullMask & (1u << (priority - 1))) != 0;
+		}
+
+		T GetValue(const uint32_t priority) const {
+			if (!this->IsValidPriority(priority)) {
+				return this->relinquishDefault;
+			}
+			return this->values[priority - 1];
+		}
+
+		// Writes a value into a slot. Returns true if the present value changed.
+		bool Set(const uint32_t priority, const T value) {
+			if (!this->IsValidPriority(priority)) {
+				return false;
+			}
+			this->values[priority - 1] = value;
+			this->nullMask &= (uint16_t)~(1u << (priority - 1));
+			return this->Resolve();
+		}
+
+		// Sets a slot back to NULL. Returns true if the present value changed.
+		bool Relinquish(const uint32_t priority) {
+			if (!this->IsValidPriority(priority)) {
+				return false;
+			}
+			this->nullMask |= (uint16_t)(1u << (priority - 1));
+			return this->Resolve();
+		}
+
+		// Returns true if the present value changed.
+		bool SetRelinquishDefault(const T value) {
+			this->relinquishDefault = value;
+			return this->Resolve();
+		}
+
+		T GetRelinquishDefault() const {
+			return this->relinquishDefault;
+		}
+
+		T GetPresentValue() const {
+			return this->presentValue;
+		}
+
+		// Returns the priority that is currently in control, or zero if the relinquish default is in use.
+		uint8_t GetActivePriority() const {
+			const uint32_t commanded = (uint16_t)~this->nullMask;
+			if (commanded == 0) {
+				return 0;
+			}
+			return (uint8_t)(ExampleCountTrailingZeros(commanded) + 1);
+		}
+
+	private:
+		uint16_t nullMask; // Bit set = slot is NULL. Bit 0 is priority 1.
+		T values[PRIORITY_ARRAY_LENGTH];
+		T relinquishDefault;
+		T presentValue; // Cached effective value
+
+		bool Resolve() {
+			const uint8_t activePriority = this->GetActivePriority();
+			const T newValue = activePriority == 0 ? this->relinquishDefault : this->values[activePriority - 1];
+			const bool changed = !(newValue == this->presentValue);
+			this->presentValue = newValue;
+			return changed;
+		}
+};
+
+#endif // __CASBACnetStackExamplePriorityArray_h__
@@ -0,0 +1,726 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleProfile.cpp
+ *
+ * Loads a device profile, a JSON file that describes the device and its
+ * objects, over the default values from ExampleDatabase::Setup. The profile
+ * is read with the streaming reader (CASBACnetStackExampleJsonReader.h), one
+ * object at a time.
+ *
+ * {
+ *   "device": { "instance": 389001, "name": "Boiler room", "description": "...", "values": { "119": -300 } },
+ *   "templates": {
+ *     "setpoint": { "writable": [ 85 ], "subscribable": [ 85 ],
+ *       "proprietary": [ { "property": 600, "dataType": 4, "writable": true, "subscribable": false, "array": false } ] }
+ *   },
+ *   "objects": [
+ *     { "type": 0, "instance": 0, "name": "Supply temperature", "description": "...", "values": { "22": 0.5 } },
+ *     { "type": 2, "instance": 1000, "name": "Setpoint 1000", "values": { "85": 21.5 },
+ *       "enabled": [ 28 ], "writable": [ 77 ], "subscribable": [ 85 ] },
+ *     { "type": 2, "instance": 1001, "name": "Setpoint 1001", "template": "setpoint" }
+ *   ]
+ * }
+ *
+ * Objects
+ *   type and instance are the BACnet object type and instance. An object that
+ *   is in the example database is updated, an Analog Value that is not is
+ *   added like one created with the CreateObject service. Other object types
+ *   can not be added.
+ * Values
+ *   Keyed by property identifier. Numbers and booleans, for the properties
+ *   declared writable in CASBACnetStackExampleObjectDescriptors.h (for added
+ *   Analog Values, the present value). Values are validated like a write.
+ * Property flags
+ *   enabled, writable and subscribable list property identifiers. They are
+ *   stored in ExampleDatabase::profileProperties and applied by SetupDevice
+ *   once the objects are added to the stack.
+ * Templates
+ *   Property flags and proprietary properties shared by many objects. A
+ *   template is declared once, before the objects that use it, and an object
+ *   names it with "template". Each object is stored as a small reference to
+ *   its template instead of a copy of the flags, and SetupDevice enables a
+ *   template's properties for a whole object type at once when every object
+ *   of the type uses the template.
+ *
+ * A profile can be compiled offline (--compile-profile) into a binary image
+ * that is mapped at startup instead, see CASBACnetStackExampleCompiledProfile.h
+*/
+
+#include "CASBACnetStackExampleDatabase.h"
+#include "CASBACnetStackExampleConstants.h"
+#include "CASBACnetStackExampleJsonReader.h"
+#include "CASBACnetStackExampleObjectDescriptors.h"
+
+#include <algorithm> // std::sort
+#include <float.h> // FLT_MAX
+#include <iostream>
+#include <map>
+#include <math.h> // floor()
+#include <stdint.h>
+#include <stdlib.h> // strtoul()
+
+// One object of the profile. The keys can come in any order, so the object is collected and then applied.
+// The vectors are reused from one object to the next.
+struct ExampleProfileObject {
+	bool hasType;
+	bool hasInstance;
+	bool hasName;
+	bool hasDescription;
+	bool hasTemplate;
+	uint16_t objectType;
+	uint32_t objectInstance;
+	std::string name;
+	std::string description;
+	std::string templateName;
+
+	struct Value {
+		uint32_t propertyIdentifier;
+		bool boolean; // true / false, otherwise a number
+		double number;
+	};
+	std::vector<Value> values;
+	std::vector<ExampleProfileProperty> properties;
+
+	void Clear() {
+		this->hasType = false;
+		this->hasInstance = false;
+		this->hasName = false;
+		this->hasDescription = false;
+		this->hasTemplate = false;
+		this->objectType = 0;
+		this->objectInstance = 0;
+		this->values.clear();
+		this->properties.clear();
+	}
+};
+
+// Largest object type, object instance and property identifier of a BACnet object identifier
+static const uint32_t EXAMPLE_PROFILE_MAX_OBJECT_TYPE = 0x3FF;
+static const uint32_t EXAMPLE_PROFILE_MAX_INSTANCE = 0x3FFFFF;
+static const uint32_t EXAMPLE_PROFILE_MAX_PROPERTY_IDENTIFIER = 0x3FFFFF;
+
+// The number just read, as an integer from 0 to maximum. Anything else is an error, it is never cast.
+static bool ExampleGetProfileInteger(ExampleJsonReader& reader, const char* key, const uint32_t maximum, uint32_t* value) {
+	const double number = reader.GetNumber();
+	if (!(number >= 0.0 && number <= (double)maximum) || number != floor(number)) {
+		std::cerr << "Error - Expected an integer from 0 to " << maximum << ". key=[" << key << "], value=[" << number << "], line=[" << reader.GetLine() << "]" << std::endl;
+		return false;
+	}
+	*value = (uint32_t)number;
+	return true;
+}
+
+static bool ExampleReadProfileInteger(ExampleJsonReader& reader, const char* key, const uint32_t maximum, uint32_t* value) {
+	if (reader.Next() != ExampleJsonReader::TOKEN_NUMBER) {
+		std::cerr << "Error - Expected a number. key=[" << key << "], line=[" << reader.GetLine() << "]" << std::endl;
+		return false;
+	}
+	return ExampleGetProfileInteger(reader, key, maximum, value);
+}
+
+static bool ExampleReadProfileString(ExampleJsonReader& reader, const char* key, std::string* value) {
+	if (reader.Next() != ExampleJsonReader::TOKEN_STRING) {
+		std::cerr << "Error - Expected a string. key=[" << key << "], line=[" << reader.GetLine() << "]" << std::endl;
+		return false;
+	}
+	*value = reader.GetString();
+	return true;
+}
+
+// "values": { "<propertyIdentifier>": number or boolean, ... }
+static bool ExampleReadProfileValues(ExampleJsonReader& reader, ExampleProfileObject& object) {
+	if (reader.Next() != ExampleJsonReader::TOKEN_BEGIN_OBJECT) {
+		std::cerr << "Error - Expected an object. key=[values], line=[" << reader.GetLine() << "]" << std::endl;
+		return false;
+	}
+	for (;;) {
+		ExampleJsonReader::Token token = reader.Next();
+		if (token == ExampleJsonReader::TOKEN_END_OBJECT) {
+			return true;
+		}
+		if (token != ExampleJsonReader::TOKEN_KEY) {
+			return false;
+		}
+		ExampleProfileObject::Value value;
+		char* end = NULL;
+		const unsigned long propertyIdentifier = strtoul(reader.GetString().c_str(), &end, 10);
+		value.propertyIdentifier = (uint32_t)propertyIdentifier;
+		if (reader.GetString().empty() || *end != 0 || propertyIdentifier > EXAMPLE_PROFILE_MAX_PROPERTY_IDENTIFIER) {
+			std::cerr << "Error - Values are keyed by property identifier. key=[" << reader.GetString() << "], line=[" << reader.GetLine() << "]" << std::endl;
+			return false;
+		}
+		token = reader.Next();
+		if (token == ExampleJsonReader::TOKEN_NUMBER) {
+			value.boolean = false;
+			value.number = reader.GetNumber();
+		}
+		else if (token == ExampleJsonReader::TOKEN_TRUE || token == ExampleJsonReader::TOKEN_FALSE) {
+			value.boolean = true;
+			value.number = token == ExampleJsonReader::TOKEN_TRUE ? 1 : 0;
+		}
+		else {
+			std::cerr << "Error - Only numbers and booleans are supported as values. propertyIdentifier=[" << value.propertyIdentifier << "], line=[" << reader.GetLine() << "]" << std::endl;
+			return false;
+		}
+		object.values.push_back(value);
+	}
+}
+
+// "enabled" / "writable" / "subscribable": [ propertyIdentifier, ... ]
+static bool ExampleReadProfileProperties(ExampleJsonReader& reader, ExampleProfileObject& object, const uint16_t flag) {
+	if (reader.Next() != ExampleJsonReader::TOKEN_BEGIN_ARRAY) {
+		std::cerr << "Error - Expected an array of property identifiers. line=[" << reader.GetLine() << "]" << std::endl;
+		return false;
+	}
+	for (;;) {
+		const ExampleJsonReader::Token token = reader.Next();
+		if (token == ExampleJsonReader::TOKEN_END_ARRAY) {
+			return true;
+		}
+		if (token != ExampleJsonReader::TOKEN_NUMBER) {
+			std::cerr << "Error - Expected a property identifier. line=[" << reader.GetLine() << "]" << std::endl;
+			return false;
+		}
+		ExampleProfileProperty property;
+		property.objectType = 0; // Set when the object is applied
+		property.objectInstance = 0;
+		if (!ExampleGetProfileInteger(reader, "property", EXAMPLE_PROFILE_MAX_PROPERTY_IDENTIFIER, &property.propertyIdentifier)) {
+			return false;
+		}
+		property.flags = flag;
+		object.properties.push_back(property);
+	}
+}
+
+// Reads the keys of one object, the opening brace has been read.
+static bool ExampleReadProfileObject(ExampleJsonReader& reader, ExampleProfileObject& object) {
+	object.Clear();
+	for (;;) {
+		const ExampleJsonReader::Token token = reader.Next();
+		if (token == ExampleJsonReader::TOKEN_END_OBJECT) {
+			return true;
+		}
+		if (token != ExampleJsonReader::TOKEN_KEY) {
+			return false;
+		}
+		const std::string& key = reader.GetString();
+		uint32_t number = 0;
+		bool ok = true;
+		if (key == "type") {
+			ok = ExampleReadProfileInteger(reader, "type", EXAMPLE_PROFILE_MAX_OBJECT_TYPE, &number);
+			object.objectType = (uint16_t)number;
+			object.hasType = true;
+		}
+		else if (key == "instance") {
+			ok = ExampleReadProfileInteger(reader, "instance", EXAMPLE_PROFILE_MAX_INSTANCE, &object.objectInstance);
+			object.hasInstance = true;
+		}
+		else if (key == "name") {
+			ok = ExampleReadProfileString(reader, "name", &object.name);
+			object.hasName = true;
+		}
+		else if (key == "description") {
+			ok = ExampleReadProfileString(reader, "description", &object.description);
+			object.hasDescription = true;
+		}
+		else if (key == "values") {
+			ok = ExampleReadProfileValues(reader, object);
+		}
+		else if (key == "template") {
+			ok = ExampleReadProfileString(reader, "template", &object.templateName);
+			object.hasTemplate = true;
+		}
+		else if (key == "enabled") {
+			ok = ExampleReadProfileProperties(reader, object, ExampleProfileProperty::ENABLED);
+		}
+		else if (key == "writable") {
+			ok = ExampleReadProfileProperties(reader, object, ExampleProfileProperty::WRITABLE);
+		}
+		else if (key == "subscribable") {
+			ok = ExampleReadProfileProperties(reader, object, ExampleProfileProperty::SUBSCRIBABLE);
+		}
+		else {
+			// Unknown keys are ignored so that profiles can carry extra information
+			ok = reader.Skip(reader.Next());
+		}
+		if (!ok) {
+			return false;
+		}
+	}
+}
+
+// "enabled" / "writable" / "subscribable" of a template
+static bool ExampleReadProfileTemplateProperties(ExampleJsonReader& reader, std::vector<ExampleObjectTemplateProperty>& properties, const uint16_t templateIndex, const uint16_t flag) {
+	if (reader.Next() != ExampleJsonReader::TOKEN_BEGIN_ARRAY) {
+		std::cerr << "Error - Expected an array of property identifiers. line=[" << reader.GetLine() << "]" << std::endl;
+		return false;
+	}
+	for (;;) {
+		const ExampleJsonReader::Token token = reader.Next();
+		if (token == ExampleJsonReader::TOKEN_END_ARRAY) {
+			return true;
+		}
+		if (token != ExampleJsonReader::TOKEN_NUMBER) {
+			std::cerr << "Error - Expected a property identifier. line=[" << reader.GetLine() << "]" << std::endl;
+			return false;
+		}
+		ExampleObjectTemplateProperty property;
+		property.templateIndex = templateIndex;
+		property.flags = flag;
+		property.dataType = 0;
+		if (!ExampleGetProfileInteger(reader, "property", EXAMPLE_PROFILE_MAX_PROPERTY_IDENTIFIER, &property.propertyIdentifier)) {
+			return false;
+		}
+		properties.push_back(property);
+	}
+}
+
+// "proprietary": [ { "property": 600, "dataType": 4, "writable": true, "subscribable": false, "array": false }, ... ]
+static bool ExampleReadProfileTemplateProprietary(ExampleJsonReader& reader, std::vector<ExampleObjectTemplateProperty>& properties, const uint16_t templateIndex) {
+	if (reader.Next() != ExampleJsonReader::TOKEN_BEGIN_ARRAY) {
+		std::cerr << "Error - Expected an array of proprietary properties. line=[" << reader.GetLine() << "]" << std::endl;
+		return false;
+	}
+	for (;;) {
+		ExampleJsonReader::Token token = reader.Next();
+		if (token == ExampleJsonReader::TOKEN_END_ARRAY) {
+			return true;
+		}
+		if (token != ExampleJsonReader::TOKEN_BEGIN_OBJECT) {
+			return false;
+		}
+		ExampleObjectTemplateProperty property;
+		property.templateIndex = templateIndex;
+		property.flags = ExampleObjectTemplateProperty::PROPRIETARY;
+		property.propertyIdentifier = 0;
+		property.dataType = 0;
+		bool hasProperty = false;
+		bool hasDataType = false;
+		for (;;) {
+			token = reader.Next();
+			if (token == ExampleJsonReader::TOKEN_END_OBJECT) {
+				break;
+			}
+			if (token != ExampleJsonReader::TOKEN_KEY) {
+				return false;
+			}
+			const std::string key = reader.GetString();
+			token = reader.Next();
+			if (key == "property" && token == ExampleJsonReader::TOKEN_NUMBER) {
+				if (!ExampleGetProfileInteger(reader, "property", EXAMPLE_PROFILE_MAX_PROPERTY_IDENTIFIER, &property.propertyIdentifier)) {
+					return false;
+				}
+				hasProperty = true;
+			}
+			else if (key == "dataType" && token == ExampleJsonReader::TOKEN_NUMBER) {
+				if (!ExampleGetProfileInteger(reader, "dataType", 0xFFFF, &property.dataType)) {
+					return false;
+				}
+				hasDataType = true;
+			}
+			else if ((key == "writable" || key == "subscribable" || key == "array") && (token == ExampleJsonReader::TOKEN_TRUE || token == ExampleJsonReader::TOKEN_FALSE)) {
+				if (token == ExampleJsonReader::TOKEN_TRUE) {
+					property.flags |= key == "writable" ? ExampleObjectTemplateProperty::WRITABLE : key == "subscribable" ? ExampleObjectTemplateProperty::SUBSCRIBABLE : ExampleObjectTemplateProperty::ARRAY;
+				}
+			}
+			else {
+				std::cerr << "Error - Invalid proprietary property. key=[" << key << "], line=[" << reader.GetLine() << "]" << std::endl;
+				return false;
+			}
+		}
+		if (!hasProperty || !hasDataType) {
+			std::cerr << "Error - Proprietary properties need a property and a dataType. line=[" << reader.GetLine() << "]" << std::endl;
+			return false;
+		}
+		properties.push_back(property);
+	}
+}
+
+// "templates": { "<name>": { ... }, ... }. The template index is the position in templateNames.
+static bool ExampleReadProfileTemplates(ExampleJsonReader& reader, ExampleDatabase& database, std::map<std::string, uint16_t>& templateNames) {
+	if (reader.Next() != ExampleJsonReader::TOKEN_BEGIN_OBJECT) {
+		std::cerr << "Error - Expected an object. key=[templates], line=[" << reader.GetLine() << "]" << std::endl;
+		return false;
+	}
+	std::vector<ExampleObjectTemplateProperty>& properties = database.objectTemplateProperties;
+	for (;;) {
+		ExampleJsonReader::Token token = reader.Next();
+		if (token == ExampleJsonReader::TOKEN_END_OBJECT) {
+			return true;
+		}
+		if (token != ExampleJsonReader::TOKEN_KEY) {
+			return false;
+		}
+		if (templateNames.count(reader.GetString()) > 0 || templateNames.size() >= 0xFFFF) {
+			std::cerr << "Error - Duplicate template, or too many templates. name=[" << reader.GetString() << "], line=[" << reader.GetLine() << "]" << std::endl;
+			return false;
+		}
+		const uint16_t templateIndex = (uint16_t)templateNames.size();
+		templateNames[reader.GetString()] = templateIndex;
+		if (reader.Next() != ExampleJsonReader::TOKEN_BEGIN_OBJECT) {
+			return false;
+		}
+		for (;;) {
+			token = reader.Next();
+			if (token == ExampleJsonReader::TOKEN_END_OBJECT) {
+				break;
+			}
+			if (token != ExampleJsonReader::TOKEN_KEY) {
+				return false;
+			}
+			bool ok = true;
+			if (reader.GetString() == "enabled") {
+				ok = ExampleReadProfileTemplateProperties(reader, properties, templateIndex, ExampleObjectTemplateProperty::ENABLED);
+			}
+			else if (reader.GetString() == "writable") {
+				ok = ExampleReadProfileTemplateProperties(reader, properties, templateIndex, ExampleObjectTemplateProperty::WRITABLE);
+			}
+			else if (reader.GetString() == "subscribable") {
+				ok = ExampleReadProfileTemplateProperties(reader, properties, templateIndex, ExampleObjectTemplateProperty::SUBSCRIBABLE);
+			}
+			else if (reader.GetString() == "proprietary") {
+				ok = ExampleReadProfileTemplateProprietary(reader, properties, templateIndex);
+			}
+			else {
+				ok = reader.Skip(reader.Next());
+			}
+			if (!ok) {
+				return false;
+			}
+		}
+	}
+}
+
+// Writes a value through the object descriptors, trying the data types a number or a boolean can be declared with.
+static bool ExampleSetProfileValue(ExampleDatabase& database, const uint16_t objectType, const uint32_t objectInstance, const ExampleProfileObject::Value& value) {
+	uint32_t errorCode = 0;
+	bool handled = false;
+	bool result = false;
+	// Each type is only tried with a number it can hold, a cast of a number out of range is undefined
+	const double number = value.number;
+	const bool integer = number == floor(number);
+	const bool real = number >= -FLT_MAX && number <= FLT_MAX;
+	const bool signedInteger = integer && number >= (double)INT32_MIN && number <= (double)INT32_MAX;
+	const bool unsignedInteger = integer && number >= 0.0 && number <= (double)UINT32_MAX;
+	if (value.boolean) {
+		result = ExampleObjectDescriptors::Set<CASBACnetStackExampleConstants::DATA_TYPE_BOOLEAN>(database, objectType, objectInstance, value.propertyIdentifier, number != 0, &errorCode, &handled);
+	}
+	if (!handled && real) {
+		result = ExampleObjectDescriptors::Set<CASBACnetStackExampleConstants::DATA_TYPE_REAL>(database, objectType, objectInstance, value.propertyIdentifier, (float)number, &errorCode, &handled);
+	}
+	if (!handled) {
+		result = ExampleObjectDescriptors::Set<CASBACnetStackExampleConstants::DATA_TYPE_DOUBLE>(database, objectType, objectInstance, value.propertyIdentifier, number, &errorCode, &handled);
+	}
+	if (!handled && signedInteger) {
+		result = ExampleObjectDescriptors::Set<CASBACnetStackExampleConstants::DATA_TYPE_SIGNED_INTEGER>(database, objectType, objectInstance, value.propertyIdentifier, (int32_t)number, &errorCode, &handled);
+	}
+	if (!handled && unsignedInteger) {
+		result = ExampleObjectDescriptors::Set<CASBACnetStackExampleConstants::DATA_TYPE_UNSIGNED_INTEGER>(database, objectType, objectInstance, value.propertyIdentifier, (uint32_t)number, &errorCode, &handled);
+	}
+	if (!handled && unsignedInteger) {
+		result = ExampleObjectDescriptors::Set<CASBACnetStackExampleConstants::DATA_TYPE_ENUMERATED>(database, objectType, objectInstance, value.propertyIdentifier, (uint32_t)number, &errorCode, &handled);
+	}
+	if (!handled) {
+		// Also a number out of the range of the property's data type
+		std::cerr << "Error - The property can not be set from a profile. objectType=[" << objectType << "], objectInstance=[" << objectInstance << "], propertyIdentifier=[" << value.propertyIdentifier << "]" << std::endl;
+		return false;
+	}
+	if (!result) {
+		std::cerr << "Error - Invalid value. objectType=[" << objectType << "], objectInstance=[" << objectInstance << "], propertyIdentifier=[" << value.propertyIdentifier << "], errorCode=[" << errorCode << "]" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// Description of the objects that have one
+static std::string* ExampleGetProfileDescription(ExampleDatabase& database, const ExampleDatabaseBaseObject* object) {
+	if (object == &database.analogInput) {
+		return &database.analogInput.description;
+	}
+	if (object == &database.analogInputOutOfService) {
+		return &database.analogInputOutOfService.description;
+	}
+	if (object == &database.binaryInput) {
+		return &database.binaryInput.description;
+	}
+	return NULL;
+}
+
+static bool ExampleApplyProfileObject(ExampleDatabase& database, ExampleProfileObject& object, const std::map<std::string, uint16_t>& templateNames) {
+	if (!object.hasType || !object.hasInstance) {
+		std::cerr << "Error - Profile objects need a type and an instance" << std::endl;
+		return false;
+	}
+
+	ExampleDatabaseBaseObject* databaseObject = database.FindObject(object.objectType, object.objectInstance);
+	if (databaseObject != NULL) {
+		if (object.hasName) {
+			databaseObject->objectName = object.name;
+		}
+		if (object.hasDescription) {
+			std::string* description = ExampleGetProfileDescription(database, databaseObject);
+			if (description == NULL) {
+				std::cerr << "Error - The object has no description. objectType=[" << object.objectType << "], objectInstance=[" << object.objectInstance << "]" << std::endl;
+				return false;
+			}
+			*description = object.description;
+		}
+		for (size_t offset = 0; offset < object.values.size(); offset++) {
+			if (!ExampleSetProfileValue(database, object.objectType, object.objectInstance, object.values[offset])) {
+				return false;
+			}
+		}
+	}
+	else if (object.objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE) {
+		// Added the same way as with the CreateObject service. Profiles are usually in instance order, so the
+		// end of the map is passed as the hint.
+		std::map<uint32_t, CreatedAnalogValue>& created = database.CreatedAnalogValueData;
+		CreatedAnalogValue& createdAnalogValue = created.insert(created.end(), std::make_pair(object.objectInstance, CreatedAnalogValue()))->second;
+		createdAnalogValue.instance = object.objectInstance;
+		if (object.hasName) {
+			createdAnalogValue.objectName.swap(object.name);
+		}
+		else {
+			createdAnalogValue.objectName = "AnalogValue_" + std::to_string(object.objectInstance);
+		}
+		for (size_t offset = 0; offset < object.values.size(); offset++) {
+			if (object.values[offset].propertyIdentifier != CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE || object.values[offset].boolean) {
+				std::cerr << "Error - Only the present value of an added Analog Value can be set. objectInstance=[" << object.objectInstance << "], propertyIdentifier=[" << object.values[offset].propertyIdentifier << "]" << std::endl;
+				return false;
+			}
+			if (!(object.values[offset].number >= -FLT_MAX && object.values[offset].number <= FLT_MAX)) {
+				std::cerr << "Error - The present value is out of the range of a Real. objectInstance=[" << object.objectInstance << "], value=[" << object.values[offset].number << "]" << std::endl;
+				return false;
+			}
+			createdAnalogValue.value = (float)object.values[offset].number;
+		}
+	}
+	else {
+		std::cerr << "Error - Only Analog Values can be added by a profile. objectType=[" << object.objectType << "], objectInstance=[" << object.objectInstance << "]" << std::endl;
+		return false;
+	}
+
+	for (size_t offset = 0; offset < object.properties.size(); offset++) {
+		object.properties[offset].objectType = object.objectType;
+		object.properties[offset].objectInstance = object.objectInstance;
+		database.profileProperties.push_back(object.properties[offset]);
+	}
+	if (object.hasTemplate) {
+		std::map<std::string, uint16_t>::const_iterator itr = templateNames.find(object.templateName);
+		if (itr == templateNames.end()) {
+			std::cerr << "Error - Unknown template, templates must be declared before the objects. name=[" << object.templateName << "], objectType=[" << object.objectType << "], objectInstance=[" << object.objectInstance << "]" << std::endl;
+			return false;
+		}
+		ExampleObjectTemplateInstance instance;
+		instance.objectType = object.objectType;
+		instance.templateIndex = itr->second;
+		instance.objectInstance = object.objectInstance;
+		database.objectTemplateInstances.push_back(instance);
+	}
+	return true;
+}
+
+static bool ExampleCompareTemplateInstances(const ExampleObjectTemplateInstance& left, const ExampleObjectTemplateInstance& right) {
+	if (left.objectType != right.objectType) {
+		return left.objectType < right.objectType;
+	}
+	return left.objectInstance < right.objectInstance;
+}
+
+// Sorts the template instances by object type and instance for SetupDevice. An object listed more than once
+// keeps one instance, as long as it is of the same template.
+static bool ExampleSortTemplateInstances(std::vector<ExampleObjectTemplateInstance>& instances) {
+	std::sort(instances.begin(), instances.end(), ExampleCompareTemplateInstances);
+	size_t count = 0;
+	for (size_t offset = 0; offset < instances.size(); offset++) {
+		if (count > 0 && instances[count - 1].objectType == instances[offset].objectType && instances[count - 1].objectInstance == instances[offset].objectInstance) {
+			if (instances[count - 1].templateIndex != instances[offset].templateIndex) {
+				std::cerr << "Error - An object can only use one template. objectType=[" << instances[offset].objectType << "], objectInstance=[" << instances[offset].objectInstance << "]" << std::endl;
+				return false;
+			}
+			continue;
+		}
+		instances[count++] = instances[offset];
+	}
+	instances.resize(count);
+	return true;
+}
+
+static bool ExampleApplyProfileDevice(ExampleDatabase& database, ExampleProfileObject& object) {
+	if (object.hasInstance && object.objectInstance == EXAMPLE_PROFILE_MAX_INSTANCE) {
+		std::cerr << "Error - The device instance 4194303 is reserved" << std::endl;
+		return false;
+	}
+	if (object.hasInstance) {
+		database.device.instance = object.objectInstance;
+	}
+	if (object.hasName) {
+		database.device.objectName = object.name;
+	}
+	if (object.hasDescription) {
+		database.device.description = object.description;
+	}
+	if (object.hasTemplate) {
+		std::cerr << "Error - Templates are for objects, not the device" << std::endl;
+		return false;
+	}
+	for (size_t offset = 0; offset < object.values.size(); offset++) {
+		if (!ExampleSetProfileValue(database, CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE, database.device.instance, object.values[offset])) {
+			return false;
+		}
+	}
+	// The device instance can still be changed by the command line, SetupDevice uses the current one
+	for (size_t offset = 0; offset < object.properties.size(); offset++) {
+		object.properties[offset].objectType = CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE;
+		database.profileProperties.push_back(object.properties[offset]);
+	}
+	return true;
+}
+
+bool ExampleDatabase::LoadProfile(const std::string& path, uint32_t* objectCount) {
+	ExampleJsonReader reader;
+	if (!reader.Open(path)) {
+		return false;
+	}
+	this->profileProperties.clear();
+	this->objectTemplateProperties.clear();
+	this->objectTemplateInstances.clear();
+	*objectCount = 0;
+
+	ExampleProfileObject object;
+	std::map<std::string, uint16_t> templateNames;
+	bool ok = reader.Next() == ExampleJsonReader::TOKEN_BEGIN_OBJECT;
+	while (ok) {
+		ExampleJsonReader::Token token = reader.Next();
+		if (token == ExampleJsonReader::TOKEN_END_OBJECT) {
+			break;
+		}
+		if (token != ExampleJsonReader::TOKEN_KEY) {
+			ok = false;
+		}
+		else if (reader.GetString() == "device") {
+			ok = reader.Next() == ExampleJsonReader::TOKEN_BEGIN_OBJECT && ExampleReadProfileObject(reader, object) && ExampleApplyProfileDevice(*this, object);
+		}
+		else if (reader.GetString() == "templates") {
+			ok = ExampleReadProfileTemplates(reader, *this, templateNames);
+		}
+		else if (reader.GetString() == "objects") {
+			ok = reader.Next() == ExampleJsonReader::TOKEN_BEGIN_ARRAY;
+			while (ok) {
+				token = reader.Next();
+				if (token == ExampleJsonReader::TOKEN_END_ARRAY) {
+					break;
+				}
+				ok = token == ExampleJsonReader::TOKEN_BEGIN_OBJECT && ExampleReadProfileObject(reader, object) && ExampleApplyProfileObject(*this, object, templateNames);
+				(*objectCount)++;
+			}
+		}
+		else {
+			ok = reader.Skip(reader.Next());
+		}
+	}
+	ok = ok && reader.Next() == ExampleJsonReader::TOKEN_END;
+	ok = ok && ExampleSortTemplateInstances(this->objectTemplateInstances);
+	if (!ok) {
+		std::cerr << "Error - Could not load the device profile. path=[" << path << "], line=[" << reader.GetLine() << "]" << std::endl;
+	}
+
+	// Objects were added and values changed outside of the normal setters
+	this->RebuildObjectIndex();
+	this->covFilter.SetIncrement(this->analogInput.presentValueCovFilterPoint, this->analogInput.covIncrement);
+	return ok;
+}
+
+bool ExampleDatabase::CompileProfile(const std::string& path) {
+	ExampleCompiledProfile compiled;
+	compiled.Begin();
+
+	// Values of the built in objects, the same records as in the persistent image (device first)
+	this->StorePersistentBuiltInValues(compiled);
+
+	// Names and descriptions, which are not in the persistent image
+	for (std::unordered_map<uint32_t, ExampleDatabaseBaseObject*>::const_iterator itr = this->objectIndex.begin(); itr != this->objectIndex.end(); itr++) {
+		const uint16_t objectType = (uint16_t)(itr->first >> 22);
+		const ExampleDatabaseBaseObject* object = itr->second;
+		if (objectType == CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE && object != &this->analogValue) {
+			continue; // Added Analog Values have their own table
+		}
+		compiled.AddData(objectType, object->instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OBJECT_NAME, 0, CASBACnetStackExampleConstants::DATA_TYPE_CHARACTER_STRING, object->objectName.c_str(), (uint32_t)object->objectName.size());
+		const std::string* description = ExampleGetProfileDescription(*this, object);
+		if (description != NULL) {
+			compiled.AddData(objectType, object->instance, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_DESCRIPTION, 0, CASBACnetStackExampleConstants::DATA_TYPE_CHARACTER_STRING, description->c_str(), (uint32_t)description->size());
+		}
+	}
+
+	for (std::map<uint32_t, CreatedAnalogValue>::const_iterator itr = this->CreatedAnalogValueData.begin(); itr != this->CreatedAnalogValueData.end(); itr++) {
+		compiled.AddAnalogValue(itr->first, itr->second.objectName, itr->second.value);
+	}
+	for (size_t offset = 0; offset < this->profileProperties.size(); offset++) {
+		compiled.AddProperty(this->profileProperties[offset]);
+	}
+	for (size_t offset = 0; offset < this->objectTemplateProperties.size(); offset++) {
+		compiled.AddTemplateProperty(this->objectTemplateProperties[offset]);
+	}
+	for (size_t offset = 0; offset < this->objectTemplateInstances.size(); offset++) {
+		compiled.AddTemplateInstance(this->objectTemplateInstances[offset]);
+	}
+	return compiled.Commit(path);
+}
+
+bool ExampleDatabase::LoadCompiledProfile(const std::string& path, uint32_t* objectCount) {
+	ExampleCompiledProfile compiled;
+	if (!compiled.Open(path)) {
+		return false;
+	}
+	*objectCount = 0;
+
+	// Everything was validated when the profile was compiled. A record is only rejected if the objects of
+	// this build differ from the build that compiled the profile.
+	bool ok = true;
+	const uint32_t recordCount = compiled.GetRecordCount();
+	for (uint32_t offset = 0; offset < recordCount; offset++) {
+		const ExamplePersistentRecord& record = compiled.GetRecord(offset);
+		if (record.objectType != CASBACnetStackExampleConstants::OBJECT_TYPE_DEVICE && (record.propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OBJECT_NAME || record.propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_DESCRIPTION)) {
+			ExampleDatabaseBaseObject* object = this->FindObject(record.objectType, record.objectInstance);
+			std::string* text = NULL;
+			if (object != NULL) {
+				text = record.propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OBJECT_NAME ? &object->objectName : ExampleGetProfileDescription(*this, object);
+			}
+			if (text == NULL) {
+				ok = false;
+				continue;
+			}
+			text->assign((const char*)compiled.GetData(record), record.length);
+			if (record.propertyIdentifier == CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OBJECT_NAME) {
+				(*objectCount)++;
+			}
+		}
+		else if (!this->LoadPersistentRecord(record, record.length > 0 ? compiled.GetData(record) : NULL)) {
+			ok = false;
+		}
+	}
+
+	// Added Analog Values, in instance order
+	std::map<uint32_t, CreatedAnalogValue>& created = this->CreatedAnalogValueData;
+	const uint32_t analogValueCount = compiled.GetAnalogValueCount();
+	for (uint32_t offset = 0; offset < analogValueCount; offset++) {
+		const ExampleCompiledAnalogValue& analogValue = compiled.GetAnalogValue(offset);
+		CreatedAnalogValue& createdAnalogValue = created.insert(created.end(), std::make_pair(analogValue.instance, CreatedAnalogValue()))->second;
+		createdAnalogValue.instance = analogValue.instance;
+		createdAnalogValue.objectName.assign(compiled.GetName(analogValue), analogValue.nameLength);
+		createdAnalogValue.value = analogValue.value;
+	}
+	*objectCount += analogValueCount;
+
+	this->profileProperties.assign(compiled.GetProperties(), compiled.GetProperties() + compiled.GetPropertyCount());
+	this->objectTemplateProperties.assign(compiled.GetTemplateProperties(), compiled.GetTemplateProperties() + compiled.GetTemplatePropertyCount());
+	this->objectTemplateInstances.assign(compiled.GetTemplateInstances(), compiled.GetTemplateInstances() + compiled.GetTemplateInstanceCount());
+
+	this->RebuildObjectIndex();
+	this->covFilter.SetIncrement(this->analogInput.presentValueCovFilterPoint, this->analogInput.covIncrement);
+	if (!ok) {
+		std::cerr << "Error - The compiled profile does not match the objects of this version, compile it again. path=[" << path << "]" << std::endl;
+	}
+	return ok;
+}
@@ -0,0 +1,795 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleSelfTest.cpp
+ *
+ * See CASBACnetStackExampleSelfTest.h
+*/
+
+#include "CASBACnetStackExampleSelfTest.h"
+#include "CASBACnetStackExampleConstants.h"
+#include "CASBACnetStackExampleCovFilter.h"
+#include "CASBACnetStackExampleDatabase.h"
+#include "CASBACnetStackExampleDeviceRegistry.h"
+#include "CASBACnetStackExampleDirtyPointSet.h"
+#include "CASBACnetStackExamplePointValue.h"
+#include "CASBACnetStackExampleVirtualRouter.h"
+
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <stdio.h>
+#include <unistd.h>
+#endif // _WIN32
+
+// Several words, so that a read can be torn between two writes. The wider the value, the more often a read
+// overlaps a write: with 16 words a seqlock that does not retry is caught within seconds. Every word holds the
+// writer in the top 16 bits and the writer's count of writes below.
+struct ExampleSeqLockStressValue {
+	static const uint32_t WORD_COUNT = 16;
+	uint64_t words[WORD_COUNT];
+};
+
+struct ExampleSeqLockStressWriter {
+	ExampleSeqLock<ExampleSeqLockStressValue>* value;
+	const std::atomic<bool>* stop;
+	uint64_t* writes;
+	uint64_t writer;
+
+	void operator()() {
+		uint64_t count = 0;
+		while (!this->stop->load(std::memory_order_relaxed)) {
+			count++;
+			ExampleSeqLockStressValue written;
+			for (uint32_t offset = 0; offset < ExampleSeqLockStressValue::WORD_COUNT; offset++) {
+				written.words[offset] = this->writer << 48 | count;
+			}
+			this->value->Write(written);
+		}
+		*this->writes = count;
+	}
+};
+
+struct ExampleSeqLockStressReader {
+	const ExampleSeqLock<ExampleSeqLockStressValue>* value;
+	const std::atomic<bool>* stop;
+	uint64_t* reads;
+	uint64_t* errors;
+
+	void operator()() {
+		// The last count seen from each writer, a writer's values must never go backwards
+		std::vector<uint64_t> last(0x10000, 0);
+		uint64_t count = 0;
+		uint64_t errorCount = 0;
+		while (!this->stop->load(std::memory_order_relaxed)) {
+			const ExampleSeqLockStressValue read = this->value->Read();
+			count++;
+			bool torn = false;
+			for (uint32_t offset = 1; offset < ExampleSeqLockStressValue::WORD_COUNT; offset++) {
+				torn = torn || read.words[offset] != read.words[0];
+			}
+			const uint64_t writer = read.words[0] >> 48;
+			const uint64_t writes = read.words[0] & 0xFFFFFFFFFFFFull;
+			if (torn || writes < last[writer]) {
+				if (errorCount++ < 10) {
+					std::cerr << "Error - Inconsistent seqlock read. first=[" << read.words[0] << "], last=[" << read.words[ExampleSeqLockStressValue::WORD_COUNT - 1] << "], previous=[" << last[writer] << "]" << std::endl;
+				}
+				continue;
+			}
+			last[writer] = writes;
+		}
+		*this->reads = count;
+		*this->errors = errorCount;
+	}
+};
+
+int ExampleSeqLockStressTest(const uint32_t seconds, const uint32_t writerCount, const uint32_t readerCount) {
+	if (writerCount == 0 || writerCount > 64 || readerCount == 0 || readerCount > 64) {
+		std::cerr << "Error - Invalid number of threads. writers=[" << writerCount << "], readers=[" << readerCount << "]" << std::endl;
+		return 1;
+	}
+	std::cout << "FYI: Seqlock stress test. writers=[" << writerCount << "], readers=[" << readerCount << "], seconds=[" << seconds << "]" << std::endl;
+
+	ExampleSeqLock<ExampleSeqLockStressValue> value;
+	std::atomic<bool> stop(false);
+	std::vector<uint64_t> writes(writerCount, 0);
+	std::vector<uint64_t> reads(readerCount, 0);
+	std::vector<uint64_t> errors(readerCount, 0);
+	std::vector<std::thread> threads;
+	for (uint32_t writer = 0; writer < writerCount; writer++) {
+		ExampleSeqLockStressWriter function = { &value, &stop, &writes[writer], writer + 1 };
+		threads.push_back(std::thread(function));
+	}
+	for (uint32_t reader = 0; reader < readerCount; reader++) {
+		ExampleSeqLockStressReader function = { &value, &stop, &reads[reader], &errors[reader] };
+		threads.push_back(std::thread(function));
+	}
+	std::this_thread::sleep_for(std::chrono::seconds(seconds));
+	stop.store(true, std::memory_order_relaxed);
+	for (size_t offset = 0; offset < threads.size(); offset++) {
+		threads[offset].join();
+	}
+
+	uint64_t writeCount = 0;
+	uint64_t readCount = 0;
+	uint64_t errorCount = 0;
+	for (uint32_t writer = 0; writer < writerCount; writer++) {
+		writeCount += writes[writer];
+	}
+	for (uint32_t reader = 0; reader < readerCount; reader++) {
+		readCount += reads[reader];
+		errorCount += errors[reader];
+	}
+	const uint64_t divisor = seconds > 0 ? seconds : 1;
+	std::cout << "FYI: Writes=[" << writeCount << "], writes per second=[" << writeCount / divisor << "], reads=[" << readCount << "], reads per second=[" << readCount / divisor << "], errors=[" << errorCount << "]" << std::endl;
+	if (errorCount > 0 || writeCount == 0 || readCount == 0) {
+		std::cerr << "Error - Seqlock stress test failed" << std::endl;
+		return 1;
+	}
+	std::cout << "FYI: Seqlock stress test passed" << std::endl;
+	return 0;
+}
+
+// Mixes the bits of a point, so that a sum of hashes tells sets of points apart (splitmix64 finalizer)
+static uint64_t ExampleHashPoint(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier) {
+	uint64_t hash = ((uint64_t)objectType << 54) ^ ((uint64_t)objectInstance << 22) ^ propertyIdentifier;
+	hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+	hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+	return hash ^ (hash >> 31);
+}
+
+// Counts the points drained and adds up their hashes, to check which points were reported whatever the order
+struct ExampleDirtyPointBenchmarkCounter {
+	uint64_t count;
+	uint64_t hash;
+
+	void operator()(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier) {
+		this->count++;
+		this->hash += ExampleHashPoint(objectType, objectInstance, propertyIdentifier);
+	}
+};
+
+int ExampleDirtyPointSetBenchmark(const uint32_t pointCount) {
+	if (pointCount == 0 || pointCount > 4 * 0x3FFFFF) {
+		std::cerr << "Error - Invalid number of points. points=[" << pointCount << "]" << std::endl;
+		return 1;
+	}
+	std::cout << "FYI: Dirty point set benchmark. points=[" << pointCount << "]" << std::endl;
+
+	// The points are spread over four pools, as the Analog, Binary, Multi-State Inputs and the Analog Values would be
+	ExampleDirtyPointSet dirtyPoints;
+	std::vector<uint32_t> handles;
+	for (uint32_t point = 0; point < pointCount; point++) {
+		handles.push_back(dirtyPoints.AddPoint((uint16_t)(point % 4), point, 85));
+	}
+
+	// Every 7th point marked three times is reported once, and nothing is left for the next drain
+	uint64_t expectedHash = 0;
+	for (uint32_t repeat = 0; repeat < 3; repeat++) {
+		for (uint32_t point = 0; point < pointCount; point += 7) {
+			dirtyPoints.MarkDirty(handles[point]);
+		}
+	}
+	for (uint32_t point = 0; point < pointCount; point += 7) {
+		expectedHash += ExampleHashPoint((uint16_t)(point % 4), point, 85);
+	}
+	ExampleDirtyPointBenchmarkCounter coalesced = { 0, 0 };
+	dirtyPoints.Drain(coalesced);
+	ExampleDirtyPointBenchmarkCounter empty = { 0, 0 };
+	dirtyPoints.Drain(empty);
+	const uint64_t expectedCount = (pointCount + 6) / 7;
+	if (coalesced.count != expectedCount || coalesced.hash != expectedHash || empty.count != 0) {
+		std::cerr << "Error - Wrong points drained. drained=[" << coalesced.count << "], expected=[" << expectedCount << "], next drain=[" << empty.count << "]" << std::endl;
+		return 1;
+	}
+
+	// All the points changed in one tick
+	const uint32_t ROUNDS = 100;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (uint32_t round = 0; round < ROUNDS; round++) {
+		for (uint32_t point = 0; point < pointCount; point++) {
+			dirtyPoints.MarkDirty(handles[point]);
+		}
+		ExampleDirtyPointBenchmarkCounter all = { 0, 0 };
+		dirtyPoints.Drain(all);
+		if (all.count != pointCount) {
+			std::cerr << "Error - Wrong points drained. drained=[" << all.count << "], expected=[" << pointCount << "]" << std::endl;
+			return 1;
+		}
+	}
+	const double allMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / ROUNDS;
+
+	// One point changed in one tick, the drain should not visit the clean points
+	const uint32_t SINGLE_ROUNDS = 10000;
+	start = std::chrono::steady_clock::now();
+	for (uint32_t round = 0; round < SINGLE_ROUNDS; round++) {
+		dirtyPoints.MarkDirty(handles[(uint64_t)round * 37 % pointCount]);
+		ExampleDirtyPointBenchmarkCounter single = { 0, 0 };
+		dirtyPoints.Drain(single);
+		if (single.count != 1) {
+			std::cerr << "Error - Wrong points drained. drained=[" << single.count << "], expected=[1]" << std::endl;
+			return 1;
+		}
+	}
+	const double singleMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / SINGLE_ROUNDS;
+
+	std::cout << "FYI: Mark and drain all points=[" << allMicroseconds << " us], mark and drain one point=[" << singleMicroseconds << " us]" << std::endl;
+	std::cout << "FYI: Dirty point set benchmark passed" << std::endl;
+	return 0;
+}
+
+int ExampleCovFilterBenchmark(const uint32_t pointCount, const uint32_t tickCount) {
+	if (pointCount == 0 || pointCount > 0x3FFFFF || tickCount == 0) {
+		std::cerr << "Error - Invalid benchmark size. points=[" << pointCount << "], ticks=[" << tickCount << "]" << std::endl;
+		return 1;
+	}
+	std::cout << "FYI: COV filter benchmark. points=[" << pointCount << "], ticks=[" << tickCount << "]" << std::endl;
+
+	// The same random walk with both loops, each point moves by a little noise every tick and is reported
+	// when it has moved by its COV increment of 1.0
+	// The points reported in each tick are hashed, in the order of the ticks
+	uint64_t notified[2] = { 0, 0 };
+	uint64_t notifiedHash[2] = { 0, 0 };
+	for (uint32_t mode = 0; mode < 2; mode++) {
+		const bool vectorized = mode == 1;
+		ExampleDirtyPointSet dirtyPoints;
+		ExampleCovFilter filter;
+		filter.SetVectorized(vectorized);
+		if (vectorized && !filter.IsVectorized()) {
+			std::cout << "FYI: AVX2 is not available, nothing to compare the scalar loop with" << std::endl;
+			std::cout << "FYI: COV filter benchmark skipped" << std::endl;
+			return 0;
+		}
+		for (uint32_t point = 0; point < pointCount; point++) {
+			filter.AddPoint(dirtyPoints.AddPoint(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, point, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE), 20.0f, 1.0f);
+		}
+
+		std::mt19937 random(1);
+		std::normal_distribution<float> noise(0.0f, 0.06f);
+		std::vector<float> values(pointCount, 20.0f);
+		double microseconds = 0.0;
+		for (uint32_t tick = 0; tick < tickCount; tick++) {
+			for (uint32_t point = 0; point < pointCount; point++) {
+				values[point] += noise(random);
+				filter.SetValue(point, values[point]);
+			}
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			filter.Scan(dirtyPoints);
+			ExampleDirtyPointBenchmarkCounter counter = { 0, 0 };
+			dirtyPoints.Drain(counter);
+			microseconds += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+			notified[mode] += counter.count;
+			notifiedHash[mode] = notifiedHash[mode] * 31 + counter.hash;
+		}
+		std::cout << "FYI: " << (vectorized ? "AVX2" : "Scalar") << " scan and drain per tick=[" << microseconds / tickCount << " us], fpValueUpdated calls=[" << notified[mode] << "] for value updates=[" << (uint64_t)pointCount * tickCount << "]" << std::endl;
+		if (notified[mode] == 0) {
+			std::cerr << "Error - No point moved by its COV increment, nothing was compared. Use more points or ticks" << std::endl;
+			return 1;
+		}
+	}
+
+	if (notified[0] != notified[1] || notifiedHash[0] != notifiedHash[1]) {
+		std::cerr << "Error - The scalar and AVX2 loops reported different points. scalar=[" << notified[0] << "], avx2=[" << notified[1] << "]" << std::endl;
+		return 1;
+	}
+	std::cout << "FYI: COV filter benchmark passed" << std::endl;
+	return 0;
+}
+
+#ifndef _WIN32
+
+int ExamplePersistentImageBenchmark(const uint32_t objectCount) {
+	if (objectCount == 0 || objectCount > 1000000) {
+		std::cerr << "Error - Invalid number of objects. objects=[" << objectCount << "]" << std::endl;
+		return 1;
+	}
+	const std::string path = "CASBACnetStackExample_benchmark_" + std::to_string(getpid()) + ".image";
+	std::cout << "FYI: Persistent image benchmark. objects=[" << objectCount << "], path=[" << path << "]" << std::endl;
+
+	// The databases are large, they are not kept on the stack
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	ExampleDatabase* saved = new ExampleDatabase();
+	const double setupMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	// Analog Values as created by CreateObject, and a written priority array
+	for (uint32_t offset = 0; offset < objectCount; offset++) {
+		const uint32_t instance = 1000 + offset;
+		CreatedAnalogValue& created = saved->CreatedAnalogValueData[instance];
+		created.instance = instance;
+		created.objectName = "AnalogValue_" + std::to_string(instance);
+		created.value = (float)offset * 0.5f;
+	}
+	saved->RebuildObjectIndex();
+	saved->analogOutput.priorityArray.Set(8, 42.0f);
+
+	bool passed = saved->OpenPersistentImage(path);
+	start = std::chrono::steady_clock::now();
+	passed = passed && saved->SavePersistentImage();
+	const double saveMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	const uint32_t recordCount = saved->persistentImage.GetRecordCount();
+	delete saved;
+
+	// Startup: the defaults from Setup, then the image applied over them
+	ExampleDatabase* loaded = new ExampleDatabase();
+	start = std::chrono::steady_clock::now();
+	passed = passed && loaded->OpenPersistentImage(path);
+	const double openMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	const CreatedAnalogValue* last = loaded->FindCreatedAnalogValue(1000 + objectCount - 1);
+	if (!passed || loaded->CreatedAnalogValueData.size() != objectCount || last == NULL || last->value != (float)(objectCount - 1) * 0.5f || loaded->analogOutput.priorityArray.GetPresentValue() != 42.0f) {
+		std::cerr << "Error - The image did not restore the saved values. created=[" << loaded->CreatedAnalogValueData.size() << "], expected=[" << objectCount << "]" << std::endl;
+		passed = false;
+	}
+	delete loaded;
+	remove(path.c_str());
+	remove((path + ".wal").c_str());
+	if (!passed) {
+		return 1;
+	}
+
+	std::cout << "FYI: Records=[" << recordCount << "], setup from the defaults=[" << setupMilliseconds << " ms], save=[" << saveMilliseconds << " ms], open and apply=[" << openMilliseconds << " ms]" << std::endl;
+	std::cout << "FYI: Persistent image benchmark passed" << std::endl;
+	return 0;
+}
+
+// Writes to the Analog Value present value as CallbackSetPropertyReal accepts them, committed by
+// CommitPersistentWrites every writesPerTick writes like Loop does. The values stay within the min and
+// max present value, a restart applies them with the same checks. Returns the writes per second or 0.
+static double ExampleWriteAheadLogRun(ExampleDatabase& database, const uint32_t writeCount, const uint32_t writesPerTick) {
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (uint32_t write = 0; write < writeCount; write++) {
+		database.analogValue.presentValue = (float)(write % 100);
+		database.LogPersistentWrite(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE, database.analogValue.instance);
+		if ((write + 1) % writesPerTick == 0 || write + 1 == writeCount) {
+			database.CommitPersistentWrites();
+		}
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	database.WaitPersistentCheckpoint(true);
+	if (database.writeAheadLog.GetPendingCount() > 0) {
+		std::cerr << "Error - Writes were not committed. pending=[" << database.writeAheadLog.GetPendingCount() << "]" << std::endl;
+		return 0.0;
+	}
+	return seconds > 0.0 ? writeCount / seconds : 0.0;
+}
+
+int ExampleWriteAheadLogBenchmark(const uint32_t writeCount, const uint32_t writesPerTick) {
+	if (writeCount == 0 || writesPerTick == 0) {
+		std::cerr << "Error - Invalid number of writes. writes=[" << writeCount << "], writesPerTick=[" << writesPerTick << "]" << std::endl;
+		return 1;
+	}
+	const std::string path = "CASBACnetStackExample_benchmark_" + std::to_string(getpid()) + ".image";
+	std::cout << "FYI: Write-ahead log benchmark. writes=[" << writeCount << "], writesPerTick=[" << writesPerTick << "], path=[" << path << "]" << std::endl;
+
+	// The databases are large, they are not kept on the stack
+	ExampleDatabase* database = new ExampleDatabase();
+	bool passed = database->OpenPersistentImage(path) && database->writeAheadLog.IsOpen();
+	double writesPerSecond[2] = { 0.0, 0.0 };
+	if (passed) {
+		// A commit for every write, then a commit for every tick
+		writesPerSecond[0] = ExampleWriteAheadLogRun(*database, writeCount, 1);
+		writesPerSecond[1] = ExampleWriteAheadLogRun(*database, writeCount, writesPerTick);
+		passed = writesPerSecond[0] > 0.0 && writesPerSecond[1] > 0.0;
+	}
+	delete database;
+
+	// A restart finds the last write, from the log or from a compacted image
+	ExampleDatabase* restarted = new ExampleDatabase();
+	if (passed && (!restarted->OpenPersistentImage(path) || restarted->analogValue.presentValue != (float)((writeCount - 1) % 100))) {
+		std::cerr << "Error - The last write was not restored. value=[" << restarted->analogValue.presentValue << "], expected=[" << (writeCount - 1) % 100 << "]" << std::endl;
+		passed = false;
+	}
+	delete restarted;
+	remove(path.c_str());
+	remove((path + ".wal").c_str());
+	if (!passed) {
+		return 1;
+	}
+
+	std::cout << "FYI: Durable writes per second, a commit per write=[" << (uint64_t)writesPerSecond[0] << "], a commit per tick=[" << (uint64_t)writesPerSecond[1] << "]" << std::endl;
+	std::cout << "FYI: Write-ahead log benchmark passed" << std::endl;
+	return 0;
+}
+
+int ExampleStartupBenchmark(const uint32_t objectCount) {
+	if (objectCount == 0 || objectCount > 1000000) {
+		std::cerr << "Error - Invalid number of objects. objects=[" << objectCount << "]" << std::endl;
+		return 1;
+	}
+	const std::string path = "CASBACnetStackExample_benchmark_" + std::to_string(getpid());
+	std::cout << "FYI: Startup benchmark. objects=[" << objectCount << "], path=[" << path << ".json]" << std::endl;
+
+	// A JSON profile with Analog Values added by the profile, half of them from a template
+	FILE* file = fopen((path + ".json").c_str(), "w");
+	if (file == NULL) {
+		std::cerr << "Error - Could not create the profile. path=[" << path << ".json]" << std::endl;
+		return 1;
+	}
+	fprintf(file, "{\n  \"device\": { \"instance\": 389001, \"name\": \"Benchmark\" },\n");
+	fprintf(file, "  \"templates\": { \"setpoint\": { \"writable\": [ 85 ], \"subscribable\": [ 85 ] } },\n  \"objects\": [\n");
+	for (uint32_t offset = 0; offset < objectCount; offset++) {
+		const uint32_t instance = 1000 + offset;
+		fprintf(file, "    { \"type\": 2, \"instance\": %u, \"name\": \"Setpoint %u\", \"values\": { \"85\": %u.5 }%s }%s\n", instance, instance, offset % 100,
+			offset % 2 == 0 ? ", \"template\": \"setpoint\"" : ", \"writable\": [ 85 ]", offset + 1 < objectCount ? "," : "");
+	}
+	fprintf(file, "  ]\n}\n");
+	const bool written = fclose(file) == 0;
+
+	// The databases are large, they are not kept on the stack
+	uint32_t profileObjectCount = 0;
+	ExampleDatabase* parsed = new ExampleDatabase();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	bool passed = written && parsed->LoadProfile(path + ".json", &profileObjectCount);
+	const double parseMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	passed = passed && parsed->CompileProfile(path + ".bin");
+
+	uint32_t compiledObjectCount = 0;
+	ExampleDatabase* mapped = new ExampleDatabase();
+	start = std::chrono::steady_clock::now();
+	passed = passed && mapped->LoadCompiledProfile(path + ".bin", &compiledObjectCount);
+	const double mapMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	// Both startups end with the same objects. The compiled profile also counts the names of the built in objects.
+	const CreatedAnalogValue* last = mapped->FindCreatedAnalogValue(1000 + objectCount - 1);
+	if (passed && (mapped->CreatedAnalogValueData.size() != objectCount || parsed->CreatedAnalogValueData.size() != objectCount || last == NULL || last->value != (float)((objectCount - 1) % 100) + 0.5f ||
+		mapped->profileProperties.size() != parsed->profileProperties.size() || mapped->objectTemplateInstances.size() != parsed->objectTemplateInstances.size())) {
+		std::cerr << "Error - The compiled profile does not match the JSON profile. created=[" << mapped->CreatedAnalogValueData.size() << "], expected=[" << objectCount << "]" << std::endl;
+		passed = false;
+	}
+	delete parsed;
+	delete mapped;
+	remove((path + ".json").c_str());
+	remove((path + ".bin").c_str());
+	if (!passed) {
+		return 1;
+	}
+
+	std::cout << "FYI: Profile objects=[" << profileObjectCount << "], JSON profile load=[" << parseMilliseconds << " ms], compiled profile load=[" << mapMilliseconds << " ms]" << std::endl;
+	std::cout << "FYI: Startup benchmark passed" << std::endl;
+	return 0;
+}
+
+#else // _WIN32
+
+int ExamplePersistentImageBenchmark(const uint32_t objectCount) {
+	std::cerr << "Error - The persistent image is only supported on Linux" << std::endl;
+	return 1;
+}
+
+int ExampleWriteAheadLogBenchmark(const uint32_t writeCount, const uint32_t writesPerTick) {
+	std::cerr << "Error - The write-ahead log is only supported on Linux" << std::endl;
+	return 1;
+}
+
+int ExampleStartupBenchmark(const uint32_t objectCount) {
+	std::cerr << "Error - The compiled profile is only supported on Linux" << std::endl;
+	return 1;
+}
+
+#endif // _WIN32
+
+// Builds a B/IP unicast message with the NPDU header and the APDU given, returns its length
+static uint16_t ExampleBuildTestMessage(const uint8_t* npdu, const size_t npduLength, const uint8_t* apdu, const size_t apduLength, uint8_t* message) {
+	const uint16_t length = (uint16_t)(4 + npduLength + apduLength);
+	message[0] = BVLC_TYPE_BACNET_IP;
+	message[1] = BVLC_ORIGINAL_UNICAST_NPDU;
+	message[2] = (uint8_t)(length >> 8);
+	message[3] = (uint8_t)length;
+	memcpy(message + 4, npdu, npduLength);
+	memcpy(message + 4 + npduLength, apdu, apduLength);
+	return length;
+}
+
+// Builds a request and gives it to the router like CallbackReceiveMessage does, returns the length for the stack
+static uint16_t ExampleReceiveTestMessage(ExampleVirtualRouter& router, const uint8_t* npdu, const size_t npduLength, const uint8_t* apdu, const size_t apduLength, const uint8_t* client, uint8_t* message, uint32_t* deviceInstance) {
+	const uint16_t length = ExampleBuildTestMessage(npdu, npduLength, apdu, apduLength, message);
+	ExampleNpdu decoded;
+	if (!ExampleDecodeNpdu(message, length, &decoded)) {
+		return 0;
+	}
+	return router.Receive(message, length, decoded, client, deviceInstance);
+}
+
+// Checks one step of the virtual router test, prints the error and counts it
+static bool ExampleCheckVirtualRouter(const bool passed, const char* step, uint32_t* errorCount) {
+	if (!passed) {
+		std::cerr << "Error - Virtual router test failed. step=[" << step << "]" << std::endl;
+		(*errorCount)++;
+	}
+	return passed;
+}
+
+int ExampleVirtualRouterTest() {
+	static const uint16_t NETWORK_NUMBER = 1000;
+	static const uint16_t CLIENT_NETWORK = 5;
+	static const uint32_t DEVICE_INSTANCE = 389002; // 0x05EF8A
+	static const uint32_t SECOND_DEVICE_INSTANCE = 389003;
+	std::cout << "FYI: Virtual router test. network=[" << NETWORK_NUMBER << "], device=[" << DEVICE_INSTANCE << "]" << std::endl;
+
+	ExampleDeviceRegistry registry;
+	registry.Add(DEVICE_INSTANCE);
+	registry.Add(SECOND_DEVICE_INSTANCE);
+	ExampleVirtualRouter router;
+	router.Enable(NETWORK_NUMBER, &registry, 100);
+	const uint8_t client[6] = { 192, 168, 1, 10, 0xBA, 0xC0 };
+	uint32_t errorCount = 0;
+
+	// ReadProperty of the Present_Value of Analog Value 1, invoke ID 7, and its answer from the stack
+	const uint8_t request[] = { 0x00, 0x05, 0x07, 0x0C, 0x0C, 0x00, 0x80, 0x00, 0x01, 0x19, 0x55 };
+	const uint8_t answer[] = { 0x30, 0x07, 0x0C, 0x0C, 0x00, 0x80, 0x00, 0x01, 0x19, 0x55, 0x3E, 0x44, 0x41, 0xA8, 0x00, 0x00, 0x3F };
+	uint8_t message[64];
+	uint8_t reply[ExampleVirtualRouter::MAX_REPLY_LENGTH];
+	ExampleNpdu npdu;
+	uint32_t deviceInstance;
+
+	// A client on the local network: DNET/DADR of the device, expecting a reply
+	const uint8_t localRequest[] = { NPDU_VERSION, 0x24, 0x03, 0xE8, 0x03, 0x05, 0xEF, 0x8A, 0xFF };
+	uint16_t length = ExampleBuildTestMessage(localRequest, sizeof(localRequest), request, sizeof(request), message);
+	ExampleDecodeNpdu(message, length, &npdu);
+	length = router.Receive(message, length, npdu, client, &deviceInstance);
+	if (ExampleCheckVirtualRouter(length > 0 && deviceInstance == DEVICE_INSTANCE && ExampleDecodeNpdu(message, length, &npdu), "local request routed", &errorCount)) {
+		ExampleCheckVirtualRouter(!npdu.hasDestination && npdu.sourceNetwork == 0 && npdu.dataLength == sizeof(request) && memcmp(npdu.data, request, sizeof(request)) == 0, "local request is a local message for the stack", &errorCount);
+	}
+	const uint8_t localAnswer[] = { NPDU_VERSION, 0x00 };
+	length = ExampleBuildTestMessage(localAnswer, sizeof(localAnswer), answer, sizeof(answer), message);
+	uint16_t replyLength = router.Reply(message, length, client, reply, sizeof(reply));
+	if (ExampleCheckVirtualRouter(replyLength > 0 && ExampleDecodeNpdu(reply, replyLength, &npdu), "local answer routed", &errorCount)) {
+		const uint8_t sourceAddress[] = { 0x05, 0xEF, 0x8A };
+		ExampleCheckVirtualRouter(!npdu.hasDestination && npdu.sourceNetwork == NETWORK_NUMBER && npdu.sourceLength == 3 && memcmp(npdu.sourceAddress, sourceAddress, 3) == 0, "local answer comes from the device", &errorCount);
+		ExampleCheckVirtualRouter(npdu.dataLength == sizeof(answer) && memcmp(npdu.data, answer, sizeof(answer)) == 0, "local answer APDU", &errorCount);
+	}
+	ExampleCheckVirtualRouter(router.Reply(message, length, client, reply, sizeof(reply)) == 0, "answered request is forgotten", &errorCount);
+
+	// A client on a remote network, behind another router: SNET/SADR of the client are kept for the stack, the
+	// answer has DNET/DADR of the client and gets SNET/SADR of the device
+	const uint8_t remoteRequest[] = { NPDU_VERSION, 0x2C, 0x03, 0xE8, 0x03, 0x05, 0xEF, 0x8A, 0x00, CLIENT_NETWORK, 0x01, 0x10, 0xFE };
+	length = ExampleBuildTestMessage(remoteRequest, sizeof(remoteRequest), request, sizeof(request), message);
+	ExampleDecodeNpdu(message, length, &npdu);
+	length = router.Receive(message, length, npdu, client, &deviceInstance);
+	if (ExampleCheckVirtualRouter(length > 0 && ExampleDecodeNpdu(message, length, &npdu), "remote request routed", &errorCount)) {
+		ExampleCheckVirtualRouter(!npdu.hasDestination && npdu.sourceNetwork == CLIENT_NETWORK && npdu.sourceLength == 1 && npdu.sourceAddress[0] == 0x10 && memcmp(npdu.data, request, sizeof(request)) == 0, "remote request keeps the client", &errorCount);
+	}
+	const uint8_t remoteAnswer[] = { NPDU_VERSION, 0x20, 0x00, CLIENT_NETWORK, 0x01, 0x10, 0xFF };
+	length = ExampleBuildTestMessage(remoteAnswer, sizeof(remoteAnswer), answer, sizeof(answer), message);
+	replyLength = router.Reply(message, length, client, reply, sizeof(reply));
+	if (ExampleCheckVirtualRouter(replyLength > 0 && ExampleDecodeNpdu(reply, replyLength, &npdu), "remote answer routed", &errorCount)) {
+		ExampleCheckVirtualRouter(npdu.hasDestination && npdu.destinationNetwork == CLIENT_NETWORK && npdu.destinationLength == 1 && npdu.destinationAddress[0] == 0x10, "remote answer goes to the client", &errorCount);
+		ExampleCheckVirtualRouter(npdu.sourceNetwork == NETWORK_NUMBER && npdu.sourceLength == 3 && npdu.data[-1] == 0xFF && memcmp(npdu.data, answer, sizeof(answer)) == 0, "remote answer comes from the device", &errorCount);
+	}
+
+	// A device that is not hosted
+	const uint8_t unknownRequest[] = { NPDU_VERSION, 0x24, 0x03, 0xE8, 0x03, 0x05, 0xEF, 0x8F, 0xFF };
+	ExampleCheckVirtualRouter(ExampleReceiveTestMessage(router, unknownRequest, sizeof(unknownRequest), request, sizeof(request), client, message, &deviceInstance) == 0 && router.GetStats().dropped == 1, "unknown device dropped", &errorCount);
+
+	// The same invoke ID to two hosted devices at once: the answers could not be told apart, the second request
+	// is dropped until the first one is answered
+	const uint8_t secondRequest[] = { NPDU_VERSION, 0x24, 0x03, 0xE8, 0x03, 0x05, 0xEF, 0x8B, 0xFF };
+	ExampleCheckVirtualRouter(ExampleReceiveTestMessage(router, localRequest, sizeof(localRequest), request, sizeof(request), client, message, &deviceInstance) > 0, "first device routed", &errorCount);
+	ExampleCheckVirtualRouter(ExampleReceiveTestMessage(router, secondRequest, sizeof(secondRequest), request, sizeof(request), client, message, &deviceInstance) == 0, "same invoke ID to a second device dropped", &errorCount);
+	length = ExampleBuildTestMessage(localAnswer, sizeof(localAnswer), answer, sizeof(answer), message);
+	replyLength = router.Reply(message, length, client, reply, sizeof(reply));
+	ExampleCheckVirtualRouter(replyLength > 0 && ExampleDecodeNpdu(reply, replyLength, &npdu) && npdu.sourceAddress[2] == 0x8A, "answer of the first device", &errorCount);
+	ExampleCheckVirtualRouter(ExampleReceiveTestMessage(router, secondRequest, sizeof(secondRequest), request, sizeof(request), client, message, &deviceInstance) > 0 && deviceInstance == SECOND_DEVICE_INSTANCE, "second device routed once answered", &errorCount);
+	length = ExampleBuildTestMessage(localAnswer, sizeof(localAnswer), answer, sizeof(answer), message);
+	replyLength = router.Reply(message, length, client, reply, sizeof(reply));
+	ExampleCheckVirtualRouter(replyLength > 0 && ExampleDecodeNpdu(reply, replyLength, &npdu) && npdu.sourceAddress[2] == 0x8B, "answer of the second device", &errorCount);
+
+	// Two clients behind the same router with the same invoke ID, each to its own device: SADR tells them apart
+	const uint8_t firstClientRequest[] = { NPDU_VERSION, 0x2C, 0x03, 0xE8, 0x03, 0x05, 0xEF, 0x8A, 0x00, CLIENT_NETWORK, 0x01, 0x10, 0xFE };
+	const uint8_t secondClientRequest[] = { NPDU_VERSION, 0x2C, 0x03, 0xE8, 0x03, 0x05, 0xEF, 0x8B, 0x00, CLIENT_NETWORK, 0x01, 0x11, 0xFE };
+	ExampleCheckVirtualRouter(ExampleReceiveTestMessage(router, firstClientRequest, sizeof(firstClientRequest), request, sizeof(request), client, message, &deviceInstance) > 0, "first remote client routed", &errorCount);
+	ExampleCheckVirtualRouter(ExampleReceiveTestMessage(router, secondClientRequest, sizeof(secondClientRequest), request, sizeof(request), client, message, &deviceInstance) > 0, "second remote client routed", &errorCount);
+	const uint8_t secondClientAnswer[] = { NPDU_VERSION, 0x20, 0x00, CLIENT_NETWORK, 0x01, 0x11, 0xFF };
+	length = ExampleBuildTestMessage(secondClientAnswer, sizeof(secondClientAnswer), answer, sizeof(answer), message);
+	replyLength = router.Reply(message, length, client, reply, sizeof(reply));
+	ExampleCheckVirtualRouter(replyLength > 0 && ExampleDecodeNpdu(reply, replyLength, &npdu) && npdu.sourceAddress[2] == 0x8B, "answer to the second remote client", &errorCount);
+	length = ExampleBuildTestMessage(remoteAnswer, sizeof(remoteAnswer), answer, sizeof(answer), message);
+	replyLength = router.Reply(message, length, client, reply, sizeof(reply));
+	ExampleCheckVirtualRouter(replyLength > 0 && ExampleDecodeNpdu(reply, replyLength, &npdu) && npdu.sourceAddress[2] == 0x8A, "answer to the first remote client", &errorCount);
+
+	// A request for the example device with the invoke ID of a routed one: its answer is left alone
+	const uint8_t exampleRequest[] = { NPDU_VERSION, 0x04 };
+	ExampleCheckVirtualRouter(ExampleReceiveTestMessage(router, exampleRequest, sizeof(exampleRequest), request, sizeof(request), client, message, &deviceInstance) > 0 && deviceInstance == ExampleVirtualRouter::NO_DEVICE, "example device request", &errorCount);
+	ExampleCheckVirtualRouter(ExampleReceiveTestMessage(router, localRequest, sizeof(localRequest), request, sizeof(request), client, message, &deviceInstance) == 0, "routed request with the invoke ID of the example device dropped", &errorCount);
+	length = ExampleBuildTestMessage(localAnswer, sizeof(localAnswer), answer, sizeof(answer), message);
+	ExampleCheckVirtualRouter(router.Reply(message, length, client, reply, sizeof(reply)) == 0, "answer of the example device unchanged", &errorCount);
+	ExampleCheckVirtualRouter(router.Reply(message, length, client, reply, sizeof(reply)) == 0, "unknown answer unchanged", &errorCount);
+
+	if (errorCount > 0) {
+		std::cerr << "Error - Virtual router test failed. errors=[" << errorCount << "]" << std::endl;
+		return 1;
+	}
+	std::cout << "FYI: Routed=[" << router.GetStats().routed << "], replied=[" << router.GetStats().replied << "], dropped=[" << router.GetStats().dropped << "]" << std::endl;
+	std::cout << "FYI: Virtual router test passed" << std::endl;
+	return 0;
+}
+
+// A property of a PROPERTY_IDENTIFIER_ALL read and the callback the stack gets it with
+struct ExamplePropertyAllRead {
+	enum Callback {
+		CALLBACK_BOOL,
+		CALLBACK_CHAR_STRING,
+		CALLBACK_REAL
+	};
+	Callback callback;
+	uint32_t propertyIdentifier;
+};
+
+int ExamplePropertyAllBenchmark(ExampleDatabase& database, const ExampleGetPropertyCallbacks& callbacks, const uint32_t rounds) {
+	if (rounds == 0) {
+		std::cerr << "Error - Invalid number of rounds. rounds=[" << rounds << "]" << std::endl;
+		return 1;
+	}
+	// The properties of an analog object that the stack asks the application for, in the order of the object.
+	// The ones that an object does not have are asked for too and fail, as they would with the stack. The enumerated
+	// properties (reliability, units) are left out, CallbackGetPropertyEnum logs every call and that is all it would measure.
+	static const ExamplePropertyAllRead PROPERTIES[] = {
+		{ ExamplePropertyAllRead::CALLBACK_CHAR_STRING, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OBJECT_NAME },
+		{ ExamplePropertyAllRead::CALLBACK_REAL, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE },
+		{ ExamplePropertyAllRead::CALLBACK_CHAR_STRING, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_DESCRIPTION },
+		{ ExamplePropertyAllRead::CALLBACK_BOOL, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_OUT_OF_SERVICE },
+		{ ExamplePropertyAllRead::CALLBACK_REAL, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_MIN_PRES_VALUE },
+		{ ExamplePropertyAllRead::CALLBACK_REAL, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_MAX_PRES_VALUE },
+		{ ExamplePropertyAllRead::CALLBACK_REAL, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_RELINQUISH_DEFAULT },
+		{ ExamplePropertyAllRead::CALLBACK_REAL, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_COV_INCURMENT }
+	};
+	static const uint32_t PROPERTY_COUNT = sizeof(PROPERTIES) / sizeof(PROPERTIES[0]);
+	struct ExamplePropertyAllObject {
+		uint16_t objectType;
+		uint32_t objectInstance;
+	};
+	const ExamplePropertyAllObject objects[] = {
+		{ CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, database.analogInput.instance },
+		{ CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_INPUT, database.analogInputOutOfService.instance },
+		{ CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_OUTPUT, database.analogOutput.instance },
+		{ CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE, database.analogValue.instance }
+	};
+	const uint32_t objectCount = sizeof(objects) / sizeof(objects[0]);
+	const uint32_t deviceInstance = database.device.instance;
+	std::cout << "FYI: PROPERTY_IDENTIFIER_ALL benchmark. objects=[" << objectCount << "], properties=[" << PROPERTY_COUNT << "], rounds=[" << rounds << "]" << std::endl;
+
+	static const char* LOOKUP_NAMES[] = { "cursor, cache and index", "cache and index", "index only" };
+	double nanoseconds[3] = { 0.0, 0.0, 0.0 };
+	uint64_t hashes[3] = { 0, 0, 0 };
+	for (uint32_t lookup = 0; lookup < 3; lookup++) {
+		database.SetObjectLookup((ExampleDatabase::ObjectLookup)lookup);
+		// Everything that was read, so that the lookups can be compared and the reads are not optimized out
+		uint64_t hash = 0;
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (uint32_t round = 0; round < rounds; round++) {
+			for (uint32_t object = 0; object < objectCount; object++) {
+				const uint16_t objectType = objects[object].objectType;
+				const uint32_t objectInstance = objects[object].objectInstance;
+				for (uint32_t property = 0; property < PROPERTY_COUNT; property++) {
+					const uint32_t propertyIdentifier = PROPERTIES[property].propertyIdentifier;
+					uint64_t value = 0;
+					bool found = false;
+					if (PROPERTIES[property].callback == ExamplePropertyAllRead::CALLBACK_BOOL) {
+						bool boolValue = false;
+						found = callbacks.getBool(deviceInstance, objectType, objectInstance, propertyIdentifier, &boolValue, false, 0);
+						value = boolValue ? 1 : 0;
+					}
+					else if (PROPERTIES[property].callback == ExamplePropertyAllRead::CALLBACK_CHAR_STRING) {
+						char text[128];
+						uint32_t length = 0;
+						uint8_t encoding = 0;
+						found = callbacks.getCharString(deviceInstance, objectType, objectInstance, propertyIdentifier, text, &length, sizeof(text), &encoding, false, 0);
+						value = found && length > 0 ? (uint8_t)text[0] + (length << 8) : 0;
+					}
+					else {
+						float realValue = 0.0f;
+						found = callbacks.getReal(deviceInstance, objectType, objectInstance, propertyIdentifier, &realValue, false, 0);
+						uint32_t bits;
+						memcpy(&bits, &realValue, sizeof(bits));
+						value = bits;
+					}
+					hash = hash * 31 + (found ? value + 1 : 0);
+				}
+			}
+		}
+		nanoseconds[lookup] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ((double)rounds * objectCount * PROPERTY_COUNT);
+		hashes[lookup] = hash;
+		std::cout << "FYI: Lookup=[" << LOOKUP_NAMES[lookup] << "], per callback=[" << nanoseconds[lookup] << " ns]" << std::endl;
+	}
+	database.SetObjectLookup(ExampleDatabase::OBJECT_LOOKUP_CURSOR);
+
+	if (hashes[1] != hashes[0] || hashes[2] != hashes[0]) {
+		std::cerr << "Error - The lookups returned different values" << std::endl;
+		return 1;
+	}
+	std::cout << "FYI: PROPERTY_IDENTIFIER_ALL benchmark passed" << std::endl;
+	return 0;
+}
+
+// Resident memory of the process in kilobytes, 0 where it is not known
+static uint64_t ExampleGetResidentKilobytes() {
+#ifndef _WIN32
+	FILE* statm = fopen("/proc/self/statm", "r");
+	if (statm == NULL) {
+		return 0;
+	}
+	unsigned long sizePages = 0;
+	unsigned long residentPages = 0;
+	const int count = fscanf(statm, "%lu %lu", &sizePages, &residentPages);
+	fclose(statm);
+	return count == 2 ? (uint64_t)residentPages * (uint64_t)sysconf(_SC_PAGESIZE) / 1024 : 0;
+#else // _WIN32
+	return 0;
+#endif // _WIN32
+}
+
+int ExampleHostedDevicesBenchmark(const uint32_t deviceCount, const uint32_t pointCount) {
+	if (deviceCount == 0 || deviceCount > 100000 || pointCount == 0 || pointCount > 100000) {
+		std::cerr << "Error - Invalid number of devices or points. devices=[" << deviceCount << "], points=[" << pointCount << "]" << std::endl;
+		return 1;
+	}
+	std::cout << "FYI: Hosted devices benchmark. devices=[" << deviceCount << "], points=[" << pointCount << "]" << std::endl;
+	const uint32_t firstInstance = 390000;
+
+	// The devices and points as AddHostedDevice adds them, without the stack
+	const uint64_t residentBefore = ExampleGetResidentKilobytes();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	ExampleDeviceRegistry* registry = new ExampleDeviceRegistry();
+	for (uint32_t offset = 0; offset < deviceCount; offset++) {
+		ExampleHostedDevice* device = registry->Add(firstInstance + offset);
+		device->objectName = "Hosted Device " + std::to_string(firstInstance + offset);
+		device->ReservePoints(pointCount);
+		for (uint32_t objectInstance = 0; objectInstance < pointCount; objectInstance++) {
+			device->AddPoint(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE, objectInstance, "AV-" + std::to_string(objectInstance), 95); // 95 = no-units
+		}
+	}
+	const double addMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	const uint64_t residentAfter = ExampleGetResidentKilobytes();
+
+	// Present value reads as CallbackGetPropertyReal serves them: a random device for every read, then runs
+	// of reads of one device like a ReadPropertyMultiple
+	static const uint32_t READ_COUNT = 10000000;
+	static const uint32_t TARGET_COUNT = 65536;
+	static const uint32_t RUN_LENGTH = 64;
+	std::vector<uint32_t> targetDevices(TARGET_COUNT);
+	std::vector<uint32_t> targetPoints(TARGET_COUNT);
+	std::mt19937 random(1);
+	for (uint32_t offset = 0; offset < TARGET_COUNT; offset++) {
+		targetDevices[offset] = firstInstance + (uint32_t)(random() % deviceCount);
+		targetPoints[offset] = (uint32_t)(random() % pointCount);
+	}
+	double readNanoseconds[2] = { 0.0, 0.0 };
+	uint32_t foundCount[2] = { 0, 0 };
+	for (uint32_t mode = 0; mode < 2; mode++) {
+		start = std::chrono::steady_clock::now();
+		for (uint32_t read = 0; read < READ_COUNT; read++) {
+			const uint32_t deviceInstance = mode == 0 ? targetDevices[read % TARGET_COUNT] : firstInstance + (read / RUN_LENGTH) % deviceCount;
+			ExampleHostedDevice* device = registry->Find(deviceInstance);
+			float value = 0.0f;
+			if (device != NULL && device->GetPropertyReal(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE, targetPoints[read % TARGET_COUNT], CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, &value)) {
+				foundCount[mode]++;
+			}
+		}
+		readNanoseconds[mode] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / READ_COUNT;
+	}
+
+	// Every point is found, and nothing past the last point or device
+	float value = 0.0f;
+	ExampleHostedDevice* last = registry->Find(firstInstance + deviceCount - 1);
+	const bool passed = registry->GetPointCount() == (size_t)deviceCount * pointCount && foundCount[0] == READ_COUNT && foundCount[1] == READ_COUNT && last != NULL &&
+		!last->GetPropertyReal(CASBACnetStackExampleConstants::OBJECT_TYPE_ANALOG_VALUE, pointCount, CASBACnetStackExampleConstants::PROPERTY_IDENTIFIER_PRESENT_VALUE, &value) &&
+		registry->Find(firstInstance + deviceCount) == NULL;
+	const size_t totalPointCount = registry->GetPointCount();
+	delete registry;
+	if (!passed) {
+		std::cerr << "Error - Hosted points were not found. points=[" << totalPointCount << "], found=[" << foundCount[0] << ", " << foundCount[1] << "], reads=[" << READ_COUNT << "]" << std::endl;
+		return 1;
+	}
+
+	std::cout << "FYI: Add=[" << addMilliseconds << " ms], resident memory=[" << (residentAfter > residentBefore ? residentAfter - residentBefore : 0) << " KB]" << std::endl;
+	std::cout << "FYI: Present value read, random device=[" << readNanoseconds[0] << " ns], runs of " << RUN_LENGTH << " reads per device=[" << readNanoseconds[1] << " ns]" << std::endl;
+	std::cout << "FYI: Hosted devices benchmark passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,77 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleSelfTest.h
+ *
+ * Stress tests and benchmarks of the example's building blocks, run from the
+ * command line instead of starting the server. The example has no test
+ * suite, these make the concurrency checks and the measurements quoted in
+ * the change log reproducible.
+ *
+ *   --stress-seqlock [seconds] [writers] [readers]
+ *   --benchmark-dirty-points [points]
+ *   --benchmark-cov-filter [points] [ticks]
+ *   --benchmark-image [objects]
+ *   --test-virtual-router
+ *   --benchmark-property-all [rounds]
+ *   --benchmark-wal [writes] [writes per tick]
+ *   --benchmark-startup [objects]
+ *   --benchmark-hosted-devices [devices] [points]
+ *
+ * Each returns the exit code of the process, 0 when the test passed.
+*/
+
+#ifndef __CASBACnetStackExampleSelfTest_h__
+#define __CASBACnetStackExampleSelfTest_h__
+
+#include <stdint.h>
+
+class ExampleDatabase;
+
+// Writer threads write values made of several words to one ExampleSeqLock while reader threads read it.
+// Fails if a reader sees a value made of words from two different writes, or a writer's values out of order.
+int ExampleSeqLockStressTest(const uint32_t seconds, const uint32_t writerCount, const uint32_t readerCount);
+
+// Times marking and draining all the points of an ExampleDirtyPointSet, and a single point. Fails if a point
+// marked several times is not drained exactly once.
+int ExampleDirtyPointSetBenchmark(const uint32_t pointCount);
+
+// Times the ExampleCovFilter scan and the drain of the points it marks over a random walk of analog values,
+// with the scalar and the AVX2 loop. Fails if no point is reported, or if the two loops report different points.
+// Skipped without AVX2.
+int ExampleCovFilterBenchmark(const uint32_t pointCount, const uint32_t tickCount);
+
+// Times saving a persistent image with created Analog Values, then the startup that applies it over the
+// defaults. Uses a temporary image in the working directory. Fails if the values are not restored.
+int ExamplePersistentImageBenchmark(const uint32_t objectCount);
+
+// Times durable writes through the write-ahead log, committed for every write and then for every
+// writesPerTick writes. Uses a temporary image in the working directory. Fails if the last write is lost.
+int ExampleWriteAheadLogBenchmark(const uint32_t writeCount, const uint32_t writesPerTick);
+
+// Times loading a generated JSON profile with Analog Values, then loading the same profile compiled. Uses
+// temporary files in the working directory. Fails if the two startups do not end with the same objects.
+int ExampleStartupBenchmark(const uint32_t objectCount);
+
+// Routes a ReadProperty for a hosted device on the virtual network from a local and a remote client, and the
+// answers of the stack back, then requests with the same invoke ID to two devices, from two clients behind the
+// same router and to the example device. Fails if the stack would not get a local message, or if an answer
+// does not carry SNET/SADR of the device it came from. The stack itself is not involved.
+int ExampleVirtualRouterTest();
+
+// The get property callbacks of the server, as registered with the stack
+struct ExampleGetPropertyCallbacks {
+	bool (*getBool)(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, bool* value, const bool useArrayIndex, const uint32_t propertyArrayIndex);
+	bool (*getCharString)(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, char* value, uint32_t* valueElementCount, const uint32_t maxElementCount, uint8_t* encodingType, const bool useArrayIndex, const uint32_t propertyArrayIndex);
+	bool (*getReal)(const uint32_t deviceInstance, const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, float* value, const bool useArrayIndex, const uint32_t propertyArrayIndex);
+};
+
+// Calls the get property callbacks in the order of a PROPERTY_IDENTIFIER_ALL read of each analog object of the
+// database, with each ExampleDatabase::ObjectLookup. Fails if the lookups do not return the same values.
+int ExamplePropertyAllBenchmark(ExampleDatabase& database, const ExampleGetPropertyCallbacks& callbacks, const uint32_t rounds);
+
+// Times adding the hosted devices and their points to a device registry, with the memory they take, and
+// the present value reads of the property callbacks. Fails if a point is not found.
+int ExampleHostedDevicesBenchmark(const uint32_t deviceCount, const uint32_t pointCount);
+
+#endif // __CASBACnetStackExampleSelfTest_h__
@@ -0,0 +1,442 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleSharedPoints.cpp
+ *
+ * See CASBACnetStackExampleSharedPoints.h
+*/
+
+#include "CASBACnetStackExampleSharedPoints.h"
+
+#include <chrono>
+#include <iostream>
+#include <new>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif // _WIN32
+
+ExampleSharedPoints::ExampleSharedPoints() {
+	this->owner = false;
+	this->memory = NULL;
+	this->size = 0;
+	this->capacity = 0;
+	this->header = NULL;
+	this->points = NULL;
+	this->changed = NULL;
+	this->lastChangeSequence = 0;
+}
+
+ExampleSharedPoints::~ExampleSharedPoints() {
+	this->Close();
+}
+
+size_t ExampleSharedPoints::GetSegmentSize(const uint32_t capacity) {
+	return sizeof(ExampleSharedPointsHeader) + sizeof(ExampleSharedPoint) * capacity + sizeof(uint64_t) * ((capacity + 63) / 64);
+}
+
+// capacity must have been checked against size
+void ExampleSharedPoints::Attach(void* memory, const size_t size, const uint32_t capacity) {
+	this->memory = memory;
+	this->size = size;
+	this->capacity = capacity;
+	this->header = (ExampleSharedPointsHeader*)memory;
+	this->points = (ExampleSharedPoint*)((uint8_t*)memory + sizeof(ExampleSharedPointsHeader));
+	this->changed = (std::atomic<uint64_t>*)((uint8_t*)this->points + sizeof(ExampleSharedPoint) * capacity);
+}
+
+float ExampleSharedPoints::ToReal(const uint64_t value) {
+	const uint32_t bits = (uint32_t)value;
+	float real;
+	memcpy(&real, &bits, sizeof(real));
+	return real;
+}
+
+std::string ExampleSharedPoints::GetDefaultName(const uint32_t deviceInstance) {
+	return "/CASBACnetStackExample_" + std::to_string(deviceInstance);
+}
+
+#ifndef _WIN32
+
+bool ExampleSharedPoints::Create(const std::string& name, const uint32_t capacity, const bool replace) {
+	this->Close();
+
+	// A segment left behind by a server that did not exit cleanly is only replaced on request, it could
+	// also belong to a server that is running with the same device instance.
+	if (replace) {
+		shm_unlink(name.c_str());
+	}
+	const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (fd < 0 && errno == EEXIST) {
+		std::cerr << "Error - The shared memory segment exists, it is used by another server or was left by one (--shm-replace). name=[" << name << "]" << std::endl;
+		return false;
+	}
+	if (fd < 0) {
+		std::cerr << "Error - Could not create the shared memory segment. name=[" << name << "], errno=[" << errno << "]" << std::endl;
+		return false;
+	}
+	const size_t size = ExampleSharedPoints::GetSegmentSize(capacity);
+	if (ftruncate(fd, (off_t)size) != 0) {
+		std::cerr << "Error - Could not size the shared memory segment. name=[" << name << "], size=[" << size << "]" << std::endl;
+		close(fd);
+		shm_unlink(name.c_str());
+		return false;
+	}
+	void* memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (memory == MAP_FAILED) {
+		std::cerr << "Error - Could not map the shared memory segment. name=[" << name << "]" << std::endl;
+		shm_unlink(name.c_str());
+		return false;
+	}
+
+	// The segment is zero filled by ftruncate. Construct the header and atomics in place.
+	ExampleSharedPointsHeader* header = new (memory) ExampleSharedPointsHeader();
+	header->magic = ExampleSharedPointsHeader::MAGIC;
+	header->layoutVersion = ExampleSharedPointsHeader::LAYOUT_VERSION;
+	header->capacity = capacity;
+	header->pointCount.store(0, std::memory_order_relaxed);
+	header->ready.store(0, std::memory_order_relaxed);
+	header->changeSequence.store(0, std::memory_order_relaxed);
+	this->Attach(memory, size, capacity);
+	for (uint32_t offset = 0; offset < capacity; offset++) {
+		new (&this->points[offset]) ExampleSharedPoint();
+		this->points[offset].value.store(0, std::memory_order_relaxed);
+	}
+	for (uint32_t offset = 0; offset < (capacity + 63) / 64; offset++) {
+		new (&this->changed[offset]) std::atomic<uint64_t>(0);
+	}
+
+	this->name = name;
+	this->owner = true;
+	this->lastChangeSequence = 0;
+	return true;
+}
+
+bool ExampleSharedPoints::Open(const std::string& name) {
+	this->Close();
+
+	const int fd = shm_open(name.c_str(), O_RDWR, 0);
+	if (fd < 0) {
+		std::cerr << "Error - Could not open the shared memory segment, is the server running? name=[" << name << "]" << std::endl;
+		return false;
+	}
+	struct stat status;
+	if (fstat(fd, &status) != 0 || (size_t)status.st_size < sizeof(ExampleSharedPointsHeader)) {
+		std::cerr << "Error - The shared memory segment is too small. name=[" << name << "]" << std::endl;
+		close(fd);
+		return false;
+	}
+	void* memory = mmap(NULL, (size_t)status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (memory == MAP_FAILED) {
+		std::cerr << "Error - Could not map the shared memory segment. name=[" << name << "]" << std::endl;
+		return false;
+	}
+
+	// Read once, checked and kept
+	const ExampleSharedPointsHeader* header = (const ExampleSharedPointsHeader*)memory;
+	const uint32_t capacity = *(const volatile uint32_t*)&header->capacity;
+	if (header->magic != ExampleSharedPointsHeader::MAGIC || header->layoutVersion != ExampleSharedPointsHeader::LAYOUT_VERSION || ExampleSharedPoints::GetSegmentSize(capacity) > (size_t)status.st_size) {
+		std::cerr << "Error - Unsupported shared memory segment. name=[" << name << "], layoutVersion=[" << header->layoutVersion << "]" << std::endl;
+		munmap(memory, (size_t)status.st_size);
+		return false;
+	}
+	this->Attach(memory, (size_t)status.st_size, capacity);
+	this->name = name;
+	this->owner = false;
+
+	// Wait up to 5 seconds for the server to finish the point table
+	for (uint32_t attempt = 0; attempt < 500 && this->header->ready.load(std::memory_order_acquire) == 0; attempt++) {
+		usleep(10 * 1000);
+	}
+	if (this->header->ready.load(std::memory_order_acquire) == 0) {
+		std::cerr << "Error - The shared memory segment is not ready. name=[" << name << "]" << std::endl;
+		this->Close();
+		return false;
+	}
+	return true;
+}
+
+void ExampleSharedPoints::Close() {
+	if (this->memory != NULL) {
+		munmap(this->memory, this->size);
+		if (this->owner) {
+			shm_unlink(this->name.c_str());
+		}
+	}
+	this->owner = false;
+	this->memory = NULL;
+	this->size = 0;
+	this->capacity = 0;
+	this->header = NULL;
+	this->points = NULL;
+	this->changed = NULL;
+}
+
+// Collects like the server and checks that the values of each point never go backwards
+struct ExampleSharedPointsStressApply {
+	std::vector<uint64_t>* values;
+	uint64_t collected;
+	uint64_t errors;
+
+	void operator()(const uint32_t index, const ExampleSharedPoint& point) {
+		const uint64_t value = point.value.load(std::memory_order_acquire);
+		if (value < (*this->values)[index]) {
+			if (this->errors++ < 10) {
+				std::cerr << "Error - A collected value went backwards. index=[" << index << "], value=[" << value << "], previous=[" << (*this->values)[index] << "]" << std::endl;
+			}
+		}
+		(*this->values)[index] = value;
+		this->collected++;
+	}
+};
+
+// What a producer process sends back through its pipe when it is done
+struct ExampleSharedPointsStressResult {
+	uint64_t writes;
+	uint64_t lastValue; // Written to every point of the producer last
+};
+
+int ExampleSharedPointsStressTest(const uint32_t seconds, const uint32_t producerCount) {
+	static const uint32_t POINTS_PER_PRODUCER = 64;
+	if (producerCount == 0 || producerCount > 1024) {
+		std::cerr << "Error - Invalid number of producers. producers=[" << producerCount << "]" << std::endl;
+		return 1;
+	}
+	const std::string name = "/CASBACnetStackExample_stress_" + std::to_string(getpid());
+	const uint32_t pointCount = producerCount * POINTS_PER_PRODUCER;
+	ExampleSharedPoints server;
+	if (!server.Create(name, pointCount, false)) {
+		return 1;
+	}
+	for (uint32_t index = 0; index < pointCount; index++) {
+		server.AddPoint(2, index, 85, ExampleSharedPoint::DATA_TYPE_UNSIGNED, 0); // Analog Values, present value
+	}
+	server.SetReady();
+	std::cout << "FYI: Shared memory stress test. producers=[" << producerCount << "], points=[" << pointCount << "], seconds=[" << seconds << "]" << std::endl;
+
+	// Each producer is a process with its own mapping of the segment and its own points
+	std::vector<pid_t> processes;
+	std::vector<int> pipes;
+	for (uint32_t producer = 0; producer < producerCount; producer++) {
+		int fds[2];
+		if (pipe(fds) != 0) {
+			std::cerr << "Error - Could not create a pipe. errno=[" << errno << "]" << std::endl;
+			break;
+		}
+		const pid_t process = fork();
+		if (process < 0) {
+			std::cerr << "Error - Could not start a producer. errno=[" << errno << "]" << std::endl;
+			close(fds[0]);
+			close(fds[1]);
+			break;
+		}
+		if (process == 0) {
+			// Producer. _exit, the copy of the server must not unlink the segment.
+			close(fds[0]);
+			ExampleSharedPointsStressResult result = { 0, 0 };
+			ExampleSharedPoints sharedPoints;
+			if (sharedPoints.Open(name)) {
+				const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+				while (std::chrono::steady_clock::now() < end) {
+					for (uint32_t round = 0; round < 1000; round++) {
+						result.lastValue++;
+						for (uint32_t index = producer * POINTS_PER_PRODUCER; index < (producer + 1) * POINTS_PER_PRODUCER; index++) {
+							sharedPoints.WriteUnsigned(index, (uint32_t)result.lastValue);
+						}
+						result.writes += POINTS_PER_PRODUCER;
+					}
+				}
+			}
+			const bool sent = write(fds[1], &result, sizeof(result)) == (ssize_t)sizeof(result);
+			_exit(sent && result.writes > 0 ? 0 : 1);
+		}
+		close(fds[1]);
+		processes.push_back(process);
+		pipes.push_back(fds[0]);
+	}
+
+	// Server side, a tick every millisecond until the producers are done
+	std::vector<uint64_t> values(pointCount, 0);
+	ExampleSharedPointsStressApply apply;
+	apply.values = &values;
+	apply.collected = 0;
+	apply.errors = 0;
+	uint64_t ticks = 0;
+	uint32_t running = (uint32_t)processes.size();
+	bool failed = processes.size() != producerCount;
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	while (running > 0) {
+		server.CollectChanges(apply);
+		ticks++;
+		usleep(1000);
+		int status = 0;
+		pid_t process;
+		while ((process = waitpid(-1, &status, WNOHANG)) > 0) {
+			running--;
+			failed = failed || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+		}
+		if (process < 0 && errno == ECHILD) {
+			break;
+		}
+	}
+	const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	server.CollectChanges(apply);
+
+	// The last value of every producer must have been collected for each of its points
+	uint64_t writes = 0;
+	for (size_t producer = 0; producer < pipes.size(); producer++) {
+		ExampleSharedPointsStressResult result = { 0, 0 };
+		if (read(pipes[producer], &result, sizeof(result)) != (ssize_t)sizeof(result)) {
+			failed = true;
+		}
+		close(pipes[producer]);
+		writes += result.writes;
+		for (uint32_t index = (uint32_t)producer * POINTS_PER_PRODUCER; index < (uint32_t)(producer + 1) * POINTS_PER_PRODUCER; index++) {
+			if (values[index] != (uint32_t)result.lastValue) {
+				if (apply.errors++ < 10) {
+					std::cerr << "Error - The last value written was not collected. index=[" << index << "], collected=[" << values[index] << "], written=[" << (uint32_t)result.lastValue << "]" << std::endl;
+				}
+			}
+		}
+	}
+	server.Close();
+
+	std::cout << "FYI: Writes=[" << writes << "], writes per second=[" << (uint64_t)((double)writes / elapsed) << "], ticks=[" << ticks << "], collected=[" << apply.collected << "], errors=[" << apply.errors << "]" << std::endl;
+	if (failed || apply.errors > 0) {
+		std::cerr << "Error - Shared memory stress test failed" << std::endl;
+		return 1;
+	}
+	std::cout << "FYI: Shared memory stress test passed" << std::endl;
+	return 0;
+}
+
+#else // _WIN32
+
+bool ExampleSharedPoints::Create(const std::string& name, const uint32_t capacity, const bool replace) {
+	std::cerr << "Error - Shared memory point ingestion is only supported on Linux" << std::endl;
+	return false;
+}
+
+bool ExampleSharedPoints::Open(const std::string& name) {
+	std::cerr << "Error - Shared memory point ingestion is only supported on Linux" << std::endl;
+	return false;
+}
+
+void ExampleSharedPoints::Close() {
+}
+
+int ExampleSharedPointsStressTest(const uint32_t seconds, const uint32_t producerCount) {
+	std::cerr << "Error - Shared memory point ingestion is only supported on Linux" << std::endl;
+	return 1;
+}
+
+#endif // _WIN32
+
+uint32_t ExampleSharedPoints::AddPoint(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint16_t dataType, const uint64_t initialValue) {
+	if (this->header == NULL || !this->owner) {
+		return INVALID_POINT;
+	}
+	const uint32_t index = this->header->pointCount.load(std::memory_order_relaxed);
+	if (index >= this->capacity) {
+		return INVALID_POINT;
+	}
+	ExampleSharedPoint& point = this->points[index];
+	point.objectType = objectType;
+	point.dataType = dataType;
+	point.objectInstance = objectInstance;
+	point.propertyIdentifier = propertyIdentifier;
+	point.value.store(initialValue, std::memory_order_relaxed);
+	this->header->pointCount.store(index + 1, std::memory_order_release);
+	return index;
+}
+
+void ExampleSharedPoints::SetReady() {
+	if (this->header != NULL) {
+		this->header->ready.store(1, std::memory_order_release);
+	}
+}
+
+uint32_t ExampleSharedPoints::GetPointCount() const {
+	if (this->header == NULL) {
+		return 0;
+	}
+	// Also written by the producers
+	const uint32_t pointCount = this->header->pointCount.load(std::memory_order_acquire);
+	return pointCount < this->capacity ? pointCount : this->capacity;
+}
+
+uint32_t ExampleSharedPoints::FindPoint(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier) const {
+	const uint32_t pointCount = this->GetPointCount();
+	for (uint32_t index = 0; index < pointCount; index++) {
+		const ExampleSharedPoint& point = this->points[index];
+		if (point.objectType == objectType && point.objectInstance == objectInstance && point.propertyIdentifier == propertyIdentifier) {
+			return index;
+		}
+	}
+	return INVALID_POINT;
+}
+
+bool ExampleSharedPoints::Write(const uint32_t index, const uint16_t dataType, const uint64_t value) {
+	if (index >= this->GetPointCount() || this->points[index].dataType != dataType) {
+		return false;
+	}
+	// Value, then changed bit, then change sequence. The server reads them in the opposite order,
+	// so a write it misses in one tick is picked up in the next one.
+	this->points[index].value.store(value, std::memory_order_release);
+	this->changed[index / 64].fetch_or(((uint64_t)1) << (index % 64), std::memory_order_release);
+	this->header->changeSequence.fetch_add(1, std::memory_order_release);
+	return true;
+}
+
+bool ExampleSharedPoints::WriteReal(const uint32_t index, const float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return this->Write(index, ExampleSharedPoint::DATA_TYPE_REAL, bits);
+}
+
+bool ExampleSharedPoints::WriteUnsigned(const uint32_t index, const uint32_t value) {
+	return this->Write(index, ExampleSharedPoint::DATA_TYPE_UNSIGNED, value);
+}
+
+bool ExampleSharedPoints::WriteBoolean(const uint32_t index, const bool value) {
+	return this->Write(index, ExampleSharedPoint::DATA_TYPE_BOOLEAN, value ? 1 : 0);
+}
+
+int ExampleSharedPointsTestProducer(const std::string& name, const uint32_t seconds) {
+	ExampleSharedPoints sharedPoints;
+	if (!sharedPoints.Open(name)) {
+		return 1;
+	}
+	const uint32_t pointCount = sharedPoints.GetPointCount();
+	std::cout << "FYI: Opened shared memory segment. name=[" << name << "], points=[" << pointCount << "]" << std::endl;
+
+	// Only the real and boolean points are written, the unsigned points (reliability,
+	// multi-state) have a limited set of valid values.
+	uint64_t writes = 0;
+	uint32_t cycle = 0;
+	const time_t startTime = time(0);
+	time_t reportTime = startTime;
+	while (time(0) < startTime + (time_t)seconds) {
+		cycle++;
+		for (uint32_t index = 0; index < pointCount; index++) {
+			if (sharedPoints.WriteReal(index, (float)(cycle % 1000) * 0.1f) || sharedPoints.WriteBoolean(index, (cycle & 1) != 0)) {
+				writes++;
+			}
+		}
+		if (time(0) != reportTime) {
+			reportTime = time(0);
+			std::cout << "FYI: Writes=[" << writes << "], writes per second=[" << writes / (uint64_t)(reportTime - startTime) << "]" << std::endl;
+		}
+	}
+	return 0;
+}
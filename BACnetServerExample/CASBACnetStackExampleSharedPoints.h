@@ -0,0 +1,153 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleSharedPoints.h
+ *
+ * POSIX shared memory segment that lets external acquisition processes
+ * (field drivers) write point values into the example server without going
+ * through BACnet writes or a socket.
+ *
+ * The server creates the segment and fills the point table (object type,
+ * instance, property, data type). A producer opens the segment, looks up the
+ * points it owns and writes their values with plain atomic stores. Each write
+ * sets the point's bit in the changed bitmap and increments the change
+ * sequence counter. Once per tick the server compares the change sequence
+ * with the last one it saw, and if it moved, collects the changed points from
+ * the bitmap. Nothing in the segment is locked.
+ *
+ * Segment layout (layout version 1)
+ *   ExampleSharedPointsHeader
+ *   ExampleSharedPoint[capacity]
+ *   uint64_t changed[(capacity + 63) / 64]   Bit set = point written since the server last looked
+ *
+ * Only supported on Linux. On other platforms Create and Open fail.
+*/
+
+#ifndef __CASBACnetStackExampleSharedPoints_h__
+#define __CASBACnetStackExampleSharedPoints_h__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <string>
+
+#include "CASBACnetStackExampleDirtyPointSet.h" // ExampleCountTrailingZeros64
+
+struct ExampleSharedPointsHeader {
+	static const uint32_t MAGIC = 0x50534143; // "CASP"
+	static const uint32_t LAYOUT_VERSION = 1;
+
+	uint32_t magic;
+	uint32_t layoutVersion;
+	uint32_t capacity;
+	std::atomic<uint32_t> pointCount; // Points in the table, set by the server before ready
+	std::atomic<uint32_t> ready; // Set once the server has filled the point table
+	uint32_t reserved;
+	std::atomic<uint64_t> changeSequence; // Incremented after every write
+};
+
+struct ExampleSharedPoint {
+	static const uint16_t DATA_TYPE_REAL = 0;
+	static const uint16_t DATA_TYPE_UNSIGNED = 1;
+	static const uint16_t DATA_TYPE_BOOLEAN = 2;
+
+	uint16_t objectType;
+	uint16_t dataType;
+	uint32_t objectInstance;
+	uint32_t propertyIdentifier;
+	uint32_t reserved;
+	std::atomic<uint64_t> value; // Raw bits. float for DATA_TYPE_REAL, 0 or 1 for DATA_TYPE_BOOLEAN.
+};
+
+class ExampleSharedPoints
+{
+	public:
+		ExampleSharedPoints();
+		~ExampleSharedPoints();
+
+		// Server side. Creates the segment with room for capacity points. Fails if a segment with the name exists,
+		// unless replace is set: a server may still be using it.
+		bool Create(const std::string& name, const uint32_t capacity, const bool replace);
+		// Adds a point to the table and returns its index, or INVALID_POINT if the table is full.
+		uint32_t AddPoint(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint16_t dataType, const uint64_t initialValue);
+		// Lets the producers in once the table is complete.
+		void SetReady();
+
+		// Calls apply(index, point) for every point written since the last call. Returns the number of points.
+		// Returns straight away if the change sequence did not move.
+		template <typename Apply>
+		uint32_t CollectChanges(Apply& apply) {
+			if (this->header == NULL) {
+				return 0;
+			}
+			const uint64_t changeSequence = this->header->changeSequence.load(std::memory_order_acquire);
+			if (changeSequence == this->lastChangeSequence) {
+				return 0;
+			}
+			this->lastChangeSequence = changeSequence;
+
+			uint32_t count = 0;
+			const uint32_t wordCount = (this->capacity + 63) / 64;
+			for (uint32_t word = 0; word < wordCount; word++) {
+				uint64_t bits = this->changed[word].exchange(0, std::memory_order_acquire);
+				while (bits != 0) {
+					const uint32_t index = word * 64 + ExampleCountTrailingZeros64(bits);
+					bits &= bits - 1;
+					apply(index, this->points[index]);
+					count++;
+				}
+			}
+			return count;
+		}
+
+		// Producer side. Opens a segment created by the server and waits for it to be ready.
+		bool Open(const std::string& name);
+		uint32_t FindPoint(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier) const;
+		bool WriteReal(const uint32_t index, const float value);
+		bool WriteUnsigned(const uint32_t index, const uint32_t value);
+		bool WriteBoolean(const uint32_t index, const bool value);
+
+		void Close();
+		bool IsOpen() const {
+			return this->header != NULL;
+		}
+		uint32_t GetPointCount() const;
+
+		static const uint32_t INVALID_POINT = 0xFFFFFFFF;
+
+		static float ToReal(const uint64_t value);
+		// Segment name used by the server for a device, "/CASBACnetStackExample_<deviceInstance>"
+		static std::string GetDefaultName(const uint32_t deviceInstance);
+
+	private:
+		ExampleSharedPoints(const ExampleSharedPoints&);
+		ExampleSharedPoints& operator=(const ExampleSharedPoints&);
+
+		static size_t GetSegmentSize(const uint32_t capacity);
+		void Attach(void* memory, const size_t size, const uint32_t capacity);
+		bool Write(const uint32_t index, const uint16_t dataType, const uint64_t value);
+
+		std::string name;
+		bool owner; // The server unlinks the segment on Close
+		void* memory;
+		size_t size;
+		// The capacity the segment was created or checked with. The producers can write the header, so the bounds
+		// come from this copy and never from the segment.
+		uint32_t capacity;
+		ExampleSharedPointsHeader* header;
+		ExampleSharedPoint* points;
+		std::atomic<uint64_t>* changed;
+		uint64_t lastChangeSequence;
+};
+
+// Test producer, run with the --shm-producer command argument. Writes a changing value to every point
+// in the segment for the given number of seconds and prints the write rate.
+int ExampleSharedPointsTestProducer(const std::string& name, const uint32_t seconds);
+
+// Stress test, run with the --shm-stress command argument. Creates its own segment, forks producer processes
+// that write increasing values to their own points as fast as they can, and collects the changes like the
+// server does. Fails if a collected value goes backwards, or if the last value written by a producer is not
+// collected. Prints the write and collect rates. Returns the exit code.
+int ExampleSharedPointsStressTest(const uint32_t seconds, const uint32_t producerCount);
+
+#endif // __CASBACnetStackExampleSharedPoints_h__
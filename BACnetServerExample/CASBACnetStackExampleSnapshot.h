@@ -0,0 +1,204 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleSnapshot.h
+ *
+ * Double buffered snapshot of the input point values (the values that come
+ * from the field: Analog Input, Binary Input, Multi-State Input).
+ *
+ * Each pool keeps two copies of its values. The acquisition side writes into
+ * the back copy and calls Publish once per acquisition cycle, which makes it
+ * the front copy by incrementing the epoch. The stack side pins the current
+ * epoch for a whole fpTick with BeginRead/EndRead, so all the callbacks of a
+ * ReadPropertyMultiple see the values of the same acquisition cycle even if
+ * a new cycle is published in the middle of the request.
+ *
+ * The reader never waits. Publish only waits if the reader is still pinned
+ * to the copy that is about to become the back copy, which is at most the
+ * rest of one fpTick.
+ *
+ * There is one reader (the thread that calls fpTick) and one writer (the
+ * acquisition thread, or the main loop in this example).
+*/
+
+#ifndef __CASBACnetStackExampleSnapshot_h__
+#define __CASBACnetStackExampleSnapshot_h__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "CASBACnetStackExamplePointValue.h"
+
+template <typename T>
+class ExampleSnapshotPool
+{
+	public:
+		// Adds a point to both copies and returns its index. Setup only.
+		uint32_t Add(const T initialValue) {
+			this->buffers[0].push_back(initialValue);
+			this->buffers[1].push_back(initialValue);
+			return (uint32_t)(this->buffers[0].size() - 1);
+		}
+		void Clear() {
+			this->buffers[0].clear();
+			this->buffers[1].clear();
+		}
+
+		T Get(const uint32_t buffer, const uint32_t index) const {
+			return this->buffers[buffer][index];
+		}
+		void Set(const uint32_t buffer, const uint32_t index, const T value) {
+			this->buffers[buffer][index] = value;
+		}
+		// Both copies are the same size so this is a straight copy, no allocation.
+		void Copy(const uint32_t fromBuffer, const uint32_t toBuffer) {
+			this->buffers[toBuffer] = this->buffers[fromBuffer];
+		}
+
+		uint32_t GetCount() const {
+			return (uint32_t)this->buffers[0].size();
+		}
+
+	private:
+		std::vector<T> buffers[2];
+};
+
+class ExampleSnapshot
+{
+	public:
+		ExampleSnapshotPool<float> reals;
+		ExampleSnapshotPool<uint32_t> unsignedIntegers;
+		ExampleSnapshotPool<bool> booleans;
+
+		ExampleSnapshot() : epoch(0), pinnedEpoch(NOT_PINNED) {
+		}
+
+		// Reader (stack) side
+		// Pins the current epoch until EndRead. Reads in between all come from the same copy.
+		void BeginRead() {
+			uint32_t current = this->epoch.load();
+			for (;;) {
+				this->pinnedEpoch.store(current);
+				const uint32_t check = this->epoch.load();
+				if (check == current) {
+					break;
+				}
+				current = check; // Published while pinning, pin the new one instead
+			}
+		}
+		void EndRead() {
+			this->pinnedEpoch.store(NOT_PINNED);
+		}
+		// Copy that reads come from. The pinned one during a read, otherwise the latest published.
+		uint32_t GetReadBuffer() const {
+			const uint32_t pinned = this->pinnedEpoch.load(std::memory_order_acquire);
+			if (pinned != NOT_PINNED) {
+				return pinned & 1;
+			}
+			return this->epoch.load(std::memory_order_acquire) & 1;
+		}
+
+		// Writer (acquisition) side
+		uint32_t GetWriteBuffer() const {
+			return (this->epoch.load(std::memory_order_relaxed) + 1) & 1;
+		}
+		// Makes the values written since the last Publish visible to the reader as one snapshot.
+		void Publish() {
+			const uint32_t published = this->epoch.load(std::memory_order_relaxed);
+			this->epoch.store(published + 1);
+
+			// The old front copy becomes the back copy. Wait for a reader still pinned to it, then
+			// bring it up to date so the next cycle only has to write the points that change.
+			while (this->pinnedEpoch.load() == published) {
+				std::this_thread::yield();
+			}
+			const uint32_t front = (published + 1) & 1;
+			this->reals.Copy(front, front ^ 1);
+			this->unsignedIntegers.Copy(front, front ^ 1);
+			this->booleans.Copy(front, front ^ 1);
+		}
+
+		uint32_t GetEpoch() const {
+			return this->epoch.load(std::memory_order_acquire);
+		}
+
+		void Clear() {
+			this->reals.Clear();
+			this->unsignedIntegers.Clear();
+			this->booleans.Clear();
+		}
+
+		ExampleSnapshotPool<float>& GetPool(float*) {
+			return this->reals;
+		}
+		ExampleSnapshotPool<uint32_t>& GetPool(uint32_t*) {
+			return this->unsignedIntegers;
+		}
+		ExampleSnapshotPool<bool>& GetPool(bool*) {
+			return this->booleans;
+		}
+
+	private:
+		static const uint32_t NOT_PINNED = 0xFFFFFFFF;
+
+		std::atomic<uint32_t> epoch; // Front copy is epoch & 1
+		std::atomic<uint32_t> pinnedEpoch;
+};
+
+// A point stored in an ExampleSnapshot pool, used as a member of the example database objects.
+// Reading it gives the value from the reader's copy, writing it goes to the back copy.
+template <typename T>
+class ExampleSnapshotPoint
+{
+	public:
+		ExampleSnapshotPoint() : snapshot(NULL), index(0) {
+		}
+
+		void Attach(ExampleSnapshot* snapshot, const T initialValue) {
+			this->snapshot = snapshot;
+			this->index = snapshot->GetPool((T*)NULL).Add(initialValue);
+		}
+
+		// Value of the snapshot seen by the stack
+		T Get() const {
+			return this->snapshot->GetPool((T*)NULL).Get(this->snapshot->GetReadBuffer(), this->index);
+		}
+		// Value being prepared for the next Publish, for the writer
+		T GetLatest() const {
+			return this->snapshot->GetPool((T*)NULL).Get(this->snapshot->GetWriteBuffer(), this->index);
+		}
+		void Set(const T value) {
+			this->snapshot->GetPool((T*)NULL).Set(this->snapshot->GetWriteBuffer(), this->index, value);
+		}
+
+		// Lets the point be used like the plain member it replaces.
+		operator T() const {
+			return this->Get();
+		}
+		ExampleSnapshotPoint& operator=(const T value) {
+			this->Set(value);
+			return *this;
+		}
+		T operator+=(const T delta) {
+			const T value = this->GetLatest() + delta;
+			this->Set(value);
+			return value;
+		}
+
+	private:
+		ExampleSnapshotPoint(const ExampleSnapshotPoint&);
+		ExampleSnapshotPoint& operator=(const ExampleSnapshotPoint&);
+
+		ExampleSnapshot* snapshot;
+		uint32_t index;
+};
+
+template <typename T>
+struct ExamplePointValueType<ExampleSnapshotPoint<T> > {
+	typedef T Type;
+};
+
+#endif // __CASBACnetStackExampleSnapshot_h__
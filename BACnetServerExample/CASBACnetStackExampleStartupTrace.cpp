@@ -0,0 +1,133 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleStartupTrace.cpp
+ *
+ * See CASBACnetStackExampleStartupTrace.h
+*/
+
+#include "CASBACnetStackExampleStartupTrace.h"
+
+#include <iostream>
+#include <stdio.h>
+
+ExampleStartupTrace& ExampleStartupTrace::Get() {
+	static ExampleStartupTrace trace;
+	return trace;
+}
+
+ExampleStartupTrace::ExampleStartupTrace() {
+	this->epoch = std::chrono::steady_clock::now();
+	this->finishTime = 0;
+	this->recording = true;
+	this->events.reserve(128);
+}
+
+void ExampleStartupTrace::Begin(const char* name) {
+	if (!this->recording) {
+		return;
+	}
+	Event event;
+	event.name = name;
+	event.start = this->Now();
+	event.duration = 0;
+	event.depth = (uint32_t)this->open.size();
+	event.count = 0;
+	event.step = false;
+	this->open.push_back(this->events.size());
+	this->events.push_back(event);
+}
+
+void ExampleStartupTrace::Next(const char* name) {
+	if (!this->recording) {
+		return;
+	}
+	if (!this->open.empty() && this->events[this->open.back()].step) {
+		this->Close(this->Now());
+	}
+	this->Begin(name);
+	this->events.back().step = true;
+}
+
+void ExampleStartupTrace::End() {
+	if (!this->recording) {
+		return;
+	}
+	// The steps of the phase, then the phase
+	const uint64_t now = this->Now();
+	while (!this->open.empty() && this->events[this->open.back()].step) {
+		this->Close(now);
+	}
+	if (!this->open.empty()) {
+		this->Close(now);
+	}
+}
+
+void ExampleStartupTrace::SetCount(const uint32_t count) {
+	if (!this->recording || this->open.empty()) {
+		return;
+	}
+	this->events[this->open.back()].count = count;
+}
+
+void ExampleStartupTrace::Finish() {
+	if (!this->recording) {
+		return;
+	}
+	this->finishTime = this->Now();
+	while (!this->open.empty()) {
+		this->Close(this->finishTime);
+	}
+	this->recording = false;
+}
+
+void ExampleStartupTrace::Close(const uint64_t now) {
+	Event& event = this->events[this->open.back()];
+	event.duration = now - event.start;
+	this->open.pop_back();
+}
+
+void ExampleStartupTrace::PrintSummary(std::ostream& output) const {
+	const double total = (double)this->finishTime / 1000000.0;
+	char line[256];
+	output << "FYI: Startup phases, total=[" << total << " ms]" << std::endl;
+	snprintf(line, sizeof(line), "  %10s %10s %7s %8s  %s", "Start ms", "Time ms", "%", "Objects", "Phase");
+	output << line << std::endl;
+	for (size_t offset = 0; offset < this->events.size(); offset++) {
+		const Event& event = this->events[offset];
+		const double duration = (double)event.duration / 1000000.0;
+		char count[16] = "";
+		if (event.count > 0) {
+			snprintf(count, sizeof(count), "%u", event.count);
+		}
+		snprintf(line, sizeof(line), "  %10.3f %10.3f %6.1f%% %8s  %*s%s", (double)event.start / 1000000.0, duration, total > 0 ? duration * 100.0 / total : 0.0, count, (int)(event.depth * 2), "", event.name);
+		output << line << std::endl;
+	}
+}
+
+bool ExampleStartupTrace::WriteChromeTrace(const std::string& path) const {
+	FILE* file = fopen(path.c_str(), "w");
+	if (file == NULL) {
+		std::cerr << "Error - Could not create the startup trace. path=[" << path << "]" << std::endl;
+		return false;
+	}
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for (size_t offset = 0; offset < this->events.size(); offset++) {
+		const Event& event = this->events[offset];
+		// Names are literals from this application, only quotes and backslashes need escaping
+		std::string name;
+		for (const char* character = event.name; *character != 0; character++) {
+			if (*character == '"' || *character == '\\') {
+				name.push_back('\\');
+			}
+			name.push_back(*character);
+		}
+		fprintf(file, "%s{\"name\":\"%s\",\"cat\":\"startup\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"objects\":%u}}", offset > 0 ? ",\n" : "", name.c_str(), (double)event.start / 1000.0, (double)event.duration / 1000.0, event.count);
+	}
+	fprintf(file, "\n]}\n");
+	if (fclose(file) != 0) {
+		std::cerr << "Error - Could not write the startup trace. path=[" << path << "]" << std::endl;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,77 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleStartupTrace.h
+ *
+ * Records where the startup time goes. Each phase gets a monotonic start
+ * time and duration, phases nest, and object registration loops can record
+ * batches with an object count. Once startup is done the phases are printed
+ * as a table and can be written as a Chrome trace event file (load it in
+ * chrome://tracing or https://ui.perfetto.dev).
+ *
+ * Usage
+ *   ExampleStartupTrace& trace = ExampleStartupTrace::Get();
+ *   trace.Begin("SetupDevice");        // A phase, closed by End
+ *   trace.Next("AnalogInput");         // A step, closed by the next step or by the End of the enclosing phase
+ *   trace.Next("AnalogOutput");
+ *   trace.SetCount(objects);           // Objects registered by the current phase or step
+ *   trace.End();
+ *   trace.Finish();                    // Closes what is still open and stops recording
+ *
+ * The example database is set up by a global constructor, before main, so
+ * the trace is a function local static that exists before either of them.
+ * Phase names must be string literals, they are not copied.
+*/
+
+#ifndef __CASBACnetStackExampleStartupTrace_h__
+#define __CASBACnetStackExampleStartupTrace_h__
+
+#include <stdint.h>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class ExampleStartupTrace
+{
+	public:
+		static ExampleStartupTrace& Get();
+
+		void Begin(const char* name);
+		void Next(const char* name);
+		void End();
+		void SetCount(const uint32_t count);
+		void Finish();
+
+		// Table of the phases, in start order and indented by depth
+		void PrintSummary(std::ostream& output) const;
+		// Chrome trace event format, one complete ("X") event per phase
+		bool WriteChromeTrace(const std::string& path) const;
+
+	private:
+		ExampleStartupTrace();
+		ExampleStartupTrace(const ExampleStartupTrace&);
+		ExampleStartupTrace& operator=(const ExampleStartupTrace&);
+
+		struct Event {
+			const char* name;
+			uint64_t start; // Nanoseconds since the trace was created
+			uint64_t duration;
+			uint32_t depth;
+			uint32_t count; // Objects, 0 = not counted
+			bool step; // Opened by Next
+		};
+
+		uint64_t Now() const {
+			return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - this->epoch).count();
+		}
+		void Close(const uint64_t now);
+
+		std::chrono::steady_clock::time_point epoch;
+		uint64_t finishTime;
+		bool recording;
+		std::vector<Event> events;
+		std::vector<size_t> open; // Offsets in events of the open phases, innermost last
+};
+
+#endif // __CASBACnetStackExampleStartupTrace_h__
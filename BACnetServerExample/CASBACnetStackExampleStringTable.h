@@ -0,0 +1,95 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleStringTable.h
+ *
+ * Table of preformatted strings used by the example database for the
+ * character string properties that are constant or rarely change
+ * (state text, bit text, application software version, etc).
+ *
+ * Each entry is a (pointer, length) pair so a read is a single bounded memcpy
+ * into the buffer provided by the CAS BACnet Stack, with no formatting and no
+ * scan for the terminating NULL. An entry is only rewritten when a write
+ * actually changes its value.
+*/
+
+#ifndef __CASBACnetStackExampleStringTable_h__
+#define __CASBACnetStackExampleStringTable_h__
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <stdint.h>
+#include <string.h>
+
+class ExampleStringTable
+{
+	public:
+		// Adds a string to the table and returns its handle.
+		uint32_t Add(const std::string& text) {
+			this->storage.push_back(text);
+			Entry entry;
+			entry.data = this->storage.back().c_str();
+			entry.length = (uint32_t)this->storage.back().size();
+			this->entries.push_back(entry);
+			return (uint32_t)(this->entries.size() - 1);
+		}
+
+		// Adds an array of strings with consecutive handles and returns the handle of the
+		// first one. Element N (zero based) of the array is at the returned handle + N.
+		uint32_t AddArray(const std::vector<std::string>& texts) {
+			const uint32_t first = (uint32_t)this->entries.size();
+			for (size_t offset = 0; offset < texts.size(); offset++) {
+				this->Add(texts[offset]);
+			}
+			return first;
+		}
+
+		// Updates the string for a handle. Returns true if the value changed.
+		bool Set(const uint32_t handle, const std::string& text) {
+			if (handle >= this->entries.size()) {
+				return false;
+			}
+			std::string& stored = this->storage[handle];
+			if (stored == text) {
+				return false;
+			}
+			stored = text;
+			this->entries[handle].data = stored.c_str();
+			this->entries[handle].length = (uint32_t)stored.size();
+			return true;
+		}
+
+		// Copies the string for a handle into value. Fails if the handle is unknown or
+		// the string does not fit in maxElementCount.
+		bool Copy(const uint32_t handle, char* value, uint32_t* valueElementCount, const uint32_t maxElementCount) const {
+			if (handle >= this->entries.size()) {
+				return false;
+			}
+			const Entry& entry = this->entries[handle];
+			if (entry.length > maxElementCount) {
+				return false;
+			}
+			memcpy(value, entry.data, entry.length);
+			*valueElementCount = entry.length;
+			return true;
+		}
+
+		void Clear() {
+			this->entries.clear();
+			this->storage.clear();
+		}
+
+	private:
+		struct Entry {
+			const char* data;
+			uint32_t length;
+		};
+
+		// The entries are what the reads touch, kept together in one array. The strings
+		// are owned by a deque so adding a string never moves the ones already referenced.
+		std::vector<Entry> entries;
+		std::deque<std::string> storage;
+};
+
+#endif // __CASBACnetStackExampleStringTable_h__
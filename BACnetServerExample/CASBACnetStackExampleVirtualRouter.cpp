@@ -0,0 +1,392 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleVirtualRouter.cpp
+ *
+ * See CASBACnetStackExampleVirtualRouter.h
+*/
+
+#include "CASBACnetStackExampleVirtualRouter.h"
+
+#include <string.h>
+
+// NPDU (clause 6)
+static const uint8_t NETWORK_MESSAGE_WHO_IS_ROUTER_TO_NETWORK = 0x00;
+static const uint8_t NETWORK_MESSAGE_I_AM_ROUTER_TO_NETWORK = 0x01;
+
+// APDU
+static const uint8_t SERVICE_UNCONFIRMED_I_AM = 0;
+static const uint8_t SERVICE_UNCONFIRMED_WHO_IS = 8;
+static const uint16_t OBJECT_TYPE_DEVICE = 8;
+static const uint16_t MAX_APDU_LENGTH_ACCEPTED = 1476;
+static const uint8_t SEGMENTATION_NONE = 3;
+
+// Decodes a context tagged unsigned of 1 to 4 bytes. Returns the length of the tag and value, 0 if it is not one.
+static size_t ExampleDecodeContextUnsigned(const uint8_t* buffer, const size_t length, const uint8_t tagNumber, uint32_t* value) {
+	if (length < 1 || (buffer[0] & 0xF8) != ((tagNumber << 4) | 0x08)) {
+		return 0;
+	}
+	const size_t valueLength = buffer[0] & 0x07;
+	if (valueLength < 1 || valueLength > 4 || length < 1 + valueLength) {
+		return 0;
+	}
+	*value = 0;
+	for (size_t offset = 0; offset < valueLength; offset++) {
+		*value = (*value << 8) | buffer[1 + offset];
+	}
+	return 1 + valueLength;
+}
+
+// Passed by reference to std::chrono::seconds
+const uint32_t ExampleVirtualRouter::ROUTE_TIMEOUT;
+
+ExampleVirtualRouter::ExampleVirtualRouter() {
+	this->networkNumber = 0;
+	this->registry = NULL;
+	this->announce = false;
+	this->pendingHead = 0;
+	this->rate = 0;
+	this->burst = 0;
+	this->tokens = 0;
+	memset(&this->stats, 0, sizeof(this->stats));
+}
+
+bool ExampleVirtualRouter::Enable(const uint16_t networkNumber, ExampleDeviceRegistry* registry, const uint32_t iAmRate) {
+	if (networkNumber == 0 || networkNumber == NPDU_GLOBAL_BROADCAST || registry == NULL || iAmRate == 0) {
+		return false;
+	}
+	this->networkNumber = networkNumber;
+	this->registry = registry;
+	this->rate = (double)iAmRate;
+	// A tenth of a second of I-Am messages can go out at once
+	this->burst = this->rate / 10.0 < 1.0 ? 1.0 : this->rate / 10.0;
+	this->tokens = this->burst;
+	this->lastRefill = std::chrono::steady_clock::now();
+	return true;
+}
+
+uint16_t ExampleVirtualRouter::Receive(uint8_t* message, const uint16_t length, const ExampleNpdu& npdu, const uint8_t* source, uint32_t* deviceInstance) {
+	*deviceInstance = NO_DEVICE;
+	if (!this->IsEnabled()) {
+		return length;
+	}
+
+	// Network layer messages. Only the router discovery is answered, the rest is for the stack.
+	if ((npdu.control & NPDU_CONTROL_NETWORK_MESSAGE) != 0) {
+		if (npdu.data[0] == NETWORK_MESSAGE_WHO_IS_ROUTER_TO_NETWORK) {
+			// Without a network number the question is for all the networks of the router
+			const bool forThisNetwork = npdu.dataLength < 3 || (uint16_t)((npdu.data[1] << 8) | npdu.data[2]) == this->networkNumber;
+			if (forThisNetwork) {
+				this->announce = true;
+			}
+			return 0;
+		}
+		return length;
+	}
+
+	const bool forVirtualNetwork = npdu.hasDestination && npdu.destinationNetwork == this->networkNumber;
+	const bool globalBroadcast = !npdu.hasDestination || npdu.destinationNetwork == NPDU_GLOBAL_BROADCAST;
+	if (!forVirtualNetwork && !globalBroadcast) {
+		return length; // For another network, the stack drops it
+	}
+
+	const bool whoIs = npdu.dataLength >= 2 && npdu.data[0] == APDU_UNCONFIRMED_REQUEST && npdu.data[1] == SERVICE_UNCONFIRMED_WHO_IS;
+	if (!forVirtualNetwork || npdu.destinationLength == 0) {
+		if (!whoIs) {
+			// A request for the example device, or another broadcast
+			if (!npdu.hasDestination && !this->AddRoute(message, npdu, source, NO_DEVICE)) {
+				this->stats.dropped++;
+				return 0;
+			}
+			return length;
+		}
+		// Who-Is, answered from the registry
+		this->ReceiveWhoIs(npdu.data + 2, npdu.dataLength - 2, npdu.sourceNetwork, 0, 0x3FFFFF);
+		// The example device answers a global Who-Is, it is not on the virtual network
+		return globalBroadcast ? length : 0;
+	}
+
+	// A device on the virtual network
+	if (npdu.destinationLength != MAC_LENGTH) {
+		this->stats.dropped++;
+		return 0;
+	}
+	const uint32_t destinationDevice = ((uint32_t)npdu.destinationAddress[0] << 16) | ((uint32_t)npdu.destinationAddress[1] << 8) | npdu.destinationAddress[2];
+	if (this->registry->Find(destinationDevice) == NULL) {
+		this->stats.dropped++;
+		return 0;
+	}
+	if (whoIs) {
+		// Directed to one device
+		this->ReceiveWhoIs(npdu.data + 2, npdu.dataLength - 2, npdu.sourceNetwork, destinationDevice, destinationDevice);
+		return 0;
+	}
+	const uint16_t routedLength = this->ReceiveRouted(message, length, npdu, source, destinationDevice);
+	if (routedLength == 0) {
+		this->stats.dropped++;
+		return 0;
+	}
+	this->stats.routed++;
+	*deviceInstance = destinationDevice;
+	return routedLength;
+}
+
+uint16_t ExampleVirtualRouter::ReceiveRouted(uint8_t* message, const uint16_t length, const ExampleNpdu& npdu, const uint8_t* source, const uint32_t deviceInstance) {
+	// The moves below trust the offsets of the decoder, they must stay inside the message
+	if (npdu.data < message || npdu.data + npdu.dataLength > message + length) {
+		return 0;
+	}
+	if (!this->AddRoute(message, npdu, source, deviceInstance)) {
+		return 0;
+	}
+	const size_t npduOffset = message[1] == BVLC_FORWARDED_NPDU ? 10 : 4;
+
+	// Version, control without the destination, the source if any and the APDU. Everything moves towards the
+	// start of the message, in order.
+	uint8_t* write = message + npduOffset + 1;
+	*write++ = npdu.control & ~NPDU_CONTROL_DESTINATION;
+	if ((npdu.control & NPDU_CONTROL_SOURCE) != 0) {
+		const size_t sourceLength = 3 + (size_t)npdu.sourceLength;
+		memmove(write, npdu.sourceAddress - 3, sourceLength);
+		write += sourceLength;
+	}
+	memmove(write, npdu.data, npdu.dataLength);
+	write += npdu.dataLength;
+
+	const uint16_t routedLength = (uint16_t)(write - message);
+	message[2] = (uint8_t)(routedLength >> 8);
+	message[3] = (uint8_t)routedLength;
+	return routedLength;
+}
+
+bool ExampleVirtualRouter::AddRoute(const uint8_t* message, const ExampleNpdu& npdu, const uint8_t* source, const uint32_t deviceInstance) {
+	if ((npdu.control & NPDU_CONTROL_NETWORK_MESSAGE) != 0 || (npdu.data[0] & APDU_TYPE_MASK) != APDU_CONFIRMED_REQUEST) {
+		return true; // Not answered
+	}
+	// The stack answers the original sender of a forwarded message, not the BBMD
+	RouteKey key;
+	const uint8_t* client = message[1] == BVLC_FORWARDED_NPDU ? message + 4 : source;
+	if (npdu.dataLength < 3 || !key.Set(client, npdu.sourceNetwork, npdu.sourceLength, npdu.sourceAddress, npdu.data[2])) {
+		return false;
+	}
+
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	std::map<RouteKey, Route>::iterator itr = this->routes.find(key);
+	if (itr != this->routes.end()) {
+		// A retry, or a request that was never answered, takes the place of the old one. Otherwise the answers
+		// of the two devices could not be told apart.
+		if (itr->second.deviceInstance != deviceInstance && now - itr->second.time < std::chrono::seconds(ROUTE_TIMEOUT)) {
+			return false;
+		}
+		itr->second.deviceInstance = deviceInstance;
+		itr->second.time = now;
+		return true;
+	}
+	if (this->routes.size() >= MAX_ROUTES) {
+		// Forget the requests that were never answered
+		for (itr = this->routes.begin(); itr != this->routes.end();) {
+			if (now - itr->second.time >= std::chrono::seconds(ROUTE_TIMEOUT)) {
+				itr = this->routes.erase(itr);
+			}
+			else {
+				itr++;
+			}
+		}
+		if (this->routes.size() >= MAX_ROUTES) {
+			return false;
+		}
+	}
+	Route& route = this->routes[key];
+	route.deviceInstance = deviceInstance;
+	route.time = now;
+	return true;
+}
+
+uint16_t ExampleVirtualRouter::Reply(const uint8_t* message, const uint16_t length, const uint8_t* destination, uint8_t* buffer, const uint16_t maxLength) {
+	if (this->routes.empty()) {
+		return 0;
+	}
+	// The answers of the stack are local messages, the ones for a client on a remote network have DNET/DADR
+	ExampleNpdu npdu;
+	if (!ExampleDecodeNpdu(message, length, &npdu) || (npdu.control & (NPDU_CONTROL_NETWORK_MESSAGE | NPDU_CONTROL_SOURCE)) != 0 || npdu.dataLength < 2) {
+		return 0;
+	}
+	const uint8_t type = npdu.data[0] & APDU_TYPE_MASK;
+	if (type == APDU_CONFIRMED_REQUEST || type == APDU_UNCONFIRMED_REQUEST) {
+		return 0;
+	}
+	RouteKey key;
+	if (!key.Set(destination, npdu.destinationNetwork, npdu.destinationLength, npdu.destinationAddress, npdu.data[1])) {
+		return 0;
+	}
+	std::map<RouteKey, Route>::iterator itr = this->routes.find(key);
+	if (itr == this->routes.end()) {
+		return 0;
+	}
+	// The request stays remembered while the segments of the answer are sent
+	const bool lastAnswer = type != APDU_SEGMENT_ACK && !(type == APDU_COMPLEX_ACK && (npdu.data[0] & APDU_MORE_FOLLOWS) != 0);
+	if (itr->second.deviceInstance == NO_DEVICE) {
+		// An answer of the example device
+		if (lastAnswer) {
+			this->routes.erase(itr);
+		}
+		return 0;
+	}
+	const size_t npduOffset = message[1] == BVLC_FORWARDED_NPDU ? 10 : 4;
+	const size_t destinationLength = npdu.hasDestination ? 3 + (size_t)npdu.destinationLength : 0;
+	const size_t replyLength = npduOffset + 2 + destinationLength + 3 + MAC_LENGTH + (npdu.hasDestination ? 1 : 0) + npdu.dataLength;
+	if (replyLength > maxLength || replyLength > 0xFFFF) {
+		return 0;
+	}
+	const uint32_t deviceInstance = itr->second.deviceInstance;
+	if (lastAnswer) {
+		this->routes.erase(itr);
+	}
+
+	// Destination, source, hop count, in the order of clause 6.2
+	memcpy(buffer, message, npduOffset);
+	size_t offset = npduOffset;
+	buffer[offset++] = NPDU_VERSION;
+	buffer[offset++] = npdu.control | NPDU_CONTROL_SOURCE;
+	if (npdu.hasDestination) {
+		memcpy(buffer + offset, npdu.destinationAddress - 3, destinationLength);
+		offset += destinationLength;
+	}
+	buffer[offset++] = (uint8_t)(this->networkNumber >> 8);
+	buffer[offset++] = (uint8_t)this->networkNumber;
+	buffer[offset++] = MAC_LENGTH;
+	buffer[offset++] = (uint8_t)(deviceInstance >> 16);
+	buffer[offset++] = (uint8_t)(deviceInstance >> 8);
+	buffer[offset++] = (uint8_t)deviceInstance;
+	if (npdu.hasDestination) {
+		buffer[offset++] = npdu.data[-1]; // Hop count
+	}
+	memcpy(buffer + offset, npdu.data, npdu.dataLength);
+	offset += npdu.dataLength;
+
+	buffer[2] = (uint8_t)(offset >> 8);
+	buffer[3] = (uint8_t)offset;
+	this->stats.replied++;
+	return (uint16_t)offset;
+}
+
+void ExampleVirtualRouter::ReceiveWhoIs(const uint8_t* apdu, const size_t length, const uint16_t sourceNetwork, uint32_t low, uint32_t high) {
+	this->stats.whoIsReceived++;
+	if (length > 0) {
+		uint32_t rangeLow;
+		uint32_t rangeHigh;
+		const size_t lowLength = ExampleDecodeContextUnsigned(apdu, length, 0, &rangeLow);
+		if (lowLength == 0 || ExampleDecodeContextUnsigned(apdu + lowLength, length - lowLength, 1, &rangeHigh) == 0) {
+			return; // Malformed, one limit without the other
+		}
+		low = rangeLow > low ? rangeLow : low;
+		high = rangeHigh < high ? rangeHigh : high;
+	}
+	if (low > high) {
+		return;
+	}
+
+	// Whichever is smaller, the range or the registry
+	if ((uint64_t)high - low + 1 <= this->registry->GetCount()) {
+		for (uint64_t deviceInstance = low; deviceInstance <= high; deviceInstance++) {
+			if (this->registry->Find((uint32_t)deviceInstance) != NULL) {
+				this->QueueIAm((uint32_t)deviceInstance, sourceNetwork);
+			}
+		}
+	}
+	else {
+		struct Visitor {
+			ExampleVirtualRouter* router;
+			uint32_t low;
+			uint32_t high;
+			uint16_t sourceNetwork;
+			void operator()(ExampleHostedDevice& device) {
+				if (device.GetInstance() >= this->low && device.GetInstance() <= this->high) {
+					this->router->QueueIAm(device.GetInstance(), this->sourceNetwork);
+				}
+			}
+		};
+		Visitor visitor = { this, low, high, sourceNetwork };
+		this->registry->ForEach(visitor);
+	}
+}
+
+void ExampleVirtualRouter::QueueIAm(const uint32_t deviceInstance, const uint16_t destinationNetwork) {
+	if (!this->pendingDevices.insert(deviceInstance).second) {
+		return; // Already queued
+	}
+	PendingIAm pendingIAm;
+	pendingIAm.deviceInstance = deviceInstance;
+	pendingIAm.destinationNetwork = destinationNetwork;
+	this->pending.push_back(pendingIAm);
+	this->stats.iAmQueued++;
+}
+
+void ExampleVirtualRouter::Refill() {
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	this->tokens += std::chrono::duration<double>(now - this->lastRefill).count() * this->rate;
+	if (this->tokens > this->burst) {
+		this->tokens = this->burst;
+	}
+	this->lastRefill = now;
+}
+
+uint16_t ExampleVirtualRouter::EncodeIAm(const PendingIAm& pendingIAm, uint8_t* buffer) const {
+	uint16_t offset = 4;
+
+	// NPDU, from the device on the virtual network. A Who-Is from a remote network is answered with a
+	// broadcast on that network.
+	buffer[offset++] = NPDU_VERSION;
+	buffer[offset++] = NPDU_CONTROL_SOURCE | (pendingIAm.destinationNetwork != 0 ? NPDU_CONTROL_DESTINATION : 0);
+	if (pendingIAm.destinationNetwork != 0) {
+		buffer[offset++] = (uint8_t)(pendingIAm.destinationNetwork >> 8);
+		buffer[offset++] = (uint8_t)pendingIAm.destinationNetwork;
+		buffer[offset++] = 0; // Broadcast
+	}
+	buffer[offset++] = (uint8_t)(this->networkNumber >> 8);
+	buffer[offset++] = (uint8_t)this->networkNumber;
+	buffer[offset++] = MAC_LENGTH;
+	buffer[offset++] = (uint8_t)(pendingIAm.deviceInstance >> 16);
+	buffer[offset++] = (uint8_t)(pendingIAm.deviceInstance >> 8);
+	buffer[offset++] = (uint8_t)pendingIAm.deviceInstance;
+	if (pendingIAm.destinationNetwork != 0) {
+		buffer[offset++] = 255; // Hop count
+	}
+
+	// I-Am APDU
+	const uint32_t objectIdentifier = ((uint32_t)OBJECT_TYPE_DEVICE << 22) | (pendingIAm.deviceInstance & 0x003FFFFF);
+	buffer[offset++] = APDU_UNCONFIRMED_REQUEST;
+	buffer[offset++] = SERVICE_UNCONFIRMED_I_AM;
+	buffer[offset++] = 0xC4; // Object identifier
+	buffer[offset++] = (uint8_t)(objectIdentifier >> 24);
+	buffer[offset++] = (uint8_t)(objectIdentifier >> 16);
+	buffer[offset++] = (uint8_t)(objectIdentifier >> 8);
+	buffer[offset++] = (uint8_t)objectIdentifier;
+	buffer[offset++] = 0x22; // Unsigned, 2 bytes
+	buffer[offset++] = (uint8_t)(MAX_APDU_LENGTH_ACCEPTED >> 8);
+	buffer[offset++] = (uint8_t)MAX_APDU_LENGTH_ACCEPTED;
+	buffer[offset++] = 0x91; // Enumerated, 1 byte
+	buffer[offset++] = SEGMENTATION_NONE;
+	buffer[offset++] = 0x22; // Unsigned, 2 bytes
+	buffer[offset++] = (uint8_t)(VENDOR_IDENTIFIER >> 8);
+	buffer[offset++] = (uint8_t)VENDOR_IDENTIFIER;
+
+	buffer[0] = BVLC_TYPE_BACNET_IP;
+	buffer[1] = BVLC_ORIGINAL_BROADCAST_NPDU;
+	buffer[2] = (uint8_t)(offset >> 8);
+	buffer[3] = (uint8_t)offset;
+	return offset;
+}
+
+uint16_t ExampleVirtualRouter::EncodeIAmRouterToNetwork(uint8_t* buffer) const {
+	buffer[0] = BVLC_TYPE_BACNET_IP;
+	buffer[1] = BVLC_ORIGINAL_BROADCAST_NPDU;
+	buffer[2] = 0;
+	buffer[3] = 9;
+	buffer[4] = NPDU_VERSION;
+	buffer[5] = NPDU_CONTROL_NETWORK_MESSAGE;
+	buffer[6] = NETWORK_MESSAGE_I_AM_ROUTER_TO_NETWORK;
+	buffer[7] = (uint8_t)(this->networkNumber >> 8);
+	buffer[8] = (uint8_t)this->networkNumber;
+	return 9;
+}
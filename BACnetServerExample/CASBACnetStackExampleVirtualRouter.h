@@ -0,0 +1,235 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleVirtualRouter.h
+ *
+ * Virtual network mode. The server acts as a BACnet router between the
+ * BACnet/IP network of g_udp and a virtual network on which the hosted
+ * devices (CASBACnetStackExampleDeviceRegistry.h) live. The MAC address of a
+ * hosted device on the virtual network is its device instance, 3 bytes big
+ * endian.
+ *
+ * Receive looks at the BVLC and NPDU header (CASBACnetStackExampleNpdu.h) of
+ * every message before it is given to the stack:
+ *   - Who-Is-Router-To-Network is answered with I-Am-Router-To-Network.
+ *   - Who-Is for the virtual network, or a global Who-Is, is answered by the
+ *     router from the registry. The global Who-Is also goes to the stack for
+ *     the example device.
+ *   - A message for a device on the virtual network (DNET, DADR) is dropped
+ *     if the device is not hosted. Otherwise it is rewritten into a local
+ *     message for the stack: DNET, DADR and the hop count are removed, and
+ *     the device is given to the stack as the destination of the message.
+ *     SNET/SADR of a client on a remote network are kept.
+ *   - Everything else goes to the stack unchanged.
+ *
+ * The stack answers a routed confirmed request as if it came from the local
+ * network. Each confirmed request the stack will answer is remembered by its
+ * client (B/IP address, SNET/SADR) and invoke ID, with the device it is for:
+ * a hosted device, or the example device for the local requests. Reply adds
+ * SNET/SADR of the hosted device to an answer (ack, error, reject or abort)
+ * to a routed request before it is sent, so the client sees it come from
+ * the device on the virtual network, and leaves the answers of the example
+ * device alone. A request with the same client and invoke ID as a request
+ * for another device that was not answered yet is dropped, since the two
+ * answers could not be told apart; the client retries it. A request that is
+ * not answered is forgotten after ROUTE_TIMEOUT. Unconfirmed messages sent by a
+ * hosted device on its own, such as COV notifications, are not routed; they
+ * go out as messages of the local network.
+ *
+ * The I-Am responses are not sent from Receive. The devices are queued once
+ * (a device asked for again before its I-Am was sent is not queued twice)
+ * and Loop sends them at a fixed rate with a short burst allowance, so a
+ * Who-Is for thousands of devices does not flood the network or the
+ * receive buffers of the client. The I-Am messages carry SNET/SADR of the
+ * device on the virtual network.
+*/
+
+#ifndef __CASBACnetStackExampleVirtualRouter_h__
+#define __CASBACnetStackExampleVirtualRouter_h__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <chrono>
+#include <map>
+#include <vector>
+#include <unordered_set>
+
+#include "CASBACnetStackExampleDeviceRegistry.h"
+#include "CASBACnetStackExampleNpdu.h"
+
+struct ExampleVirtualRouterStats {
+	uint64_t whoIsReceived; // For the virtual network, global ones included
+	uint64_t iAmQueued;
+	uint64_t iAmSent;
+	uint64_t routed; // Messages given to the stack for a device on the virtual network
+	uint64_t replied; // Answers of the stack sent with SNET/SADR of a hosted device
+	uint64_t dropped; // Messages for a device that is not hosted, requests that can not be told apart from one waiting for an answer, or with too many waiting
+};
+
+class ExampleVirtualRouter
+{
+	public:
+		static const uint16_t VENDOR_IDENTIFIER = 389; // Of the I-Am messages sent by the router
+		static const uint8_t MAC_LENGTH = 3;
+		static const uint16_t MAX_MESSAGE_LENGTH = 32;
+		// A B/IP message (1507 bytes at most) with SNET/SADR added
+		static const uint16_t MAX_REPLY_LENGTH = 1507 + 3 + MAC_LENGTH;
+		static const uint32_t NO_DEVICE = 0xFFFFFFFF;
+		static const uint32_t MAX_ROUTES = 4096; // Requests waiting for an answer
+		static const uint32_t ROUTE_TIMEOUT = 60; // Seconds, longer than the APDU timeout and retries of a client
+
+		ExampleVirtualRouter();
+
+		// networkNumber 1 to 65534. iAmRate is the number of I-Am messages sent per second.
+		bool Enable(const uint16_t networkNumber, ExampleDeviceRegistry* registry, const uint32_t iAmRate);
+		bool IsEnabled() const {
+			return this->networkNumber != 0;
+		}
+		uint16_t GetNetworkNumber() const {
+			return this->networkNumber;
+		}
+
+		// message is a received B/IP message of length bytes, npdu its decoded header and source the B/IP address
+		// (6 bytes) it came from. Returns the length of the message the stack has to process, 0 if the router
+		// consumed it. A message for a hosted device is rewritten in place, *deviceInstance is then the device
+		// and NO_DEVICE otherwise. npdu points into the old message after a rewrite.
+		uint16_t Receive(uint8_t* message, const uint16_t length, const ExampleNpdu& npdu, const uint8_t* source, uint32_t* deviceInstance);
+
+		// message is about to be sent to the B/IP address destination (6 bytes). If it answers a routed request,
+		// copies it to buffer with SNET/SADR of the hosted device and returns the new length. Returns 0 when the
+		// message has to be sent unchanged.
+		uint16_t Reply(const uint8_t* message, const uint16_t length, const uint8_t* destination, uint8_t* buffer, const uint16_t maxLength);
+
+		// Queues an I-Am of a device on the virtual network, as if a Who-Is had asked for it
+		void AnnounceDevice(const uint32_t deviceInstance) {
+			this->QueueIAm(deviceInstance, 0);
+		}
+		// Queues an I-Am-Router-To-Network broadcast, sent by the next Loop
+		void AnnounceNetwork() {
+			this->announce = true;
+		}
+
+		// Sends the queued messages that the rate allows, with send(message, length). All of them are
+		// local broadcasts. Returns the number of messages sent.
+		template <typename Sender>
+		uint32_t Loop(Sender& send) {
+			if (!this->IsEnabled()) {
+				return 0;
+			}
+			uint8_t buffer[MAX_MESSAGE_LENGTH];
+			uint32_t sent = 0;
+			if (this->announce) {
+				this->announce = false;
+				if (send(buffer, this->EncodeIAmRouterToNetwork(buffer))) {
+					sent++;
+				}
+			}
+			if (this->pendingHead == this->pending.size()) {
+				return sent;
+			}
+
+			this->Refill();
+			while (this->tokens >= 1.0 && this->pendingHead < this->pending.size()) {
+				const PendingIAm& pendingIAm = this->pending[this->pendingHead++];
+				this->pendingDevices.erase(pendingIAm.deviceInstance);
+				this->tokens -= 1.0;
+				// Removed since it was queued
+				if (this->registry->Find(pendingIAm.deviceInstance) == NULL) {
+					continue;
+				}
+				if (send(buffer, this->EncodeIAm(pendingIAm, buffer))) {
+					this->stats.iAmSent++;
+					sent++;
+				}
+			}
+			if (this->pendingHead == this->pending.size()) {
+				this->pending.clear();
+				this->pendingHead = 0;
+			}
+			else if (this->pendingHead >= 1024 && this->pendingHead * 2 >= this->pending.size()) {
+				// Who-Is keeps coming in while the queue drains
+				this->pending.erase(this->pending.begin(), this->pending.begin() + this->pendingHead);
+				this->pendingHead = 0;
+			}
+			return sent;
+		}
+
+		size_t GetPendingCount() const {
+			return this->pending.size() - this->pendingHead;
+		}
+		const ExampleVirtualRouterStats& GetStats() const {
+			return this->stats;
+		}
+
+	private:
+		struct PendingIAm {
+			uint32_t deviceInstance;
+			uint16_t destinationNetwork; // Network of the Who-Is, 0 = local
+		};
+		struct Route {
+			uint32_t deviceInstance; // NO_DEVICE for a request to the example device
+			std::chrono::steady_clock::time_point time; // Of the request
+		};
+		// Who asked: the B/IP address the answer is sent to, SNET/SADR of a client behind another router and the
+		// invoke ID. Compared as bytes, Set clears the padding.
+		struct RouteKey {
+			static const uint8_t MAX_ADDRESS_LENGTH = 8;
+			uint8_t client[6];
+			uint16_t network; // 0 = the client is on the local network
+			uint8_t addressLength;
+			uint8_t address[MAX_ADDRESS_LENGTH];
+			uint8_t invokeId;
+
+			// Returns false if the address is too long
+			bool Set(const uint8_t* client, const uint16_t network, const uint8_t addressLength, const uint8_t* address, const uint8_t invokeId) {
+				memset(this, 0, sizeof(RouteKey));
+				if (addressLength > MAX_ADDRESS_LENGTH) {
+					return false;
+				}
+				memcpy(this->client, client, sizeof(this->client));
+				this->network = network;
+				this->addressLength = addressLength;
+				if (addressLength > 0) {
+					memcpy(this->address, address, addressLength);
+				}
+				this->invokeId = invokeId;
+				return true;
+			}
+			bool operator<(const RouteKey& other) const {
+				return memcmp(this, &other, sizeof(RouteKey)) < 0;
+			}
+		};
+
+		// Remembers a confirmed request that the stack will answer. Returns false if a request with the same key is
+		// waiting for the answer of another device, or if there are too many requests waiting.
+		bool AddRoute(const uint8_t* message, const ExampleNpdu& npdu, const uint8_t* source, const uint32_t deviceInstance);
+		uint16_t ReceiveRouted(uint8_t* message, const uint16_t length, const ExampleNpdu& npdu, const uint8_t* source, const uint32_t deviceInstance);
+		// Queues the hosted devices between low and high that are in the range of the Who-Is, if it has one
+		void ReceiveWhoIs(const uint8_t* apdu, const size_t length, const uint16_t sourceNetwork, uint32_t low, uint32_t high);
+		void QueueIAm(const uint32_t deviceInstance, const uint16_t destinationNetwork);
+		void Refill();
+		uint16_t EncodeIAm(const PendingIAm& pendingIAm, uint8_t* buffer) const;
+		uint16_t EncodeIAmRouterToNetwork(uint8_t* buffer) const;
+
+		uint16_t networkNumber; // 0 = disabled
+		ExampleDeviceRegistry* registry;
+		bool announce;
+
+		// Paced I-Am responses, a queue with the devices in it
+		std::vector<PendingIAm> pending;
+		size_t pendingHead;
+		std::unordered_set<uint32_t> pendingDevices;
+		double rate; // Per second
+		double burst; // Most tokens kept
+		double tokens;
+		std::chrono::steady_clock::time_point lastRefill;
+
+		// Confirmed requests waiting for the answer of the stack, the ones for the example device included so that
+		// its answers are never taken for the answer of a hosted device
+		std::map<RouteKey, Route> routes;
+
+		ExampleVirtualRouterStats stats;
+};
+
+#endif // __CASBACnetStackExampleVirtualRouter_h__
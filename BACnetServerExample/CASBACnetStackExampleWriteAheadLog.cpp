@@ -0,0 +1,242 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleWriteAheadLog.cpp
+ *
+ * See CASBACnetStackExampleWriteAheadLog.h
+*/
+
+#include "CASBACnetStackExampleWriteAheadLog.h"
+
+#include <iostream>
+#include <stdio.h> // rename()
+#include <string.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+ExampleWriteAheadLog::ExampleWriteAheadLog() {
+	this->fd = -1;
+	this->size = 0;
+	this->sequence = 0;
+}
+
+ExampleWriteAheadLog::~ExampleWriteAheadLog() {
+	this->Close();
+}
+
+void ExampleWriteAheadLog::AddValue(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint32_t arrayIndex, const uint16_t dataType, const uint64_t value) {
+	ExamplePersistentRecord record;
+	memset(&record, 0, sizeof(record));
+	record.objectType = objectType;
+	record.dataType = dataType;
+	record.objectInstance = objectInstance;
+	record.propertyIdentifier = propertyIdentifier;
+	record.arrayIndex = arrayIndex;
+	record.value = value;
+	this->pendingRecords.push_back(record);
+}
+
+void ExampleWriteAheadLog::AddData(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint32_t arrayIndex, const uint16_t dataType, const void* data, const uint32_t length) {
+	this->AddValue(objectType, objectInstance, propertyIdentifier, arrayIndex, dataType, this->pendingData.size());
+	this->pendingRecords.back().length = length;
+	this->pendingData.insert(this->pendingData.end(), (const uint8_t*)data, (const uint8_t*)data + length);
+}
+
+size_t ExampleWriteAheadLog::GetBatchSize(const std::vector<uint8_t>& buffer, const size_t offset) const {
+	if (offset + sizeof(ExampleWriteAheadLogBatch) > buffer.size()) {
+		return 0;
+	}
+	const ExampleWriteAheadLogBatch* batch = (const ExampleWriteAheadLogBatch*)&buffer[offset];
+	if (batch->magic != ExampleWriteAheadLogBatch::MAGIC) {
+		return 0;
+	}
+	const uint64_t bodySize = (uint64_t)batch->recordCount * sizeof(ExamplePersistentRecord) + batch->dataSize;
+	if (offset + sizeof(ExampleWriteAheadLogBatch) + bodySize > buffer.size()) {
+		return 0;
+	}
+	if (batch->checksum != ExamplePersistentImage::Checksum(batch + 1, (size_t)bodySize)) {
+		return 0;
+	}
+	return sizeof(ExampleWriteAheadLogBatch) + (size_t)bodySize;
+}
+
+#ifndef _WIN32
+
+bool ExampleWriteAheadLog::Open(const std::string& path) {
+	this->Close();
+	this->fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+	if (this->fd < 0) {
+		std::cerr << "Error - Could not open the write-ahead log. path=[" << path << "]" << std::endl;
+		return false;
+	}
+	struct stat status;
+	if (fstat(this->fd, &status) != 0) {
+		std::cerr << "Error - Could not read the size of the write-ahead log. path=[" << path << "]" << std::endl;
+		this->Close();
+		return false;
+	}
+	this->path = path;
+	this->size = (uint64_t)status.st_size;
+	this->sequence = 0;
+	return true;
+}
+
+void ExampleWriteAheadLog::Close() {
+	if (this->fd >= 0) {
+		close(this->fd);
+	}
+	this->fd = -1;
+	this->size = 0;
+	this->pendingRecords.clear();
+	this->pendingData.clear();
+}
+
+bool ExampleWriteAheadLog::Read(const uint64_t start, std::vector<uint8_t>& buffer) {
+	if (this->fd < 0 || start > this->size) {
+		return false;
+	}
+	buffer.resize((size_t)(this->size - start));
+	size_t offset = 0;
+	while (offset < buffer.size()) {
+		const ssize_t count = pread(this->fd, &buffer[offset], buffer.size() - offset, (off_t)(start + offset));
+		if (count <= 0) {
+			std::cerr << "Error - Could not read the write-ahead log. path=[" << this->path << "]" << std::endl;
+			return false;
+		}
+		offset += (size_t)count;
+	}
+	return true;
+}
+
+bool ExampleWriteAheadLog::Truncate(const uint64_t size) {
+	if (size == this->size) {
+		return true;
+	}
+	if (ftruncate(this->fd, (off_t)size) != 0 || fdatasync(this->fd) != 0) {
+		std::cerr << "Error - Could not truncate the write-ahead log. path=[" << this->path << "]" << std::endl;
+		return false;
+	}
+	this->size = size;
+	return true;
+}
+
+bool ExampleWriteAheadLog::Commit() {
+	if (this->fd < 0 || this->pendingRecords.empty()) {
+		return false;
+	}
+
+	// Keep the next batch 8 byte aligned
+	while (this->pendingData.size() % sizeof(uint64_t) != 0) {
+		this->pendingData.push_back(0);
+	}
+
+	// One write per batch, the buffer is kept between commits
+	const size_t recordsSize = this->pendingRecords.size() * sizeof(ExamplePersistentRecord);
+	this->batchBuffer.resize(sizeof(ExampleWriteAheadLogBatch) + recordsSize + this->pendingData.size());
+	ExampleWriteAheadLogBatch* batch = (ExampleWriteAheadLogBatch*)&this->batchBuffer[0];
+	memset(batch, 0, sizeof(ExampleWriteAheadLogBatch));
+	memcpy(batch + 1, &this->pendingRecords[0], recordsSize);
+	if (!this->pendingData.empty()) {
+		memcpy((uint8_t*)(batch + 1) + recordsSize, &this->pendingData[0], this->pendingData.size());
+	}
+	batch->magic = ExampleWriteAheadLogBatch::MAGIC;
+	batch->recordCount = (uint32_t)this->pendingRecords.size();
+	batch->dataSize = (uint32_t)this->pendingData.size();
+	batch->sequence = this->sequence + 1;
+	batch->checksum = ExamplePersistentImage::Checksum(batch + 1, recordsSize + this->pendingData.size());
+
+	const ssize_t count = pwrite(this->fd, &this->batchBuffer[0], this->batchBuffer.size(), (off_t)this->size);
+	if (count != (ssize_t)this->batchBuffer.size() || fdatasync(this->fd) != 0) {
+		// The batch stays pending and is written again at the same offset by the next commit. Anything
+		// written past the last good batch is cut off by the next replay.
+		std::cerr << "Error - Could not commit to the write-ahead log. path=[" << this->path << "], errno=[" << errno << "]" << std::endl;
+		return false;
+	}
+	this->pendingRecords.clear();
+	this->pendingData.clear();
+	this->size += this->batchBuffer.size();
+	this->sequence++;
+	return true;
+}
+
+bool ExampleWriteAheadLog::Reset() {
+	this->pendingRecords.clear();
+	this->pendingData.clear();
+	if (this->fd < 0) {
+		return false;
+	}
+	return this->Truncate(0);
+}
+
+bool ExampleWriteAheadLog::Discard(const uint64_t offset) {
+	if (this->fd < 0 || offset > this->size) {
+		return false;
+	}
+	if (offset == 0) {
+		return true;
+	}
+	if (offset == this->size) {
+		return this->Truncate(0);
+	}
+
+	// Copy the batches after offset to a new file and rename it over the log, so that a crash leaves
+	// either the old log or the new one. Replaying the old log over the new image gives the same values.
+	std::vector<uint8_t> buffer;
+	if (!this->Read(offset, buffer)) {
+		return false;
+	}
+	const std::string tempPath = this->path + ".tmp";
+	const int tempFd = open(tempPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (tempFd < 0) {
+		std::cerr << "Error - Could not create the write-ahead log. path=[" << tempPath << "]" << std::endl;
+		return false;
+	}
+	const ssize_t count = pwrite(tempFd, &buffer[0], buffer.size(), 0);
+	if (count != (ssize_t)buffer.size() || fdatasync(tempFd) != 0 || rename(tempPath.c_str(), this->path.c_str()) != 0) {
+		std::cerr << "Error - Could not replace the write-ahead log. path=[" << this->path << "]" << std::endl;
+		close(tempFd);
+		unlink(tempPath.c_str());
+		return false;
+	}
+	close(this->fd);
+	this->fd = tempFd;
+	this->size = buffer.size();
+	return true;
+}
+
+#else // _WIN32
+
+bool ExampleWriteAheadLog::Open(const std::string& path) {
+	std::cerr << "Error - The write-ahead log is only supported on POSIX systems" << std::endl;
+	return false;
+}
+
+void ExampleWriteAheadLog::Close() {
+}
+
+bool ExampleWriteAheadLog::Read(const uint64_t start, std::vector<uint8_t>& buffer) {
+	return false;
+}
+
+bool ExampleWriteAheadLog::Truncate(const uint64_t size) {
+	return false;
+}
+
+bool ExampleWriteAheadLog::Commit() {
+	return false;
+}
+
+bool ExampleWriteAheadLog::Reset() {
+	return false;
+}
+
+bool ExampleWriteAheadLog::Discard(const uint64_t offset) {
+	return false;
+}
+
+#endif // _WIN32
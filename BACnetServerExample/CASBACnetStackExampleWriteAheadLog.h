@@ -0,0 +1,133 @@
+/*
+ * BACnet Server Example C++
+ * ----------------------------------------------------------------------------
+ * CASBACnetStackExampleWriteAheadLog.h
+ *
+ * Append only log of the values written by BACnet clients since the last
+ * save of the persistent image (see CASBACnetStackExamplePersistentImage.h).
+ *
+ * Writes are added to a pending batch as they are accepted and the batch is
+ * committed with a single write and fdatasync (group commit), once per tick
+ * or per commit window. A write is acknowledged to the client before its
+ * batch is committed, so a crash loses at most the writes of the last
+ * window, never a partial batch.
+ *
+ * At startup the committed batches are replayed on top of the image. The log
+ * is compacted by saving a new generation of the image and truncating it.
+ *
+ * File layout
+ *   ExampleWriteAheadLogBatch, ExamplePersistentRecord[recordCount], dataSize bytes of string data
+ *   ExampleWriteAheadLogBatch, ...
+ * A batch whose checksum does not match (torn by a crash) ends the log.
+ *
+ * Only supported on POSIX systems.
+*/
+
+#ifndef __CASBACnetStackExampleWriteAheadLog_h__
+#define __CASBACnetStackExampleWriteAheadLog_h__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "CASBACnetStackExamplePersistentImage.h"
+
+struct ExampleWriteAheadLogBatch {
+	static const uint32_t MAGIC = 0x4C534143; // "CASL"
+
+	uint32_t magic;
+	uint32_t recordCount;
+	uint32_t dataSize;
+	uint32_t reserved;
+	uint64_t sequence; // Incremented for every batch
+	uint64_t checksum; // Checksum of the records and data
+};
+
+class ExampleWriteAheadLog : public ExamplePersistentRecordWriter
+{
+	public:
+		ExampleWriteAheadLog();
+		~ExampleWriteAheadLog();
+
+		// Opens the log, creating an empty one if it does not exist.
+		bool Open(const std::string& path);
+		void Close();
+		bool IsOpen() const {
+			return this->fd >= 0;
+		}
+
+		// Calls apply(record, data) for every record of the committed batches, in order. data points at the
+		// record's string data or is NULL. A torn batch at the end is cut off. Returns the number of records.
+		template <typename Apply>
+		uint32_t Replay(Apply& apply) {
+			std::vector<uint8_t> buffer;
+			if (!this->Read(0, buffer)) {
+				return 0;
+			}
+			uint32_t count = 0;
+			size_t offset = 0;
+			for (;;) {
+				const size_t batchSize = this->GetBatchSize(buffer, offset);
+				if (batchSize == 0) {
+					break;
+				}
+				const ExampleWriteAheadLogBatch* batch = (const ExampleWriteAheadLogBatch*)&buffer[offset];
+				const ExamplePersistentRecord* records = (const ExamplePersistentRecord*)(batch + 1);
+				const uint8_t* data = (const uint8_t*)(records + batch->recordCount);
+				for (uint32_t record = 0; record < batch->recordCount; record++) {
+					if (records[record].length > 0 && records[record].value + records[record].length > batch->dataSize) {
+						continue;
+					}
+					apply(records[record], records[record].length > 0 ? data + records[record].value : (const uint8_t*)NULL);
+					count++;
+				}
+				this->sequence = batch->sequence;
+				offset += batchSize;
+			}
+			this->Truncate(offset);
+			return count;
+		}
+
+		// Pending batch
+		void AddValue(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint32_t arrayIndex, const uint16_t dataType, const uint64_t value);
+		void AddData(const uint16_t objectType, const uint32_t objectInstance, const uint32_t propertyIdentifier, const uint32_t arrayIndex, const uint16_t dataType, const void* data, const uint32_t length);
+		uint32_t GetPendingCount() const {
+			return (uint32_t)this->pendingRecords.size();
+		}
+
+		// Appends the pending batch and waits for it to reach the disk. Does nothing if there is no pending record.
+		// If the write or the sync fails the batch stays pending, with the writes added since, for the next commit.
+		bool Commit();
+		// Empties the log and drops the pending batch, after the image has been saved (compaction).
+		bool Reset();
+		// Drops the committed batches before offset, a value of GetSize taken when a checkpoint of the
+		// image was started. The batches committed since then are kept.
+		bool Discard(const uint64_t offset);
+
+		// Size of the committed log in bytes
+		uint64_t GetSize() const {
+			return this->size;
+		}
+
+	private:
+		ExampleWriteAheadLog(const ExampleWriteAheadLog&);
+		ExampleWriteAheadLog& operator=(const ExampleWriteAheadLog&);
+
+		// Reads the committed log from offset to the end
+		bool Read(const uint64_t offset, std::vector<uint8_t>& buffer);
+		// Size of the valid batch at offset, or 0 if there is none
+		size_t GetBatchSize(const std::vector<uint8_t>& buffer, const size_t offset) const;
+		bool Truncate(const uint64_t size);
+
+		std::string path;
+		int fd;
+		uint64_t size;
+		uint64_t sequence;
+
+		std::vector<ExamplePersistentRecord> pendingRecords;
+		std::vector<uint8_t> pendingData;
+		std::vector<uint8_t> batchBuffer;
+};
+
+#endif // __CASBACnetStackExampleWriteAheadLog_h__